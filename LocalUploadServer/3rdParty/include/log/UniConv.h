@@ -55,7 +55,9 @@
 #include <memory>
 #include <algorithm>
 #include <functional>
+#ifdef _WIN32
 #include <io.h>
+#endif // _WIN32
 #include <fcntl.h>
 #include "log/singleton.h"
 
@@ -27,7 +27,7 @@ void LightLogWrite_Impl::SetLogsFileName(const std::wstring& sFilename)
 	if (pLogFileStream.is_open())
 		pLogFileStream.close();
 	ChecksDirectory(sFilename); 
-	pLogFileStream.open(sFilename, std::ios::app);
+	pLogFileStream.open(std::filesystem::path(sFilename), std::ios::app);
 }
 
 // todo: repair this function
@@ -157,7 +157,7 @@ void LightLogWrite_Impl::CreateLogsFile()
 	std::lock_guard<std::mutex> sLock(pLogWriteMutex);
 	ChecksDirectory(sOutFileName);
 	pLogFileStream.close(); 
-	pLogFileStream.open(sOutFileName, std::ios::app);
+	pLogFileStream.open(std::filesystem::path(sOutFileName), std::ios::app);
     pLogFileStream.imbue(std::locale(std::locale(), new std::codecvt_utf8_utf16<wchar_t>));
 }
 
@@ -218,7 +218,7 @@ std::tm LightLogWrite_Impl::GetCurrsTimerTm() const
 #ifdef _WIN32
 	localtime_s(&sCurrTmDatas, &sCurrTimerTm);
 #else
-	localtime_r(&sCurrTmDatas, &sCurrTimerTm);
+	localtime_r(&sCurrTimerTm, &sCurrTmDatas);
 #endif
 	return sCurrTmDatas;
 
@@ -402,9 +402,9 @@ std::uint16_t UniConv::GetCurrentSystemEncodingCodePage() {
 	setlocale(LC_ALL, "");
 	char* locstr = setlocale(LC_CTYPE, NULL);
 	char* encoding = nl_langinfo(CODESET);
-	auto it = m_encodingToCodePage.find(encoding);
+	auto it = m_encodingToCodePageMap.find(encoding);
 
-	if (it != m_encodingToCodePage.end())
+	if (it != m_encodingToCodePageMap.end())
         return it->second;
     else
     {
@@ -678,7 +678,12 @@ std::string UniConv::WideStringToLocale(const std::wstring& sInput) {
     WideCharToMultiByte(CP_ACP, 0, sInput.c_str(), -1, &result[0], bytes_needed, nullptr, nullptr);    return result;
 #else
     // Linux implementation
-    std::wstring_convert<std::codecvt_byname<wchar_t, char, std::mbstate_t>> converter(new std::codecvt_byname<wchar_t, char, std::mbstate_t>(""));
+    // codecvt_byname 的析构函数是 protected，wstring_convert 需要能 delete 它
+    struct LocaleCodecvt : std::codecvt_byname<wchar_t, char, std::mbstate_t> {
+        using std::codecvt_byname<wchar_t, char, std::mbstate_t>::codecvt_byname;
+        ~LocaleCodecvt() override = default;
+    };
+    std::wstring_convert<LocaleCodecvt> converter(new LocaleCodecvt(""));
     return converter.to_bytes(sInput);
 #endif
 }
@@ -192,6 +192,11 @@ struct FBS_SyncUploadFileInfoT : public ::flatbuffers::NativeTable {
   UploadClient::Sync::FBS_SyncUploadStatusInf e_upload_status_inf = UploadClient::Sync::FBS_SyncUploadStatusInf_FBS_SYNC_UPLOAD_STATUS_COMPLETED;
   std::string s_description_info{};
   uint64_t enqueue_time_ms = 0;
+  uint32_t u_chunk_size = 0;
+  std::vector<uint8_t> v_chunk_digests{};
+  std::string s_chunk_root_digest{};
+  bool b_payload_compressed = false;
+  uint64_t u_file_id = 0;
 };
 
 struct FBS_SyncUploadFileInfo FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
@@ -210,47 +215,121 @@ struct FBS_SyncUploadFileInfo FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::T
     VT_U_UPLOAD_TIME_STAMP = 22,
     VT_E_UPLOAD_STATUS_INF = 24,
     VT_S_DESCRIPTION_INFO = 26,
-    VT_ENQUEUE_TIME_MS = 28
+    VT_ENQUEUE_TIME_MS = 28,
+    VT_U_CHUNK_SIZE = 30,
+    VT_V_CHUNK_DIGESTS = 32,
+    VT_S_CHUNK_ROOT_DIGEST = 34,
+    VT_B_PAYLOAD_COMPRESSED = 36,
+    VT_U_FILE_ID = 38
   };
   UploadClient::Sync::FBS_SyncUploadFileTyped e_upload_file_typed() const {
     return static_cast<UploadClient::Sync::FBS_SyncUploadFileTyped>(GetField<int32_t>(VT_E_UPLOAD_FILE_TYPED, 0));
   }
+  bool mutate_e_upload_file_typed(UploadClient::Sync::FBS_SyncUploadFileTyped _e_upload_file_typed = static_cast<UploadClient::Sync::FBS_SyncUploadFileTyped>(0)) {
+    return SetField<int32_t>(VT_E_UPLOAD_FILE_TYPED, static_cast<int32_t>(_e_upload_file_typed), 0);
+  }
   const ::flatbuffers::String *s_lan_client_device() const {
     return GetPointer<const ::flatbuffers::String *>(VT_S_LAN_CLIENT_DEVICE);
   }
+  ::flatbuffers::String *mutable_s_lan_client_device() {
+    return GetPointer<::flatbuffers::String *>(VT_S_LAN_CLIENT_DEVICE);
+  }
   uint64_t s_sync_file_size_value() const {
     return GetField<uint64_t>(VT_S_SYNC_FILE_SIZE_VALUE, 0);
   }
+  bool mutate_s_sync_file_size_value(uint64_t _s_sync_file_size_value = 0) {
+    return SetField<uint64_t>(VT_S_SYNC_FILE_SIZE_VALUE, _s_sync_file_size_value, 0);
+  }
   const ::flatbuffers::String *s_file_full_name_value() const {
     return GetPointer<const ::flatbuffers::String *>(VT_S_FILE_FULL_NAME_VALUE);
   }
+  ::flatbuffers::String *mutable_s_file_full_name_value() {
+    return GetPointer<::flatbuffers::String *>(VT_S_FILE_FULL_NAME_VALUE);
+  }
   const ::flatbuffers::String *s_only_file_name_value() const {
     return GetPointer<const ::flatbuffers::String *>(VT_S_ONLY_FILE_NAME_VALUE);
   }
+  ::flatbuffers::String *mutable_s_only_file_name_value() {
+    return GetPointer<::flatbuffers::String *>(VT_S_ONLY_FILE_NAME_VALUE);
+  }
   const ::flatbuffers::String *s_file_record_time_value() const {
     return GetPointer<const ::flatbuffers::String *>(VT_S_FILE_RECORD_TIME_VALUE);
   }
+  ::flatbuffers::String *mutable_s_file_record_time_value() {
+    return GetPointer<::flatbuffers::String *>(VT_S_FILE_RECORD_TIME_VALUE);
+  }
   const ::flatbuffers::String *s_file_md5_value_info() const {
     return GetPointer<const ::flatbuffers::String *>(VT_S_FILE_MD5_VALUE_INFO);
   }
+  ::flatbuffers::String *mutable_s_file_md5_value_info() {
+    return GetPointer<::flatbuffers::String *>(VT_S_FILE_MD5_VALUE_INFO);
+  }
   UploadClient::Sync::FBS_SyncFileExistPolicy e_file_exist_policy() const {
     return static_cast<UploadClient::Sync::FBS_SyncFileExistPolicy>(GetField<int32_t>(VT_E_FILE_EXIST_POLICY, 0));
   }
+  bool mutate_e_file_exist_policy(UploadClient::Sync::FBS_SyncFileExistPolicy _e_file_exist_policy = static_cast<UploadClient::Sync::FBS_SyncFileExistPolicy>(0)) {
+    return SetField<int32_t>(VT_E_FILE_EXIST_POLICY, static_cast<int32_t>(_e_file_exist_policy), 0);
+  }
   const ::flatbuffers::String *s_auth_token_values() const {
     return GetPointer<const ::flatbuffers::String *>(VT_S_AUTH_TOKEN_VALUES);
   }
+  ::flatbuffers::String *mutable_s_auth_token_values() {
+    return GetPointer<::flatbuffers::String *>(VT_S_AUTH_TOKEN_VALUES);
+  }
   uint64_t u_upload_time_stamp() const {
     return GetField<uint64_t>(VT_U_UPLOAD_TIME_STAMP, 0);
   }
+  bool mutate_u_upload_time_stamp(uint64_t _u_upload_time_stamp = 0) {
+    return SetField<uint64_t>(VT_U_UPLOAD_TIME_STAMP, _u_upload_time_stamp, 0);
+  }
   UploadClient::Sync::FBS_SyncUploadStatusInf e_upload_status_inf() const {
     return static_cast<UploadClient::Sync::FBS_SyncUploadStatusInf>(GetField<int32_t>(VT_E_UPLOAD_STATUS_INF, 0));
   }
+  bool mutate_e_upload_status_inf(UploadClient::Sync::FBS_SyncUploadStatusInf _e_upload_status_inf = static_cast<UploadClient::Sync::FBS_SyncUploadStatusInf>(0)) {
+    return SetField<int32_t>(VT_E_UPLOAD_STATUS_INF, static_cast<int32_t>(_e_upload_status_inf), 0);
+  }
   const ::flatbuffers::String *s_description_info() const {
     return GetPointer<const ::flatbuffers::String *>(VT_S_DESCRIPTION_INFO);
   }
+  ::flatbuffers::String *mutable_s_description_info() {
+    return GetPointer<::flatbuffers::String *>(VT_S_DESCRIPTION_INFO);
+  }
   uint64_t enqueue_time_ms() const {
     return GetField<uint64_t>(VT_ENQUEUE_TIME_MS, 0);
   }
+  bool mutate_enqueue_time_ms(uint64_t _enqueue_time_ms = 0) {
+    return SetField<uint64_t>(VT_ENQUEUE_TIME_MS, _enqueue_time_ms, 0);
+  }
+  uint32_t u_chunk_size() const {
+    return GetField<uint32_t>(VT_U_CHUNK_SIZE, 0);
+  }
+  bool mutate_u_chunk_size(uint32_t _u_chunk_size = 0) {
+    return SetField<uint32_t>(VT_U_CHUNK_SIZE, _u_chunk_size, 0);
+  }
+  const ::flatbuffers::Vector<uint8_t> *v_chunk_digests() const {
+    return GetPointer<const ::flatbuffers::Vector<uint8_t> *>(VT_V_CHUNK_DIGESTS);
+  }
+  ::flatbuffers::Vector<uint8_t> *mutable_v_chunk_digests() {
+    return GetPointer<::flatbuffers::Vector<uint8_t> *>(VT_V_CHUNK_DIGESTS);
+  }
+  const ::flatbuffers::String *s_chunk_root_digest() const {
+    return GetPointer<const ::flatbuffers::String *>(VT_S_CHUNK_ROOT_DIGEST);
+  }
+  ::flatbuffers::String *mutable_s_chunk_root_digest() {
+    return GetPointer<::flatbuffers::String *>(VT_S_CHUNK_ROOT_DIGEST);
+  }
+  bool b_payload_compressed() const {
+    return GetField<uint8_t>(VT_B_PAYLOAD_COMPRESSED, 0) != 0;
+  }
+  bool mutate_b_payload_compressed(bool _b_payload_compressed = 0) {
+    return SetField<uint8_t>(VT_B_PAYLOAD_COMPRESSED, static_cast<uint8_t>(_b_payload_compressed), 0);
+  }
+  uint64_t u_file_id() const {
+    return GetField<uint64_t>(VT_U_FILE_ID, 0);
+  }
+  bool mutate_u_file_id(uint64_t _u_file_id = 0) {
+    return SetField<uint64_t>(VT_U_FILE_ID, _u_file_id, 0);
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int32_t>(verifier, VT_E_UPLOAD_FILE_TYPED, 4) &&
@@ -273,6 +352,13 @@ struct FBS_SyncUploadFileInfo FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::T
            VerifyOffset(verifier, VT_S_DESCRIPTION_INFO) &&
            verifier.VerifyString(s_description_info()) &&
            VerifyField<uint64_t>(verifier, VT_ENQUEUE_TIME_MS, 8) &&
+           VerifyField<uint32_t>(verifier, VT_U_CHUNK_SIZE, 4) &&
+           VerifyOffset(verifier, VT_V_CHUNK_DIGESTS) &&
+           verifier.VerifyVector(v_chunk_digests()) &&
+           VerifyOffset(verifier, VT_S_CHUNK_ROOT_DIGEST) &&
+           verifier.VerifyString(s_chunk_root_digest()) &&
+           VerifyField<uint8_t>(verifier, VT_B_PAYLOAD_COMPRESSED, 1) &&
+           VerifyField<uint64_t>(verifier, VT_U_FILE_ID, 8) &&
            verifier.EndTable();
   }
   FBS_SyncUploadFileInfoT *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -323,6 +409,21 @@ struct FBS_SyncUploadFileInfoBuilder {
   void add_enqueue_time_ms(uint64_t enqueue_time_ms) {
     fbb_.AddElement<uint64_t>(FBS_SyncUploadFileInfo::VT_ENQUEUE_TIME_MS, enqueue_time_ms, 0);
   }
+  void add_u_chunk_size(uint32_t u_chunk_size) {
+    fbb_.AddElement<uint32_t>(FBS_SyncUploadFileInfo::VT_U_CHUNK_SIZE, u_chunk_size, 0);
+  }
+  void add_v_chunk_digests(::flatbuffers::Offset<::flatbuffers::Vector<uint8_t>> v_chunk_digests) {
+    fbb_.AddOffset(FBS_SyncUploadFileInfo::VT_V_CHUNK_DIGESTS, v_chunk_digests);
+  }
+  void add_s_chunk_root_digest(::flatbuffers::Offset<::flatbuffers::String> s_chunk_root_digest) {
+    fbb_.AddOffset(FBS_SyncUploadFileInfo::VT_S_CHUNK_ROOT_DIGEST, s_chunk_root_digest);
+  }
+  void add_b_payload_compressed(bool b_payload_compressed) {
+    fbb_.AddElement<uint8_t>(FBS_SyncUploadFileInfo::VT_B_PAYLOAD_COMPRESSED, static_cast<uint8_t>(b_payload_compressed), 0);
+  }
+  void add_u_file_id(uint64_t u_file_id) {
+    fbb_.AddElement<uint64_t>(FBS_SyncUploadFileInfo::VT_U_FILE_ID, u_file_id, 0);
+  }
   explicit FBS_SyncUploadFileInfoBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -348,11 +449,20 @@ inline ::flatbuffers::Offset<FBS_SyncUploadFileInfo> CreateFBS_SyncUploadFileInf
     uint64_t u_upload_time_stamp = 0,
     UploadClient::Sync::FBS_SyncUploadStatusInf e_upload_status_inf = UploadClient::Sync::FBS_SyncUploadStatusInf_FBS_SYNC_UPLOAD_STATUS_COMPLETED,
     ::flatbuffers::Offset<::flatbuffers::String> s_description_info = 0,
-    uint64_t enqueue_time_ms = 0) {
+    uint64_t enqueue_time_ms = 0,
+    uint32_t u_chunk_size = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint8_t>> v_chunk_digests = 0,
+    ::flatbuffers::Offset<::flatbuffers::String> s_chunk_root_digest = 0,
+    bool b_payload_compressed = false,
+    uint64_t u_file_id = 0) {
   FBS_SyncUploadFileInfoBuilder builder_(_fbb);
+  builder_.add_u_file_id(u_file_id);
   builder_.add_enqueue_time_ms(enqueue_time_ms);
   builder_.add_u_upload_time_stamp(u_upload_time_stamp);
   builder_.add_s_sync_file_size_value(s_sync_file_size_value);
+  builder_.add_s_chunk_root_digest(s_chunk_root_digest);
+  builder_.add_v_chunk_digests(v_chunk_digests);
+  builder_.add_u_chunk_size(u_chunk_size);
   builder_.add_s_description_info(s_description_info);
   builder_.add_e_upload_status_inf(e_upload_status_inf);
   builder_.add_s_auth_token_values(s_auth_token_values);
@@ -363,6 +473,7 @@ inline ::flatbuffers::Offset<FBS_SyncUploadFileInfo> CreateFBS_SyncUploadFileInf
   builder_.add_s_file_full_name_value(s_file_full_name_value);
   builder_.add_s_lan_client_device(s_lan_client_device);
   builder_.add_e_upload_file_typed(e_upload_file_typed);
+  builder_.add_b_payload_compressed(b_payload_compressed);
   return builder_.Finish();
 }
 
@@ -380,7 +491,12 @@ inline ::flatbuffers::Offset<FBS_SyncUploadFileInfo> CreateFBS_SyncUploadFileInf
     uint64_t u_upload_time_stamp = 0,
     UploadClient::Sync::FBS_SyncUploadStatusInf e_upload_status_inf = UploadClient::Sync::FBS_SyncUploadStatusInf_FBS_SYNC_UPLOAD_STATUS_COMPLETED,
     const char *s_description_info = nullptr,
-    uint64_t enqueue_time_ms = 0) {
+    uint64_t enqueue_time_ms = 0,
+    uint32_t u_chunk_size = 0,
+    const std::vector<uint8_t> *v_chunk_digests = nullptr,
+    const char *s_chunk_root_digest = nullptr,
+    bool b_payload_compressed = false,
+    uint64_t u_file_id = 0) {
   auto s_lan_client_device__ = s_lan_client_device ? _fbb.CreateString(s_lan_client_device) : 0;
   auto s_file_full_name_value__ = s_file_full_name_value ? _fbb.CreateString(s_file_full_name_value) : 0;
   auto s_only_file_name_value__ = s_only_file_name_value ? _fbb.CreateString(s_only_file_name_value) : 0;
@@ -388,6 +504,8 @@ inline ::flatbuffers::Offset<FBS_SyncUploadFileInfo> CreateFBS_SyncUploadFileInf
   auto s_file_md5_value_info__ = s_file_md5_value_info ? _fbb.CreateString(s_file_md5_value_info) : 0;
   auto s_auth_token_values__ = s_auth_token_values ? _fbb.CreateString(s_auth_token_values) : 0;
   auto s_description_info__ = s_description_info ? _fbb.CreateString(s_description_info) : 0;
+  auto v_chunk_digests__ = v_chunk_digests ? _fbb.CreateVector<uint8_t>(*v_chunk_digests) : 0;
+  auto s_chunk_root_digest__ = s_chunk_root_digest ? _fbb.CreateString(s_chunk_root_digest) : 0;
   return UploadClient::Sync::CreateFBS_SyncUploadFileInfo(
       _fbb,
       e_upload_file_typed,
@@ -402,7 +520,12 @@ inline ::flatbuffers::Offset<FBS_SyncUploadFileInfo> CreateFBS_SyncUploadFileInf
       u_upload_time_stamp,
       e_upload_status_inf,
       s_description_info__,
-      enqueue_time_ms);
+      enqueue_time_ms,
+      u_chunk_size,
+      v_chunk_digests__,
+      s_chunk_root_digest__,
+      b_payload_compressed,
+      u_file_id);
 }
 
 ::flatbuffers::Offset<FBS_SyncUploadFileInfo> CreateFBS_SyncUploadFileInfo(::flatbuffers::FlatBufferBuilder &_fbb, const FBS_SyncUploadFileInfoT *_o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
@@ -431,21 +554,39 @@ struct FBS_HeartbeatMessage FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Tab
   UploadClient::Sync::FBS_HeartbeatType type() const {
     return static_cast<UploadClient::Sync::FBS_HeartbeatType>(GetField<int8_t>(VT_TYPE, 0));
   }
+  bool mutate_type(UploadClient::Sync::FBS_HeartbeatType _type = static_cast<UploadClient::Sync::FBS_HeartbeatType>(0)) {
+    return SetField<int8_t>(VT_TYPE, static_cast<int8_t>(_type), 0);
+  }
   uint32_t sequence() const {
     return GetField<uint32_t>(VT_SEQUENCE, 0);
   }
+  bool mutate_sequence(uint32_t _sequence = 0) {
+    return SetField<uint32_t>(VT_SEQUENCE, _sequence, 0);
+  }
   uint64_t timestamp() const {
     return GetField<uint64_t>(VT_TIMESTAMP, 0);
   }
+  bool mutate_timestamp(uint64_t _timestamp = 0) {
+    return SetField<uint64_t>(VT_TIMESTAMP, _timestamp, 0);
+  }
   const ::flatbuffers::String *client_name() const {
     return GetPointer<const ::flatbuffers::String *>(VT_CLIENT_NAME);
   }
+  ::flatbuffers::String *mutable_client_name() {
+    return GetPointer<::flatbuffers::String *>(VT_CLIENT_NAME);
+  }
   const ::flatbuffers::String *client_version() const {
     return GetPointer<const ::flatbuffers::String *>(VT_CLIENT_VERSION);
   }
+  ::flatbuffers::String *mutable_client_version() {
+    return GetPointer<::flatbuffers::String *>(VT_CLIENT_VERSION);
+  }
   const ::flatbuffers::String *payload() const {
     return GetPointer<const ::flatbuffers::String *>(VT_PAYLOAD);
   }
+  ::flatbuffers::String *mutable_payload() {
+    return GetPointer<::flatbuffers::String *>(VT_PAYLOAD);
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int8_t>(verifier, VT_TYPE, 1) &&
@@ -560,6 +701,11 @@ inline void FBS_SyncUploadFileInfo::UnPackTo(FBS_SyncUploadFileInfoT *_o, const
   { auto _e = e_upload_status_inf(); _o->e_upload_status_inf = _e; }
   { auto _e = s_description_info(); if (_e) _o->s_description_info = _e->str(); }
   { auto _e = enqueue_time_ms(); _o->enqueue_time_ms = _e; }
+  { auto _e = u_chunk_size(); _o->u_chunk_size = _e; }
+  { auto _e = v_chunk_digests(); if (_e) { _o->v_chunk_digests.resize(_e->size()); std::copy(_e->begin(), _e->end(), _o->v_chunk_digests.begin()); } }
+  { auto _e = s_chunk_root_digest(); if (_e) _o->s_chunk_root_digest = _e->str(); }
+  { auto _e = b_payload_compressed(); _o->b_payload_compressed = _e; }
+  { auto _e = u_file_id(); _o->u_file_id = _e; }
 }
 
 inline ::flatbuffers::Offset<FBS_SyncUploadFileInfo> FBS_SyncUploadFileInfo::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const FBS_SyncUploadFileInfoT* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
@@ -583,6 +729,11 @@ inline ::flatbuffers::Offset<FBS_SyncUploadFileInfo> CreateFBS_SyncUploadFileInf
   auto _e_upload_status_inf = _o->e_upload_status_inf;
   auto _s_description_info = _o->s_description_info.empty() ? 0 : _fbb.CreateString(_o->s_description_info);
   auto _enqueue_time_ms = _o->enqueue_time_ms;
+  auto _u_chunk_size = _o->u_chunk_size;
+  auto _v_chunk_digests = _o->v_chunk_digests.size() ? _fbb.CreateVector(_o->v_chunk_digests) : 0;
+  auto _s_chunk_root_digest = _o->s_chunk_root_digest.empty() ? 0 : _fbb.CreateString(_o->s_chunk_root_digest);
+  auto _b_payload_compressed = _o->b_payload_compressed;
+  auto _u_file_id = _o->u_file_id;
   return UploadClient::Sync::CreateFBS_SyncUploadFileInfo(
       _fbb,
       _e_upload_file_typed,
@@ -597,7 +748,12 @@ inline ::flatbuffers::Offset<FBS_SyncUploadFileInfo> CreateFBS_SyncUploadFileInf
       _u_upload_time_stamp,
       _e_upload_status_inf,
       _s_description_info,
-      _enqueue_time_ms);
+      _enqueue_time_ms,
+      _u_chunk_size,
+      _v_chunk_digests,
+      _s_chunk_root_digest,
+      _b_payload_compressed,
+      _u_file_id);
 }
 
 inline FBS_HeartbeatMessageT *FBS_HeartbeatMessage::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
@@ -649,6 +805,14 @@ inline const UploadClient::Sync::FBS_SyncUploadFileInfo *GetSizePrefixedFBS_Sync
   return ::flatbuffers::GetSizePrefixedRoot<UploadClient::Sync::FBS_SyncUploadFileInfo>(buf);
 }
 
+inline UploadClient::Sync::FBS_SyncUploadFileInfo *GetMutableFBS_SyncUploadFileInfo(void *buf) {
+  return ::flatbuffers::GetMutableRoot<UploadClient::Sync::FBS_SyncUploadFileInfo>(buf);
+}
+
+inline UploadClient::Sync::FBS_SyncUploadFileInfo *GetMutableSizePrefixedFBS_SyncUploadFileInfo(void *buf) {
+  return ::flatbuffers::GetMutableSizePrefixedRoot<UploadClient::Sync::FBS_SyncUploadFileInfo>(buf);
+}
+
 inline bool VerifyFBS_SyncUploadFileInfoBuffer(
     ::flatbuffers::Verifier &verifier) {
   return verifier.VerifyBuffer<UploadClient::Sync::FBS_SyncUploadFileInfo>(nullptr);
@@ -0,0 +1,378 @@
+/**
+ * @file io_uring_benchmark.cpp
+ * @brief asio 的 epoll 反应器与 io_uring(LUSP_IO_URING)在套接字读与文件写上的对比
+ *
+ * 反应器在编译期选定，同一份源码分别按 epoll 与 io_uring 构建各跑一次，对比两次的输出：
+ * 1. 套接字: connections 条回环连接，客户端一问一答发送 payload 字节的消息，服务端原样回写；
+ *    io_uring 构建下服务端每条连接的读缓冲区向内核注册(IORING_OP_READ_FIXED)，与 IPC 服务端一致
+ * 2. 文件写: 按 block 字节的块顺序写 file-mb MB，同时在途 depth 个写请求，最后 fdatasync；
+ *    io_uring 构建用 asio::random_access_file + 注册缓冲区(IORING_OP_WRITE_FIXED)，
+ *    epoll 构建下 asio 没有文件支持，用与 Lusp_PositionalFile 相同的同步 pwrite(一次一个块)
+ *
+ * --no-register 时 io_uring 构建也使用普通缓冲区，用于单独衡量注册缓冲区本身的收益。
+ *
+ * 用法: io_uring_benchmark [--connections <n>] [--rounds <n>] [--payload <bytes>]
+ *                          [--file-mb <n>] [--block <bytes>] [--depth <n>] [--path <file>] [--no-register]
+ *
+ * 构建(在 LocalUploadServer 目录下，仅 Linux):
+ *   g++ -std=c++17 -O2 -I3rdParty/include -I3rdParty/include/asio examples/io_uring_benchmark.cpp -pthread -o io_uring_benchmark_epoll
+ *   g++ -std=c++17 -O2 -DASIO_HAS_IO_URING -DASIO_DISABLE_EPOLL -I3rdParty/include -I3rdParty/include/asio \
+ *       examples/io_uring_benchmark.cpp -pthread -luring -o io_uring_benchmark_uring
+ */
+
+#include "asio/asio.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(__linux__)
+#error "io_uring_benchmark is Linux only"
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+    constexpr const char* kBackend = "io_uring";
+#else
+    constexpr const char* kBackend = "epoll";
+#endif
+
+    struct BenchmarkOptions {
+        uint32_t connections = 8;
+        uint32_t rounds = 20000;        // 每条连接的往返次数
+        uint32_t payload = 512;
+        uint32_t file_mb = 256;
+        uint32_t block = 256 * 1024;
+        uint32_t depth = 8;
+        std::string path = "io_uring_benchmark.tmp";
+        bool registered = true;
+    };
+
+    uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    double percentile_us(std::vector<uint64_t> values, double fraction) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index] / 1000.0;
+    }
+
+    // ---- 套接字 ----
+
+    // 回写服务端：每条连接一块读缓冲区，注册时从同一块连续内存切出
+    class EchoServer {
+    public:
+        EchoServer(asio::io_context& io, const BenchmarkOptions& options)
+            : io_(io), acceptor_(io, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0)) {
+            storage_.resize(static_cast<size_t>(options.connections) * options.payload);
+            for (uint32_t i = 0; i < options.connections; ++i) {
+                buffers_.push_back(asio::buffer(storage_.data() + static_cast<size_t>(i) * options.payload, options.payload));
+            }
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+            if (options.registered) {
+                registration_ = std::make_unique<asio::buffer_registration<std::vector<asio::mutable_buffer>>>(
+                    asio::register_buffers(io_, buffers_));
+            }
+#endif
+        }
+
+        uint16_t port() const { return acceptor_.local_endpoint().port(); }
+
+        void start() { do_accept(); }
+        void stop() { asio::post(io_, [this]() { acceptor_.close(); }); }
+
+    private:
+        struct Connection {
+            explicit Connection(asio::io_context& io) : socket(io) {}
+            asio::ip::tcp::socket socket;
+            size_t slot = 0;
+        };
+
+        void do_accept() {
+            auto connection = std::make_shared<Connection>(io_);
+            acceptor_.async_accept(connection->socket, [this, connection](std::error_code ec) {
+                if (ec) {
+                    return;
+                }
+                connection->socket.set_option(asio::ip::tcp::no_delay(true));
+                connection->slot = next_slot_++ % buffers_.size();
+                do_read(connection);
+                do_accept();
+                });
+        }
+
+        void do_read(const std::shared_ptr<Connection>& connection) {
+            auto handler = [this, connection](std::error_code ec, std::size_t len) {
+                if (ec) {
+                    return;
+                }
+                asio::async_write(connection->socket, asio::buffer(buffers_[connection->slot].data(), len),
+                    [this, connection](std::error_code write_ec, std::size_t) {
+                        if (!write_ec) {
+                            do_read(connection);
+                        }
+                    });
+                };
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+            if (registration_) {
+                connection->socket.async_read_some((*registration_)[connection->slot], std::move(handler));
+                return;
+            }
+#endif
+            connection->socket.async_read_some(buffers_[connection->slot], std::move(handler));
+        }
+
+        asio::io_context& io_;
+        asio::ip::tcp::acceptor acceptor_;
+        std::vector<char> storage_;
+        std::vector<asio::mutable_buffer> buffers_;
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+        std::unique_ptr<asio::buffer_registration<std::vector<asio::mutable_buffer>>> registration_;
+#endif
+        size_t next_slot_ = 0;
+    };
+
+    // 一问一答的客户端：写出整条消息后读满同样长度再发下一条
+    class EchoClient : public std::enable_shared_from_this<EchoClient> {
+    public:
+        EchoClient(asio::io_context& io, const BenchmarkOptions& options, std::vector<uint64_t>& rtt_ns)
+            : socket_(io), options_(options), rtt_ns_(rtt_ns),
+            out_(options.payload, 'x'), in_(options.payload) {}
+
+        void start(uint16_t port) {
+            socket_.connect(asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), port));
+            socket_.set_option(asio::ip::tcp::no_delay(true));
+            send();
+        }
+
+    private:
+        void send() {
+            sent_at_ = now_ns();
+            auto self = shared_from_this();
+            asio::async_write(socket_, asio::buffer(out_), [this, self](std::error_code ec, std::size_t) {
+                if (ec) {
+                    return;
+                }
+                asio::async_read(socket_, asio::buffer(in_), [this, self](std::error_code read_ec, std::size_t) {
+                    if (read_ec) {
+                        return;
+                    }
+                    rtt_ns_.push_back(now_ns() - sent_at_);
+                    if (++done_ < options_.rounds) {
+                        send();
+                    }
+                    else {
+                        socket_.close();
+                    }
+                    });
+                });
+        }
+
+        asio::ip::tcp::socket socket_;
+        const BenchmarkOptions& options_;
+        std::vector<uint64_t>& rtt_ns_;
+        std::vector<char> out_;
+        std::vector<char> in_;
+        uint64_t sent_at_ = 0;
+        uint32_t done_ = 0;
+    };
+
+    void run_socket(const BenchmarkOptions& options) {
+        asio::io_context server_io(1);
+        EchoServer server(server_io, options);
+        server.start();
+        std::thread server_thread([&server_io]() { server_io.run(); });
+
+        asio::io_context client_io(1);
+        std::vector<uint64_t> rtt_ns;
+        rtt_ns.reserve(static_cast<size_t>(options.connections) * options.rounds);
+        for (uint32_t i = 0; i < options.connections; ++i) {
+            std::make_shared<EchoClient>(client_io, options, rtt_ns)->start(server.port());
+        }
+        const uint64_t begin = now_ns();
+        client_io.run();
+        const double seconds = (now_ns() - begin) / 1e9;
+
+        server.stop();
+        server_io.stop();
+        server_thread.join();
+
+        std::cout << "  socket     " << std::fixed
+            << " p50 " << std::setprecision(1) << std::setw(7) << percentile_us(rtt_ns, 0.50) << " us"
+            << "  p99 " << std::setw(7) << percentile_us(rtt_ns, 0.99) << " us"
+            << "  " << std::setprecision(0) << std::setw(8) << (seconds > 0 ? rtt_ns.size() / seconds : 0.0) << " msg/s"
+            << std::endl;
+    }
+
+    // ---- 文件写 ----
+
+    void print_file_result(uint64_t bytes, uint64_t begin, uint64_t written_at) {
+        const double write_seconds = (written_at - begin) / 1e9;
+        const double total_seconds = (now_ns() - begin) / 1e9;
+        std::cout << "  file write " << std::fixed << std::setprecision(0)
+            << std::setw(7) << (write_seconds > 0 ? bytes / write_seconds / (1024.0 * 1024.0) : 0.0) << " MB/s"
+            << "  (" << std::setw(7) << (total_seconds > 0 ? bytes / total_seconds / (1024.0 * 1024.0) : 0.0)
+            << " MB/s incl. fdatasync)" << std::endl;
+    }
+
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+    // depth 个块各自循环：写完一块就领取下一个偏移，直到写满 total
+    class FileWriter {
+    public:
+        FileWriter(asio::io_context& io, const BenchmarkOptions& options)
+            : file_(io, options.path, asio::random_access_file::write_only |
+                asio::random_access_file::create | asio::random_access_file::truncate),
+            options_(options),
+            total_(static_cast<uint64_t>(options.file_mb) * 1024 * 1024) {
+            storage_.assign(static_cast<size_t>(options.depth) * options.block, 'x');
+            for (uint32_t i = 0; i < options.depth; ++i) {
+                buffers_.push_back(asio::buffer(storage_.data() + static_cast<size_t>(i) * options.block, options.block));
+            }
+            if (options.registered) {
+                registration_ = std::make_unique<asio::buffer_registration<std::vector<asio::mutable_buffer>>>(
+                    asio::register_buffers(io, buffers_));
+            }
+        }
+
+        void start() {
+            for (uint32_t i = 0; i < options_.depth; ++i) {
+                write_next(i);
+            }
+        }
+
+        void sync() { ::fdatasync(file_.native_handle()); }
+
+    private:
+        void write_next(uint32_t slot) {
+            if (next_offset_ >= total_) {
+                return;
+            }
+            const uint64_t offset = next_offset_;
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(options_.block, total_ - offset));
+            next_offset_ += length;
+            auto handler = [this, slot](std::error_code ec, std::size_t) {
+                if (ec) {
+                    std::cerr << "write failed: " << ec.message() << std::endl;
+                    return;
+                }
+                write_next(slot);
+                };
+            if (registration_) {
+                asio::async_write_at(file_, offset, asio::buffer((*registration_)[slot], length), std::move(handler));
+            }
+            else {
+                asio::async_write_at(file_, offset, asio::buffer(buffers_[slot], length), std::move(handler));
+            }
+        }
+
+        asio::random_access_file file_;
+        const BenchmarkOptions& options_;
+        const uint64_t total_;
+        uint64_t next_offset_ = 0;
+        std::vector<char> storage_;
+        std::vector<asio::mutable_buffer> buffers_;
+        std::unique_ptr<asio::buffer_registration<std::vector<asio::mutable_buffer>>> registration_;
+    };
+
+    void run_file(const BenchmarkOptions& options) {
+        asio::io_context io(1);
+        FileWriter writer(io, options);
+        const uint64_t begin = now_ns();
+        writer.start();
+        io.run();
+        const uint64_t written_at = now_ns();
+        writer.sync();
+        print_file_result(static_cast<uint64_t>(options.file_mb) * 1024 * 1024, begin, written_at);
+    }
+#else
+    void run_file(const BenchmarkOptions& options) {
+        const int fd = ::open(options.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            std::cerr << "open " << options.path << " failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        const std::vector<char> block(options.block, 'x');
+        const uint64_t total = static_cast<uint64_t>(options.file_mb) * 1024 * 1024;
+        const uint64_t begin = now_ns();
+        for (uint64_t offset = 0; offset < total;) {
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(block.size(), total - offset));
+            const ssize_t done = ::pwrite(fd, block.data(), length, static_cast<off_t>(offset));
+            if (done < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "pwrite failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+            offset += static_cast<uint64_t>(done);
+        }
+        const uint64_t written_at = now_ns();
+        ::fdatasync(fd);
+        ::close(fd);
+        print_file_result(total, begin, written_at);
+    }
+#endif
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--connections" && i + 1 < argc) {
+            options.connections = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--rounds" && i + 1 < argc) {
+            options.rounds = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--payload" && i + 1 < argc) {
+            options.payload = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--file-mb" && i + 1 < argc) {
+            options.file_mb = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--block" && i + 1 < argc) {
+            options.block = std::max<uint32_t>(4096, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--depth" && i + 1 < argc) {
+            options.depth = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--path" && i + 1 < argc) {
+            options.path = argv[++i];
+        }
+        else if (arg == "--no-register") {
+            options.registered = false;
+        }
+    }
+
+    std::cout << kBackend;
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+    std::cout << (options.registered ? " (registered buffers)" : " (plain buffers)");
+#endif
+    std::cout << ": " << options.connections << " connections x " << options.rounds << " round trips, payload "
+        << options.payload << " B; file " << options.file_mb << " MB in " << options.block << " B blocks";
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+    std::cout << ", depth " << options.depth;
+#endif
+    std::cout << std::endl;
+
+    run_socket(options);
+    if (options.file_mb > 0) {
+        run_file(options);
+        std::remove(options.path.c_str());
+    }
+    return 0;
+}
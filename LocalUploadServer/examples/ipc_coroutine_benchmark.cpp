@@ -0,0 +1,421 @@
+/**
+ * @file ipc_coroutine_benchmark.cpp
+ * @brief 回环 IPC 回调链与协程(LUSP_IPC_COROUTINES)两种读写循环的分配次数与延迟对比
+ *
+ * 服务端与客户端各用一个 io_context 线程，按 IPC 协议(4字节小端长度前缀)互发消息，服务端原样回写：
+ * 1. 回调版本照搬现有写法: 服务端每次读分配临时缓冲区、每个回包一个 shared_ptr 缓冲区；
+ *    客户端每条消息一个 shared_ptr 帧，读回调里再发下一条
+ * 2. 协程版本照搬 LUSP_IPC_COROUTINES 写法: 每个连接一个读循环，客户端另有一个发送循环，
+ *    读缓冲区、帧缓冲区跟随连接复用，回包按批合并写出
+ *
+ * 分配次数统计全局 operator new(asio 的对齐分配也改走 operator new)，预热后按消息平均；
+ * 往返时延取自消息体里的发送时间戳。window 为客户端同时在途的消息数(1 = 一问一答)。
+ *
+ * 用法: ipc_coroutine_benchmark [--rounds <n>] [--payload <bytes>] [--window <n>]
+ *
+ * 构建(在 LocalUploadServer 目录下):
+ *   cl /std:c++20 /O2 /EHsc /utf-8 /I3rdParty\include /I3rdParty\include\asio examples\ipc_coroutine_benchmark.cpp
+ */
+
+#define ASIO_DISABLE_STD_ALIGNED_ALLOC
+#include "asio/asio.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(ASIO_HAS_CO_AWAIT)
+#error "ipc_coroutine_benchmark requires C++20 coroutine support"
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+// 替换后的 operator new/delete 内联进 asio 后 GCC 会误报 new/free 不配对
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+    std::atomic<uint64_t> g_allocations{ 0 };
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+    constexpr size_t kReadBufferSize = 8192;    // 与 server_config.toml 的 buffer_size 一致
+    constexpr auto use_awaitable_tuple = asio::as_tuple(asio::use_awaitable);
+
+    uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 帧: 4字节小端长度 + 消息体(前8字节为发送时间戳)
+    void encode_frame(std::vector<char>& frame, uint32_t payload) {
+        frame.resize(4 + payload);
+        frame[0] = static_cast<char>(payload & 0xFF);
+        frame[1] = static_cast<char>((payload >> 8) & 0xFF);
+        frame[2] = static_cast<char>((payload >> 16) & 0xFF);
+        frame[3] = static_cast<char>((payload >> 24) & 0xFF);
+        const uint64_t stamp = now_ns();
+        std::memcpy(frame.data() + 4, &stamp, sizeof(stamp));
+    }
+
+    // 逐个交出 buffer 中的完整帧(含长度前缀)，剩余半包留在 buffer
+    template <typename F>
+    void take_frames(std::vector<char>& buffer, F&& on_frame) {
+        size_t offset = 0;
+        while (buffer.size() - offset >= 4) {
+            const char* head = buffer.data() + offset;
+            uint32_t len = 0;
+            len |= (uint8_t)head[0];
+            len |= ((uint8_t)head[1] << 8);
+            len |= ((uint8_t)head[2] << 16);
+            len |= ((uint8_t)head[3] << 24);
+            if (buffer.size() - offset < 4 + static_cast<size_t>(len)) {
+                break;
+            }
+            on_frame(head, 4 + static_cast<size_t>(len));
+            offset += 4 + static_cast<size_t>(len);
+        }
+        if (offset > 0) {
+            buffer.erase(buffer.begin(), buffer.begin() + offset);
+        }
+    }
+
+    struct BenchmarkOptions {
+        uint32_t rounds = 20000;
+        uint32_t payload = 64;
+        uint32_t window = 1;
+    };
+
+    // 客户端两种实现共用的计数与时延记录
+    struct ClientProgress {
+        explicit ClientProgress(const BenchmarkOptions& options)
+            : options(options), warmup(std::max<uint32_t>(1, options.rounds / 10)) {
+            rtt_ns.reserve(options.rounds);
+        }
+
+        void on_reply(const char* frame) {
+            uint64_t stamp = 0;
+            std::memcpy(&stamp, frame + 4, sizeof(stamp));
+            rtt_ns.push_back(now_ns() - stamp);
+            if (++received == warmup) {
+                allocations_at_warmup = g_allocations.load(std::memory_order_relaxed);
+                time_at_warmup = now_ns();
+            }
+        }
+
+        bool finished() const { return received >= options.rounds; }
+        bool may_send() const { return sent < options.rounds; }
+
+        BenchmarkOptions options;
+        uint32_t warmup;
+        uint32_t sent = 0;
+        uint32_t received = 0;
+        uint64_t allocations_at_warmup = 0;
+        uint64_t time_at_warmup = 0;
+        std::vector<uint64_t> rtt_ns;
+    };
+
+    // ---- 回调版本 ----
+
+    class CallbackServer {
+    public:
+        CallbackServer(asio::io_context& io, uint16_t port)
+            : io_(io), acceptor_(io, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), port)) {}
+
+        void start() { do_accept(); }
+        void stop() { asio::post(io_, [this]() { acceptor_.close(); }); }
+
+    private:
+        void do_accept() {
+            auto socket = std::make_shared<asio::ip::tcp::socket>(io_);
+            auto state = std::make_shared<std::vector<char>>();
+            acceptor_.async_accept(*socket, [this, socket, state](std::error_code ec) {
+                if (!ec) {
+                    do_read(socket, state);
+                    do_accept();
+                }
+                });
+        }
+
+        void do_read(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<std::vector<char>> state) {
+            auto temp_buffer = std::make_shared<std::vector<char>>(kReadBufferSize);
+            socket->async_read_some(asio::buffer(*temp_buffer), [this, socket, state, temp_buffer](std::error_code ec, std::size_t len) {
+                if (ec) {
+                    return;
+                }
+                state->insert(state->end(), temp_buffer->begin(), temp_buffer->begin() + len);
+                take_frames(*state, [&socket](const char* frame, size_t size) {
+                    auto reply = std::make_shared<std::vector<char>>(frame, frame + size);
+                    asio::async_write(*socket, asio::buffer(*reply), [reply](std::error_code, std::size_t) {});
+                    });
+                do_read(socket, state);
+                });
+        }
+
+        asio::io_context& io_;
+        asio::ip::tcp::acceptor acceptor_;
+    };
+
+    class CallbackClient {
+    public:
+        CallbackClient(asio::io_context& io, ClientProgress& progress)
+            : socket_(std::make_shared<asio::ip::tcp::socket>(io)),
+            buffer_(std::make_shared<std::vector<char>>(kReadBufferSize)),
+            progress_(progress) {}
+
+        void start(uint16_t port) {
+            socket_->connect(asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), port));
+            socket_->set_option(asio::ip::tcp::no_delay(true));
+            do_read();
+            for (uint32_t i = 0; i < progress_.options.window && progress_.may_send(); ++i) {
+                ++pending_;
+                ++progress_.sent;
+            }
+            do_send();
+        }
+
+    private:
+        void do_send() {
+            if (is_sending_ || pending_ == 0) {
+                return;
+            }
+            is_sending_ = true;
+            --pending_;
+            std::vector<char> buffer;
+            encode_frame(buffer, progress_.options.payload);
+            auto data = std::make_shared<std::vector<char>>(std::move(buffer));
+            asio::async_write(*socket_, asio::buffer(*data), [this, data](std::error_code ec, std::size_t) {
+                is_sending_ = false;
+                if (!ec) {
+                    do_send();
+                }
+                });
+        }
+
+        void do_read() {
+            socket_->async_read_some(asio::buffer(*buffer_), [this](std::error_code ec, std::size_t len) {
+                if (ec) {
+                    return;
+                }
+                inbox_.insert(inbox_.end(), buffer_->begin(), buffer_->begin() + len);
+                take_frames(inbox_, [this](const char* frame, size_t) {
+                    progress_.on_reply(frame);
+                    if (progress_.may_send()) {
+                        ++pending_;
+                        ++progress_.sent;
+                    }
+                    });
+                if (progress_.finished()) {
+                    socket_->close();
+                    return;
+                }
+                do_send();
+                do_read();
+                });
+        }
+
+        std::shared_ptr<asio::ip::tcp::socket> socket_;
+        std::shared_ptr<std::vector<char>> buffer_;
+        std::vector<char> inbox_;
+        ClientProgress& progress_;
+        uint32_t pending_ = 0;
+        bool is_sending_ = false;
+    };
+
+    // ---- 协程版本 ----
+
+    asio::awaitable<void> coroutine_session(asio::ip::tcp::socket socket) {
+        std::vector<char> chunk(kReadBufferSize);
+        std::vector<char> inbox;
+        std::vector<char> replies;
+        while (true) {
+            auto [ec, len] = co_await socket.async_read_some(asio::buffer(chunk), use_awaitable_tuple);
+            if (ec) {
+                co_return;
+            }
+            inbox.insert(inbox.end(), chunk.begin(), chunk.begin() + len);
+            take_frames(inbox, [&replies](const char* frame, size_t size) {
+                replies.insert(replies.end(), frame, frame + size);
+                });
+            if (!replies.empty()) {
+                auto [write_ec, written] = co_await asio::async_write(socket, asio::buffer(replies), use_awaitable_tuple);
+                replies.clear();
+                if (write_ec) {
+                    co_return;
+                }
+            }
+        }
+    }
+
+    asio::awaitable<void> coroutine_server(asio::ip::tcp::acceptor& acceptor) {
+        while (true) {
+            auto [ec, socket] = co_await acceptor.async_accept(use_awaitable_tuple);
+            if (ec) {
+                co_return;
+            }
+            asio::co_spawn(acceptor.get_executor(), coroutine_session(std::move(socket)), asio::detached);
+        }
+    }
+
+    class CoroutineClient {
+    public:
+        CoroutineClient(asio::io_context& io, ClientProgress& progress)
+            : io_(io), socket_(io), signal_(io), progress_(progress) {}
+
+        void start(uint16_t port) {
+            socket_.connect(asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), port));
+            socket_.set_option(asio::ip::tcp::no_delay(true));
+            for (uint32_t i = 0; i < progress_.options.window && progress_.may_send(); ++i) {
+                ++pending_;
+                ++progress_.sent;
+            }
+            asio::co_spawn(io_, read_loop(), asio::detached);
+            asio::co_spawn(io_, send_loop(), asio::detached);
+        }
+
+    private:
+        asio::awaitable<void> send_loop() {
+            std::vector<char> frame;
+            while (!progress_.finished()) {
+                if (pending_ == 0) {
+                    signal_.expires_at(asio::steady_timer::time_point::max());
+                    co_await signal_.async_wait(use_awaitable_tuple);
+                    continue;
+                }
+                --pending_;
+                encode_frame(frame, progress_.options.payload);
+                auto [ec, written] = co_await asio::async_write(socket_, asio::buffer(frame), use_awaitable_tuple);
+                if (ec) {
+                    co_return;
+                }
+            }
+        }
+
+        asio::awaitable<void> read_loop() {
+            std::vector<char> chunk(kReadBufferSize);
+            std::vector<char> inbox;
+            while (!progress_.finished()) {
+                auto [ec, len] = co_await socket_.async_read_some(asio::buffer(chunk), use_awaitable_tuple);
+                if (ec) {
+                    break;
+                }
+                inbox.insert(inbox.end(), chunk.begin(), chunk.begin() + len);
+                take_frames(inbox, [this](const char* frame, size_t) {
+                    progress_.on_reply(frame);
+                    if (progress_.may_send()) {
+                        ++pending_;
+                        ++progress_.sent;
+                    }
+                    });
+                signal_.cancel();
+            }
+            socket_.close();
+            signal_.cancel();
+        }
+
+        asio::io_context& io_;
+        asio::ip::tcp::socket socket_;
+        asio::steady_timer signal_;     // 发送循环的唤醒信号
+        ClientProgress& progress_;
+        uint32_t pending_ = 0;
+    };
+
+    double percentile_us(std::vector<uint64_t> values, double fraction) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index] / 1000.0;
+    }
+
+    template <typename Server, typename Client>
+    void run(const char* name, const BenchmarkOptions& options, uint16_t port) {
+        asio::io_context server_io;
+        Server server(server_io, port);
+        server.start();
+        std::thread server_thread([&server_io]() { server_io.run(); });
+
+        asio::io_context client_io;
+        ClientProgress progress(options);
+        Client client(client_io, progress);
+        client.start(port);
+        client_io.run();
+        const uint64_t end_time = now_ns();
+        const uint64_t end_allocations = g_allocations.load(std::memory_order_relaxed);
+
+        server.stop();
+        server_io.stop();
+        server_thread.join();
+
+        const uint32_t measured = progress.received - progress.warmup;
+        std::vector<uint64_t> steady(progress.rtt_ns.begin() + progress.warmup, progress.rtt_ns.end());
+        const double seconds = (end_time - progress.time_at_warmup) / 1e9;
+        std::cout << "  " << std::left << std::setw(10) << name << std::right << std::fixed
+            << " allocs/msg " << std::setprecision(2) << std::setw(6)
+            << (measured ? double(end_allocations - progress.allocations_at_warmup) / measured : 0.0)
+            << "  p50 " << std::setprecision(1) << std::setw(7) << percentile_us(steady, 0.50) << " us"
+            << "  p99 " << std::setw(7) << percentile_us(steady, 0.99) << " us"
+            << "  " << std::setprecision(0) << std::setw(8) << (seconds > 0 ? measured / seconds : 0.0) << " msg/s"
+            << std::endl;
+    }
+
+    // 把协程服务端包装成与 CallbackServer 相同的接口
+    class CoroutineServer {
+    public:
+        CoroutineServer(asio::io_context& io, uint16_t port)
+            : io_(io), acceptor_(io, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), port)) {}
+
+        void start() { asio::co_spawn(io_, coroutine_server(acceptor_), asio::detached); }
+        void stop() { asio::post(io_, [this]() { acceptor_.close(); }); }
+
+    private:
+        asio::io_context& io_;
+        asio::ip::tcp::acceptor acceptor_;
+    };
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--rounds" && i + 1 < argc) {
+            options.rounds = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--payload" && i + 1 < argc) {
+            options.payload = std::max<uint32_t>(8, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--window" && i + 1 < argc) {
+            options.window = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+    }
+
+    std::cout << options.rounds << " messages, payload " << options.payload << " B, window "
+        << options.window << ":" << std::endl;
+    run<CallbackServer, CallbackClient>("callback", options, 9601);
+    run<CoroutineServer, CoroutineClient>("coroutine", options, 9602);
+    return 0;
+}
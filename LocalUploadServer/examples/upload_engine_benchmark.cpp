@@ -0,0 +1,343 @@
+/**
+ * @file upload_engine_benchmark.cpp
+ * @brief Lusp_BackgroundUploader 回环吞吐基准
+ *
+ * 在临时目录生成三组文件，经本地替身接收端(127.0.0.1)上传并统计吞吐:
+ * - 微小文件: 20000 个 4KB(--tiny-count 调整个数)，启用打包时再关闭打包跑一遍，对比 files/s
+ * - 小文件: 2000 个 16KB
+ * - 大文件: 4 个 256MB(--large-count 调整个数)
+ * 接收端校验每个分块的 CRC32 并检查分块是否到齐；可选择落盘后逐字节比对。
+ * 默认内容为随机数据(不可压缩，压缩阶段应被熵探测跳过)；--compressible 生成类日志文本，用于观察压缩比与吞吐。
+ * --ack-delay-us 让接收端每帧延迟回复，模拟单流受 RTT 限制的链路，对比自适应条带与 --fixed-streams、
+ * 自适应并发数与 --fixed-concurrency；--link-rate 让所有连接共享一条限速瓶颈链路(帧在其上排队)，
+ * 观察自适应并发数在时延膨胀时退回。
+ * --cpu-threads 指定校验/压缩/CDC 指纹线程池的线程数(默认硬件线程数)，每组结束时输出线程池的任务与窃取次数。
+ * 最后把大文件排在小文件之前一起提交(mixed，不打包)，与全部走同一通道的 FIFO 对比各通道的排队时长。
+ *
+ * 用法: upload_engine_benchmark [--write-output] [--chunk-size <bytes>] [--concurrency <n>] [--streams <n>]
+ *                                [--max-speed <bytes/s>] [--file-speed <bytes/s>] [--compressible] [--no-compression]
+ *                                [--cdc] [--ack-delay-us <us>] [--fixed-streams] [--large-count <n>]
+ *                                [--no-packing] [--tiny-count <n>] [--srf]
+ *                                [--fixed-concurrency] [--link-rate <bytes/s>] [--cpu-threads <n>] [--pin-cpu]
+ *
+ * 构建(在 LocalUploadServer 目录下):
+ *   cl /std:c++17 /O2 /EHsc /utf-8 /Iinclude /I3rdParty\include /I3rdParty\include\asio /I3rdParty\include\hash-library
+ *      examples\upload_engine_benchmark.cpp src\UploadEngine\*.cpp src\log_headers.cpp
+ *      3rdParty\src\hash-library\crc32.cpp 3rdParty\src\hash-library\sha256.cpp 3rdParty\src\log\*.cpp
+ */
+
+#include "UploadEngine/Lusp_BackgroundUploader.h"
+#include "UploadEngine/Lusp_LoopbackChunkReceiver.h"
+#include "UploadEngine/Lusp_PathUtf8.h"
+#include "log_headers.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr size_t   kDefaultTinyFileCount = 20000;
+    constexpr size_t   kTinyFileSize    = 4 * 1024;
+    constexpr size_t   kSmallFileCount  = 2000;
+    constexpr size_t   kSmallFileSize   = 16 * 1024;
+    constexpr size_t   kDefaultLargeFileCount = 4;
+    constexpr uint64_t kLargeFileSize   = 256ull * 1024 * 1024;
+
+    struct FileSet {
+        std::string             name;
+        std::vector<fs::path>   paths;
+        uint64_t                total_bytes = 0;
+    };
+
+    void write_random_file(const fs::path& path, uint64_t size, std::mt19937_64& rng) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        std::vector<uint64_t> block(64 * 1024 / sizeof(uint64_t));
+        uint64_t remaining = size;
+        while (remaining > 0) {
+            for (auto& word : block) {
+                word = rng();
+            }
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(remaining, block.size() * sizeof(uint64_t)));
+            out.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(length));
+            remaining -= length;
+        }
+    }
+
+    void write_text_file(const fs::path& path, uint64_t size, std::mt19937_64& rng) {
+        static const char* const kLevels[] = { "INFO", "WARN", "DEBUG", "ERROR" };
+        static const char* const kMessages[] = {
+            "upload session opened for device", "chunk acknowledged by remote receiver",
+            "retrying connection after timeout", "file metadata synchronized to database",
+        };
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        std::string block;
+        uint64_t remaining = size;
+        while (remaining > 0) {
+            block.clear();
+            while (block.size() < 64 * 1024) {
+                const uint64_t value = rng();
+                block += "2026-01-01 12:" + std::to_string(value % 60) + ":" + std::to_string((value >> 8) % 60) +
+                    " [" + kLevels[(value >> 16) % 4] + "] " + kMessages[(value >> 24) % 4] +
+                    " id=" + std::to_string((value >> 32) % 100000) + "\n";
+            }
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(remaining, block.size()));
+            out.write(block.data(), static_cast<std::streamsize>(length));
+            remaining -= length;
+        }
+    }
+
+    FileSet make_file_set(const fs::path& root, const std::string& name, size_t count, uint64_t size, bool compressible) {
+        FileSet set;
+        set.name = name;
+        const fs::path dir = root / name;
+        fs::create_directories(dir);
+        std::mt19937_64 rng(count * 131 + size);
+        for (size_t i = 0; i < count; ++i) {
+            fs::path path = dir / (name + "_" + std::to_string(i) + ".bin");
+            if (compressible) {
+                write_text_file(path, size, rng);
+            }
+            else {
+                write_random_file(path, size, rng);
+            }
+            set.paths.push_back(path);
+            set.total_bytes += size;
+        }
+        return set;
+    }
+
+    bool same_content(const fs::path& a, const fs::path& b) {
+        if (!fs::exists(b) || fs::file_size(a) != fs::file_size(b)) {
+            return false;
+        }
+        std::ifstream left(a, std::ios::binary);
+        std::ifstream right(b, std::ios::binary);
+        std::vector<char> x(1 << 20);
+        std::vector<char> y(1 << 20);
+        while (left && right) {
+            left.read(x.data(), static_cast<std::streamsize>(x.size()));
+            right.read(y.data(), static_cast<std::streamsize>(y.size()));
+            if (left.gcount() != right.gcount() || std::memcmp(x.data(), y.data(), static_cast<size_t>(left.gcount())) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool run_set(const FileSet& set, Lusp_UploadEngineConfig config, const fs::path& output_dir, bool write_output,
+        Lusp_LoopbackReceiverConfig receiver_config) {
+        receiver_config.port = 0;
+        receiver_config.output_dir = write_output ? path_to_utf8(output_dir / set.name) : std::string();
+        Lusp_LoopbackChunkReceiver receiver(receiver_config);
+        if (!receiver.start()) {
+            std::cerr << "receiver failed to start" << std::endl;
+            return false;
+        }
+        config.remote_port = receiver.port();
+
+        std::atomic<uint64_t> failed{ 0 };
+        Lusp_BackgroundUploader uploader(config);
+        uploader.set_complete_callback([&failed](uint64_t file_id, bool success, const std::string& message) {
+            if (!success) {
+                failed.fetch_add(1);
+                std::cerr << "file " << file_id << " failed: " << message << std::endl;
+            }
+            });
+        uploader.start();
+
+        const auto begin = std::chrono::steady_clock::now();
+        uint64_t file_id = 1;
+        for (const auto& path : set.paths) {
+            Lusp_UploadTask task;
+            task.file_id = file_id++;
+            task.file_path = path_to_utf8(path);
+            task.remote_name = path_to_utf8(path.filename());
+            task.file_type = Lusp_UploadFileTyped::LUSP_UPLOADTYPE_DOCUMENT;
+            uploader.submit(task);
+        }
+        uploader.wait_idle();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        uploader.stop();
+
+        const auto engine = uploader.get_statistics();
+        const auto received = receiver.get_statistics();
+        receiver.stop();
+
+        size_t mismatched = 0;
+        if (write_output) {
+            for (const auto& path : set.paths) {
+                if (!same_content(path, output_dir / set.name / path.filename())) {
+                    ++mismatched;
+                }
+            }
+        }
+
+        std::cout << "[" << set.name << "] " << set.paths.size() << " files, "
+                  << set.total_bytes / (1024.0 * 1024.0) << " MB in " << seconds << " s: "
+                  << set.total_bytes / seconds / 1e9 << " GB/s, "
+                  << set.paths.size() / seconds << " files/s" << std::endl;
+        std::cout << "    completed " << engine.files_completed << ", failed " << engine.files_failed
+                  << ", chunks " << engine.chunks_sent << ", retries " << engine.chunk_retries
+                  << ", throttled " << engine.throttled_chunks
+                  << ", stripes +" << engine.stripe_increases << "/-" << engine.stripe_decreases
+                  << ", packs " << engine.packs_sent << " (" << engine.files_packed << " files)"
+                  << ", concurrency " << engine.concurrency_limit << " (+" << engine.concurrency_increases
+                  << "/-" << engine.concurrency_decreases << ", rtt " << engine.chunk_rtt_us << "/" << engine.base_rtt_us << " us)"
+                  << " | receiver files " << received.files_completed << ", bytes " << received.bytes_received
+                  << ", deduplicated " << received.bytes_deduplicated << ", digest errors " << received.digest_errors;
+        if (write_output) {
+            std::cout << ", content mismatches " << mismatched;
+        }
+        std::cout << std::endl;
+        for (size_t lane = 0; lane < kUploadLaneCount; ++lane) {
+            const auto& wait = engine.lanes[lane].queue_wait;
+            if (wait.count == 0) {
+                continue;
+            }
+            std::cout << "    lane[" << upload_lane_name(static_cast<Lusp_UploadLane>(lane)) << "] files " << wait.count
+                      << ", tasks " << engine.lanes[lane].dispatched << ", queue wait p50 " << wait.quantile_ms(0.5)
+                      << " ms, p99 " << wait.quantile_ms(0.99) << " ms, max " << wait.max_ms << " ms" << std::endl;
+        }
+        std::cout << "    cpu pool " << engine.cpu_pool.threads << " threads: tasks " << engine.cpu_pool.executed
+                  << ", stolen " << engine.cpu_pool.stolen << ", injected " << engine.cpu_pool.injected
+                  << ", parked " << engine.cpu_pool.parked << std::endl;
+        for (size_t type = 0; type < kUploadFileTypeCount; ++type) {
+            const auto& compression = engine.compression[type];
+            if (compression.raw_bytes == 0) {
+                continue;
+            }
+            std::cout << "    compression[" << upload_file_type_name(static_cast<Lusp_UploadFileTyped>(type)) << "] ratio "
+                      << static_cast<double>(compression.wire_bytes) / compression.raw_bytes
+                      << ", chunks compressed " << compression.chunks_compressed << ", raw " << compression.chunks_raw
+                      << ", cpu " << compression.cpu_ns / 1e6 << " ms" << std::endl;
+        }
+        return failed == 0 && received.files_completed == set.paths.size() && received.bytes_received + received.bytes_deduplicated == set.total_bytes
+            && mismatched == 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    initializeLogger();
+
+    Lusp_UploadEngineConfig config;
+    bool write_output = false;
+    bool compressible = false;
+    Lusp_LoopbackReceiverConfig link;
+    size_t large_count = kDefaultLargeFileCount;
+    size_t tiny_count = kDefaultTinyFileCount;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--write-output") {
+            write_output = true;
+        }
+        else if (arg == "--chunk-size" && i + 1 < argc) {
+            config.chunk_size = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--concurrency" && i + 1 < argc) {
+            config.max_concurrent_uploads = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--streams" && i + 1 < argc) {
+            config.max_streams_per_file = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--max-speed" && i + 1 < argc) {
+            config.max_upload_speed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--file-speed" && i + 1 < argc) {
+            config.max_file_upload_speed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--compressible") {
+            compressible = true;
+        }
+        else if (arg == "--no-compression") {
+            config.enable_compression = false;
+        }
+        else if (arg == "--cdc") {
+            config.chunking_mode = "CDC";
+        }
+        else if (arg == "--ack-delay-us" && i + 1 < argc) {
+            link.ack_delay_us = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--large-count" && i + 1 < argc) {
+            large_count = std::stoul(argv[++i]);
+        }
+        else if (arg == "--fixed-streams") {
+            config.adaptive_streams = false;
+        }
+        else if (arg == "--no-packing") {
+            config.enable_packing = false;
+        }
+        else if (arg == "--tiny-count" && i + 1 < argc) {
+            tiny_count = std::stoul(argv[++i]);
+        }
+        else if (arg == "--link-rate" && i + 1 < argc) {
+            link.link_rate = std::stoull(argv[++i]);
+        }
+        else if (arg == "--fixed-concurrency") {
+            config.adaptive_concurrency = false;
+        }
+        else if (arg == "--cpu-threads" && i + 1 < argc) {
+            config.cpu_threads = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--pin-cpu") {
+            config.pin_cpu_threads = true;
+        }
+        else if (arg == "--srf") {
+            config.shortest_remaining_first = true;
+        }
+    }
+
+    const fs::path root = fs::temp_directory_path() / "lusp_upload_engine_benchmark";
+    fs::remove_all(root);
+    config.journal_dir = path_to_utf8(root / "journal");
+    std::cout << "generating test files under " << path_to_utf8(root) << " ..." << std::endl;
+    const FileSet tiny = make_file_set(root / "source", "tiny", tiny_count, kTinyFileSize, compressible);
+    const FileSet small = make_file_set(root / "source", "small", kSmallFileCount, kSmallFileSize, compressible);
+    const FileSet large = make_file_set(root / "source", "large", large_count, kLargeFileSize, compressible);
+
+    std::cout << "chunk_size " << config.chunk_size << ", concurrency " << (config.adaptive_concurrency ? "adaptive up to " : "")
+              << config.max_concurrent_uploads
+              << ", streams/file " << (config.adaptive_streams ? "adaptive up to " : "") << config.max_streams_per_file
+              << ", ack delay " << link.ack_delay_us << " us, link rate " << link.link_rate << " B/s"
+              << ", max speed " << config.max_upload_speed << " B/s, file speed " << config.max_file_upload_speed << " B/s"
+              << ", compression " << (config.enable_compression ? config.compression_algorithm : std::string("off"))
+              << ", chunking " << config.chunking_mode
+              << ", packing " << (config.enable_packing ? "<= " + std::to_string(config.pack_file_threshold) + " bytes" : std::string("off"))
+              << ", lane weight " << config.small_lane_weight << ":" << config.large_lane_weight
+              << (config.shortest_remaining_first ? ", shortest remaining first" : "")
+              << (compressible ? ", text content" : ", random content")
+              << (write_output ? ", writing output" : ", discarding output") << std::endl;
+    bool ok = run_set(tiny, config, root / "output", write_output, link);
+    if (config.enable_packing) {
+        FileSet unpacked = tiny;
+        unpacked.name = "tiny_unpacked";
+        Lusp_UploadEngineConfig unpacked_config = config;
+        unpacked_config.enable_packing = false;
+        ok = run_set(unpacked, unpacked_config, root / "output", write_output, link) && ok;
+    }
+    ok = run_set(small, config, root / "output", write_output, link) && ok;
+    ok = run_set(large, config, root / "output", write_output, link) && ok;
+
+    // 大文件在前：分通道时小文件不必等大文件打开完；FIFO 时所有文件同在大文件通道
+    FileSet mixed = large;
+    mixed.name = "mixed";
+    mixed.paths.insert(mixed.paths.end(), small.paths.begin(), small.paths.end());
+    mixed.total_bytes += small.total_bytes;
+    Lusp_UploadEngineConfig mixed_config = config;
+    mixed_config.enable_packing = false;
+    ok = run_set(mixed, mixed_config, root / "output", write_output, link) && ok;
+    FileSet fifo = mixed;
+    fifo.name = "mixed_fifo";
+    mixed_config.small_file_threshold = 0;
+    ok = run_set(fifo, mixed_config, root / "output", write_output, link) && ok;
+
+    fs::remove_all(root);
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -14,10 +14,15 @@
 #include <chrono>
 #include "AsioLoopbackIpcServer/Lusp_AsioIpcSender.h"
 
+#if defined(LUSP_IPC_COROUTINES) && !defined(ASIO_HAS_CO_AWAIT)
+#error "LUSP_IPC_COROUTINES requires C++20 coroutine support"
+#endif
+
 typedef struct Lusp_AsioIpcConfig {
     std::string host = "127.0.0.1";
     uint16_t port = 9000;
     size_t buffer_size = 1024;   // read buffer size
+    size_t registered_read_slots = 64;  // io_uring 构建(LUSP_IO_URING)向内核注册的读缓冲区个数，超出的连接退回普通缓冲区
     int reconnect_interval_ms = 1000; //reconnect interval in milliseconds
 
     // 心跳配置
@@ -30,15 +35,28 @@ typedef struct Lusp_AsioIpcConfig {
 struct ClientHeartbeatInfo {
     std::string client_name;                    // 客户端计算机名
     std::string client_version;                 // 客户端版本
-    uint64_t last_heartbeat_time_ms = 0;        // 最后一次心跳时间（毫秒）
+    uint64_t last_heartbeat_time_ms = 0;        // 最后一次心跳或收到消息的时间（毫秒）
     uint32_t last_sequence = 0;                 // 最后一次序列号
     uint32_t heartbeat_count = 0;               // 收到的心跳总数
+    bool legacy_heartbeat = false;              // 客户端发送不带 file_identifier 的旧版心跳
 };
 
 // 新增：每个连接的状态，包含接收缓冲区
 struct ConnState {
     std::vector<char> buffer;
+    std::vector<char> read_chunk;               // 回调版本的读缓冲区，跟随连接复用
     ClientHeartbeatInfo heartbeat_info;         // 心跳信息
+    // 预先编码的 PONG 帧(4字节长度前缀 + FlatBuffer)，客户端名称/版本变化时重建，
+    // 每次 PING 只原地改写序列号与时间戳后追加到 pong_frames
+    std::vector<uint8_t> pong_frame;
+    std::vector<uint8_t> pong_frames;           // 待写出的 PONG(协程版本由读循环处理完一批消息后统一写出)
+#ifndef LUSP_IPC_COROUTINES
+    std::vector<uint8_t> pong_writing;          // 正在写出的 PONG，写完后与 pong_frames 交换(两块缓冲区的容量都保留)
+    bool pong_in_flight = false;
+#endif
+#ifdef LUSP_IO_URING
+    int read_slot = -1;                         // 占用的注册读缓冲区下标，-1 表示使用普通缓冲区
+#endif
 };
 
 class Lusp_AsioLoopbackIpcServer {
@@ -61,10 +79,36 @@ private:
     void do_accept();
     // 修改：do_read带ConnState
     void do_read(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<ConnState> state);
+    void handle_read(const std::shared_ptr<asio::ip::tcp::socket>& socket, const std::shared_ptr<ConnState>& state,
+        std::error_code ec, const char* data, std::size_t len);
+    // 拆出 state->buffer 中所有完整的消息并分发，剩余的半包留在缓冲区
+    void dispatch_frames(const std::shared_ptr<asio::ip::tcp::socket>& socket, const std::shared_ptr<ConnState>& state);
+    void remove_client(const std::shared_ptr<asio::ip::tcp::socket>& socket);
+
+#ifdef LUSP_IO_URING
+    // io_uring 注册缓冲区：start 时一次性注册 registered_read_slots 块，连接建立时领取一块，读循环结束时归还
+    void register_read_buffers();
+    int acquire_read_slot();
+    void release_read_slot(ConnState& state);
+#endif
+
+#ifdef LUSP_IPC_COROUTINES
+    // 协程版本(LUSP_IPC_COROUTINES)：每个连接一个读循环，整个连接期间复用同一块读缓冲区
+    asio::awaitable<void> read_loop(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<ConnState> state);
+    asio::awaitable<void> heartbeat_check_loop();
+#endif
 
     // 心跳相关私有方法
-    void handle_heartbeat_ping(const std::string& ping_data, std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<ConnState> state);
-    void send_heartbeat_pong(uint32_t sequence, uint64_t timestamp, const std::string& client_name, const std::string& client_version, std::shared_ptr<asio::ip::tcp::socket> socket);
+    // 心跳快速路径：PING 直接在接收缓冲区上解析，PONG 由连接上的模板改写后发出，稳态下不分配内存
+    void handle_heartbeat_ping(const uint8_t* ping_data, size_t size, const std::shared_ptr<asio::ip::tcp::socket>& socket, const std::shared_ptr<ConnState>& state);
+#ifndef LUSP_IPC_COROUTINES
+    // 写出 state->pong_frames(回调版本)；写完前再收到的 PING 留在 pong_frames 中，写完后接着写
+    void send_heartbeat_pong(const std::shared_ptr<asio::ip::tcp::socket>& socket, const std::shared_ptr<ConnState>& state);
+#endif
+    // 按客户端名称/版本重建 PONG 模板，序列号与时间戳字段强制写出以便原地改写
+    void encode_heartbeat_pong(const std::string& client_name, const std::string& client_version, std::vector<uint8_t>& frame);
+    // 原地改写模板中的序列号与时间戳
+    static void stamp_heartbeat_pong(std::vector<uint8_t>& frame, uint32_t sequence, uint64_t timestamp);
     void start_heartbeat_checker();
     void check_clients_heartbeat();
     uint64_t get_current_time_ms() const;
@@ -82,6 +126,14 @@ private:
     std::shared_ptr<asio::steady_timer> heartbeat_checker_timer_;
     std::unordered_map<std::shared_ptr<asio::ip::tcp::socket>, std::shared_ptr<ConnState>> socket_states_;
     mutable std::mutex states_mutex_;  // mutable 允许在 const 函数中加锁
+
+#ifdef LUSP_IO_URING
+    std::vector<char> read_slot_storage_;                   // 所有注册读缓冲区共用一块连续内存
+    std::vector<asio::mutable_buffer> read_slot_buffers_;
+    std::unique_ptr<asio::buffer_registration<std::vector<asio::mutable_buffer>>> read_registration_;
+    std::vector<int> free_read_slots_;
+    std::mutex read_slots_mutex_;
+#endif
 };
 
 
@@ -0,0 +1,19 @@
+#ifndef LUSP_SERVER_CONFIG_LOADER_H
+#define LUSP_SERVER_CONFIG_LOADER_H
+
+#include <string>
+#include "UploadEngine/Lusp_BackgroundUploader.h"
+
+/**
+ * @brief 读取 config/server_config.toml 中的 [upload] 表(含 [[upload.rate_schedule]] 时段)
+ *
+ * 表中未出现的项保留 config 原有的值。任何一项类型不符、超出取值范围、互相矛盾(如 min > max)，
+ * 或出现未知的键(多为拼写错误)时整体失败，config 不被修改，error 给出第一个出错的键。
+ *
+ * @param path      配置文件路径(UTF-8)
+ * @param config    输入为默认配置，成功时写入文件中的配置
+ * @param error     失败原因
+ */
+bool load_upload_engine_config(const std::string& path, Lusp_UploadEngineConfig& config, std::string& error);
+
+#endif // LUSP_SERVER_CONFIG_LOADER_H
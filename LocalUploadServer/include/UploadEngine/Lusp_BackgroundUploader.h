@@ -0,0 +1,353 @@
+#ifndef LUSP_BACKGROUND_UPLOADER_H
+#define LUSP_BACKGROUND_UPLOADER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "UploadEngine/Lusp_ChunkBufferPool.h"
+#include "UploadEngine/Lusp_ChunkCodec.h"
+#include "UploadEngine/Lusp_ConcurrencyController.h"
+#include "UploadEngine/Lusp_ContentChunker.h"
+#include "UploadEngine/Lusp_FilePack.h"
+#include "UploadEngine/Lusp_RateLimiter.h"
+#include "UploadEngine/Lusp_StripeController.h"
+#include "UploadEngine/Lusp_UploadScheduler.h"
+#include "UploadEngine/Lusp_WorkStealingPool.h"
+
+/**
+ * @brief 上传引擎配置(字段与客户端 UploadConfig 同名项含义一致)
+ */
+struct Lusp_UploadEngineConfig {
+    std::string remote_host             = "127.0.0.1";  // 远端接收端地址
+    uint16_t    remote_port             = 9100;         // 远端接收端端口
+    uint32_t    chunk_size              = 1024 * 1024;  // 分块大小（默认1MB）
+    uint32_t    max_concurrent_uploads  = 4;            // 全局并发数（上传连接数，同时在传的分块数上限）
+    bool        adaptive_concurrency    = true;         // 按 goodput 与分块往返时间在 [min, max] 内 AIMD 调整并发数
+    uint32_t    min_concurrent_uploads  = 1;            // 自适应并发数的下限
+    uint32_t    max_streams_per_file    = 4;            // 单个文件同时在传的分块数上限(条带数上限)
+    bool        adaptive_streams        = true;         // 按文件吞吐在 [1, max_streams_per_file] 内自动调整条带数
+    uint32_t    max_active_files        = 0;            // 同时打开的文件数上限（0=2*max_concurrent_uploads）
+    uint32_t    timeout_seconds         = 30;           // 单次发送/等待确认超时
+    uint32_t    retry_count             = 3;            // 分块失败重试次数
+    uint32_t    retry_delay_ms          = 1000;         // 重试间隔（毫秒）
+    bool        enable_checksum         = true;         // 每个分块附带 CRC32
+    bool        enable_resume           = true;         // 断点续传(写分块日志，FILE_BEGIN 时与接收端握手)
+    std::string journal_dir             = "upload_journal"; // 续传日志目录(UTF-8)
+    uint32_t    journal_flush_chunks    = 64;           // 每确认多少块刷一次日志
+    uint32_t    resume_min_chunks       = 8;            // 少于该块数的文件不写日志
+    uint64_t    max_upload_speed        = 0;            // 全局最大上传速率 (bytes/s, 0=不限速)
+    uint64_t    max_device_upload_speed = 0;            // 单个客户端设备的最大上传速率 (bytes/s, 0=不限速)
+    uint64_t    max_file_upload_speed   = 0;            // 单个文件的最大上传速率 (bytes/s, 0=不限速)
+    std::vector<Lusp_RateWindow> rate_schedule;         // 限速时段(如工作时间)，命中时代替以上三项
+    uint32_t    rate_burst_ms           = 200;          // 限速允许的突发时长（毫秒）
+    bool        enable_compression      = true;         // 分块压缩(按文件类型与熵探测自动跳过，压缩成为瓶颈时自动退避)
+    std::string compression_algorithm   = "LZ4";        // NONE/LZ4(其他取值按 LZ4 处理)
+    double      compression_max_entropy = 7.5;          // 首块字节熵(bits/byte)不低于该值的文件不压缩
+    std::string chunking_mode           = "FIXED";      // FIXED/CDC(内容定义分块，接收端按指纹跨文件去重)
+    uint32_t    cdc_average_chunk_size  = 256 * 1024;   // CDC 期望平均分块长度(最小为其 1/4，最大为 chunk_size)
+    bool        enable_packing          = true;         // 小文件打包成容器发送，每个容器一次往返
+    uint32_t    pack_file_threshold     = 64 * 1024;    // 不超过该大小的文件参与打包
+    uint32_t    pack_max_bytes          = 4 * 1024 * 1024;  // 单个容器的文件数据上限
+    uint32_t    pack_max_files          = 1024;         // 单个容器的文件数上限
+    uint64_t    small_file_threshold    = 16 * 1024 * 1024; // 不超过该大小的文件走小文件通道(不小于 pack_file_threshold)
+    uint32_t    small_lane_weight       = 3;            // 两个通道按权重分享上传连接(有任务的通道至少分到其份额)
+    uint32_t    large_lane_weight       = 1;
+    bool        shortest_remaining_first = false;       // 通道内优先打开最小的文件、优先发送剩余字节最少的文件
+    uint32_t    fair_queue_quantum      = 1024 * 1024;  // 各客户端设备之间差额轮转的每轮字节数
+    uint32_t    cpu_threads             = 0;            // 校验/压缩/CDC 指纹线程池的线程数(0=硬件线程数)，外部传入线程池时忽略
+    bool        pin_cpu_threads         = false;        // 线程池工作线程绑定 CPU
+};
+
+/**
+ * @brief 上传文件类型(取值与 FlatBuffer FBS_SyncUploadFileTyped、客户端 Lusp_UploadFileTyped 一致)
+ */
+enum class Lusp_UploadFileTyped : uint8_t {
+    LUSP_UPLOADTYPE_DOCUMENT = 0,
+    LUSP_UPLOADTYPE_IMAGE,
+    LUSP_UPLOADTYPE_VIDEO,
+    LUSP_UPLOADTYPE_AUDIO,
+    LUSP_UPLOADTYPE_ARCHIVE,
+    LUSP_UPLOADTYPE_CODE,
+    LUSP_UPLOADTYPE_UNDEFINED,
+};
+
+constexpr size_t kUploadFileTypeCount = static_cast<size_t>(Lusp_UploadFileTyped::LUSP_UPLOADTYPE_UNDEFINED) + 1;
+
+const char* upload_file_type_name(Lusp_UploadFileTyped type);
+
+/**
+ * @brief 上传任务
+ */
+struct Lusp_UploadTask {
+    uint64_t    file_id = 0;        // 文件ID（客户端生成）
+    std::string file_path;          // 本地路径（UTF-8）
+    std::string remote_name;        // 远端相对路径（UTF-8，接收端清理后落在输出目录下），为空时取本地文件名
+    std::string client_device;      // 局域网客户端设备名(按设备限速)
+    Lusp_UploadFileTyped file_type = Lusp_UploadFileTyped::LUSP_UPLOADTYPE_UNDEFINED;
+    bool        payload_compressed = false;     // 内容已是压缩格式，不再压缩
+    uint32_t    chunk_hash_size = 0;            // 客户端分块哈希的分块大小(0 表示未提供)
+    std::vector<uint8_t> chunk_digests;         // 客户端入队时各分块的 MD5(每块 16 字节，按块序拼接)
+    std::string chunk_root_digest;              // chunk_digests 的 MD5(小写十六进制)
+};
+
+/**
+ * @brief 按文件类型统计的压缩指标
+ */
+struct Lusp_CompressionStats {
+    uint64_t    raw_bytes           = 0;    // 已发送分块的原文字节数
+    uint64_t    wire_bytes          = 0;    // 实际发送的数据字节数(压缩后或原文)
+    uint64_t    chunks_compressed   = 0;
+    uint64_t    chunks_raw          = 0;    // 未压缩发送的分块(类型跳过、熵过高、退避或压缩收益不足)
+    uint64_t    cpu_ns              = 0;    // 压缩耗时(含收益不足而放弃的尝试)
+};
+
+/**
+ * @brief 单个上传通道的调度指标
+ */
+struct Lusp_UploadLaneStats {
+    uint64_t            queued          = 0;    // 等待打开的文件数
+    uint64_t            active          = 0;    // 正在上传的文件数
+    uint64_t            dispatched      = 0;    // 分派的任务数(FILE_BEGIN/分块/容器)
+    Lusp_WaitHistogram  queue_wait;             // 提交到开始上传(FILE_BEGIN 或装入容器)的排队时长
+};
+
+/**
+ * @brief 上传引擎统计
+ */
+struct Lusp_UploadEngineStats {
+    uint64_t    files_submitted = 0;
+    uint64_t    files_completed = 0;
+    uint64_t    files_failed    = 0;
+    uint64_t    chunks_sent     = 0;    // 已确认的分块数
+    uint64_t    chunk_retries   = 0;    // 重发次数
+    uint64_t    bytes_sent      = 0;    // 已确认的文件字节数
+    uint64_t    queued_files    = 0;    // 等待打开的文件数
+    uint64_t    active_files    = 0;    // 正在上传的文件数
+    uint64_t    throttled_chunks = 0;   // 因限速而等待过的分块数
+    uint64_t    stripe_increases = 0;   // 条带数试探增加次数
+    uint64_t    stripe_decreases = 0;   // 试探无收益而退回的次数
+    uint64_t    chunks_deduplicated = 0;    // CDC 文件中接收端已有、未发送的分块数
+    uint64_t    bytes_deduplicated  = 0;
+    uint64_t    packs_sent      = 0;    // 已确认的小文件容器数
+    uint64_t    files_packed    = 0;    // 经容器上传成功的文件数
+    uint64_t    concurrency_limit   = 0;    // 当前并发上限(在途窗口 = 该值 × chunk_size 字节)
+    uint64_t    inflight_bytes      = 0;    // 在途的分块与容器字节数
+    uint64_t    concurrency_increases = 0;  // 加性增次数
+    uint64_t    concurrency_decreases = 0;  // 乘性减次数(重发或排队)
+    uint64_t    goodput             = 0;    // 最近一个测量窗口的有效吞吐 (bytes/s)
+    uint64_t    chunk_rtt_us        = 0;    // 最近一个测量窗口的平均分块往返时间
+    uint64_t    base_rtt_us         = 0;    // 往返时间基准(近期窗口的最小值)
+    double      queued_chunks       = 0;    // 估算的在链路缓冲中排队的分块数
+    Lusp_WorkStealingPoolStats cpu_pool;    // CPU 线程池(与其他组件共用时为整个池的统计)
+    std::array<Lusp_CompressionStats, kUploadFileTypeCount> compression{};     // 下标为 Lusp_UploadFileTyped
+    std::array<Lusp_UploadLaneStats, kUploadLaneCount> lanes{};                // 下标为 Lusp_UploadLane
+};
+
+/**
+ * @brief 后台上传器(分块并发上传引擎)
+ *
+ * - 每个工作线程持有一条到远端的 TCP 连接，工作线程数 = max_concurrent_uploads(全局并发上限)
+ * - 在途的分块与容器数据不超过 并发上限 × chunk_size 字节(FILE_BEGIN/FILE_END 不计)；adaptive_concurrency 时
+ *   并发上限由 Lusp_ConcurrencyController 在 [min_concurrent_uploads, max_concurrent_uploads] 内按 AIMD 调整：
+ *   窗口占满仍有分块等待时逐个增加，出现重发或往返时间膨胀而吞吐不涨时按比例退回。按字节而不是按请求数计，
+ *   拥塞时退回的是大文件的分块，小文件的请求仍能并行
+ * - 文件按 chunk_size 切块，工作线程从活动文件中轮转取块，单个文件同时在传的块数不超过
+ *   max_streams_per_file；大文件的多个块经多条连接并行发送(条带)，小文件之间互不阻塞
+ * - adaptive_streams 时每个文件的条带数由 Lusp_StripeController 按确认吞吐调整：有空闲连接时逐条试探，
+ *   新增条带带不来吞吐提升(链路或接收端已饱和)就退回，单流受窗口/RTT 限制的长肥链路上自动用满上限
+ * - 分块以 pread 读入缓冲池中的定长缓冲区，发送时帧头与数据分散写(不拷贝)
+ * - 分块发送失败时重连并重发，超过 retry_count 次后该文件失败
+ * - 启用续传时，较大的文件在 journal_dir 中维护分块日志(Lusp_ChunkJournal)；FILE_BEGIN 带续传标志，
+ *   接收端回报已持有的分块，与日志中摘要一致的分块不再发送。失败或停止的文件保留日志，下次启动时重新提交；
+ *   日志按源文件路径命名，客户端再次推送同一文件(文件ID已变)时，大小与修改时间未变就沿用日志及其中的文件ID续传
+ * - 任务带有客户端分块 MD5(chunk_digests)时，提交时先用哈希根核对列表，不符则忽略；之后读出的分块与容器数据
+ *   按客户端分块逐块比对，不一致说明文件在入队后被改写，该文件失败。续传日志记录哈希根，根不同的日志不再沿用
+ * - 配置了限速时，每个分块发送前在 全局/设备/文件 三级令牌桶(Lusp_RateLimiter)上一次性预约整块的线路字节数
+ * - 启用压缩时由工作线程逐块 LZ4 压缩：图片/视频/压缩包及客户端标记为已压缩的文件直接跳过，
+ *   其余文件按首个分块的字节熵决定是否压缩；压缩耗时超过节省的传输时间时自动退避(Lusp_AdaptiveCompressor)
+ * - chunking_mode 为 CDC 时，打开文件先整体扫描一遍，按内容切块(Lusp_ContentChunker)并计算各块 SHA-256，
+ *   清单随 FILE_BEGIN 发送；接收端回报本地已有的分块，只发送其余分块。CDC 文件不写续传日志
+ * - enable_packing 时，提交时不超过 pack_file_threshold 的文件另排一队，工作线程一次取一批读入容器
+ *   (Lusp_PackWriter)，以一个 PACK 帧发送、一个 ACK 确认；整个容器失败时其中的文件各自以失败回调
+ * - CPU 密集的阶段(分块 CRC32、熵探测与压缩、CDC 各块 SHA-256)在工作窃取线程池(Lusp_WorkStealingPool)上执行：
+ *   连接线程把本块的校验与压缩作为高优先级任务交给线程池并等待，CDC 预扫描边切块边把各块指纹并行计算；
+ *   CPU 并行度由线程池大小决定而不随连接数增长。线程池可由外部传入，与进程内其他组件共用
+ * - 提交时按大小分入小/大文件两个通道(Lusp_UploadLane)，各自排队、各自受 max_active_files 限制；
+ *   两个通道按 small_lane_weight:large_lane_weight 分享连接占用时长(Lusp_LaneShare)，大文件不会把小文件堵在后面。
+ *   通道内按客户端设备差额轮转(Lusp_FairQueue)，shortest_remaining_first 时优先处理剩余最少的文件
+ *
+ * 线路协议见 Lusp_ChunkProtocol.h。
+ */
+class Lusp_BackgroundUploader {
+public:
+    using ProgressCallback = std::function<void(uint64_t file_id, uint64_t bytes_done, uint64_t file_size)>;
+    using CompleteCallback = std::function<void(uint64_t file_id, bool success, const std::string& message)>;
+
+    /**
+     * @param cpu_pool 共用的 CPU 线程池，为空时按 cpu_threads 自建
+     */
+    explicit Lusp_BackgroundUploader(const Lusp_UploadEngineConfig& config,
+        std::shared_ptr<Lusp_WorkStealingPool> cpu_pool = nullptr);
+    ~Lusp_BackgroundUploader();
+
+    Lusp_BackgroundUploader(const Lusp_BackgroundUploader&) = delete;
+    Lusp_BackgroundUploader& operator=(const Lusp_BackgroundUploader&) = delete;
+
+    // 回调在工作线程上调用，需在 start 之前设置
+    void set_progress_callback(ProgressCallback callback);
+    void set_complete_callback(CompleteCallback callback);
+
+    /**
+     * @brief 启动工作线程；启用续传时重新提交日志目录中未完成的文件
+     */
+    bool start();
+    /**
+     * @brief 停止上传，未完成的文件以失败回调
+     */
+    void stop();
+    bool is_running() const { return running_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 提交上传任务(非阻塞)
+     * @return 引擎未运行时返回 false
+     */
+    bool submit(const Lusp_UploadTask& task);
+
+    /**
+     * @brief 等待所有已提交的文件完成
+     * @return 超时返回 false
+     */
+    bool wait_idle(std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+    Lusp_UploadEngineStats get_statistics() const;
+    const Lusp_UploadEngineConfig& config() const { return config_; }
+    const std::shared_ptr<Lusp_WorkStealingPool>& cpu_pool() const { return cpu_pool_; }
+
+private:
+    struct FileState;
+    class Connection;
+
+    /**
+     * @brief 工作线程的一次任务
+     */
+    struct WorkItem {
+        enum class Kind { None, Begin, Chunk, Pack };
+        Kind                        kind = Kind::None;
+        std::shared_ptr<FileState>  file;
+        uint32_t                    chunk_index = 0;
+        std::vector<std::shared_ptr<FileState>> pack;   // Kind::Pack 的文件
+        Lusp_UploadLane             lane = Lusp_UploadLane::Small;
+        std::chrono::steady_clock::time_point dispatched;
+        std::chrono::nanoseconds    charged{ 0 };       // 分派时在通道时钟上预记的占用时长
+        uint64_t                    bytes = 0;          // 计入在途窗口的数据字节数(分块或容器)
+    };
+
+    void worker_loop(size_t worker_index);
+    /**
+     * @brief 结算上一个任务占用连接的时长，取下一个任务
+     */
+    WorkItem next_work(const WorkItem& finished);
+    bool open_file(Connection& connection, FileState& file, std::string& error);
+    bool prepare_resume(FileState& file);
+    /**
+     * @brief CDC 预扫描：切块并把 名称 + 分块清单 追加到 body
+     */
+    bool build_manifest(FileState& file, std::vector<uint8_t>& body, std::string& error);
+    void apply_resume_state(FileState& file, const std::vector<uint8_t>& payload);
+    bool send_chunk(Connection& connection, Lusp_ChunkBuffer& buffer, Lusp_AdaptiveCompressor* compressor,
+        FileState& file, uint32_t chunk_index, uint32_t& digest, std::string& error);
+    bool finish_file(Connection& connection, FileState& file, std::string& error);
+    /**
+     * @brief 把一批小文件读入容器并发送，逐个完成其中的文件；读取时发现已变大的文件放回普通队列
+     */
+    void send_pack(Connection& connection, Lusp_PackWriter& writer, std::vector<std::shared_ptr<FileState>>& files);
+    std::string remote_name(const FileState& file) const;
+    bool throttle(std::chrono::nanoseconds wait);     // 限速等待，引擎停止时返回 false
+    /**
+     * @brief 发送一帧并等待对应 ACK，校验失败或连接错误时重连重发(最多 retry_count 次)
+     */
+    bool exchange(Connection& connection, const uint8_t* head, size_t head_size, const uint8_t* body, size_t body_size,
+        uint64_t file_id, uint32_t chunk_index, std::vector<uint8_t>* resume_payload, std::string& error);
+    void on_begin_done(Connection& connection, const std::shared_ptr<FileState>& file, bool success, const std::string& error);
+    void on_chunk_done(Connection& connection, const std::shared_ptr<FileState>& file, uint32_t chunk_index, uint32_t digest,
+        bool success, const std::string& error);
+    void complete_file(const std::shared_ptr<FileState>& file, bool success, const std::string& message);
+    /**
+     * @brief 从一个通道取任务(调用方持有 mutex_)，没有可做的返回 false
+     */
+    bool take_work(Lusp_UploadLane lane, WorkItem& item);
+    void enqueue(std::shared_ptr<FileState> file);                  // 调用方持有 mutex_
+    void remove_active(const std::shared_ptr<FileState>& file);   // 调用方持有 mutex_
+    void log_lane_statistics() const;
+    uint64_t window_room() const;                                   // 在途窗口的剩余字节数，调用方持有 mutex_
+    /**
+     * @brief 把一次确认交给并发控制器(调用方持有 mutex_)，上限改变时返回日志内容
+     */
+    std::string record_ack(uint64_t bytes, std::chrono::steady_clock::duration rtt);
+    size_t recover_journals();
+    void log_compression_statistics() const;
+    std::string journal_path(const std::string& file_path) const;     // 按源文件路径命名
+
+    Lusp_UploadEngineConfig                     config_;
+    std::unique_ptr<Lusp_ChunkBufferPool>       buffer_pool_;
+    std::unique_ptr<Lusp_RateLimiter>           rate_limiter_;      // 未配置限速时为空
+    std::unique_ptr<Lusp_ContentChunker>        chunker_;           // FIXED 模式时为空
+    std::shared_ptr<Lusp_WorkStealingPool>      cpu_pool_;
+    std::vector<std::thread>                    workers_;
+    std::atomic<bool>                           running_{ false };
+    ProgressCallback                            progress_callback_;
+    CompleteCallback                            complete_callback_;
+
+    mutable std::mutex                          mutex_;
+    std::condition_variable                     work_cv_;
+    std::condition_variable                     idle_cv_;
+    // 以下各数组下标为 Lusp_UploadLane
+    std::array<Lusp_FairQueue<std::shared_ptr<FileState>>, kUploadLaneCount> pending_files_;   // 已提交、未打开(含等待打包的)
+    std::array<std::vector<std::shared_ptr<FileState>>, kUploadLaneCount> active_files_;      // 已打开(含正在发送 FILE_BEGIN 的)
+    std::array<size_t, kUploadLaneCount>        round_robin_{};
+    Lusp_LaneShare                              lane_share_;
+    Lusp_ConcurrencyController                  concurrency_;
+    uint64_t                                    inflight_bytes_ = 0;    // 已分派未结束的分块/容器字节数
+    uint64_t                                    rtt_sample_bytes_ = 0;  // 不短于该长度的分块才作为往返时间样本
+    std::array<uint64_t, kUploadLaneCount>      lane_dispatched_{};
+    std::array<Lusp_WaitHistogram, kUploadLaneCount> queue_wait_;
+    uint64_t                                    next_pack_id_ = 1;
+    uint64_t                                    unfinished_ = 0;    // 已提交未完成的文件数
+    std::vector<Connection*>                    connections_;       // 各工作线程的连接(stop 时中断)
+    std::unordered_set<std::string>             journals_in_use_;   // 上传中的文件占用的续传日志
+
+    std::atomic<uint64_t>                       files_submitted_{ 0 };
+    std::atomic<uint64_t>                       files_completed_{ 0 };
+    std::atomic<uint64_t>                       files_failed_{ 0 };
+    std::atomic<uint64_t>                       chunks_sent_{ 0 };
+    std::atomic<uint64_t>                       chunk_retries_{ 0 };
+    std::atomic<uint64_t>                       bytes_sent_{ 0 };
+    std::atomic<uint64_t>                       chunks_deduplicated_{ 0 };
+    std::atomic<uint64_t>                       stripe_increases_{ 0 };
+    std::atomic<uint64_t>                       stripe_decreases_{ 0 };
+    std::atomic<uint64_t>                       bytes_deduplicated_{ 0 };
+    std::atomic<uint64_t>                       packs_sent_{ 0 };
+    std::atomic<uint64_t>                       files_packed_{ 0 };
+    uint64_t                                    concurrency_increases_ = 0;     // 由 mutex_ 保护
+    uint64_t                                    concurrency_decreases_ = 0;
+
+    struct CompressionCounters {
+        std::atomic<uint64_t>   raw_bytes{ 0 };
+        std::atomic<uint64_t>   wire_bytes{ 0 };
+        std::atomic<uint64_t>   chunks_compressed{ 0 };
+        std::atomic<uint64_t>   chunks_raw{ 0 };
+        std::atomic<uint64_t>   cpu_ns{ 0 };
+    };
+    std::array<CompressionCounters, kUploadFileTypeCount> compression_;
+};
+
+#endif // LUSP_BACKGROUND_UPLOADER_H
@@ -0,0 +1,81 @@
+#ifndef LUSP_CHUNK_BUFFER_POOL_H
+#define LUSP_CHUNK_BUFFER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Lusp_ChunkBufferPool;
+
+/**
+ * @brief 从缓冲池借出的缓冲区，析构时自动归还
+ */
+class Lusp_ChunkBuffer {
+public:
+    Lusp_ChunkBuffer() = default;
+    Lusp_ChunkBuffer(Lusp_ChunkBuffer&& other) noexcept;
+    Lusp_ChunkBuffer& operator=(Lusp_ChunkBuffer&& other) noexcept;
+    ~Lusp_ChunkBuffer();
+
+    uint8_t*    data() const { return data_; }
+    size_t      capacity() const { return capacity_; }
+    explicit operator bool() const { return data_ != nullptr; }
+
+private:
+    friend class Lusp_ChunkBufferPool;
+    Lusp_ChunkBuffer(Lusp_ChunkBufferPool* pool, uint8_t* data, size_t capacity)
+        : pool_(pool), data_(data), capacity_(capacity) {}
+
+    void release();
+
+    Lusp_ChunkBufferPool*   pool_ = nullptr;
+    uint8_t*                data_ = nullptr;
+    size_t                  capacity_ = 0;
+};
+
+/**
+ * @brief 定长分块缓冲池
+ *
+ * 启动时一次性分配 count 个 buffer_size 字节的缓冲区(4KB 对齐)，上传期间不再分配；
+ * 借出数量达到上限时 acquire 阻塞，借出的总内存即为上传引擎的内存上限。
+ */
+class Lusp_ChunkBufferPool {
+public:
+    Lusp_ChunkBufferPool(size_t buffer_size, size_t count);
+    ~Lusp_ChunkBufferPool();
+
+    Lusp_ChunkBufferPool(const Lusp_ChunkBufferPool&) = delete;
+    Lusp_ChunkBufferPool& operator=(const Lusp_ChunkBufferPool&) = delete;
+
+    /**
+     * @brief 借出一个缓冲区(无空闲时阻塞)
+     */
+    Lusp_ChunkBuffer acquire();
+
+    /**
+     * @brief 尝试借出，无空闲时返回空缓冲区
+     */
+    Lusp_ChunkBuffer try_acquire();
+
+    size_t buffer_size() const { return buffer_size_; }
+    size_t capacity() const { return count_; }
+    size_t available() const;
+
+private:
+    friend class Lusp_ChunkBuffer;
+    void give_back(uint8_t* data);
+
+    static constexpr size_t kAlignment = 4096;
+
+    size_t                      buffer_size_;
+    size_t                      count_;
+    uint8_t*                    arena_ = nullptr;       ///< 所有缓冲区的连续内存
+    std::vector<uint8_t*>       free_list_;
+    mutable std::mutex          mutex_;
+    std::condition_variable     available_cv_;
+};
+
+#endif // LUSP_CHUNK_BUFFER_POOL_H
@@ -0,0 +1,90 @@
+#ifndef LUSP_CHUNK_CODEC_H
+#define LUSP_CHUNK_CODEC_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "UploadEngine/Lusp_ChunkProtocol.h"
+
+/**
+ * @brief 分块压缩编解码(发送端与接收端共用)
+ *
+ * 压缩格式为 LZ4 块格式(与 liblz4 的 LZ4_decompress_safe 兼容)，内置实现，不依赖第三方库。
+ * 压缩的 CHUNK 帧带 kFlagCompressed，Chunk::length 与 digest 仍对应原文。
+ */
+namespace Lusp_ChunkCodec {
+
+    /**
+     * @brief 压缩输出的最大长度
+     */
+    size_t lz4_compress_bound(size_t size);
+
+    /**
+     * @brief 贪心 LZ4 压缩
+     * @return 压缩后长度；输出超过 capacity 时返回 0(调用方改发原文)
+     */
+    size_t lz4_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+    /**
+     * @brief 解压，输出长度必须恰好为 raw_size
+     */
+    bool lz4_decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size);
+
+    /**
+     * @brief 字节熵估计(bits/byte，0~8)，只采样前 64KB
+     */
+    double byte_entropy(const uint8_t* data, size_t size);
+
+    /**
+     * @brief 取 CHUNK 帧的原文：未压缩时直接指向负载，压缩时解压到 scratch
+     * @return 帧格式错误或解压失败返回 false
+     */
+    bool chunk_data(uint16_t flags, const uint8_t* payload, size_t size, Lusp_ChunkProtocol::Chunk& chunk,
+        const uint8_t*& data, std::vector<uint8_t>& scratch);
+}
+
+/**
+ * @brief 上传工作线程的自适应压缩器(每个工作线程一个，不共享)
+ *
+ * 记录本线程的压缩速度、节省比例与连接的传输速度(EWMA)；压缩一个分块的耗时超过它省下的传输时间
+ * (compress_rate * saving < link_rate)时说明压缩成了瓶颈，按指数退避跳过后续分块(1, 2, 4 ... 256 块)，
+ * 退避结束后的第一个分块重新试探。
+ */
+class Lusp_AdaptiveCompressor {
+public:
+    explicit Lusp_AdaptiveCompressor(uint32_t max_chunk_size);
+
+    /**
+     * @brief 退避期间返回 false(并消耗一次退避计数)
+     */
+    bool should_try();
+
+    /**
+     * @brief 压缩一个分块
+     * @return 压缩后长度；压缩后节省不足 1/8 时返回 0，调用方发送原文
+     */
+    size_t compress(const uint8_t* data, size_t size);
+
+    const uint8_t* output() const { return output_.data(); }
+    uint64_t last_cpu_ns() const { return last_cpu_ns_; }
+
+    /**
+     * @brief 记录一次分块传输(帧写出到收到 ACK)，用于估计链路速度
+     */
+    void record_transfer(size_t wire_bytes, std::chrono::nanoseconds elapsed);
+
+private:
+    static constexpr double     kAlpha = 0.2;
+    static constexpr uint32_t   kMaxBackoff = 256;
+
+    std::vector<uint8_t>    output_;
+    double                  compress_rate_ = 0;     // 原文字节/秒
+    double                  saving_ = -1;           // 压缩节省的比例，负数表示尚无样本
+    double                  link_rate_ = 0;         // 线路字节/秒
+    uint64_t                last_cpu_ns_ = 0;
+    uint32_t                backoff_ = 0;
+    uint32_t                skip_remaining_ = 0;
+};
+
+#endif // LUSP_CHUNK_CODEC_H
@@ -0,0 +1,104 @@
+#ifndef LUSP_CHUNK_JOURNAL_H
+#define LUSP_CHUNK_JOURNAL_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "UploadEngine/Lusp_PositionalFile.h"
+
+/**
+ * @brief 断点续传日志(每个文件一个，发送端与接收端共用)
+ *
+ * 文件布局(小端):
+ *
+ *   [0, 64)     头: magic(u64) | file_id(u64) | file_size(u64) | mtime(i64) | chunk_size(u32) | chunk_count(u32) | meta_length(u32) |
+ *               content_root(16 字节) | 保留
+ *   [64, B)     元数据: path_length(u16) | path | name_length(u16) | name，按 8 字节对齐
+ *   [B, D)      分块位图，每 64 块一个 u64
+ *   [D, D+4n)   每块的 CRC32
+ *
+ * 位图与摘要都在固定偏移，mark 只改内存；flush 只写脏的位图字及其对应的 64 个摘要(264 字节)，
+ * 每个分块的写放大有上界，与文件大小无关。
+ */
+class Lusp_ChunkJournal {
+public:
+    struct Meta {
+        uint64_t    file_id     = 0;
+        uint64_t    file_size   = 0;
+        int64_t     mtime       = 0;    // 源文件修改时间，发送端用于判断文件是否变化
+        uint32_t    chunk_size  = 0;
+        uint32_t    chunk_count = 0;
+        std::array<uint8_t, 16> content_root{};    // 发送端: 客户端分块哈希根(MD5)，没有时全零；早期的日志读出为全零
+        std::string file_path;          // 发送端: 本地路径；接收端: .part 路径(UTF-8)
+        std::string remote_name;        // 远端文件名(UTF-8)
+    };
+
+    Lusp_ChunkJournal() = default;
+    Lusp_ChunkJournal(const Lusp_ChunkJournal&) = delete;
+    Lusp_ChunkJournal& operator=(const Lusp_ChunkJournal&) = delete;
+
+    /**
+     * @brief 新建日志(覆盖同名文件)
+     */
+    bool create(const std::string& journal_path, const Meta& meta);
+
+    /**
+     * @brief 加载已有日志，格式或长度不符返回 false
+     */
+    bool load(const std::string& journal_path);
+
+    /**
+     * @brief 记录一个已确认的分块(只改内存)
+     */
+    void mark(uint32_t chunk_index, uint32_t digest);
+
+    bool is_marked(uint32_t chunk_index) const;
+    uint32_t digest(uint32_t chunk_index) const;
+    uint32_t marked_count() const;
+    size_t dirty_count() const;
+
+    /**
+     * @brief 把脏的位图字与摘要写回并刷盘
+     * @param before_write 取出脏区之后、写日志之前调用，返回 false 时放弃本次写入；
+     *                     接收端用它先把分块数据刷盘，保证日志记录的分块一定已落盘
+     */
+    bool flush(const std::function<bool()>& before_write = nullptr);
+
+    /**
+     * @brief 关闭并删除日志文件
+     */
+    void remove();
+
+    const Meta& meta() const { return meta_; }
+    const std::string& path() const { return journal_path_; }
+
+    /**
+     * @brief 位图与摘要的快照(接收端回复续传状态用)
+     */
+    void snapshot(std::vector<uint64_t>& bitmap, std::vector<uint32_t>& digests) const;
+
+private:
+    static constexpr uint64_t   kMagic = 0x314E524A5053554Cull;   ///< "LUSPJRN1"
+    static constexpr size_t     kHeaderSize = 64;
+
+    void layout();
+
+    Meta                    meta_;
+    std::string             journal_path_;
+    Lusp_PositionalFile     file_;
+    uint64_t                bitmap_offset_ = 0;
+    uint64_t                digest_offset_ = 0;
+
+    std::mutex              flush_mutex_;   // 串行化 flush，写盘时不持有 mutex_
+    mutable std::mutex      mutex_;
+    std::vector<uint64_t>   bitmap_;
+    std::vector<uint32_t>   digests_;
+    std::vector<uint8_t>    dirty_flags_;   // 每个位图字一个标志
+    std::vector<uint32_t>   dirty_words_;
+    uint32_t                marked_count_ = 0;
+};
+
+#endif // LUSP_CHUNK_JOURNAL_H
@@ -0,0 +1,309 @@
+#ifndef LUSP_CHUNK_PROTOCOL_H
+#define LUSP_CHUNK_PROTOCOL_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "hash-library/crc32.h"
+
+/**
+ * @brief 分块上传线路协议(本地服务 -> 远端接收端)
+ *
+ * 每帧 = 12 字节帧头 + 负载，所有整数均为小端:
+ *
+ *   帧头:       magic(u32) | type(u16) | flags(u16) | payload_length(u32)
+ *   FILE_BEGIN: file_id(u64) | file_size(u64) | chunk_size(u32) | chunk_count(u32) | name_length(u16) | name(UTF-8)
+ *               [ | manifest: (length(u32) | sha256(32)) x chunk_count ]   (仅 kFlagContentDefined)
+ *   CHUNK:      file_id(u64) | offset(u64) | chunk_index(u32) | length(u32) | digest(u32) | data
+ *   FILE_END:   file_id(u64) | chunk_count(u32)
+ *   ACK:        file_id(u64) | chunk_index(u32) | status(u16) | reserved(u16)
+ *   RESUME:     ACK(16) | chunk_count(u32) | bitmap(u64 x ceil(n/64)) | digest(u32 x n)
+ *   PACK:       pack_id(u64) | 文件数据(首尾相接) | 索引(file_id(u64) | size(u32) | digest(u32) | name_length(u16) | name) x n
+ *               | index_length(u32) | file_count(u32) | magic(u32)
+ *
+ * FILE_BEGIN 带 kFlagResume 时，接收端以 RESUME 代替 ACK 回复，报告已持有的分块及其摘要，
+ * 发送端只补发缺失(或摘要与本地日志不一致)的分块。
+ * CHUNK 带 kFlagCompressed 时 data 为压缩后的数据(长度 = payload_length - 28)，接收端解压后再按原文处理。
+ *
+ * FILE_BEGIN 带 kFlagContentDefined 时分块按内容切分(长度可变，chunk_size 为最大长度)，名称之后附带分块清单
+ * (每块长度与 SHA-256 指纹)。接收端总是以 RESUME 回复：位图标出无需发送的分块(已从本地数据复制，
+ * 或与清单中更早的分块内容相同)，digest 全为 0；发送端只发送其余分块。
+ *
+ * PACK 把多个小文件装进一个容器整体发送(无需 FILE_BEGIN/FILE_END)，容器只追加：数据在前，索引与尾部在后，
+ * 接收端从尾部定位索引后按顺序解出各文件。ACK 的 file_id 为 pack_id，状态对整个容器有效；带 kFlagDigest 时
+ * 索引中的 digest 为各文件的 CRC32。
+ *
+ * 发送端每发一帧等待一个 ACK(同一连接上停等)，并发来自多条连接。
+ * 同一文件的分块可以经不同连接、以任意顺序到达；FILE_BEGIN 的 ACK 返回后才会发送该文件的分块。
+ */
+namespace Lusp_ChunkProtocol {
+
+    constexpr uint32_t kMagic               = 0x5053554C;   ///< "LUSP"
+    constexpr size_t   kHeaderSize          = 12;
+    constexpr size_t   kFileBeginFixedSize  = 26;
+    constexpr size_t   kChunkFixedSize      = 28;
+    constexpr size_t   kFileEndSize         = 12;
+    constexpr size_t   kAckSize             = 16;
+    constexpr uint32_t kControlIndex        = 0xFFFFFFFFu;  ///< FILE_BEGIN/FILE_END 的 ACK 使用的 chunk_index
+    constexpr uint32_t kMaxPayloadSize      = 64u * 1024 * 1024 + kChunkFixedSize;
+    constexpr size_t   kMaxNameLength       = 4096;
+    constexpr uint32_t kMaxChunkCount       = 1u << 26;     ///< 单个文件的分块数上限(接收端按它限制位图大小，8MB)
+    constexpr size_t   kManifestEntrySize   = 36;
+    constexpr size_t   kPackFixedSize       = 8;            ///< PACK 负载开头的 pack_id
+    constexpr size_t   kPackEntryFixedSize  = 18;           ///< 索引项(不含名称)
+    constexpr size_t   kPackTrailerSize     = 12;
+    constexpr uint32_t kPackMagic           = 0x4B41504C;   ///< "LPAK"
+
+    enum class FrameType : uint16_t {
+        FileBegin   = 1,
+        Chunk       = 2,
+        FileEnd     = 3,
+        Ack         = 4,
+        ResumeState = 5,
+        Pack        = 6
+    };
+
+    enum FrameFlags : uint16_t {
+        kFlagDigest = 1 << 0,   ///< CHUNK 的 digest 字段有效(CRC32)
+        kFlagResume = 1 << 1,   ///< FILE_BEGIN 请求续传，接收端以 RESUME 回复
+        kFlagCompressed = 1 << 2,   ///< CHUNK 的 data 为 LZ4 块(见 Lusp_ChunkCodec.h)，length/digest 仍对应原文
+        kFlagContentDefined = 1 << 3    ///< FILE_BEGIN 使用内容定义分块并附带分块清单，接收端按指纹去重
+    };
+
+    enum class AckStatus : uint16_t {
+        Ok              = 0,
+        DigestMismatch  = 1,    ///< 分块校验失败，应重发
+        UnknownFile     = 2,    ///< 接收端没有该文件的 FILE_BEGIN
+        Incomplete      = 3,    ///< FILE_END 时仍有分块缺失
+        Failed          = 4     ///< 接收端写入失败等
+    };
+
+    struct FrameHeader {
+        uint32_t    magic           = kMagic;
+        FrameType   type            = FrameType::Ack;
+        uint16_t    flags           = 0;
+        uint32_t    payload_length  = 0;
+    };
+
+    struct FileBegin {
+        uint64_t    file_id         = 0;
+        uint64_t    file_size       = 0;
+        uint32_t    chunk_size      = 0;
+        uint32_t    chunk_count     = 0;
+        uint16_t    name_length     = 0;    ///< 名称紧随其后
+    };
+
+    struct Chunk {
+        uint64_t    file_id         = 0;
+        uint64_t    offset          = 0;
+        uint32_t    chunk_index     = 0;
+        uint32_t    length          = 0;    ///< 数据紧随其后
+        uint32_t    digest          = 0;
+    };
+
+    struct FileEnd {
+        uint64_t    file_id         = 0;
+        uint32_t    chunk_count     = 0;
+    };
+
+    struct PackEntry {
+        uint64_t    file_id         = 0;
+        uint32_t    size            = 0;
+        uint32_t    digest          = 0;
+        uint16_t    name_length     = 0;    ///< 名称紧随其后
+    };
+
+    using ChunkFingerprint = std::array<uint8_t, 32>;   ///< 分块内容的 SHA-256
+
+    struct Ack {
+        uint64_t    file_id         = 0;
+        uint32_t    chunk_index     = 0;
+        AckStatus   status          = AckStatus::Ok;
+    };
+
+    // ---- 小端读写 ----
+    inline void put_u16(uint8_t* p, uint16_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+    inline void put_u32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = uint8_t(v >> (8 * i)); }
+    inline void put_u64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = uint8_t(v >> (8 * i)); }
+    inline uint16_t get_u16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+    inline uint32_t get_u32(const uint8_t* p) {
+        uint32_t v = 0;
+        for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+    inline uint64_t get_u64(const uint8_t* p) {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+
+    inline void encode_header(uint8_t* out, FrameType type, uint16_t flags, uint32_t payload_length) {
+        put_u32(out, kMagic);
+        put_u16(out + 4, static_cast<uint16_t>(type));
+        put_u16(out + 6, flags);
+        put_u32(out + 8, payload_length);
+    }
+
+    /**
+     * @return magic 正确且负载长度不超过上限
+     */
+    inline bool decode_header(const uint8_t* in, FrameHeader& header) {
+        header.magic = get_u32(in);
+        header.type = static_cast<FrameType>(get_u16(in + 4));
+        header.flags = get_u16(in + 6);
+        header.payload_length = get_u32(in + 8);
+        return header.magic == kMagic && header.payload_length <= kMaxPayloadSize;
+    }
+
+    inline void encode_file_begin(uint8_t* out, const FileBegin& begin) {
+        put_u64(out, begin.file_id);
+        put_u64(out + 8, begin.file_size);
+        put_u32(out + 16, begin.chunk_size);
+        put_u32(out + 20, begin.chunk_count);
+        put_u16(out + 24, begin.name_length);
+    }
+
+    inline void decode_file_begin(const uint8_t* in, FileBegin& begin) {
+        begin.file_id = get_u64(in);
+        begin.file_size = get_u64(in + 8);
+        begin.chunk_size = get_u32(in + 16);
+        begin.chunk_count = get_u32(in + 20);
+        begin.name_length = get_u16(in + 24);
+    }
+
+    inline void encode_chunk(uint8_t* out, const Chunk& chunk) {
+        put_u64(out, chunk.file_id);
+        put_u64(out + 8, chunk.offset);
+        put_u32(out + 16, chunk.chunk_index);
+        put_u32(out + 20, chunk.length);
+        put_u32(out + 24, chunk.digest);
+    }
+
+    inline void decode_chunk(const uint8_t* in, Chunk& chunk) {
+        chunk.file_id = get_u64(in);
+        chunk.offset = get_u64(in + 8);
+        chunk.chunk_index = get_u32(in + 16);
+        chunk.length = get_u32(in + 20);
+        chunk.digest = get_u32(in + 24);
+    }
+
+    inline void encode_file_end(uint8_t* out, const FileEnd& end) {
+        put_u64(out, end.file_id);
+        put_u32(out + 8, end.chunk_count);
+    }
+
+    inline void decode_file_end(const uint8_t* in, FileEnd& end) {
+        end.file_id = get_u64(in);
+        end.chunk_count = get_u32(in + 8);
+    }
+
+    inline void encode_ack(uint8_t* out, const Ack& ack) {
+        put_u64(out, ack.file_id);
+        put_u32(out + 8, ack.chunk_index);
+        put_u16(out + 12, static_cast<uint16_t>(ack.status));
+        put_u16(out + 14, 0);
+    }
+
+    inline void decode_ack(const uint8_t* in, Ack& ack) {
+        ack.file_id = get_u64(in);
+        ack.chunk_index = get_u32(in + 8);
+        ack.status = static_cast<AckStatus>(get_u16(in + 12));
+    }
+
+    inline void encode_pack_entry(uint8_t* out, const PackEntry& entry) {
+        put_u64(out, entry.file_id);
+        put_u32(out + 8, entry.size);
+        put_u32(out + 12, entry.digest);
+        put_u16(out + 16, entry.name_length);
+    }
+
+    inline void decode_pack_entry(const uint8_t* in, PackEntry& entry) {
+        entry.file_id = get_u64(in);
+        entry.size = get_u32(in + 8);
+        entry.digest = get_u32(in + 12);
+        entry.name_length = get_u16(in + 16);
+    }
+
+    inline void encode_pack_trailer(uint8_t* out, uint32_t index_length, uint32_t file_count) {
+        put_u32(out, index_length);
+        put_u32(out + 4, file_count);
+        put_u32(out + 8, kPackMagic);
+    }
+
+    inline void encode_manifest_entry(uint8_t* out, uint32_t length, const ChunkFingerprint& fingerprint) {
+        put_u32(out, length);
+        std::copy(fingerprint.begin(), fingerprint.end(), out + 4);
+    }
+
+    inline void decode_manifest_entry(const uint8_t* in, uint32_t& length, ChunkFingerprint& fingerprint) {
+        length = get_u32(in);
+        std::copy(in + 4, in + kManifestEntrySize, fingerprint.begin());
+    }
+
+    /**
+     * @brief RESUME 负载长度
+     */
+    inline size_t resume_state_size(uint32_t chunk_count) {
+        return kAckSize + 4 + (static_cast<size_t>(chunk_count) + 63) / 64 * 8 + static_cast<size_t>(chunk_count) * 4;
+    }
+
+    /**
+     * @param out 至少 resume_state_size(chunk_count) 字节
+     */
+    inline void encode_resume_state(uint8_t* out, const Ack& ack, uint32_t chunk_count,
+        const uint64_t* bitmap, const uint32_t* digests) {
+        encode_ack(out, ack);
+        put_u32(out + kAckSize, chunk_count);
+        uint8_t* cursor = out + kAckSize + 4;
+        const size_t words = (static_cast<size_t>(chunk_count) + 63) / 64;
+        for (size_t w = 0; w < words; ++w, cursor += 8) {
+            put_u64(cursor, bitmap[w]);
+        }
+        for (uint32_t i = 0; i < chunk_count; ++i, cursor += 4) {
+            put_u32(cursor, digests[i]);
+        }
+    }
+
+    /**
+     * @return 长度与 chunk_count 一致
+     */
+    inline bool decode_resume_state(const uint8_t* in, size_t size, Ack& ack, uint32_t& chunk_count,
+        std::vector<uint64_t>& bitmap, std::vector<uint32_t>& digests) {
+        if (size < kAckSize + 4) {
+            return false;
+        }
+        decode_ack(in, ack);
+        chunk_count = get_u32(in + kAckSize);
+        if (size != resume_state_size(chunk_count)) {
+            return false;
+        }
+        const uint8_t* cursor = in + kAckSize + 4;
+        bitmap.resize((static_cast<size_t>(chunk_count) + 63) / 64);
+        for (auto& word : bitmap) {
+            word = get_u64(cursor);
+            cursor += 8;
+        }
+        digests.resize(chunk_count);
+        for (auto& digest : digests) {
+            digest = get_u32(cursor);
+            cursor += 4;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 分块摘要(CRC32)
+     */
+    inline uint32_t chunk_digest(const void* data, size_t length) {
+        CRC32 crc;
+        crc.add(data, length);
+        unsigned char bytes[CRC32::HashBytes];
+        crc.getHash(bytes);
+        return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+    }
+
+} // namespace Lusp_ChunkProtocol
+
+#endif // LUSP_CHUNK_PROTOCOL_H
@@ -0,0 +1,102 @@
+#ifndef LUSP_CHUNK_STORE_H
+#define LUSP_CHUNK_STORE_H
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "UploadEngine/Lusp_ChunkProtocol.h"
+#include "UploadEngine/Lusp_PositionalFile.h"
+
+/**
+ * @brief 接收端按分块清单准备一个文件的结果
+ */
+struct Lusp_ManifestPlan {
+    std::vector<uint64_t>   held;           // 无需发送的分块位图(RESUME 回复用)
+    std::vector<uint32_t>   present;        // 已在输出文件中的分块(从本地数据复制；不落盘时为库中已有的分块)
+    uint64_t                present_bytes = 0;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> duplicates;   // 清单内首次出现的分块 -> 内容相同的后续分块
+};
+
+/**
+ * @brief 接收端分块指纹库(内容定义分块去重，线程安全)
+ *
+ * 每个收齐的内容定义分块文件把清单登记进来：指纹 -> (文件路径, 偏移, 长度)。
+ * 新文件的清单到达时，库中已有的分块直接从本地文件读出、重新计算 SHA-256 确认内容未变后写入输出文件，
+ * 不再经网络传输；校验失败(源文件已被覆盖或删除)的条目从库中移除，照常请求发送端发送。
+ *
+ * 索引文件只追加，每条记录为 magic(u32) | path_length(u16) | path | chunk_count(u32) | 清单，
+ * 启动时依次载入，尾部不完整的记录丢弃。条目数超过上限时按登记顺序淘汰。
+ */
+class Lusp_ChunkStore {
+public:
+    static constexpr size_t kDefaultMaxEntries = 1u << 20;     // 平均 256KB 的分块约覆盖 256GB 数据
+
+    explicit Lusp_ChunkStore(size_t max_entries = kDefaultMaxEntries);
+
+    Lusp_ChunkStore(const Lusp_ChunkStore&) = delete;
+    Lusp_ChunkStore& operator=(const Lusp_ChunkStore&) = delete;
+
+    /**
+     * @brief 载入索引文件(不存在则创建)，之后登记的文件追加到其中；不调用时只在内存中维护
+     */
+    bool open(const std::string& index_path);
+
+    /**
+     * @brief 校验清单(每块长度在 (0, max_chunk_size] 内且总和等于文件大小)并计算各分块起始偏移
+     * @param offsets 输出 chunk_count + 1 个偏移，最后一个为文件大小
+     */
+    static bool layout(const uint8_t* manifest, uint32_t chunk_count, uint64_t file_size, uint32_t max_chunk_size,
+        std::vector<uint64_t>& offsets);
+
+    /**
+     * @brief 生成接收计划(可能读写大量数据，调用方不应持有全局锁)
+     * @param offsets layout 得出的分块偏移
+     * @param output 已打开的输出文件：库中已有的分块读出校验后写入其中；为空时只查询(不落盘的替身接收端)
+     */
+    void prepare(const uint8_t* manifest, uint32_t chunk_count, const std::vector<uint64_t>& offsets,
+        const Lusp_PositionalFile* output, Lusp_ManifestPlan& plan);
+
+    /**
+     * @brief 文件收齐后登记其分块
+     * @param path 文件最终路径(UTF-8)；为空时只登记指纹(不落盘的替身接收端)
+     */
+    void add_file(const std::string& path, const uint8_t* manifest, uint32_t chunk_count);
+
+    size_t size() const;
+
+private:
+    struct Location {
+        std::shared_ptr<const std::string>  path;
+        uint64_t                            offset = 0;
+        uint32_t                            length = 0;
+    };
+
+    struct FingerprintHash {
+        size_t operator()(const Lusp_ChunkProtocol::ChunkFingerprint& fingerprint) const {
+            uint64_t value;
+            std::memcpy(&value, fingerprint.data(), sizeof(value));
+            return static_cast<size_t>(value);
+        }
+    };
+
+    bool locate(const Lusp_ChunkProtocol::ChunkFingerprint& fingerprint, uint32_t length, Location& location) const;
+    void forget(const Lusp_ChunkProtocol::ChunkFingerprint& fingerprint, const Location& location);
+    void insert_manifest(const std::shared_ptr<const std::string>& path, const uint8_t* manifest, uint32_t chunk_count);  // 调用方持有 mutex_
+    void load_index();      // 调用方持有 mutex_
+
+    static constexpr uint32_t kRecordMagic = 0x58444943;   // "CIDX"
+
+    size_t                                                                                  max_entries_;
+    mutable std::mutex                                                                      mutex_;
+    std::unordered_map<Lusp_ChunkProtocol::ChunkFingerprint, Location, FingerprintHash>     entries_;
+    std::deque<Lusp_ChunkProtocol::ChunkFingerprint>                                        order_;     // 登记顺序，用于淘汰
+    Lusp_PositionalFile                                                                     index_;
+    uint64_t                                                                                index_size_ = 0;
+};
+
+#endif // LUSP_CHUNK_STORE_H
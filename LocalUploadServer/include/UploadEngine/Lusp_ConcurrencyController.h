@@ -0,0 +1,83 @@
+#ifndef LUSP_CONCURRENCY_CONTROLLER_H
+#define LUSP_CONCURRENCY_CONTROLLER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief 全局上传并发数控制(整个引擎一个，调用方加锁)
+ *
+ * 上限以整块计：在途数据不超过 上限 × 分块大小，即同时在传的整块数与用于传数据的连接数都不超过上限。
+ * 控制器按确认逐窗口测量总有效吞吐(goodput)与分块往返时间(发出到收到 ACK)，按 AIMD 调整上限:
+ *
+ * - 估算排队: 基准往返时间取近 kBaseWindows 个窗口的最小值，上限 × (1 - 基准 / 平均往返时间) 即在链路缓冲中
+ *   排队(而不是在传)的分块数(Vegas 的估算方式)
+ * - 加性增: 窗口内曾因上限而有分块等待分派，且排队不超过 kMaxQueued 块，上限 +1
+ * - 乘性减: 窗口内出现重发，或排队超过 kMaxQueued 块而吞吐没有比上个窗口提升 kMinGain，上限乘以 kBackoff
+ *
+ * 窗口至少包含 2 倍上限个确认、持续 kWindowRtts 个基准往返时间；上限改变后先丢弃一轮在途请求的确认，
+ * 再开始下一个测量窗口。
+ */
+class Lusp_ConcurrencyController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Lusp_ConcurrencyController(uint32_t initial = 1, uint32_t min = 1, uint32_t max = 1);
+
+    uint32_t limit() const { return limit_; }
+
+    /**
+     * @brief 在途数据已达上限，有分块因此等待分派
+     */
+    void mark_limited() { limited_ = true; }
+
+    enum class Decision { None, Increased, Decreased };
+
+    /**
+     * @brief 记录一次确认
+     * @param rtt 分块往返时间，容器等非分块请求传 0(只计吞吐)
+     * @param retries 引擎累计重发次数(与上个窗口比较得出本窗口是否丢失)
+     */
+    Decision on_acked(uint64_t bytes, Clock::duration rtt, uint64_t retries, Clock::time_point now);
+
+    /**
+     * @brief 最近一个完整窗口的指标，尚无样本时为 0
+     */
+    double last_goodput() const { return last_goodput_; }      // bytes/s
+    double last_rtt_us() const { return last_rtt_us_; }
+    double base_rtt_us() const { return base_rtt_us_; }
+    double last_queued() const { return last_queued_; }        // 估算的排队分块数
+
+private:
+    static constexpr double     kMaxQueued = 4;
+    static constexpr double     kMinGain = 0.1;
+    static constexpr double     kBackoff = 0.7;
+    static constexpr uint32_t   kMinWindowAcks = 8;
+    static constexpr double     kWindowRtts = 4;        // 窗口至少持续几个基准往返时间(每个往返最多加一个槽位)
+    static constexpr auto       kMinWindow = std::chrono::milliseconds(20);
+    static constexpr size_t     kBaseWindows = 16;
+
+    void restart_window(Clock::time_point now, uint64_t retries);
+
+    uint32_t            limit_;
+    uint32_t            min_;
+    uint32_t            max_;
+    bool                limited_ = false;
+    uint32_t            warmup_ = 0;            // 上限改变后还需丢弃的确认数
+    uint32_t            window_acks_ = 0;
+    uint64_t            window_bytes_ = 0;
+    uint32_t            window_rtt_count_ = 0;
+    double              window_rtt_sum_us_ = 0;
+    double              window_rtt_min_us_ = 0;
+    uint64_t            window_retries_ = 0;    // 窗口开始时的累计重发次数
+    Clock::time_point   window_start_{};
+    std::array<double, kBaseWindows> window_minimums_{};   // 近几个窗口的最小往返时间(环形)
+    size_t              window_count_ = 0;
+    double              last_goodput_ = 0;
+    double              last_rtt_us_ = 0;
+    double              base_rtt_us_ = 0;
+    double              last_queued_ = 0;
+};
+
+#endif // LUSP_CONCURRENCY_CONTROLLER_H
@@ -0,0 +1,46 @@
+#ifndef LUSP_CONTENT_CHUNKER_H
+#define LUSP_CONTENT_CHUNKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 内容定义分块(FastCDC，gear 滚动哈希)
+ *
+ * 分块边界只取决于边界前 64 字节的内容，文件中间插入或删除数据后，改动之后的边界会重新对齐，
+ * 同一内容在不同文件、不同偏移处切出相同的分块，接收端据此按指纹去重。
+ *
+ * - 分块长度在 [min, max] 之间：前 min 字节不判定边界；到 max 强制切分
+ * - 归一化分块：长度小于 avg 时用更严的掩码(多 2 位)，超过 avg 后用更松的掩码(少 2 位)，长度集中在 avg 附近
+ * - 每次迭代滚动两个字节(h << 2 + G'[b0] + G[b1])，两个位置都判定，省一次移位
+ *
+ * gear 表由固定种子生成，所有发送端切出的边界一致。
+ */
+class Lusp_ContentChunker {
+public:
+    /**
+     * @param average_size 期望平均长度(向下取 2 的幂)，最小长度为其 1/4
+     * @param max_size 最大长度(不小于 average_size)
+     */
+    Lusp_ContentChunker(uint32_t average_size, uint32_t max_size);
+
+    /**
+     * @brief 从 data 开头切出一个分块
+     * @param size 可用数据长度；不到 max_size 时视为文件结尾
+     * @return 分块长度(size 为 0 时返回 0)
+     */
+    size_t cut(const uint8_t* data, size_t size) const;
+
+    uint32_t min_size() const { return min_size_; }
+    uint32_t average_size() const { return average_size_; }
+    uint32_t max_size() const { return max_size_; }
+
+private:
+    uint32_t    min_size_;
+    uint32_t    average_size_;
+    uint32_t    max_size_;
+    uint64_t    mask_small_;    // 长度 < avg 时的掩码
+    uint64_t    mask_large_;    // 长度 >= avg 时的掩码
+};
+
+#endif // LUSP_CONTENT_CHUNKER_H
@@ -0,0 +1,84 @@
+#ifndef LUSP_FILE_PACK_H
+#define LUSP_FILE_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "UploadEngine/Lusp_ChunkProtocol.h"
+
+/**
+ * @brief 小文件容器的组装(发送端，每个工作线程一个)
+ *
+ * 容器格式见 Lusp_ChunkProtocol.h 的 PACK 帧：文件数据依次追加在 pack_id 之后，索引在 finish 时追加到末尾。
+ * 文件内容直接读入容器缓冲区，不经中间拷贝；缓冲区在各容器之间复用。
+ */
+class Lusp_PackWriter {
+public:
+    void reset(uint64_t pack_id);
+
+    /**
+     * @brief 为下一个文件预留 size 字节，返回写入位置(下一次 begin_file/finish 前有效)
+     */
+    uint8_t* begin_file(uint32_t size);
+
+    /**
+     * @brief 确认 begin_file 预留的文件
+     */
+    void end_file(uint64_t file_id, const std::string& name, uint32_t digest);
+
+    /**
+     * @brief 放弃 begin_file 预留的文件(读取失败)
+     */
+    void cancel_file();
+
+    /**
+     * @brief 追加索引与尾部，返回整个 PACK 负载
+     */
+    const std::vector<uint8_t>& finish();
+
+    uint32_t file_count() const { return file_count_; }
+    uint64_t data_size() const { return data_end_ - Lusp_ChunkProtocol::kPackFixedSize; }
+
+private:
+    std::vector<uint8_t>    buffer_;
+    std::vector<uint8_t>    index_;
+    size_t                  data_end_ = 0;
+    uint32_t                pending_size_ = 0;
+    uint32_t                file_count_ = 0;
+};
+
+/**
+ * @brief 容器中的一个文件(指向负载内部，负载释放后失效)
+ */
+struct Lusp_PackedFile {
+    uint64_t        file_id = 0;
+    uint32_t        size = 0;
+    uint32_t        digest = 0;
+    const char*     name = nullptr;
+    uint16_t        name_length = 0;
+    const uint8_t*  data = nullptr;
+};
+
+/**
+ * @brief 小文件容器的解析(接收端，每条连接一个)
+ */
+class Lusp_PackReader {
+public:
+    /**
+     * @brief 从尾部定位索引并校验：各文件长度之和恰好等于数据区长度
+     * @return 格式错误返回 false
+     */
+    bool parse(const uint8_t* payload, size_t size);
+
+    uint64_t pack_id() const { return pack_id_; }
+    uint64_t data_size() const { return data_size_; }
+    const std::vector<Lusp_PackedFile>& files() const { return files_; }
+
+private:
+    uint64_t                        pack_id_ = 0;
+    uint64_t                        data_size_ = 0;
+    std::vector<Lusp_PackedFile>    files_;     // 容量在各容器之间复用
+};
+
+#endif // LUSP_FILE_PACK_H
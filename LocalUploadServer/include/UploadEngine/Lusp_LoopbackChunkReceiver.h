@@ -0,0 +1,106 @@
+#ifndef LUSP_LOOPBACK_CHUNK_RECEIVER_H
+#define LUSP_LOOPBACK_CHUNK_RECEIVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "asio/asio.hpp"
+#include "UploadEngine/Lusp_ChunkStore.h"
+#include "UploadEngine/Lusp_FilePack.h"
+
+/**
+ * @brief 本地替身接收端配置
+ */
+struct Lusp_LoopbackReceiverConfig {
+    uint16_t    port            = 9100;     // 监听端口(0=由系统分配)
+    std::string output_dir;                 // 落盘目录(UTF-8)，为空时只校验不写盘
+    bool        verify_checksum = true;     // 校验分块 CRC32
+    uint32_t    ack_delay_us    = 0;        // 每帧延迟多久再回复(模拟链路往返时延，观察条带效果)
+    uint64_t    link_rate       = 0;        // 所有连接共享的瓶颈链路速率(bytes/s，0=不限)，帧在其上排队，模拟拥塞时的时延膨胀
+};
+
+/**
+ * @brief 本地替身接收端统计
+ */
+struct Lusp_LoopbackReceiverStats {
+    uint64_t    files_completed = 0;
+    uint64_t    chunks_received = 0;
+    uint64_t    bytes_received  = 0;
+    uint64_t    digest_errors   = 0;
+    uint64_t    chunks_deduplicated = 0;    // 内容定义分块中无需发送的分块
+    uint64_t    bytes_deduplicated  = 0;
+    uint64_t    packs_received  = 0;        // 小文件容器数(其中的文件计入 files_completed)
+};
+
+/**
+ * @brief 分块协议的本地替身接收端
+ *
+ * 在远端服务尚未部署时用于联调与压测：按 Lusp_ChunkProtocol 接收 FILE_BEGIN/CHUNK/FILE_END，
+ * 校验分块摘要，按偏移写入输出目录(或丢弃)，并在 FILE_END 时检查所有分块是否到齐。
+ * 每条连接一个线程，同一文件的分块可来自不同连接。
+ * PACK 容器校验全部文件后按顺序解出，每个文件一次写入。
+ * 内容定义分块的文件按清单去重，指纹库只保存在内存中(未配置输出目录时只登记指纹，不复制数据)。
+ */
+class Lusp_LoopbackChunkReceiver {
+public:
+    explicit Lusp_LoopbackChunkReceiver(const Lusp_LoopbackReceiverConfig& config);
+    ~Lusp_LoopbackChunkReceiver();
+
+    Lusp_LoopbackChunkReceiver(const Lusp_LoopbackChunkReceiver&) = delete;
+    Lusp_LoopbackChunkReceiver& operator=(const Lusp_LoopbackChunkReceiver&) = delete;
+
+    bool start();
+    void stop();
+
+    /**
+     * @brief 实际监听端口(配置为 0 时由系统分配)
+     */
+    uint16_t port() const { return bound_port_; }
+
+    Lusp_LoopbackReceiverStats get_statistics() const;
+
+private:
+    struct ReceiveFile;
+    using SocketPtr = std::shared_ptr<asio::ip::tcp::socket>;
+
+    void do_accept();
+    void serve(SocketPtr socket);
+    bool handle_file_begin(uint16_t flags, const uint8_t* payload, size_t size, std::vector<uint8_t>& reply);
+    bool handle_chunk(uint16_t flags, const uint8_t* payload, size_t size, std::vector<uint8_t>& scratch, std::vector<uint8_t>& reply);
+    bool handle_file_end(const uint8_t* payload, size_t size, std::vector<uint8_t>& reply);
+    bool handle_pack(uint16_t flags, const uint8_t* payload, size_t size, Lusp_PackReader& pack, std::vector<uint8_t>& reply);
+
+    Lusp_LoopbackReceiverConfig                                 config_;
+    asio::io_context                                            io_context_;
+    asio::ip::tcp::acceptor                                     acceptor_;
+    std::thread                                                 io_thread_;
+    uint16_t                                                    bound_port_ = 0;
+    std::atomic<bool>                                           running_{ false };
+
+    std::mutex                                                  link_mutex_;
+    std::chrono::steady_clock::time_point                       link_free_{};  // 瓶颈链路排空的时刻
+
+    std::mutex                                                  connections_mutex_;
+    std::vector<SocketPtr>                                      sockets_;
+    std::vector<std::thread>                                    connection_threads_;
+
+    std::mutex                                                  files_mutex_;
+    std::unordered_map<uint64_t, std::shared_ptr<ReceiveFile>>  files_;
+    Lusp_ChunkStore                                             store_;
+
+    std::atomic<uint64_t>                                       files_completed_{ 0 };
+    std::atomic<uint64_t>                                       chunks_received_{ 0 };
+    std::atomic<uint64_t>                                       bytes_received_{ 0 };
+    std::atomic<uint64_t>                                       digest_errors_{ 0 };
+    std::atomic<uint64_t>                                       chunks_deduplicated_{ 0 };
+    std::atomic<uint64_t>                                       bytes_deduplicated_{ 0 };
+    std::atomic<uint64_t>                                       packs_received_{ 0 };
+};
+
+#endif // LUSP_LOOPBACK_CHUNK_RECEIVER_H
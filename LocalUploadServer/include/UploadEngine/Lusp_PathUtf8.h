@@ -0,0 +1,34 @@
+#ifndef LUSP_PATH_UTF8_H
+#define LUSP_PATH_UTF8_H
+
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief path 转为 UTF-8 的 std::string
+ *
+ * C++20(char8_t)起 path::u8string() 返回 std::u8string，不能再当作 std::string 使用；
+ * 所有 UTF-8 路径都经这里转换，C++17 与 C++20(LUSP_IPC_COROUTINES)下都能编译。
+ */
+inline std::string path_to_utf8(const std::filesystem::path& path) {
+#if defined(__cpp_char8_t)
+    const std::u8string text = path.u8string();
+    return std::string(text.begin(), text.end());
+#else
+    return path.u8string();
+#endif
+}
+
+/**
+ * @brief 同 path_to_utf8，分隔符统一为 '/'
+ */
+inline std::string generic_path_to_utf8(const std::filesystem::path& path) {
+#if defined(__cpp_char8_t)
+    const std::u8string text = path.generic_u8string();
+    return std::string(text.begin(), text.end());
+#else
+    return path.generic_u8string();
+#endif
+}
+
+#endif // LUSP_PATH_UTF8_H
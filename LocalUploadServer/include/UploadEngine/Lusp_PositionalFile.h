@@ -0,0 +1,81 @@
+#ifndef LUSP_POSITIONAL_FILE_H
+#define LUSP_POSITIONAL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 按偏移读写的文件句柄(POSIX pread/pwrite，Windows ReadFile/WriteFile + OVERLAPPED 偏移)
+ *
+ * 不维护文件指针，多个线程可以同时读写同一句柄的不同区间。
+ */
+class Lusp_PositionalFile {
+public:
+    Lusp_PositionalFile() = default;
+    ~Lusp_PositionalFile();
+
+    Lusp_PositionalFile(const Lusp_PositionalFile&) = delete;
+    Lusp_PositionalFile& operator=(const Lusp_PositionalFile&) = delete;
+
+    /**
+     * @brief 只读打开
+     * @param path UTF-8 路径
+     */
+    bool open_read(const std::string& path);
+
+    /**
+     * @brief 读写打开(不存在则创建，不截断)
+     */
+    bool open_write(const std::string& path);
+
+    void close();
+    bool is_open() const;
+
+    /**
+     * @brief 文件大小，失败返回 false
+     */
+    bool size(uint64_t& out) const;
+
+    /**
+     * @brief 从 offset 处读满 length 字节(遇到 EOF 视为失败)
+     */
+    bool read_at(void* buffer, size_t length, uint64_t offset) const;
+
+    /**
+     * @brief 在 offset 处写入 length 字节
+     */
+    bool write_at(const void* buffer, size_t length, uint64_t offset) const;
+
+    /**
+     * @brief 预分配/设置文件长度
+     */
+    bool truncate(uint64_t length) const;
+
+    /**
+     * @brief 为 [0, length) 预留磁盘空间并把文件长度设为 length(Linux fallocate，Windows FileAllocationInfo)
+     *
+     * 文件系统不支持预分配时退化为 truncate。
+     */
+    bool preallocate(uint64_t length) const;
+
+    /**
+     * @brief 把已写入的数据刷到磁盘(fdatasync / FlushFileBuffers)
+     */
+    bool sync() const;
+
+    /**
+     * @brief 最近一次失败的系统错误码
+     */
+    int last_error() const { return last_error_; }
+
+private:
+#ifdef _WIN32
+    void*       handle_ = nullptr;
+#else
+    int         fd_ = -1;
+#endif
+    mutable int last_error_ = 0;
+};
+
+#endif // LUSP_POSITIONAL_FILE_H
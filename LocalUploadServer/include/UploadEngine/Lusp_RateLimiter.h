@@ -0,0 +1,121 @@
+#ifndef LUSP_RATE_LIMITER_H
+#define LUSP_RATE_LIMITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 三级限速值(bytes/s，0=不限速)
+ */
+struct Lusp_RateLimits {
+    uint64_t    global_speed    = 0;    // 本服务所有上传合计
+    uint64_t    device_speed    = 0;    // 单个局域网客户端设备(s_lan_client_device)
+    uint64_t    file_speed      = 0;    // 单个文件
+};
+
+/**
+ * @brief 限速时段：本地时间落在时段内时用 limits 代替默认限速
+ */
+struct Lusp_RateWindow {
+    uint8_t         weekdays        = 0x7F;     // 生效的星期，bit0=周日 ... bit6=周六
+    uint16_t        begin_minute    = 0;        // 当日起始分钟 [0, 1440)
+    uint16_t        end_minute      = 1440;     // 当日结束分钟(不含)，小于 begin_minute 时跨午夜
+    Lusp_RateLimits limits;
+};
+
+/**
+ * @brief 无锁令牌桶(GCRA / 虚拟时钟实现)
+ *
+ * 桶状态只有一个原子时间戳 tat(理论到达时间)：预约 n 字节即把 tat 推后 n / rate，
+ * 一次 CAS 完成，不需要后台补充线程。tat 最多落后当前时间 burst，空闲期间积累的额度不超过 burst * rate。
+ * 预约总是成功(允许透支)，返回调用方需要等待的时长，因此一个分块无论多大都只需一次预约。
+ */
+class Lusp_TokenBucket {
+public:
+    /**
+     * @return 需要等待的纳秒数，0 表示可以立即发送
+     */
+    int64_t reserve(uint64_t bytes, uint64_t rate, int64_t burst_ns, int64_t now_ns);
+
+private:
+    std::atomic<int64_t>    tat_ns_{ 0 };
+};
+
+/**
+ * @brief 分级限速器(全局 -> 客户端设备 -> 文件)
+ *
+ * 每个分块发送前调用一次 acquire，依次在三级桶上预约整块字节数，等待时间取三者最大值。
+ * 热路径只有原子操作；设备桶在文件打开时按设备名取得(加锁)，此后由文件持有。
+ * 当前限速值每秒按时段表刷新一次(由第一个发现过期的线程 CAS 抢到刷新权)。
+ */
+class Lusp_RateLimiter {
+public:
+    /**
+     * @param defaults 不在任何时段内时的限速
+     * @param schedule 时段表，按顺序取第一个命中的时段
+     * @param burst_ms 每级桶允许的突发时长
+     */
+    Lusp_RateLimiter(const Lusp_RateLimits& defaults, const std::vector<Lusp_RateWindow>& schedule, uint32_t burst_ms);
+
+    Lusp_RateLimiter(const Lusp_RateLimiter&) = delete;
+    Lusp_RateLimiter& operator=(const Lusp_RateLimiter&) = delete;
+
+    /**
+     * @brief 默认限速与所有时段都不限速时返回 false，调用方可跳过限速器
+     */
+    bool enabled() const { return enabled_; }
+
+    /**
+     * @brief 取得设备桶(同名设备共享)
+     */
+    std::shared_ptr<Lusp_TokenBucket> device_bucket(const std::string& device);
+
+    /**
+     * @brief 为一个分块预约令牌
+     * @param device 设备桶，可为空
+     * @param file 文件桶
+     * @return 发送前需要等待的时长
+     */
+    std::chrono::nanoseconds acquire(uint64_t bytes, Lusp_TokenBucket* device, Lusp_TokenBucket& file);
+
+    /**
+     * @brief 当前生效的限速值
+     */
+    Lusp_RateLimits current_limits();
+
+    uint64_t throttled_chunks() const { return throttled_chunks_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 按本地时间在时段表中查找限速值(供测试与日志使用)
+     */
+    static Lusp_RateLimits limits_at(const Lusp_RateLimits& defaults, const std::vector<Lusp_RateWindow>& schedule,
+        int weekday, int minute_of_day);
+
+private:
+    void refresh(int64_t now_ns);
+
+    static constexpr int64_t    kRefreshIntervalNs = 1000000000;
+
+    Lusp_RateLimits                                                     defaults_;
+    std::vector<Lusp_RateWindow>                                        schedule_;
+    int64_t                                                             burst_ns_;
+    bool                                                                enabled_;
+
+    std::atomic<uint64_t>                                               global_speed_{ 0 };
+    std::atomic<uint64_t>                                               device_speed_{ 0 };
+    std::atomic<uint64_t>                                               file_speed_{ 0 };
+    std::atomic<int64_t>                                                next_refresh_ns_{ 0 };
+    std::atomic<uint64_t>                                               throttled_chunks_{ 0 };
+    Lusp_TokenBucket                                                    global_;
+
+    std::mutex                                                          devices_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Lusp_TokenBucket>>  devices_;
+};
+
+#endif // LUSP_RATE_LIMITER_H
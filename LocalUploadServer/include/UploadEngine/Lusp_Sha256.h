@@ -0,0 +1,25 @@
+#ifndef LUSP_SHA256_H
+#define LUSP_SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 一次性 SHA-256(内容定义分块的指纹)
+ *
+ * x86 CPU 支持 SHA 扩展(SHA-NI)时走硬件指令，否则退回 hash-library 的软件实现；
+ * 两条路径输出一致，运行时检测一次。
+ */
+namespace Lusp_Sha256 {
+
+    constexpr size_t kDigestSize = 32;
+
+    void digest(const void* data, size_t size, uint8_t out[kDigestSize]);
+
+    /**
+     * @brief 当前 CPU 是否走 SHA-NI 路径
+     */
+    bool accelerated();
+}
+
+#endif // LUSP_SHA256_H
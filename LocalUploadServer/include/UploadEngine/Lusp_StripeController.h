@@ -0,0 +1,65 @@
+#ifndef LUSP_STRIPE_CONTROLLER_H
+#define LUSP_STRIPE_CONTROLLER_H
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief 单个文件的条带数控制(每个文件一个，调用方加锁)
+ *
+ * 同一文件的分块经多条连接并行发送，每条连接是一个条带；单条 TCP 流受拥塞窗口与 RTT 限制，
+ * 条带数决定单个大文件能用到的带宽。控制器按确认的分块逐窗口测量文件的总吞吐，爬山式调整条带数：
+ *
+ * - 试探: 条带数受限(有空闲连接却因条带上限取不到块)的窗口结束后，条带数 +1
+ * - 判定: 新增的条带至少带来平均单条带吞吐的 kMinGain 倍才保留，继续试探；否则退回并保持
+ *   (单流吞吐不随条带数下降说明瓶颈在单流窗口/RTT，下降则说明链路或接收端已饱和)
+ * - 保持 kProbeInterval 个窗口后重新试探，跟随链路变化
+ *
+ * 条带数改变后先丢弃一轮在途分块的确认，再开始下一个测量窗口。
+ */
+class Lusp_StripeController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Lusp_StripeController(uint32_t initial = 1, uint32_t max = 1);
+
+    uint32_t stripes() const { return stripes_; }
+
+    /**
+     * @brief 有空闲连接却因条带上限没有给本文件分派分块
+     */
+    void mark_limited() { limited_ = true; }
+
+    enum class Decision { None, Increased, Decreased };
+
+    /**
+     * @brief 记录一个确认的分块
+     */
+    Decision on_chunk_acked(uint64_t bytes, Clock::time_point now);
+
+    /**
+     * @brief 最近一个完整窗口的吞吐(bytes/s)，尚无样本时为 0
+     */
+    double last_rate() const { return last_rate_; }
+
+private:
+    static constexpr double     kMinGain = 0.5;
+    static constexpr uint32_t   kMinWindowChunks = 4;
+    static constexpr uint32_t   kProbeInterval = 8;
+
+    void restart_window(Clock::time_point now);
+
+    uint32_t            stripes_;
+    uint32_t            max_;
+    bool                probing_ = false;       // 当前窗口在评估刚增加的条带
+    bool                limited_ = false;       // 当前窗口内曾因条带上限而少分派分块
+    uint32_t            warmup_ = 0;            // 条带数改变后还需丢弃的确认数
+    uint32_t            hold_windows_ = 0;      // 试探失败退回后，再保持多少个窗口才重新试探
+    uint32_t            window_chunks_ = 0;
+    uint64_t            window_bytes_ = 0;
+    Clock::time_point   window_start_{};
+    double              base_rate_ = 0;         // 试探前(stripes_ - 1 条带)的吞吐
+    double              last_rate_ = 0;
+};
+
+#endif // LUSP_STRIPE_CONTROLLER_H
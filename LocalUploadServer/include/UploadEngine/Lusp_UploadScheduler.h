@@ -0,0 +1,259 @@
+#ifndef LUSP_UPLOAD_SCHEDULER_H
+#define LUSP_UPLOAD_SCHEDULER_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief 上传通道：按提交时的文件大小划分，两个通道按权重分享上传连接
+ */
+enum class Lusp_UploadLane : uint8_t {
+    Small = 0,
+    Large,
+};
+
+constexpr size_t kUploadLaneCount = 2;
+
+inline const char* upload_lane_name(Lusp_UploadLane lane) {
+    return lane == Lusp_UploadLane::Small ? "SMALL" : "LARGE";
+}
+
+/**
+ * @brief 通道间按权重分享上传连接的占用时长(不加锁，由调用方保护)
+ *
+ * 每个通道一个虚拟时钟，分派任务时先按该通道任务的平均耗时 / 权重预记，任务结束后按实际占用时长修正；
+ * 总是先问时钟落后的通道。一个 1MB 分块占用连接的时间是一个小文件 FILE_BEGIN 的许多倍，
+ * 按时长而不是按任务数记账，小文件通道才真正分到其权重对应的连接份额。
+ * 没有任务的通道被越过时把它的时钟拉齐到被服务的通道，空闲期间不积攒份额。
+ */
+class Lusp_LaneShare {
+public:
+    Lusp_LaneShare() {
+        weights_.fill(1);
+        estimate_ns_.fill(kInitialEstimateNs);
+    }
+
+    void set_weight(Lusp_UploadLane lane, uint32_t weight) {
+        weights_[static_cast<size_t>(lane)] = std::max<uint32_t>(weight, 1);
+    }
+
+    /**
+     * @brief 应先尝试的通道
+     */
+    Lusp_UploadLane first() const {
+        return clock_[0] <= clock_[1] ? Lusp_UploadLane::Small : Lusp_UploadLane::Large;
+    }
+
+    /**
+     * @brief 从 lane 分派了一个任务(skipped 为先被尝试、但没有任务的通道)
+     * @return 预记的占用时长，任务结束时交回 finish
+     */
+    std::chrono::nanoseconds dispatch(Lusp_UploadLane lane, Lusp_UploadLane skipped) {
+        const size_t index = static_cast<size_t>(lane);
+        clock_[index] += estimate_ns_[index] / weights_[index];
+        if (skipped != lane) {
+            const size_t idle = static_cast<size_t>(skipped);
+            clock_[idle] = std::max(clock_[idle], clock_[index]);
+        }
+        return std::chrono::nanoseconds(static_cast<int64_t>(estimate_ns_[index]));
+    }
+
+    /**
+     * @brief 任务结束：按实际占用时长修正时钟与该通道的平均耗时
+     */
+    void finish(Lusp_UploadLane lane, std::chrono::nanoseconds charged, std::chrono::steady_clock::duration elapsed) {
+        const size_t index = static_cast<size_t>(lane);
+        const double actual = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        clock_[index] += (actual - static_cast<double>(charged.count())) / weights_[index];
+        estimate_ns_[index] += (actual - estimate_ns_[index]) / 8;
+    }
+
+private:
+    static constexpr double kInitialEstimateNs = 1e6;
+
+    std::array<uint32_t, kUploadLaneCount>  weights_;
+    std::array<double, kUploadLaneCount>    estimate_ns_;   // 该通道任务占用连接的平均时长
+    std::array<double, kUploadLaneCount>    clock_{};       // 占用时长 / 权重 的累计
+};
+
+/**
+ * @brief 排队时长直方图(对数分桶，桶 i 统计 [2^(i-1), 2^i) ms，桶 0 为不足 1ms，最后一个桶不设上限)
+ */
+struct Lusp_WaitHistogram {
+    static constexpr size_t kBucketCount = 24;     // 最后一个有上限的桶约 2.3 小时
+
+    std::array<uint64_t, kBucketCount> buckets{};
+    uint64_t    count       = 0;
+    uint64_t    total_ms    = 0;
+    uint64_t    max_ms      = 0;
+
+    void record(std::chrono::steady_clock::duration wait) {
+        const uint64_t ms = static_cast<uint64_t>(std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(wait).count(), 0));
+        size_t bucket = 0;
+        while (bucket + 1 < kBucketCount && ms >= (uint64_t(1) << bucket)) {
+            ++bucket;
+        }
+        ++buckets[bucket];
+        ++count;
+        total_ms += ms;
+        max_ms = std::max(max_ms, ms);
+    }
+
+    /**
+     * @brief 分位数估计(ms)：在所在桶内按线性插值，不超过 max_ms
+     * @param quantile (0, 1]
+     */
+    uint64_t quantile_ms(double quantile) const {
+        if (count == 0) {
+            return 0;
+        }
+        const uint64_t rank = std::clamp<uint64_t>(static_cast<uint64_t>(quantile * count + 0.5), 1, count);
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket + 1 < kBucketCount; ++bucket) {
+            if (seen + buckets[bucket] >= rank) {
+                const uint64_t lower = bucket == 0 ? 0 : uint64_t(1) << (bucket - 1);
+                const uint64_t upper = std::min(uint64_t(1) << bucket, max_ms + 1);
+                return std::min(lower + (upper - lower) * (rank - seen) / buckets[bucket], max_ms);
+            }
+            seen += buckets[bucket];
+        }
+        return max_ms;
+    }
+};
+
+/**
+ * @brief 按客户端分流的差额轮转(DRR)队列(不加锁，由调用方保护)
+ *
+ * 每个 key(局域网客户端设备)一个子队列，活动子队列排成环。轮到某个子队列时其差额加一个 quantum，
+ * 差额足以支付队首项的代价(字节数)就出队并扣除，不足则轮到下一个；子队列变空时差额清零。
+ * 提交大量或大文件的客户端因此不会让其他客户端的文件一直排在后面。
+ * 所有子队列都差得很远(大文件)时一次补足若干轮，不空转。
+ *
+ * 子队列内默认按提交顺序；shortest_first 时按代价从小到大(代价相同按提交顺序)。
+ */
+template <typename T>
+class Lusp_FairQueue {
+public:
+    explicit Lusp_FairQueue(uint64_t quantum = 1024 * 1024, bool shortest_first = false)
+        : quantum_(std::max<uint64_t>(quantum, 1)), shortest_first_(shortest_first) {}
+
+    void push(const std::string& key, uint64_t cost, T value) {
+        auto result = flows_.try_emplace(key);
+        Flow& flow = result.first->second;
+        if (flow.items.empty()) {
+            ring_.push_back(key);
+        }
+        flow.items.emplace(std::make_pair(shortest_first_ ? cost : 0, sequence_++), Item{ std::move(value), cost });
+        ++size_;
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    /**
+     * @brief 按 DRR 选出下一项(可能推进轮转)，队列为空时返回 nullptr；选中的项由紧接着的 pop 取出
+     */
+    T* front() {
+        if (ring_.empty()) {
+            return nullptr;
+        }
+        for (size_t visited = 0; ; ++visited) {
+            if (visited == ring_.size()) {
+                fast_forward();
+                visited = 0;
+            }
+            Flow& flow = flows_.find(ring_.front())->second;
+            if (!flow.in_turn) {
+                flow.deficit += quantum_;
+                flow.in_turn = true;
+            }
+            Item& head = flow.items.begin()->second;
+            if (flow.deficit >= head.cost) {
+                return &head.value;
+            }
+            // 本轮配额用完，排到环尾
+            flow.in_turn = false;
+            ring_.push_back(std::move(ring_.front()));
+            ring_.pop_front();
+        }
+    }
+
+    /**
+     * @brief 取出 front() 选中的项(调用前必须先调用 front 且队列非空)
+     */
+    T pop() {
+        auto it = flows_.find(ring_.front());
+        Flow& flow = it->second;
+        auto head = flow.items.begin();
+        T value = std::move(head->second.value);
+        flow.deficit -= head->second.cost;
+        flow.items.erase(head);
+        --size_;
+        if (flow.items.empty()) {
+            flows_.erase(it);
+            ring_.pop_front();
+        }
+        return value;
+    }
+
+    /**
+     * @brief 取出全部项(不分先后)
+     */
+    template <typename F>
+    void drain(F&& consume) {
+        for (auto& entry : flows_) {
+            for (auto& item : entry.second.items) {
+                consume(std::move(item.second.value));
+            }
+        }
+        flows_.clear();
+        ring_.clear();
+        size_ = 0;
+    }
+
+private:
+    struct Item {
+        T           value;
+        uint64_t    cost = 0;
+    };
+
+    struct Flow {
+        std::map<std::pair<uint64_t, uint64_t>, Item>  items;      // (代价或 0, 提交序号) -> 项
+        uint64_t                                        deficit = 0;
+        bool                                            in_turn = false;
+    };
+
+    /**
+     * @brief 整整一轮都没有子队列能出队：给每个子队列补上最快者还差的轮数(少一轮，留给正常轮转)
+     */
+    void fast_forward() {
+        uint64_t rounds = UINT64_MAX;
+        for (const auto& key : ring_) {
+            const Flow& flow = flows_.find(key)->second;
+            const uint64_t missing = flow.items.begin()->second.cost - flow.deficit;
+            rounds = std::min(rounds, (missing + quantum_ - 1) / quantum_);
+        }
+        if (rounds > 1) {
+            for (const auto& key : ring_) {
+                flows_.find(key)->second.deficit += (rounds - 1) * quantum_;
+            }
+        }
+    }
+
+    uint64_t                                quantum_;
+    bool                                    shortest_first_;
+    uint64_t                                sequence_ = 0;
+    size_t                                  size_ = 0;
+    std::unordered_map<std::string, Flow>   flows_;
+    std::deque<std::string>                 ring_;      // 有待出队项的 key，队首为当前轮到的
+};
+
+#endif // LUSP_UPLOAD_SCHEDULER_H
@@ -0,0 +1,316 @@
+#ifndef LUSP_WORK_STEALING_POOL_H
+#define LUSP_WORK_STEALING_POOL_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "asio/execution.hpp"
+#include "asio/execution_context.hpp"
+
+/**
+ * @brief 线程池任务的优先级：工作线程总是先做完能拿到的高优先级任务(本地、注入队列、窃取)再看下一级
+ */
+enum class Lusp_TaskPriority : uint8_t {
+    High = 0,       // 有线程在等结果的任务(分块压缩/校验、I/O 完成后的后续处理)
+    Normal,         // 一般的 CPU 任务(CDC 指纹)
+    Background,     // 可以推迟的批量任务
+};
+
+constexpr size_t kTaskPriorityCount = 3;
+
+/**
+ * @brief 线程池任务(类型擦除，可只移动)
+ */
+class Lusp_PoolTask {
+public:
+    virtual ~Lusp_PoolTask() = default;
+    virtual void run() = 0;
+};
+
+/**
+ * @brief Chase-Lev 工作窃取双端队列(Lê 等 2013 年的弱内存序版本)
+ *
+ * 只有所属的工作线程在底部 push/pop(后进先出，缓存友好)，其他线程从顶部 steal(先进先出)；
+ * 三者都无锁，owner 与 thief 只在队列剩最后一项时竞争一次 CAS。
+ * 容量按 2 的幂增长，旧数组保留到析构(窃取者可能仍在读)，不会回收中途的数组。
+ */
+class Lusp_WorkStealingDeque {
+public:
+    explicit Lusp_WorkStealingDeque(size_t capacity = 256);
+    ~Lusp_WorkStealingDeque();
+
+    Lusp_WorkStealingDeque(const Lusp_WorkStealingDeque&) = delete;
+    Lusp_WorkStealingDeque& operator=(const Lusp_WorkStealingDeque&) = delete;
+
+    void push(Lusp_PoolTask* task);     // 仅 owner
+    Lusp_PoolTask* pop();               // 仅 owner，空时返回 nullptr
+    Lusp_PoolTask* steal();             // 任意线程，空或竞争失败时返回 nullptr
+
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Ring {
+        explicit Ring(size_t capacity) : mask(capacity - 1), slots(new std::atomic<Lusp_PoolTask*>[capacity]) {}
+        size_t capacity() const { return mask + 1; }
+        Lusp_PoolTask* get(int64_t index) const { return slots[index & mask].load(std::memory_order_relaxed); }
+        void put(int64_t index, Lusp_PoolTask* task) { slots[index & mask].store(task, std::memory_order_relaxed); }
+
+        size_t                                      mask;
+        std::unique_ptr<std::atomic<Lusp_PoolTask*>[]> slots;
+    };
+
+    Ring* grow(Ring* ring, int64_t bottom, int64_t top);
+
+    // top_ 被所有窃取者争用，与 owner 独占的 bottom_ 分在不同缓存行
+    alignas(64) std::atomic<int64_t>    top_{ 0 };
+    alignas(64) std::atomic<int64_t>    bottom_{ 0 };
+    std::atomic<Ring*>                  ring_;
+    std::vector<std::unique_ptr<Ring>>  rings_;         // 当前与扩容前的数组，仅 owner 修改
+};
+
+/**
+ * @brief 线程池配置
+ */
+struct Lusp_WorkStealingPoolConfig {
+    uint32_t    thread_count    = 0;        // 0 = 硬件线程数
+    bool        pin_threads     = false;    // 第 i 个工作线程绑定到第 i 个逻辑 CPU(超出时取模)
+    uint32_t    spin_rounds     = 64;       // 找不到任务时先让出 CPU 重试的轮数，之后休眠
+};
+
+/**
+ * @brief 线程池统计
+ */
+struct Lusp_WorkStealingPoolStats {
+    uint32_t    threads     = 0;
+    uint64_t    executed    = 0;    // 已执行的任务数
+    uint64_t    stolen      = 0;    // 其中从其他工作线程窃取的
+    uint64_t    injected    = 0;    // 从池外线程提交(经注入队列)的
+    uint64_t    parked      = 0;    // 工作线程进入休眠的次数
+    std::array<uint64_t, kTaskPriorityCount> submitted{};  // 下标为 Lusp_TaskPriority
+};
+
+/**
+ * @brief 工作窃取线程池(进程内 CPU 密集阶段共用的执行器)
+ *
+ * - 每个工作线程每个优先级一个 Chase-Lev 双端队列；工作线程内提交的任务压入自己的队列底部，
+ *   空闲的工作线程从其他线程的队列顶部窃取，负载自动均衡而不需要全局锁
+ * - 池外线程(上传连接、asio 的 I/O 线程)提交的任务进入按优先级划分的注入队列(加锁)
+ * - 取任务顺序: 按优先级从高到低，每一级依次看 本地队列 -> 注入队列 -> 从其他线程窃取
+ * - 找不到任务时先自旋 spin_rounds 轮，再在条件变量上休眠；提交时仅在有线程休眠时才加锁唤醒
+ * - 继承 asio::execution_context，get_executor() 返回满足 asio 标准执行器要求的执行器：
+ *   可用于 asio::post / asio::bind_executor / asio::make_strand，I/O 完成处理器把后续的 CPU 工作投递到池上，
+ *   在工作线程上投递时直接进入本地队列，下一个就在同一线程上执行
+ *
+ * 任务不应长时间阻塞(网络收发仍由各自的连接线程完成)；等待池内任务的结果用 Lusp_TaskGroup。
+ * 任务抛出的异常在池内捕获并记录日志，不会终止工作线程；需要把异常交给等待方时用 Lusp_TaskGroup。
+ */
+class Lusp_WorkStealingPool : public asio::execution_context {
+public:
+    class executor_type;
+
+    explicit Lusp_WorkStealingPool(const Lusp_WorkStealingPoolConfig& config = Lusp_WorkStealingPoolConfig());
+    ~Lusp_WorkStealingPool();
+
+    Lusp_WorkStealingPool(const Lusp_WorkStealingPool&) = delete;
+    Lusp_WorkStealingPool& operator=(const Lusp_WorkStealingPool&) = delete;
+
+    /**
+     * @brief 提交任务(线程安全，不阻塞)；池已停止后提交的任务在提交线程上就地执行
+     * @details 池外线程的提交与 stop 在 inject_mutex_ 下互斥: 进入注入队列的任务一定会被工作线程或 stop 执行
+     */
+    template <typename F>
+    void submit(F&& function, Lusp_TaskPriority priority = Lusp_TaskPriority::Normal) {
+        push(new Task<std::decay_t<F>>(std::forward<F>(function)), priority);
+    }
+
+    /**
+     * @brief 在当前线程执行一个待处理任务(供等待中的工作线程帮忙)，没有可做的返回 false
+     */
+    bool run_one();
+
+    /**
+     * @brief 停止并等待工作线程退出，队列中剩余的任务在调用线程上执行完；析构时自动调用
+     */
+    void stop();
+
+    /**
+     * @brief 当前线程是否为本池的工作线程
+     */
+    bool in_worker_thread() const;
+
+    uint32_t thread_count() const { return static_cast<uint32_t>(workers_.size()); }
+    Lusp_WorkStealingPoolStats get_statistics() const;
+
+    executor_type get_executor() noexcept;
+
+private:
+    template <typename F>
+    class Task final : public Lusp_PoolTask {
+    public:
+        explicit Task(F function) : function_(std::move(function)) {}
+        void run() override { function_(); }
+    private:
+        F function_;
+    };
+
+    struct Worker {
+        std::array<Lusp_WorkStealingDeque, kTaskPriorityCount> deques;
+        std::atomic<uint64_t>   executed{ 0 };
+        std::atomic<uint64_t>   stolen{ 0 };
+        uint64_t                steal_seed = 0;
+    };
+
+    void push(Lusp_PoolTask* task, Lusp_TaskPriority priority);
+    static void run_task(Lusp_PoolTask* task);      // 执行并释放任务，捕获并记录任务抛出的异常
+    void worker_loop(size_t index);
+    Lusp_PoolTask* find_task(size_t index, bool& stolen);
+    Lusp_PoolTask* take_injected(size_t priority);
+    void pin_current_thread(size_t index) const;
+
+    Lusp_WorkStealingPoolConfig                 config_;
+    std::vector<std::unique_ptr<Worker>>        workers_;
+    std::vector<std::thread>                    threads_;
+    std::atomic<bool>                           running_{ true };
+
+    std::mutex                                  inject_mutex_;
+    std::array<std::deque<Lusp_PoolTask*>, kTaskPriorityCount> injected_;
+    std::atomic<size_t>                         injected_count_{ 0 };
+
+    // 休眠协议: 提交方先增加 pending_ 再读 sleepers_，休眠方先增加 sleepers_ 再读 pending_(均为 seq_cst)，
+    // 两边至少有一方看到对方，唤醒不会丢失
+    std::atomic<int64_t>                        pending_{ 0 };      // 已提交未取出的任务数
+    std::atomic<uint32_t>                       sleepers_{ 0 };
+    std::mutex                                  sleep_mutex_;
+    std::condition_variable                     sleep_cv_;
+
+    std::atomic<uint64_t>                       injected_total_{ 0 };
+    std::atomic<uint64_t>                       parked_{ 0 };
+    std::array<std::atomic<uint64_t>, kTaskPriorityCount> submitted_{};
+};
+
+/**
+ * @brief Lusp_WorkStealingPool 的 asio 执行器(轻量句柄，可拷贝)
+ *
+ * 总是排队执行(blocking.never)，优先级随执行器携带，默认 High(I/O 完成后的后续处理有人在等)。
+ */
+class Lusp_WorkStealingPool::executor_type {
+public:
+    executor_type(Lusp_WorkStealingPool& pool, Lusp_TaskPriority priority = Lusp_TaskPriority::High) noexcept
+        : pool_(&pool), priority_(priority) {}
+
+    /**
+     * @brief 同一线程池、不同优先级的执行器
+     */
+    executor_type with_priority(Lusp_TaskPriority priority) const noexcept { return executor_type(*pool_, priority); }
+    Lusp_TaskPriority priority() const noexcept { return priority_; }
+
+    template <typename F>
+    void execute(F&& function) const {
+        pool_->submit(std::forward<F>(function), priority_);
+    }
+
+    Lusp_WorkStealingPool& query(asio::execution::context_t) const noexcept { return *pool_; }
+
+    static constexpr asio::execution::blocking_t::never_t query(asio::execution::blocking_t) noexcept {
+        return asio::execution::blocking.never;
+    }
+
+    static constexpr asio::execution::relationship_t::fork_t query(asio::execution::relationship_t) noexcept {
+        return asio::execution::relationship.fork;
+    }
+
+    // 池本身一直运行到 stop，不单独跟踪未完成工作
+    static constexpr asio::execution::outstanding_work_t::untracked_t query(asio::execution::outstanding_work_t) noexcept {
+        return asio::execution::outstanding_work.untracked;
+    }
+
+    template <typename Allocator>
+    std::allocator<void> query(asio::execution::allocator_t<Allocator>) const noexcept { return std::allocator<void>(); }
+
+    friend bool operator==(const executor_type& a, const executor_type& b) noexcept {
+        return a.pool_ == b.pool_ && a.priority_ == b.priority_;
+    }
+    friend bool operator!=(const executor_type& a, const executor_type& b) noexcept { return !(a == b); }
+
+private:
+    Lusp_WorkStealingPool*  pool_;
+    Lusp_TaskPriority       priority_;
+};
+
+inline Lusp_WorkStealingPool::executor_type Lusp_WorkStealingPool::get_executor() noexcept {
+    return executor_type(*this);
+}
+
+/**
+ * @brief 一组提交到线程池的任务，wait 等到全部完成
+ *
+ * 在工作线程上 wait 时边等边执行池中的其他任务，嵌套的分叉/合并不会占死工作线程；
+ * 在池外线程上 wait 时阻塞。未配置线程池(pool 为空)时 run 就地执行。
+ * 任务抛出的异常由组捕获(计数照常减少)，wait 在全部完成后重新抛出第一个；析构时只等待，不抛出。
+ */
+class Lusp_TaskGroup {
+public:
+    explicit Lusp_TaskGroup(Lusp_WorkStealingPool* pool, Lusp_TaskPriority priority = Lusp_TaskPriority::Normal)
+        : pool_(pool), priority_(priority) {}
+    ~Lusp_TaskGroup() { join(); }
+
+    Lusp_TaskGroup(const Lusp_TaskGroup&) = delete;
+    Lusp_TaskGroup& operator=(const Lusp_TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F&& function) {
+        if (!pool_) {
+            function();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++pending_;
+        }
+        pool_->submit([this, function = std::forward<F>(function)]() mutable {
+            std::exception_ptr error;
+            try {
+                function();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            // 在锁内计数归零并通知，wait 返回(group 随之析构)前不会再访问成员
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error && !error_) {
+                error_ = error;
+            }
+            if (--pending_ == 0) {
+                done_cv_.notify_all();
+            }
+        }, priority_);
+    }
+
+    /**
+     * @brief 等待全部任务完成；有任务抛出异常时重新抛出第一个(之后清除)
+     */
+    void wait();
+
+private:
+    void join();
+
+    Lusp_WorkStealingPool*  pool_;
+    Lusp_TaskPriority       priority_;
+    std::mutex              mutex_;
+    std::condition_variable done_cv_;
+    size_t                  pending_ = 0;
+    std::exception_ptr      error_;         // 第一个抛出的异常
+};
+
+#endif // LUSP_WORK_STEALING_POOL_H
@@ -9,6 +9,36 @@
 
 using namespace UploadClient::Sync;
 
+namespace {
+    // 心跳帧以此 file_identifier 封装，数据帧(FBS_SyncUploadFileInfo)不带；
+    // 不能按 type() 区分: DOCUMENT 类型的文件信息当作心跳读出的 type 同样是 0(PING)。与客户端保持一致
+    constexpr char kHeartbeatIdentifier[] = "LHBT";
+    constexpr size_t kHeartbeatMinSize = sizeof(flatbuffers::uoffset_t) + flatbuffers::FlatBufferBuilder::kFileIdentifierLength;
+
+    // 过渡期兼容不带标识的旧版客户端心跳: FBS_HeartbeatMessage 只有 6 个字段，vtable 不超过 (2 + 6) 个 voffset_t；
+    // 数据帧总写出第 7 个字段之后的字符串(MD5、描述)，vtable 更长，按 type() 判断也不会误认
+    constexpr size_t kHeartbeatFieldCount = 6;
+    constexpr size_t kLegacyHeartbeatMaxVTable = (2 + kHeartbeatFieldCount) * sizeof(flatbuffers::voffset_t);
+
+    bool is_legacy_heartbeat_ping(const uint8_t* body, size_t size) {
+        // 帧在接收缓冲区中的位置不一定按 FlatBuffer 要求对齐
+        flatbuffers::Verifier::Options verifier_options;
+        verifier_options.check_alignment = false;
+        flatbuffers::Verifier verifier(body, size, verifier_options);
+        if (!verifier.VerifyBuffer<FBS_HeartbeatMessage>(nullptr)) {
+            return false;
+        }
+        const uint8_t* vtable = flatbuffers::GetRoot<flatbuffers::Table>(body)->GetVTable();
+        return flatbuffers::ReadScalar<flatbuffers::voffset_t>(vtable) <= kLegacyHeartbeatMaxVTable &&
+            flatbuffers::GetRoot<FBS_HeartbeatMessage>(body)->type() == FBS_HeartbeatType_FBS_HEARTBEAT_PING;
+    }
+
+#ifdef LUSP_IPC_COROUTINES
+    // 以 (error_code, ...) 元组返回结果，断开等错误不走异常
+    constexpr auto use_awaitable_tuple = asio::as_tuple(asio::use_awaitable);
+#endif
+}
+
 // ---- Server ----
 Lusp_AsioLoopbackIpcServer::Lusp_AsioLoopbackIpcServer(asio::io_context& io_context, const Lusp_AsioIpcConfig& config)
     : io_context_(io_context),
@@ -31,6 +61,9 @@ Lusp_AsioLoopbackIpcServer::~Lusp_AsioLoopbackIpcServer() {
 
 void Lusp_AsioLoopbackIpcServer::start(MessageCallback on_message) {
     on_message_ = on_message;
+#ifdef LUSP_IO_URING
+    register_read_buffers();
+#endif
     do_accept();
 
     // 启动心跳检测
@@ -60,70 +93,205 @@ void Lusp_AsioLoopbackIpcServer::do_accept() {
 
             // 初始化心跳信息
             state->heartbeat_info.last_heartbeat_time_ms = get_current_time_ms();
+#ifdef LUSP_IO_URING
+            state->read_slot = acquire_read_slot();
+#endif
 
             g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO,
                 "New client connected. Total clients: " + std::to_string(clients_.size()));
 
+#ifdef LUSP_IPC_COROUTINES
+            asio::co_spawn(io_context_, read_loop(socket, state), asio::detached);
+#else
             do_read(socket, state);
+#endif
         }
         do_accept();
         });
 }
 
 void Lusp_AsioLoopbackIpcServer::do_read(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<ConnState> state) {
-    auto temp_buffer = std::make_shared<std::vector<char>>(config_.buffer_size);
-    socket->async_read_some(asio::buffer(*temp_buffer), [this, socket, state, temp_buffer](std::error_code ec, std::size_t len) {
-        if (!ec && on_message_) {
-            // 追加到状态缓冲区
-            state->buffer.insert(state->buffer.end(), temp_buffer->begin(), temp_buffer->begin() + len);
-
-            // 拆包循环
-            while (state->buffer.size() >= 4) {
-                uint32_t msg_len = 0;
-                msg_len |= (uint8_t)state->buffer[0];
-                msg_len |= ((uint8_t)state->buffer[1] << 8);
-                msg_len |= ((uint8_t)state->buffer[2] << 16);
-                msg_len |= ((uint8_t)state->buffer[3] << 24);
-                if (state->buffer.size() < 4 + msg_len) break; // 数据不够
-
-                // 取出完整消息
-                std::string msg(state->buffer.begin() + 4, state->buffer.begin() + 4 + msg_len);
-
-                // 尝试解析为心跳消息
-                try {
-                    auto heartbeat_msg = flatbuffers::GetRoot<FBS_HeartbeatMessage>(
-                        reinterpret_cast<const uint8_t*>(msg.data()));
-
-                    if (heartbeat_msg && heartbeat_msg->type() == FBS_HeartbeatType_FBS_HEARTBEAT_PING) {
-                        // 处理心跳 PING
-                        handle_heartbeat_ping(msg, socket, state);
-                    }
-                    else {
-                        // 普通消息，调用回调
-                        on_message_(msg, socket);
-                    }
-                }
-                catch (...) {
-                    // 如果不是心跳消息，当作普通消息处理
-                    on_message_(msg, socket);
-                }
-
-                // 移除已处理
-                state->buffer.erase(state->buffer.begin(), state->buffer.begin() + 4 + msg_len);
-            }
-            do_read(socket, state);
+#ifdef LUSP_IO_URING
+    if (state->read_slot >= 0) {
+        // 读入注册缓冲区(IORING_OP_READ_FIXED)，每次读取不再分配临时缓冲区，内核也不必逐次映射用户页
+        const int slot = state->read_slot;
+        socket->async_read_some((*read_registration_)[slot], [this, socket, state, slot](std::error_code ec, std::size_t len) {
+            handle_read(socket, state, ec, static_cast<const char*>(read_slot_buffers_[slot].data()), len);
+            });
+        return;
+    }
+#endif
+    // 同一连接同时只有一个读操作，读缓冲区放在连接状态里复用
+    state->read_chunk.resize(config_.buffer_size);
+    socket->async_read_some(asio::buffer(state->read_chunk), [this, socket, state](std::error_code ec, std::size_t len) {
+        handle_read(socket, state, ec, state->read_chunk.data(), len);
+        });
+}
+
+void Lusp_AsioLoopbackIpcServer::handle_read(const std::shared_ptr<asio::ip::tcp::socket>& socket, const std::shared_ptr<ConnState>& state,
+    std::error_code ec, const char* data, std::size_t len) {
+    if (!ec && on_message_) {
+        // 追加到状态缓冲区
+        state->buffer.insert(state->buffer.end(), data, data + len);
+        dispatch_frames(socket, state);
+        do_read(socket, state);
+    }
+    else {
+#ifdef LUSP_IO_URING
+        release_read_slot(*state);
+#endif
+        remove_client(socket);
+    }
+}
+
+void Lusp_AsioLoopbackIpcServer::dispatch_frames(const std::shared_ptr<asio::ip::tcp::socket>& socket, const std::shared_ptr<ConnState>& state) {
+    auto& buffer = state->buffer;
+    size_t offset = 0;
+
+    // 拆包循环
+    while (buffer.size() - offset >= 4) {
+        const char* head = buffer.data() + offset;
+        uint32_t msg_len = 0;
+        msg_len |= (uint8_t)head[0];
+        msg_len |= ((uint8_t)head[1] << 8);
+        msg_len |= ((uint8_t)head[2] << 16);
+        msg_len |= ((uint8_t)head[3] << 24);
+        if (buffer.size() - offset < 4 + static_cast<size_t>(msg_len)) break; // 数据不够
+
+        const uint8_t* body = reinterpret_cast<const uint8_t*>(head + 4);
+        offset += 4 + static_cast<size_t>(msg_len);
+
+        // 按 file_identifier 识别心跳帧(PING 直接在缓冲区上处理，不拷贝成字符串)；不带标识的按旧版心跳再判断一次
+        if ((msg_len >= kHeartbeatMinSize && flatbuffers::BufferHasIdentifier(body, kHeartbeatIdentifier)) ||
+            is_legacy_heartbeat_ping(body, msg_len)) {
+            handle_heartbeat_ping(body, msg_len, socket, state);
         }
         else {
-            std::lock_guard<std::mutex> lock1(clients_mutex_);
-            std::lock_guard<std::mutex> lock2(states_mutex_);
-            clients_.erase(socket);
-            socket_states_.erase(socket);
+            // 普通消息，调用回调
+            on_message_(std::string(head + 4, head + 4 + msg_len), socket);
+        }
+    }
 
-            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO,
-                "Client disconnected. Remaining clients: " + std::to_string(clients_.size()));
+    if (offset > 0) {
+        // 任何完整帧都说明客户端存活(客户端在有数据收发时不发心跳)
+        state->heartbeat_info.last_heartbeat_time_ms = get_current_time_ms();
+
+        // 移除已处理(一批消息只搬移一次剩余的半包)
+        buffer.erase(buffer.begin(), buffer.begin() + offset);
+    }
+}
+
+void Lusp_AsioLoopbackIpcServer::remove_client(const std::shared_ptr<asio::ip::tcp::socket>& socket) {
+    std::lock_guard<std::mutex> lock1(clients_mutex_);
+    std::lock_guard<std::mutex> lock2(states_mutex_);
+    clients_.erase(socket);
+    socket_states_.erase(socket);
+
+    g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO,
+        "Client disconnected. Remaining clients: " + std::to_string(clients_.size()));
+}
+
+#ifdef LUSP_IPC_COROUTINES
+asio::awaitable<void> Lusp_AsioLoopbackIpcServer::read_loop(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<ConnState> state) {
+    // 协程帧只在连接建立时分配一次(asio 从线程本地缓存回收)，读缓冲区也跟随连接复用，
+    // 稳态下每次读取不再分配处理器和临时缓冲区
+    std::vector<char> chunk;
+    const char* data = nullptr;
+#ifdef LUSP_IO_URING
+    if (state->read_slot >= 0) {
+        data = static_cast<const char*>(read_slot_buffers_[state->read_slot].data());
+    }
+    else
+#endif
+    {
+        chunk.resize(config_.buffer_size);
+        data = chunk.data();
+    }
+    while (on_message_) {
+        std::error_code ec;
+        std::size_t len = 0;
+#ifdef LUSP_IO_URING
+        if (state->read_slot >= 0) {
+            std::tie(ec, len) = co_await socket->async_read_some((*read_registration_)[state->read_slot], use_awaitable_tuple);
         }
-        });
+        else
+#endif
+        {
+            std::tie(ec, len) = co_await socket->async_read_some(asio::buffer(chunk), use_awaitable_tuple);
+        }
+        if (ec) {
+            break;
+        }
+        state->buffer.insert(state->buffer.end(), data, data + len);
+        dispatch_frames(socket, state);
+
+        // 本批 PING 的 PONG 合并成一次写出；写完之前不再读，PONG 缓冲区不会被并发修改
+        if (!state->pong_frames.empty()) {
+            auto [write_ec, written] = co_await asio::async_write(*socket, asio::buffer(state->pong_frames), use_awaitable_tuple);
+            state->pong_frames.clear();
+            if (write_ec) {
+                g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR,
+                    "Failed to send PONG: " + write_ec.message());
+            }
+        }
+    }
+#ifdef LUSP_IO_URING
+    release_read_slot(*state);
+#endif
+    remove_client(socket);
+}
+#endif
+
+#ifdef LUSP_IO_URING
+void Lusp_AsioLoopbackIpcServer::register_read_buffers() {
+    if (read_registration_ || config_.registered_read_slots == 0) {
+        return;
+    }
+    read_slot_storage_.resize(config_.registered_read_slots * config_.buffer_size);
+    for (size_t i = 0; i < config_.registered_read_slots; ++i) {
+        read_slot_buffers_.push_back(asio::buffer(read_slot_storage_.data() + i * config_.buffer_size, config_.buffer_size));
+    }
+    try {
+        read_registration_ = std::make_unique<asio::buffer_registration<std::vector<asio::mutable_buffer>>>(
+            asio::register_buffers(io_context_, read_slot_buffers_));
+    }
+    catch (const std::exception& e) {
+        // 内核拒绝注册(如超出 RLIMIT_MEMLOCK)时所有连接使用普通缓冲区
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN,
+            "Failed to register io_uring read buffers, falling back to plain buffers: " + std::string(e.what()));
+        read_slot_buffers_.clear();
+        read_slot_storage_.clear();
+        read_slot_storage_.shrink_to_fit();
+        return;
+    }
+    for (int slot = static_cast<int>(config_.registered_read_slots) - 1; slot >= 0; --slot) {
+        free_read_slots_.push_back(slot);
+    }
+    g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO,
+        "Registered " + std::to_string(config_.registered_read_slots) + " io_uring read buffers of " +
+        std::to_string(config_.buffer_size) + " bytes");
+}
+
+int Lusp_AsioLoopbackIpcServer::acquire_read_slot() {
+    std::lock_guard<std::mutex> lock(read_slots_mutex_);
+    if (free_read_slots_.empty()) {
+        return -1;
+    }
+    const int slot = free_read_slots_.back();
+    free_read_slots_.pop_back();
+    return slot;
+}
+
+void Lusp_AsioLoopbackIpcServer::release_read_slot(ConnState& state) {
+    // 只在读循环结束(没有挂起的读)时归还；心跳超时断开只关闭 socket，随后的读错误走到这里
+    if (state.read_slot < 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(read_slots_mutex_);
+    free_read_slots_.push_back(state.read_slot);
+    state.read_slot = -1;
 }
+#endif
 
 void Lusp_AsioLoopbackIpcServer::broadcast(const std::string& message) {
     sender_->broadcast(message);
@@ -141,43 +309,63 @@ uint64_t Lusp_AsioLoopbackIpcServer::get_current_time_ms() const {
 }
 
 void Lusp_AsioLoopbackIpcServer::handle_heartbeat_ping(
-    const std::string& ping_data,
-    std::shared_ptr<asio::ip::tcp::socket> socket,
-    std::shared_ptr<ConnState> state) {
+    const uint8_t* ping_data,
+    size_t size,
+    const std::shared_ptr<asio::ip::tcp::socket>& socket,
+    const std::shared_ptr<ConnState>& state) {
 
     try {
-        auto ping_msg = flatbuffers::GetRoot<FBS_HeartbeatMessage>(
-            reinterpret_cast<const uint8_t*>(ping_data.data()));
-
-        if (!ping_msg) return;
+        // 帧在接收缓冲区中的位置不一定按 FlatBuffer 要求对齐
+        flatbuffers::Verifier::Options verifier_options;
+        verifier_options.check_alignment = false;
+        flatbuffers::Verifier verifier(ping_data, size, verifier_options);
+        const bool legacy = size < kHeartbeatMinSize || !flatbuffers::BufferHasIdentifier(ping_data, kHeartbeatIdentifier);
+        if (!verifier.VerifyBuffer<FBS_HeartbeatMessage>(legacy ? nullptr : kHeartbeatIdentifier)) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Malformed heartbeat PING, ignored");
+            return;
+        }
+        auto ping_msg = flatbuffers::GetRoot<FBS_HeartbeatMessage>(ping_data);
+        if (ping_msg->type() != FBS_HeartbeatType_FBS_HEARTBEAT_PING) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Unexpected heartbeat type from client, ignored");
+            return;
+        }
 
         // 更新心跳信息
-        state->heartbeat_info.last_heartbeat_time_ms = get_current_time_ms();
-        state->heartbeat_info.last_sequence = ping_msg->sequence();
-        state->heartbeat_info.heartbeat_count++;
-
-        if (ping_msg->client_name()) {
-            state->heartbeat_info.client_name = ping_msg->client_name()->str();
+        auto& info = state->heartbeat_info;
+        if (legacy && !info.legacy_heartbeat) {
+            info.legacy_heartbeat = true;
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Client sends heartbeats without file identifier (legacy protocol), please upgrade it");
+        }
+        info.last_heartbeat_time_ms = get_current_time_ms();
+        info.last_sequence = ping_msg->sequence();
+        info.heartbeat_count++;
+
+        // 名称/版本只在首次 PING 或变化时拷贝，清空模板后按新值重建
+        const auto* name = ping_msg->client_name();
+        if (name && info.client_name.compare(0, std::string::npos, name->c_str(), name->size()) != 0) {
+            info.client_name.assign(name->c_str(), name->size());
+            state->pong_frame.clear();
         }
-        if (ping_msg->client_version()) {
-            state->heartbeat_info.client_version = ping_msg->client_version()->str();
+        const auto* version = ping_msg->client_version();
+        if (version && info.client_version.compare(0, std::string::npos, version->c_str(), version->size()) != 0) {
+            info.client_version.assign(version->c_str(), version->size());
+            state->pong_frame.clear();
         }
+        if (state->pong_frame.empty()) {
+            encode_heartbeat_pong(info.client_name, info.client_version, state->pong_frame);
+        }
+        stamp_heartbeat_pong(state->pong_frame, ping_msg->sequence(), ping_msg->timestamp());
+        state->pong_frames.insert(state->pong_frames.end(), state->pong_frame.begin(), state->pong_frame.end());
 
         // 发送 PONG 响应
-        send_heartbeat_pong(
-            ping_msg->sequence(),
-            ping_msg->timestamp(),
-            state->heartbeat_info.client_name,
-            state->heartbeat_info.client_version,
-            socket
-        );
-
-        // 记录日志
-        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_DEBUG,
-            "[HEARTBEAT] Received PING #" + std::to_string(ping_msg->sequence()) +
-            " from " + state->heartbeat_info.client_name +
-            " (total: " + std::to_string(state->heartbeat_info.heartbeat_count) + ")");
-
+#ifdef LUSP_IPC_COROUTINES
+        // 由读循环在本批消息处理完后写出
+        (void)socket;
+#else
+        if (!state->pong_in_flight) {
+            send_heartbeat_pong(socket, state);
+        }
+#endif
     }
     catch (const std::exception& e) {
         g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR,
@@ -185,56 +373,67 @@ void Lusp_AsioLoopbackIpcServer::handle_heartbeat_ping(
     }
 }
 
+#ifndef LUSP_IPC_COROUTINES
 void Lusp_AsioLoopbackIpcServer::send_heartbeat_pong(
-    uint32_t sequence,
-    uint64_t timestamp,
+    const std::shared_ptr<asio::ip::tcp::socket>& socket,
+    const std::shared_ptr<ConnState>& state) {
+
+    // 交换后写 pong_writing，写完之前新的 PONG 继续追加到 pong_frames；
+    // 处理器只持有两个 shared_ptr，由 asio 的处理器内存缓存回收
+    state->pong_writing.clear();
+    state->pong_writing.swap(state->pong_frames);
+    state->pong_in_flight = true;
+    asio::async_write(*socket, asio::buffer(state->pong_writing),
+        [this, socket, state](std::error_code ec, std::size_t /*length*/) {
+            state->pong_in_flight = false;
+            if (ec) {
+                g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR,
+                    "Failed to send PONG #" + std::to_string(state->heartbeat_info.last_sequence) + ": " + ec.message());
+                return;
+            }
+            if (!state->pong_frames.empty()) {
+                send_heartbeat_pong(socket, state);
+            }
+        });
+}
+#endif
+
+void Lusp_AsioLoopbackIpcServer::encode_heartbeat_pong(
     const std::string& client_name,
     const std::string& client_version,
-    std::shared_ptr<asio::ip::tcp::socket> socket) {
+    std::vector<uint8_t>& frame) {
 
-    try {
-        flatbuffers::FlatBufferBuilder builder(256);
-
-        auto pong = CreateFBS_HeartbeatMessage(builder,
-            FBS_HeartbeatType_FBS_HEARTBEAT_PONG,
-            sequence,
-            timestamp,
-            builder.CreateString(client_name),
-            builder.CreateString(client_version),
-            builder.CreateString("")
-        );
-
-        builder.Finish(pong);
-
-        // 准备发送数据（4字节长度前缀 + FlatBuffer数据）
-        uint32_t msg_len = builder.GetSize();
-        std::vector<uint8_t> send_buffer(4 + msg_len);
-
-        send_buffer[0] = msg_len & 0xFF;
-        send_buffer[1] = (msg_len >> 8) & 0xFF;
-        send_buffer[2] = (msg_len >> 16) & 0xFF;
-        send_buffer[3] = (msg_len >> 24) & 0xFF;
-
-        memcpy(send_buffer.data() + 4, builder.GetBufferPointer(), msg_len);
-
-        // 异步发送
-        asio::async_write(*socket, asio::buffer(send_buffer),
-            [this, sequence](std::error_code ec, std::size_t /*length*/) {
-                if (!ec) {
-                    g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_DEBUG,
-                        "[HEARTBEAT] Sent PONG #" + std::to_string(sequence));
-                }
-                else {
-                    g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR,
-                        "Failed to send PONG #" + std::to_string(sequence) + ": " + ec.message());
-                }
-            });
+    flatbuffers::FlatBufferBuilder builder(256);
+    // 序列号/时间戳等于默认值 0 时默认不写出，模板必须带上这两个字段才能原地改写
+    builder.ForceDefaults(true);
 
-    }
-    catch (const std::exception& e) {
-        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR,
-            "Failed to send heartbeat PONG: " + std::string(e.what()));
-    }
+    auto pong = CreateFBS_HeartbeatMessage(builder,
+        FBS_HeartbeatType_FBS_HEARTBEAT_PONG,
+        0,
+        0,
+        builder.CreateString(client_name),
+        builder.CreateString(client_version),
+        builder.CreateString("")
+    );
+
+    builder.Finish(pong, kHeartbeatIdentifier);
+
+    // 4字节长度前缀 + FlatBuffer数据
+    uint32_t msg_len = builder.GetSize();
+    frame.resize(4 + msg_len);
+
+    frame[0] = msg_len & 0xFF;
+    frame[1] = (msg_len >> 8) & 0xFF;
+    frame[2] = (msg_len >> 16) & 0xFF;
+    frame[3] = (msg_len >> 24) & 0xFF;
+
+    memcpy(frame.data() + 4, builder.GetBufferPointer(), msg_len);
+}
+
+void Lusp_AsioLoopbackIpcServer::stamp_heartbeat_pong(std::vector<uint8_t>& frame, uint32_t sequence, uint64_t timestamp) {
+    auto pong = flatbuffers::GetMutableRoot<FBS_HeartbeatMessage>(frame.data() + 4);
+    pong->mutate_sequence(sequence);
+    pong->mutate_timestamp(timestamp);
 }
 
 void Lusp_AsioLoopbackIpcServer::start_heartbeat_checker() {
@@ -242,6 +441,9 @@ void Lusp_AsioLoopbackIpcServer::start_heartbeat_checker() {
         return;
     }
 
+#ifdef LUSP_IPC_COROUTINES
+    asio::co_spawn(io_context_, heartbeat_check_loop(), asio::detached);
+#else
     heartbeat_checker_timer_->expires_after(
         std::chrono::milliseconds(config_.heartbeat_check_interval_ms));
 
@@ -251,7 +453,23 @@ void Lusp_AsioLoopbackIpcServer::start_heartbeat_checker() {
             start_heartbeat_checker();  // 继续下一次检查
         }
         });
+#endif
+}
+
+#ifdef LUSP_IPC_COROUTINES
+asio::awaitable<void> Lusp_AsioLoopbackIpcServer::heartbeat_check_loop() {
+    // 重新启动检查时 expires_after 会取消上一个循环的等待，旧循环随之退出
+    auto timer = heartbeat_checker_timer_;
+    while (heartbeat_check_enabled_) {
+        timer->expires_after(std::chrono::milliseconds(config_.heartbeat_check_interval_ms));
+        auto [ec] = co_await timer->async_wait(use_awaitable_tuple);
+        if (ec || !heartbeat_check_enabled_) {
+            break;
+        }
+        check_clients_heartbeat();
+    }
 }
+#endif
 
 void Lusp_AsioLoopbackIpcServer::check_clients_heartbeat() {
     uint64_t current_time = get_current_time_ms();
@@ -261,6 +479,7 @@ void Lusp_AsioLoopbackIpcServer::check_clients_heartbeat() {
         std::lock_guard<std::mutex> lock(states_mutex_);
 
         for (const auto& [socket, state] : socket_states_) {
+            // 任何完整帧(含数据通道的保活 PING)都会刷新 last_heartbeat_time_ms，所有连接一律检查
             uint64_t elapsed = current_time - state->heartbeat_info.last_heartbeat_time_ms;
 
             if (elapsed > config_.heartbeat_timeout_ms) {
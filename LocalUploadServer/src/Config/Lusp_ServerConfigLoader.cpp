@@ -0,0 +1,282 @@
+#include "Config/Lusp_ServerConfigLoader.h"
+#include <cctype>
+#include <filesystem>
+#include <limits>
+#include <set>
+#include "toml.hpp"
+
+namespace {
+    // 与上传引擎内部的取值范围一致
+    constexpr uint64_t kMinChunkSize = 4 * 1024;
+    constexpr uint64_t kMaxChunkSize = 64 * 1024 * 1024;
+    constexpr uint64_t kMaxPackBytes = 32 * 1024 * 1024;
+    constexpr uint64_t kMaxPackFiles = 4096;
+    constexpr uint64_t kMaxSpeed = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+
+    const std::set<std::string> kUploadKeys = {
+        "remote_host", "remote_port", "chunk_size", "max_concurrent_uploads", "adaptive_concurrency",
+        "min_concurrent_uploads", "max_streams_per_file", "adaptive_streams", "max_active_files", "timeout_seconds",
+        "retry_count", "retry_delay_ms", "enable_checksum", "enable_resume", "journal_dir", "journal_flush_chunks",
+        "resume_min_chunks", "max_upload_speed", "max_device_upload_speed", "max_file_upload_speed", "rate_schedule",
+        "rate_burst_ms", "enable_compression", "compression_algorithm", "compression_max_entropy", "chunking_mode",
+        "cdc_average_chunk_size", "enable_packing", "pack_file_threshold", "pack_max_bytes", "pack_max_files",
+        "small_file_threshold", "small_lane_weight", "large_lane_weight", "shortest_remaining_first",
+        "fair_queue_quantum", "cpu_threads", "pin_cpu_threads",
+    };
+
+    const std::set<std::string> kRateWindowKeys = {
+        "weekdays", "begin", "end", "max_upload_speed", "max_device_upload_speed", "max_file_upload_speed",
+    };
+
+    /**
+     * @brief 按键读取并校验一张表中的值，出错时记下第一个错误
+     */
+    class TableReader {
+    public:
+        TableReader(const toml::value& table, const std::string& name, std::string& error)
+            : table_(table), name_(name), error_(error) {}
+
+        bool ok() const { return error_.empty(); }
+
+        void fail(const std::string& key, const std::string& reason) {
+            if (error_.empty()) {
+                error_ = "[" + name_ + "] " + key + ": " + reason;
+            }
+        }
+
+        bool check_keys(const std::set<std::string>& known) {
+            for (const auto& entry : table_.as_table()) {
+                if (known.count(entry.first) == 0) {
+                    fail(entry.first, "未知的配置项");
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<typename T>
+        void read_integer(const std::string& key, T& target, uint64_t min_value, uint64_t max_value) {
+            if (!ok() || !table_.contains(key)) {
+                return;
+            }
+            const auto& value = table_.at(key);
+            if (!value.is_integer()) {
+                fail(key, "应为整数");
+                return;
+            }
+            const int64_t number = value.as_integer();
+            if (number < 0 || static_cast<uint64_t>(number) < min_value || static_cast<uint64_t>(number) > max_value) {
+                fail(key, std::to_string(number) + " 超出范围 [" + std::to_string(min_value) + ", " + std::to_string(max_value) + "]");
+                return;
+            }
+            target = static_cast<T>(number);
+        }
+
+        void read_bool(const std::string& key, bool& target) {
+            if (!ok() || !table_.contains(key)) {
+                return;
+            }
+            const auto& value = table_.at(key);
+            if (!value.is_boolean()) {
+                fail(key, "应为 true/false");
+                return;
+            }
+            target = value.as_boolean();
+        }
+
+        void read_double(const std::string& key, double& target, double min_value, double max_value) {
+            if (!ok() || !table_.contains(key)) {
+                return;
+            }
+            const auto& value = table_.at(key);
+            if (!value.is_floating() && !value.is_integer()) {
+                fail(key, "应为数值");
+                return;
+            }
+            const double number = value.is_floating() ? value.as_floating() : static_cast<double>(value.as_integer());
+            if (!(number >= min_value && number <= max_value)) {
+                fail(key, std::to_string(number) + " 超出范围 [" + std::to_string(min_value) + ", " + std::to_string(max_value) + "]");
+                return;
+            }
+            target = number;
+        }
+
+        /**
+         * @param allowed 为空时只要求非空字符串
+         */
+        void read_string(const std::string& key, std::string& target, const std::set<std::string>& allowed = {}) {
+            if (!ok() || !table_.contains(key)) {
+                return;
+            }
+            const auto& value = table_.at(key);
+            if (!value.is_string() || value.as_string().empty()) {
+                fail(key, "应为非空字符串");
+                return;
+            }
+            const std::string& text = value.as_string();
+            if (!allowed.empty() && allowed.count(text) == 0) {
+                std::string names;
+                for (const auto& name : allowed) {
+                    names += (names.empty() ? "" : "/") + name;
+                }
+                fail(key, "\"" + text + "\" 不是 " + names + " 之一");
+                return;
+            }
+            target = text;
+        }
+
+        /**
+         * @brief "HH:MM" 转为当日分钟数，"24:00" 表示当日结束
+         */
+        void read_minute(const std::string& key, uint16_t& target) {
+            if (!ok() || !table_.contains(key)) {
+                return;
+            }
+            const auto& value = table_.at(key);
+            const std::string text = value.is_string() ? value.as_string() : std::string();
+            const bool shaped = text.size() == 5 && text[2] == ':' && std::isdigit(static_cast<unsigned char>(text[0])) &&
+                std::isdigit(static_cast<unsigned char>(text[1])) && std::isdigit(static_cast<unsigned char>(text[3])) &&
+                std::isdigit(static_cast<unsigned char>(text[4]));
+            const int hour = shaped ? (text[0] - '0') * 10 + (text[1] - '0') : 0;
+            const int minute = shaped ? (text[3] - '0') * 10 + (text[4] - '0') : 0;
+            if (!shaped || minute > 59 || hour * 60 + minute > 1440) {
+                fail(key, "应为 \"HH:MM\"(00:00 - 24:00)");
+                return;
+            }
+            target = static_cast<uint16_t>(hour * 60 + minute);
+        }
+
+    private:
+        const toml::value&  table_;
+        std::string         name_;
+        std::string&        error_;
+    };
+
+    void read_rate_schedule(const toml::value& upload, std::vector<Lusp_RateWindow>& schedule, std::string& error) {
+        if (!upload.contains("rate_schedule")) {
+            return;
+        }
+        const auto& windows = upload.at("rate_schedule");
+        if (!windows.is_array()) {
+            error = "[upload] rate_schedule: 应为 [[upload.rate_schedule]] 表数组";
+            return;
+        }
+        std::vector<Lusp_RateWindow> parsed;
+        for (size_t i = 0; i < windows.as_array().size(); ++i) {
+            const auto& table = windows.as_array()[i];
+            if (!table.is_table()) {
+                error = "[upload] rate_schedule: 第 " + std::to_string(i + 1) + " 项应为表";
+                return;
+            }
+            Lusp_RateWindow window;
+            TableReader reader(table, "upload.rate_schedule#" + std::to_string(i + 1), error);
+            if (!reader.check_keys(kRateWindowKeys)) {
+                return;
+            }
+            reader.read_integer("weekdays", window.weekdays, 1, 0x7F);
+            reader.read_minute("begin", window.begin_minute);
+            reader.read_minute("end", window.end_minute);
+            reader.read_integer("max_upload_speed", window.limits.global_speed, 0, kMaxSpeed);
+            reader.read_integer("max_device_upload_speed", window.limits.device_speed, 0, kMaxSpeed);
+            reader.read_integer("max_file_upload_speed", window.limits.file_speed, 0, kMaxSpeed);
+            if (reader.ok() && window.begin_minute == window.end_minute) {
+                reader.fail("end", "与 begin 相同，时段为空");
+            }
+            if (!reader.ok()) {
+                return;
+            }
+            parsed.push_back(window);
+        }
+        schedule = std::move(parsed);
+    }
+}
+
+bool load_upload_engine_config(const std::string& path, Lusp_UploadEngineConfig& config, std::string& error) {
+    error.clear();
+    toml::value data;
+    try {
+        data = toml::parse(std::filesystem::u8path(path));
+    }
+    catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+    if (!data.contains("upload")) {
+        return true;
+    }
+    const auto& upload = data.at("upload");
+    if (!upload.is_table()) {
+        error = "[upload] 应为表";
+        return false;
+    }
+
+    Lusp_UploadEngineConfig loaded = config;
+    TableReader reader(upload, "upload", error);
+    if (!reader.check_keys(kUploadKeys)) {
+        return false;
+    }
+    reader.read_string("remote_host", loaded.remote_host);
+    reader.read_integer("remote_port", loaded.remote_port, 1, 65535);
+    reader.read_integer("chunk_size", loaded.chunk_size, kMinChunkSize, kMaxChunkSize);
+    reader.read_integer("max_concurrent_uploads", loaded.max_concurrent_uploads, 1, 1024);
+    reader.read_bool("adaptive_concurrency", loaded.adaptive_concurrency);
+    reader.read_integer("min_concurrent_uploads", loaded.min_concurrent_uploads, 1, 1024);
+    reader.read_integer("max_streams_per_file", loaded.max_streams_per_file, 1, 1024);
+    reader.read_bool("adaptive_streams", loaded.adaptive_streams);
+    reader.read_integer("max_active_files", loaded.max_active_files, 0, 1u << 20);
+    reader.read_integer("timeout_seconds", loaded.timeout_seconds, 1, 3600);
+    reader.read_integer("retry_count", loaded.retry_count, 0, 1000);
+    reader.read_integer("retry_delay_ms", loaded.retry_delay_ms, 0, 3600 * 1000);
+    reader.read_bool("enable_checksum", loaded.enable_checksum);
+    reader.read_bool("enable_resume", loaded.enable_resume);
+    reader.read_string("journal_dir", loaded.journal_dir);
+    reader.read_integer("journal_flush_chunks", loaded.journal_flush_chunks, 1, 1u << 20);
+    reader.read_integer("resume_min_chunks", loaded.resume_min_chunks, 0, std::numeric_limits<uint32_t>::max());
+    reader.read_integer("max_upload_speed", loaded.max_upload_speed, 0, kMaxSpeed);
+    reader.read_integer("max_device_upload_speed", loaded.max_device_upload_speed, 0, kMaxSpeed);
+    reader.read_integer("max_file_upload_speed", loaded.max_file_upload_speed, 0, kMaxSpeed);
+    reader.read_integer("rate_burst_ms", loaded.rate_burst_ms, 1, 60 * 1000);
+    reader.read_bool("enable_compression", loaded.enable_compression);
+    reader.read_string("compression_algorithm", loaded.compression_algorithm, { "NONE", "LZ4" });
+    reader.read_double("compression_max_entropy", loaded.compression_max_entropy, 0.0, 8.0);
+    reader.read_string("chunking_mode", loaded.chunking_mode, { "FIXED", "CDC" });
+    reader.read_integer("cdc_average_chunk_size", loaded.cdc_average_chunk_size, kMinChunkSize, kMaxChunkSize);
+    reader.read_bool("enable_packing", loaded.enable_packing);
+    reader.read_integer("pack_file_threshold", loaded.pack_file_threshold, 0, kMaxPackBytes);
+    reader.read_integer("pack_max_bytes", loaded.pack_max_bytes, kMinChunkSize, kMaxPackBytes);
+    reader.read_integer("pack_max_files", loaded.pack_max_files, 1, kMaxPackFiles);
+    reader.read_integer("small_file_threshold", loaded.small_file_threshold, 0, std::numeric_limits<int64_t>::max());
+    reader.read_integer("small_lane_weight", loaded.small_lane_weight, 1, 1000);
+    reader.read_integer("large_lane_weight", loaded.large_lane_weight, 1, 1000);
+    reader.read_bool("shortest_remaining_first", loaded.shortest_remaining_first);
+    reader.read_integer("fair_queue_quantum", loaded.fair_queue_quantum, kMinChunkSize, std::numeric_limits<uint32_t>::max());
+    reader.read_integer("cpu_threads", loaded.cpu_threads, 0, 1024);
+    reader.read_bool("pin_cpu_threads", loaded.pin_cpu_threads);
+    if (!reader.ok()) {
+        return false;
+    }
+
+    // 项之间的约束
+    if (loaded.min_concurrent_uploads > loaded.max_concurrent_uploads) {
+        reader.fail("min_concurrent_uploads", "大于 max_concurrent_uploads");
+    }
+    else if (loaded.max_streams_per_file > loaded.max_concurrent_uploads) {
+        reader.fail("max_streams_per_file", "大于 max_concurrent_uploads");
+    }
+    else if (loaded.cdc_average_chunk_size > loaded.chunk_size) {
+        reader.fail("cdc_average_chunk_size", "大于 chunk_size");
+    }
+    else if (loaded.pack_file_threshold > loaded.pack_max_bytes) {
+        reader.fail("pack_file_threshold", "大于 pack_max_bytes");
+    }
+    if (!reader.ok()) {
+        return false;
+    }
+
+    read_rate_schedule(upload, loaded.rate_schedule, error);
+    if (!error.empty()) {
+        return false;
+    }
+    config = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,1509 @@
+#include "UploadEngine/Lusp_BackgroundUploader.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include "asio/asio.hpp"
+#include "UploadEngine/Lusp_ChunkJournal.h"
+#include "UploadEngine/Lusp_ChunkProtocol.h"
+#include "UploadEngine/Lusp_PathUtf8.h"
+#include "UploadEngine/Lusp_PositionalFile.h"
+#include "UploadEngine/Lusp_Sha256.h"
+#include "log_headers.h"
+#include "md5.h"
+
+using namespace Lusp_ChunkProtocol;
+
+namespace {
+    constexpr uint32_t kMinChunkSize = 4 * 1024;
+    constexpr uint32_t kMaxChunkSize = 64 * 1024 * 1024;
+    constexpr int kSocketBufferSize = 4 * 1024 * 1024;
+    constexpr uint32_t kMaxIncompressibleChunks = 4;   // 连续多少块压缩收益不足后，该文件不再尝试压缩
+    constexpr size_t kManifestScanWindow = 8 * 1024 * 1024;     // CDC 预扫描的读缓冲(至少 2 * chunk_size)
+    constexpr uint32_t kMaxPackBytes = 32 * 1024 * 1024;
+    constexpr uint32_t kMaxPackFiles = 4096;                    // 索引最多约 4096 * (18 + 4096) 字节
+
+    int64_t file_mtime(const std::string& path) {
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(std::filesystem::u8path(path), ec);
+        return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    // 续传日志按源文件路径命名(FNV-1a)，与每次提交都不同的文件ID无关
+    uint64_t path_hash(const std::string& path) {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (unsigned char c : path) {
+            hash = (hash ^ c) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    // 客户端分块哈希根是各分块 MD5 拼接后的 MD5(小写十六进制)
+    bool client_root_matches(const Lusp_UploadTask& task, std::array<uint8_t, 16>& root) {
+        if (task.chunk_hash_size == 0 || task.chunk_digests.size() % MD5::HashBytes != 0) {
+            return false;
+        }
+        MD5 md5;
+        md5.add(task.chunk_digests.data(), task.chunk_digests.size());
+        std::string expected = task.chunk_root_digest;
+        std::transform(expected.begin(), expected.end(), expected.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (md5.getHash() != expected) {
+            return false;
+        }
+        md5.getHash(root.data());
+        return true;
+    }
+}
+
+// ---- FileState ----
+// 除 handle 的读取与 bytes_done 外，所有字段都由 mutex_ 保护
+struct Lusp_BackgroundUploader::FileState {
+    Lusp_UploadTask         task;
+    uint64_t                transfer_id = 0;    // 帧里的文件ID: 通常即 task.file_id，沿用旧续传日志时为日志中的ID
+    Lusp_PositionalFile     handle;
+    uint64_t                file_size = 0;
+    uint32_t                chunk_size = 0;
+    uint32_t                chunk_count = 0;
+    std::vector<uint64_t>   chunk_offsets;      // CDC 各分块起始偏移(chunk_count + 1 个)；固定分块时为空
+    uint32_t                next_chunk = 0;     // 下一个待分派的块
+    uint32_t                inflight = 0;       // 正在处理的任务数(FILE_BEGIN 或分块)
+    uint32_t                acked = 0;          // 已确认的块数
+    bool                    opened = false;     // FILE_BEGIN 已确认
+    bool                    failed = false;
+    bool                    finishing = false;  // 已移出活动列表，即将完成
+    std::string             error;
+    std::atomic<uint64_t>   bytes_done{ 0 };
+
+    // 调度
+    Lusp_UploadLane         lane = Lusp_UploadLane::Small;
+    bool                    packable = false;   // 等待装入容器(不单独打开)
+    std::chrono::steady_clock::time_point submitted;
+
+    // 续传
+    std::unique_ptr<Lusp_ChunkJournal>  journal;
+    std::vector<uint64_t>   held;               // 接收端已持有、无需发送的分块
+    uint32_t                held_count = 0;
+    uint32_t                unflushed = 0;      // 日志中未刷盘的确认数
+
+    // 客户端分块校验(提交时哈希根核对通过才启用)
+    bool                    verify_client = false;
+    std::array<uint8_t, 16> client_root{};      // 客户端分块哈希根，记入续传日志
+
+    // 限速(令牌桶本身无锁)
+    Lusp_TokenBucket                    rate_bucket;
+    std::shared_ptr<Lusp_TokenBucket>   device_bucket;
+
+    // 条带数(同时在传的分块数上限)
+    Lusp_StripeController   stripes;
+
+    // 压缩: -1 未决定(首块做熵探测)，0 不压缩，1 压缩；多个分块并发发送，用原子量
+    std::atomic<int>        compress_mode{ -1 };
+    std::atomic<uint32_t>   incompressible{ 0 };    // 连续压缩收益不足的分块数
+
+    uint64_t chunk_offset(uint32_t chunk_index) const {
+        return chunk_offsets.empty() ? static_cast<uint64_t>(chunk_index) * chunk_size : chunk_offsets[chunk_index];
+    }
+
+    uint32_t chunk_length(uint32_t chunk_index) const {
+        const uint64_t end = chunk_offsets.empty() ? std::min<uint64_t>(chunk_offset(chunk_index) + chunk_size, file_size)
+            : chunk_offsets[chunk_index + 1];
+        return static_cast<uint32_t>(end - chunk_offset(chunk_index));
+    }
+
+    bool is_held(uint32_t chunk_index) const {
+        return !held.empty() && (held[chunk_index / 64] & (uint64_t(1) << (chunk_index % 64))) != 0;
+    }
+
+    /**
+     * @brief 用客户端入队时的分块 MD5 校验从 offset 起的 length 字节
+     * @details 校验起点落在本段内的客户端分块，跨出本段的部分从文件补读；起点在本段之前的分块由前一段校验。
+     *          客户端分块与 chunk_size 一致时不补读
+     */
+    bool verify_client_chunks(const uint8_t* data, uint64_t offset, size_t length, std::string& error) const {
+        if (!verify_client) {
+            return true;
+        }
+        const uint64_t size = task.chunk_hash_size;
+        if (task.chunk_digests.size() / MD5::HashBytes != (file_size + size - 1) / size) {
+            error = "文件在入队后已变化 (大小 " + std::to_string(file_size) + " 字节与客户端分块摘要不符)";
+            return false;
+        }
+        const uint64_t end = offset + length;
+        std::vector<uint8_t> rest;
+        for (uint64_t index = (offset + size - 1) / size; index * size < end; ++index) {
+            const uint64_t begin = index * size;
+            const uint64_t chunk_end = std::min(begin + size, file_size);
+            MD5 md5;
+            md5.add(data + (begin - offset), static_cast<size_t>(std::min(chunk_end, end) - begin));
+            if (chunk_end > end) {
+                rest.resize(static_cast<size_t>(chunk_end - end));
+                if (!handle.read_at(rest.data(), rest.size(), end)) {
+                    error = "读取文件失败 (偏移 " + std::to_string(end) + ", 错误码 " + std::to_string(handle.last_error()) + ")";
+                    return false;
+                }
+                md5.add(rest.data(), rest.size());
+            }
+            uint8_t digest[MD5::HashBytes];
+            md5.getHash(digest);
+            if (std::memcmp(digest, task.chunk_digests.data() + index * MD5::HashBytes, MD5::HashBytes) != 0) {
+                error = "文件在入队后已变化 (偏移 " + std::to_string(begin) + " 的分块与客户端摘要不符)";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 让 next_chunk 跳过已持有的分块
+     */
+    void skip_held() {
+        while (next_chunk < chunk_count && is_held(next_chunk)) {
+            ++next_chunk;
+        }
+    }
+};
+
+// ---- Connection ----
+/**
+ * @brief 工作线程独占的上传连接
+ *
+ * 使用异步操作 + run_for 实现超时(同步读写无法设置超时)；cancel 可在其他线程调用。
+ */
+class Lusp_BackgroundUploader::Connection {
+public:
+    explicit Connection(const Lusp_UploadEngineConfig& config)
+        : config_(config), socket_(io_), timeout_(std::chrono::seconds(config.timeout_seconds)) {}
+
+    /**
+     * @brief 发送一帧(帧头 + 可选数据)并等待 ACK
+     */
+    bool transact(const uint8_t* head, size_t head_size, const uint8_t* body, size_t body_size,
+        Ack& ack, std::vector<uint8_t>* resume_payload, std::string& error) {
+        if (!ensure_connected(error)) {
+            return false;
+        }
+        std::array<asio::const_buffer, 2> buffers{ asio::buffer(head, head_size), asio::buffer(body, body_size) };
+        asio::error_code result;
+        bool done = false;
+        extra_.clear();
+        const auto start = std::chrono::steady_clock::now();
+        asio::async_write(socket_, buffers, [this, &result, &done](const asio::error_code& ec, size_t) {
+            if (ec) {
+                result = ec;
+                done = true;
+                return;
+            }
+            asio::async_read(socket_, asio::buffer(reply_), [this, &result, &done](const asio::error_code& ec, size_t) {
+                FrameHeader header;
+                if (ec || !decode_header(reply_.data(), header) || header.type != FrameType::ResumeState ||
+                    header.payload_length <= kAckSize) {
+                    result = ec;
+                    done = true;
+                    return;
+                }
+                // RESUME 比 ACK 长，继续读剩余部分
+                extra_.resize(header.payload_length - kAckSize);
+                asio::async_read(socket_, asio::buffer(extra_), [&result, &done](const asio::error_code& ec, size_t) {
+                    result = ec;
+                    done = true;
+                    });
+                });
+            });
+        if (!run_until(done)) {
+            error = "等待确认超时";
+            return false;
+        }
+        if (result) {
+            error = "连接错误: " + result.message();
+            reset();
+            return false;
+        }
+        FrameHeader header;
+        const bool valid = decode_header(reply_.data(), header) &&
+            ((header.type == FrameType::Ack && header.payload_length == kAckSize) ||
+             (header.type == FrameType::ResumeState && header.payload_length >= kAckSize));
+        if (!valid) {
+            error = "收到非法确认帧";
+            reset();
+            return false;
+        }
+        decode_ack(reply_.data() + kHeaderSize, ack);
+        last_rtt_ = std::chrono::steady_clock::now() - start;
+        if (resume_payload) {
+            resume_payload->clear();
+            if (header.type == FrameType::ResumeState) {
+                resume_payload->assign(reply_.begin() + kHeaderSize, reply_.end());
+                resume_payload->insert(resume_payload->end(), extra_.begin(), extra_.end());
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 最近一次成功的请求从开始发送到收到确认的时长(含重连之外的全部传输)
+     */
+    std::chrono::steady_clock::duration last_rtt() const { return last_rtt_; }
+
+    void reset() {
+        asio::error_code ignored;
+        socket_.close(ignored);
+    }
+
+    /**
+     * @brief 中断当前操作并禁止重连(线程安全)
+     */
+    void cancel() {
+        cancelled_.store(true, std::memory_order_release);
+        asio::post(io_, [this]() { reset(); });
+    }
+
+private:
+    bool ensure_connected(std::string& error) {
+        if (cancelled_.load(std::memory_order_acquire)) {
+            error = "上传已停止";
+            return false;
+        }
+        if (socket_.is_open()) {
+            return true;
+        }
+        asio::error_code ec;
+        asio::ip::tcp::resolver resolver(io_);
+        auto endpoints = resolver.resolve(config_.remote_host, std::to_string(config_.remote_port), ec);
+        if (ec) {
+            error = "解析远端地址失败: " + ec.message();
+            return false;
+        }
+        asio::error_code result;
+        bool done = false;
+        asio::async_connect(socket_, endpoints, [&result, &done](const asio::error_code& connect_ec, const asio::ip::tcp::endpoint&) {
+            result = connect_ec;
+            done = true;
+            });
+        if (!run_until(done)) {
+            error = "连接远端超时";
+            return false;
+        }
+        if (result) {
+            error = "连接远端失败: " + result.message();
+            reset();
+            return false;
+        }
+        socket_.set_option(asio::ip::tcp::no_delay(true), ec);
+        socket_.set_option(asio::socket_base::send_buffer_size(kSocketBufferSize), ec);
+        socket_.set_option(asio::socket_base::receive_buffer_size(kSocketBufferSize), ec);
+        return true;
+    }
+
+    /**
+     * @brief 运行 io_ 直到 done 或超时；超时则关闭连接并排空回调
+     */
+    bool run_until(bool& done) {
+        io_.restart();
+        io_.run_for(timeout_);
+        if (done) {
+            return true;
+        }
+        reset();
+        io_.restart();
+        io_.run();
+        return false;
+    }
+
+    const Lusp_UploadEngineConfig&              config_;
+    asio::io_context                            io_;
+    asio::ip::tcp::socket                       socket_;
+    std::chrono::steady_clock::duration         timeout_;
+    std::array<uint8_t, kHeaderSize + kAckSize> reply_{};
+    std::vector<uint8_t>                        extra_;     // RESUME 超出 ACK 的部分
+    std::chrono::steady_clock::duration         last_rtt_{};
+    std::atomic<bool>                           cancelled_{ false };
+};
+
+// ---- Lusp_BackgroundUploader ----
+Lusp_BackgroundUploader::Lusp_BackgroundUploader(const Lusp_UploadEngineConfig& config,
+    std::shared_ptr<Lusp_WorkStealingPool> cpu_pool)
+    : config_(config), cpu_pool_(std::move(cpu_pool)) {
+    config_.chunk_size = std::clamp(config_.chunk_size, kMinChunkSize, kMaxChunkSize);
+    config_.max_concurrent_uploads = std::max<uint32_t>(config_.max_concurrent_uploads, 1);
+    config_.min_concurrent_uploads = std::clamp<uint32_t>(config_.min_concurrent_uploads, 1, config_.max_concurrent_uploads);
+    // 自适应时与条带数一样从上限的一半起步；关闭时上下限相同，控制器不起作用
+    concurrency_ = config_.adaptive_concurrency
+        ? Lusp_ConcurrencyController((config_.max_concurrent_uploads + 1) / 2, config_.min_concurrent_uploads, config_.max_concurrent_uploads)
+        : Lusp_ConcurrencyController(config_.max_concurrent_uploads, config_.max_concurrent_uploads, config_.max_concurrent_uploads);
+    // 条带多于连接数没有意义
+    config_.max_streams_per_file = std::clamp<uint32_t>(config_.max_streams_per_file, 1, config_.max_concurrent_uploads);
+    if (config_.max_active_files == 0) {
+        config_.max_active_files = config_.max_concurrent_uploads * 2;
+    }
+    config_.timeout_seconds = std::max<uint32_t>(config_.timeout_seconds, 1);
+    // 容器连同索引须放得进一帧
+    config_.pack_max_bytes = std::clamp(config_.pack_max_bytes, kMinChunkSize, kMaxPackBytes);
+    config_.pack_file_threshold = std::min(config_.pack_file_threshold, config_.pack_max_bytes);
+    config_.pack_max_files = std::clamp<uint32_t>(config_.pack_max_files, 1, kMaxPackFiles);
+    if (config_.pack_file_threshold == 0) {
+        config_.enable_packing = false;
+    }
+    // 能打包的文件都在小文件通道
+    if (config_.enable_packing) {
+        config_.small_file_threshold = std::max<uint64_t>(config_.small_file_threshold, config_.pack_file_threshold);
+    }
+    config_.small_lane_weight = std::max<uint32_t>(config_.small_lane_weight, 1);
+    config_.large_lane_weight = std::max<uint32_t>(config_.large_lane_weight, 1);
+    lane_share_.set_weight(Lusp_UploadLane::Small, config_.small_lane_weight);
+    lane_share_.set_weight(Lusp_UploadLane::Large, config_.large_lane_weight);
+    config_.fair_queue_quantum = std::max(config_.fair_queue_quantum, kMinChunkSize);
+    for (auto& pending : pending_files_) {
+        pending = Lusp_FairQueue<std::shared_ptr<FileState>>(config_.fair_queue_quantum, config_.shortest_remaining_first);
+    }
+
+    Lusp_RateLimits limits;
+    limits.global_speed = config_.max_upload_speed;
+    limits.device_speed = config_.max_device_upload_speed;
+    limits.file_speed = config_.max_file_upload_speed;
+    auto limiter = std::make_unique<Lusp_RateLimiter>(limits, config_.rate_schedule, config_.rate_burst_ms);
+    if (limiter->enabled()) {
+        rate_limiter_ = std::move(limiter);
+    }
+
+    if (config_.compression_algorithm == "NONE") {
+        config_.enable_compression = false;
+    }
+    else if (config_.enable_compression && config_.compression_algorithm != "LZ4") {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN,
+            "Compression algorithm " + config_.compression_algorithm + " is not built in, using LZ4");
+        config_.compression_algorithm = "LZ4";
+    }
+
+    if (config_.chunking_mode == "CDC") {
+        chunker_ = std::make_unique<Lusp_ContentChunker>(std::min(config_.cdc_average_chunk_size, config_.chunk_size), config_.chunk_size);
+    }
+    else {
+        if (config_.chunking_mode != "FIXED") {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Unknown chunking mode " + config_.chunking_mode + ", using FIXED");
+        }
+        config_.chunking_mode = "FIXED";
+    }
+    rtt_sample_bytes_ = (chunker_ ? chunker_->average_size() : config_.chunk_size) / 2;
+
+    if (!cpu_pool_) {
+        Lusp_WorkStealingPoolConfig pool_config;
+        pool_config.thread_count = config_.cpu_threads;
+        pool_config.pin_threads = config_.pin_cpu_threads;
+        cpu_pool_ = std::make_shared<Lusp_WorkStealingPool>(pool_config);
+    }
+}
+
+const char* upload_file_type_name(Lusp_UploadFileTyped type) {
+    switch (type) {
+    case Lusp_UploadFileTyped::LUSP_UPLOADTYPE_DOCUMENT:    return "DOCUMENT";
+    case Lusp_UploadFileTyped::LUSP_UPLOADTYPE_IMAGE:       return "IMAGE";
+    case Lusp_UploadFileTyped::LUSP_UPLOADTYPE_VIDEO:       return "VIDEO";
+    case Lusp_UploadFileTyped::LUSP_UPLOADTYPE_AUDIO:       return "AUDIO";
+    case Lusp_UploadFileTyped::LUSP_UPLOADTYPE_ARCHIVE:     return "ARCHIVE";
+    case Lusp_UploadFileTyped::LUSP_UPLOADTYPE_CODE:        return "CODE";
+    default:                                                return "UNDEFINED";
+    }
+}
+
+Lusp_BackgroundUploader::~Lusp_BackgroundUploader() {
+    stop();
+}
+
+void Lusp_BackgroundUploader::set_progress_callback(ProgressCallback callback) {
+    progress_callback_ = std::move(callback);
+}
+
+void Lusp_BackgroundUploader::set_complete_callback(CompleteCallback callback) {
+    complete_callback_ = std::move(callback);
+}
+
+bool Lusp_BackgroundUploader::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_.load(std::memory_order_acquire)) {
+            return true;
+        }
+        try {
+            // 每个工作线程同一时刻只读一个分块，缓冲区数 = 工作线程数
+            buffer_pool_ = std::make_unique<Lusp_ChunkBufferPool>(config_.chunk_size, config_.max_concurrent_uploads);
+        }
+        catch (const std::bad_alloc&) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR, "Upload engine failed to allocate chunk buffers");
+            return false;
+        }
+        running_.store(true, std::memory_order_release);
+        for (uint32_t i = 0; i < config_.max_concurrent_uploads; ++i) {
+            workers_.emplace_back(&Lusp_BackgroundUploader::worker_loop, this, i);
+        }
+    }
+    g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO,
+        "Upload engine started: remote " + config_.remote_host + ":" + std::to_string(config_.remote_port) +
+        ", chunk_size " + std::to_string(config_.chunk_size) +
+        ", workers " + std::to_string(config_.max_concurrent_uploads) +
+        (config_.adaptive_concurrency ? " (adaptive from " + std::to_string(config_.min_concurrent_uploads) + ", start " +
+            std::to_string(concurrency_.limit()) + ")" : std::string()) +
+        ", streams/file " + (config_.adaptive_streams ? "adaptive up to " : "") + std::to_string(config_.max_streams_per_file) +
+        ", resume " + (config_.enable_resume ? "on" : "off") +
+        ", rate limit " + (rate_limiter_ ? "on" : "off") +
+        ", compression " + (config_.enable_compression ? config_.compression_algorithm : std::string("off")) +
+        ", chunking " + config_.chunking_mode +
+        (chunker_ ? " (avg " + std::to_string(chunker_->average_size()) + ", SHA-256 " +
+            (Lusp_Sha256::accelerated() ? "SHA-NI" : "software") + ")" : std::string()) +
+        ", packing " + (config_.enable_packing ? "<= " + std::to_string(config_.pack_file_threshold) + " bytes" : std::string("off")) +
+        ", lanes small <= " + std::to_string(config_.small_file_threshold) + " bytes, weight " +
+        std::to_string(config_.small_lane_weight) + ":" + std::to_string(config_.large_lane_weight) +
+        (config_.shortest_remaining_first ? ", shortest remaining first" : "") +
+        ", cpu threads " + std::to_string(cpu_pool_->thread_count()));
+
+    if (config_.enable_resume) {
+        const size_t recovered = recover_journals();
+        if (recovered > 0) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO,
+                "Resubmitted " + std::to_string(recovered) + " unfinished upload(s) from " + config_.journal_dir);
+        }
+    }
+    return true;
+}
+
+void Lusp_BackgroundUploader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.exchange(false, std::memory_order_acq_rel)) {
+            return;
+        }
+        for (Connection* connection : connections_) {
+            connection->cancel();
+        }
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+
+    // 工作线程退出后，列表中剩下的都是未完成的文件
+    std::vector<std::shared_ptr<FileState>> leftovers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t lane = 0; lane < kUploadLaneCount; ++lane) {
+            pending_files_[lane].drain([&leftovers](std::shared_ptr<FileState> file) { leftovers.push_back(std::move(file)); });
+            leftovers.insert(leftovers.end(), active_files_[lane].begin(), active_files_[lane].end());
+            active_files_[lane].clear();
+        }
+    }
+    for (auto& file : leftovers) {
+        complete_file(file, false, "上传已停止");
+    }
+    log_compression_statistics();
+    log_lane_statistics();
+    g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO,
+        "Upload engine stopped, " + std::to_string(leftovers.size()) + " unfinished file(s) cancelled");
+}
+
+bool Lusp_BackgroundUploader::submit(const Lusp_UploadTask& task) {
+    auto file = std::make_shared<FileState>();
+    file->task = task;
+    file->transfer_id = task.file_id;
+    if (task.chunk_hash_size != 0) {
+        file->verify_client = client_root_matches(task, file->client_root);
+        if (!file->verify_client) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Chunk digests of file id " + std::to_string(task.file_id) +
+                " do not match root " + task.chunk_root_digest + ", uploading without client verification");
+        }
+    }
+    // 通道与打包按提交时的大小决定(不持锁 stat)；打开或打包时以实际大小为准。
+    // 取不到大小的文件打开时就会失败，放在小文件通道尽快回报
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(std::filesystem::u8path(task.file_path), ec);
+    if (!ec) {
+        file->file_size = size;
+        file->lane = size <= config_.small_file_threshold ? Lusp_UploadLane::Small : Lusp_UploadLane::Large;
+        file->packable = config_.enable_packing && size <= config_.pack_file_threshold;
+    }
+    file->submitted = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        enqueue(std::move(file));
+        ++unfinished_;
+    }
+    files_submitted_.fetch_add(1, std::memory_order_relaxed);
+    work_cv_.notify_one();
+    return true;
+}
+
+bool Lusp_BackgroundUploader::wait_idle(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto idle = [this]() { return unfinished_ == 0; };
+    if (timeout == std::chrono::milliseconds::max()) {
+        idle_cv_.wait(lock, idle);
+        return true;
+    }
+    return idle_cv_.wait_for(lock, timeout, idle);
+}
+
+Lusp_UploadEngineStats Lusp_BackgroundUploader::get_statistics() const {
+    Lusp_UploadEngineStats stats;
+    stats.files_submitted = files_submitted_.load(std::memory_order_relaxed);
+    stats.files_completed = files_completed_.load(std::memory_order_relaxed);
+    stats.files_failed = files_failed_.load(std::memory_order_relaxed);
+    stats.chunks_sent = chunks_sent_.load(std::memory_order_relaxed);
+    stats.chunk_retries = chunk_retries_.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    stats.chunks_deduplicated = chunks_deduplicated_.load(std::memory_order_relaxed);
+    stats.bytes_deduplicated = bytes_deduplicated_.load(std::memory_order_relaxed);
+    stats.packs_sent = packs_sent_.load(std::memory_order_relaxed);
+    stats.files_packed = files_packed_.load(std::memory_order_relaxed);
+    stats.throttled_chunks = rate_limiter_ ? rate_limiter_->throttled_chunks() : 0;
+    stats.stripe_increases = stripe_increases_.load(std::memory_order_relaxed);
+    stats.stripe_decreases = stripe_decreases_.load(std::memory_order_relaxed);
+    stats.cpu_pool = cpu_pool_->get_statistics();
+    for (size_t t = 0; t < kUploadFileTypeCount; ++t) {
+        stats.compression[t].raw_bytes = compression_[t].raw_bytes.load(std::memory_order_relaxed);
+        stats.compression[t].wire_bytes = compression_[t].wire_bytes.load(std::memory_order_relaxed);
+        stats.compression[t].chunks_compressed = compression_[t].chunks_compressed.load(std::memory_order_relaxed);
+        stats.compression[t].chunks_raw = compression_[t].chunks_raw.load(std::memory_order_relaxed);
+        stats.compression[t].cpu_ns = compression_[t].cpu_ns.load(std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.concurrency_limit = concurrency_.limit();
+    stats.inflight_bytes = inflight_bytes_;
+    stats.concurrency_increases = concurrency_increases_;
+    stats.concurrency_decreases = concurrency_decreases_;
+    stats.goodput = static_cast<uint64_t>(concurrency_.last_goodput());
+    stats.chunk_rtt_us = static_cast<uint64_t>(concurrency_.last_rtt_us());
+    stats.base_rtt_us = static_cast<uint64_t>(concurrency_.base_rtt_us());
+    stats.queued_chunks = concurrency_.last_queued();
+    for (size_t lane = 0; lane < kUploadLaneCount; ++lane) {
+        Lusp_UploadLaneStats& lane_stats = stats.lanes[lane];
+        lane_stats.queued = pending_files_[lane].size();
+        lane_stats.active = active_files_[lane].size();
+        lane_stats.dispatched = lane_dispatched_[lane];
+        lane_stats.queue_wait = queue_wait_[lane];
+        stats.queued_files += lane_stats.queued;
+        stats.active_files += lane_stats.active;
+    }
+    return stats;
+}
+
+void Lusp_BackgroundUploader::worker_loop(size_t worker_index) {
+    Connection connection(config_);
+    Lusp_ChunkBuffer buffer = buffer_pool_->acquire();
+    // 压缩器与缓冲区一样每个工作线程独占
+    std::unique_ptr<Lusp_AdaptiveCompressor> compressor;
+    if (config_.enable_compression) {
+        compressor = std::make_unique<Lusp_AdaptiveCompressor>(config_.chunk_size);
+    }
+    Lusp_PackWriter pack_writer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.push_back(&connection);
+    }
+
+    WorkItem item;
+    while (true) {
+        item = next_work(item);
+        if (item.kind == WorkItem::Kind::None) {
+            break;
+        }
+        std::string error;
+        if (item.kind == WorkItem::Kind::Begin) {
+            const bool success = open_file(connection, *item.file, error);
+            on_begin_done(connection, item.file, success, error);
+        }
+        else if (item.kind == WorkItem::Kind::Pack) {
+            send_pack(connection, pack_writer, item.pack);
+        }
+        else {
+            uint32_t digest = 0;
+            const bool success = send_chunk(connection, buffer, compressor.get(), *item.file, item.chunk_index, digest, error);
+            on_chunk_done(connection, item.file, item.chunk_index, digest, success, error);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.erase(std::remove(connections_.begin(), connections_.end(), &connection), connections_.end());
+    }
+    g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_DEBUG, "Upload worker " + std::to_string(worker_index) + " exited");
+}
+
+Lusp_BackgroundUploader::WorkItem Lusp_BackgroundUploader::next_work(const WorkItem& finished) {
+    const auto now = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (finished.kind != WorkItem::Kind::None) {
+        lane_share_.finish(finished.lane, finished.charged, now - finished.dispatched);
+        if (finished.bytes > 0) {
+            // 完成回调里的通知早于这里归还窗口，等待窗口的线程需要再叫醒一次
+            inflight_bytes_ -= finished.bytes;
+            work_cv_.notify_all();
+        }
+    }
+    while (running_.load(std::memory_order_acquire)) {
+        // 先问占用时长落后的通道，它没有可做的任务时让给另一个通道
+        const Lusp_UploadLane first = lane_share_.first();
+        for (size_t turn = 0; turn < kUploadLaneCount; ++turn) {
+            const auto lane = static_cast<Lusp_UploadLane>((static_cast<size_t>(first) + turn) % kUploadLaneCount);
+            WorkItem item;
+            if (take_work(lane, item)) {
+                item.lane = lane;
+                item.dispatched = std::chrono::steady_clock::now();
+                item.charged = lane_share_.dispatch(lane, first);
+                ++lane_dispatched_[static_cast<size_t>(lane)];
+                inflight_bytes_ += item.bytes;
+                return item;
+            }
+        }
+        // 本线程空闲，而仍有分块的文件受条带数限制：记给条带控制器，作为增加条带的依据
+        for (const auto& active : active_files_) {
+            for (const auto& file : active) {
+                if (file->opened && !file->failed && file->next_chunk < file->chunk_count) {
+                    file->stripes.mark_limited();
+                }
+            }
+        }
+        work_cv_.wait(lock);
+    }
+    return WorkItem();
+}
+
+bool Lusp_BackgroundUploader::take_work(Lusp_UploadLane lane, WorkItem& item) {
+    const size_t index = static_cast<size_t>(lane);
+    auto& pending = pending_files_[index];
+    auto& active = active_files_[index];
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t room = window_room();
+    bool window_limited = false;
+    // 优先打开新文件，活动文件数达到上限后只在已打开的文件间取块
+    if (const auto* front = pending.front()) {
+        if ((*front)->packable && (*front)->file_size > room) {
+            window_limited = true;
+        }
+        else if ((*front)->packable) {
+            // 小文件按差额轮转的顺序整批取走，一个容器一次往返；容器大小同样受在途窗口限制
+            const uint64_t limit = std::min<uint64_t>(config_.pack_max_bytes, room);
+            item.kind = WorkItem::Kind::Pack;
+            do {
+                item.bytes += (*front)->file_size;
+                item.pack.push_back(pending.pop());
+                queue_wait_[index].record(now - item.pack.back()->submitted);
+                front = pending.front();
+            } while (front && (*front)->packable && item.pack.size() < config_.pack_max_files &&
+                item.bytes + (*front)->file_size <= limit);
+            return true;
+        }
+        else if (active.size() < config_.max_active_files) {
+            item.kind = WorkItem::Kind::Begin;
+            item.file = pending.pop();
+            queue_wait_[index].record(now - item.file->submitted);
+            item.file->inflight = 1;
+            active.push_back(item.file);
+            return true;
+        }
+    }
+
+    // 默认轮转；shortest_remaining_first 时取未分派字节最少的文件，让快完成的文件先完成
+    const size_t count = active.size();
+    size_t chosen = count;
+    uint64_t least = UINT64_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t candidate = (round_robin_[index] + i) % count;
+        const auto& file = active[candidate];
+        if (!file->opened || file->failed || file->next_chunk >= file->chunk_count ||
+            file->inflight >= file->stripes.stripes()) {
+            continue;
+        }
+        if (file->chunk_length(file->next_chunk) > room) {
+            window_limited = true;
+            continue;
+        }
+        if (!config_.shortest_remaining_first) {
+            chosen = candidate;
+            break;
+        }
+        const uint64_t remaining = file->file_size - file->chunk_offset(file->next_chunk);
+        if (remaining < least) {
+            least = remaining;
+            chosen = candidate;
+        }
+    }
+    if (window_limited) {
+        concurrency_.mark_limited();
+    }
+    if (chosen == count) {
+        return false;
+    }
+    round_robin_[index] = chosen + 1;
+    const auto& file = active[chosen];
+    ++file->inflight;
+    item.kind = WorkItem::Kind::Chunk;
+    item.file = file;
+    item.chunk_index = file->next_chunk;
+    item.bytes = file->chunk_length(file->next_chunk++);
+    file->skip_held();
+    return true;
+}
+
+void Lusp_BackgroundUploader::enqueue(std::shared_ptr<FileState> file) {
+    // 参数求值顺序不定，先取出 key 与代价再移交
+    auto& pending = pending_files_[static_cast<size_t>(file->lane)];
+    const std::string& device = file->task.client_device;
+    const uint64_t cost = file->file_size;
+    pending.push(device, cost, std::move(file));
+}
+
+bool Lusp_BackgroundUploader::open_file(Connection& connection, FileState& file, std::string& error) {
+    if (!file.handle.open_read(file.task.file_path)) {
+        error = "打开文件失败: " + file.task.file_path + " (错误码 " + std::to_string(file.handle.last_error()) + ")";
+        return false;
+    }
+    if (!file.handle.size(file.file_size)) {
+        error = "获取文件大小失败 (错误码 " + std::to_string(file.handle.last_error()) + ")";
+        return false;
+    }
+    file.chunk_size = config_.chunk_size;
+    const uint64_t chunk_count = (file.file_size + config_.chunk_size - 1) / config_.chunk_size;
+    if (chunk_count >= kControlIndex) {
+        error = "文件过大: " + std::to_string(file.file_size) + " 字节";
+        return false;
+    }
+    file.chunk_count = static_cast<uint32_t>(chunk_count);
+    const auto type = file.task.file_type;
+    if (!config_.enable_compression || file.task.payload_compressed ||
+        type == Lusp_UploadFileTyped::LUSP_UPLOADTYPE_IMAGE || type == Lusp_UploadFileTyped::LUSP_UPLOADTYPE_VIDEO ||
+        type == Lusp_UploadFileTyped::LUSP_UPLOADTYPE_ARCHIVE) {
+        file.compress_mode.store(0, std::memory_order_relaxed);
+    }
+    if (rate_limiter_) {
+        file.device_bucket = rate_limiter_->device_bucket(file.task.client_device);
+    }
+    // 自适应时从上限的一半起步，少块的文件不必等爬坡
+    file.stripes = Lusp_StripeController(config_.adaptive_streams ? (config_.max_streams_per_file + 1) / 2 : config_.max_streams_per_file,
+        config_.max_streams_per_file);
+
+    const std::string name = remote_name(file);
+    std::vector<uint8_t> body(name.begin(), name.end());
+    if (chunker_ && !build_manifest(file, body, error)) {
+        return false;
+    }
+    const bool content_defined = !file.chunk_offsets.empty();
+    // CDC 文件由接收端按指纹去重，不再写续传日志
+    const bool resume = !content_defined && config_.enable_resume && file.chunk_count >= config_.resume_min_chunks && prepare_resume(file);
+    const uint16_t flags = content_defined ? kFlagContentDefined : (resume ? kFlagResume : 0);
+
+    std::vector<uint8_t> frame(kHeaderSize + kFileBeginFixedSize);
+    FileBegin begin;
+    begin.file_id = file.transfer_id;
+    begin.file_size = file.file_size;
+    begin.chunk_size = config_.chunk_size;
+    begin.chunk_count = file.chunk_count;
+    begin.name_length = static_cast<uint16_t>(name.size());
+    encode_header(frame.data(), FrameType::FileBegin, flags, static_cast<uint32_t>(kFileBeginFixedSize + body.size()));
+    encode_file_begin(frame.data() + kHeaderSize, begin);
+    std::vector<uint8_t> resume_payload;
+    if (!exchange(connection, frame.data(), frame.size(), body.data(), body.size(),
+        file.transfer_id, kControlIndex, flags ? &resume_payload : nullptr, error)) {
+        return false;
+    }
+    if (flags && !resume_payload.empty()) {
+        apply_resume_state(file, resume_payload);
+    }
+    return true;
+}
+
+std::string Lusp_BackgroundUploader::remote_name(const FileState& file) const {
+    std::string name = file.task.remote_name;
+    if (name.empty()) {
+        name = path_to_utf8(std::filesystem::u8path(file.task.file_path).filename());
+    }
+    if (name.size() > kMaxNameLength) {
+        name.resize(kMaxNameLength);
+    }
+    return name;
+}
+
+bool Lusp_BackgroundUploader::build_manifest(FileState& file, std::vector<uint8_t>& body, std::string& error) {
+    const size_t name_size = body.size();
+    std::vector<uint64_t> offsets;
+    std::vector<uint8_t> window(static_cast<size_t>(std::min<uint64_t>(file.file_size,
+        std::max<size_t>(kManifestScanWindow, 2 * static_cast<size_t>(chunker_->max_size())))));
+    uint64_t base = 0;          // window[0] 在文件中的偏移
+    size_t filled = 0;
+    size_t position = 0;
+    std::vector<uint32_t> lengths;
+    std::deque<ChunkFingerprint> fingerprints;      // push_back 不移动已有元素，指纹任务直接写入
+    // 切块是顺序的，各块的 SHA-256 边切边交给线程池并行计算；移动读缓冲前等本窗口的指纹算完
+    Lusp_TaskGroup hashing(cpu_pool_.get(), Lusp_TaskPriority::Normal);
+    while (base + position < file.file_size) {
+        // 剩余数据不足一个最大分块且文件未读完时，把剩余部分移到开头再读满
+        if (filled - position < chunker_->max_size() && base + filled < file.file_size) {
+            hashing.wait();
+            std::memmove(window.data(), window.data() + position, filled - position);
+            base += position;
+            filled -= position;
+            position = 0;
+            const size_t want = static_cast<size_t>(std::min<uint64_t>(window.size() - filled, file.file_size - base - filled));
+            if (!file.handle.read_at(window.data() + filled, want, base + filled)) {
+                error = "读取文件失败 (偏移 " + std::to_string(base + filled) + ", 错误码 " + std::to_string(file.handle.last_error()) + ")";
+                return false;
+            }
+            filled += want;
+        }
+        const uint8_t* chunk = window.data() + position;
+        const size_t length = chunker_->cut(chunk, filled - position);
+        uint8_t* fingerprint = fingerprints.emplace_back().data();
+        hashing.run([chunk, length, fingerprint]() { Lusp_Sha256::digest(chunk, length, fingerprint); });
+        lengths.push_back(static_cast<uint32_t>(length));
+        offsets.push_back(base + position);
+        position += length;
+    }
+    offsets.push_back(file.file_size);
+    hashing.wait();
+    body.resize(name_size + lengths.size() * kManifestEntrySize);
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        encode_manifest_entry(body.data() + name_size + i * kManifestEntrySize, lengths[i], fingerprints[i]);
+    }
+
+    if (kFileBeginFixedSize + body.size() > kMaxPayloadSize) {
+        // 清单超过单帧上限(约 180 万块)，按固定分块发送
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Chunk manifest of " + file.task.file_path +
+            " exceeds frame limit, uploading with fixed chunks");
+        body.resize(name_size);
+        return true;
+    }
+    file.chunk_count = static_cast<uint32_t>(offsets.size() - 1);
+    file.chunk_offsets = std::move(offsets);
+    return true;
+}
+
+bool Lusp_BackgroundUploader::prepare_resume(FileState& file) {
+    Lusp_ChunkJournal::Meta meta;
+    meta.file_id = file.task.file_id;
+    meta.file_size = file.file_size;
+    meta.mtime = file_mtime(file.task.file_path);
+    meta.chunk_size = config_.chunk_size;
+    meta.chunk_count = file.chunk_count;
+    meta.content_root = file.client_root;
+    meta.file_path = file.task.file_path;
+    meta.remote_name = file.task.remote_name;
+
+    // 日志按源文件路径命名：客户端重启后再次推送同一文件时文件ID已变，仍能找到上次的进度
+    const std::string path = journal_path(file.task.file_path);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!journals_in_use_.insert(path).second) {
+            // 同一源文件的另一次提交正在上传，这次不续传
+            return false;
+        }
+    }
+    auto journal = std::make_unique<Lusp_ChunkJournal>();
+    const bool reusable = journal->load(path) && journal->meta().file_path == meta.file_path &&
+        journal->meta().file_size == meta.file_size && journal->meta().mtime == meta.mtime &&
+        journal->meta().chunk_size == meta.chunk_size && journal->meta().chunk_count == meta.chunk_count &&
+        journal->meta().content_root == meta.content_root;
+    if (reusable) {
+        // 接收端的续传状态按文件ID保存，沿用上次的ID
+        file.transfer_id = journal->meta().file_id;
+    }
+    else {
+        // 没有日志或源文件已变化：重新建日志，之前的进度全部作废
+        journal = std::make_unique<Lusp_ChunkJournal>();
+        if (!journal->create(path, meta)) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Failed to create resume journal " + path + ", uploading without resume");
+            std::lock_guard<std::mutex> lock(mutex_);
+            journals_in_use_.erase(path);
+            return false;
+        }
+    }
+    file.journal = std::move(journal);
+    return true;
+}
+
+void Lusp_BackgroundUploader::apply_resume_state(FileState& file, const std::vector<uint8_t>& payload) {
+    Ack ack;
+    uint32_t chunk_count = 0;
+    std::vector<uint64_t> remote_bitmap;
+    std::vector<uint32_t> remote_digests;
+    if (!decode_resume_state(payload.data(), payload.size(), ack, chunk_count, remote_bitmap, remote_digests) ||
+        chunk_count != file.chunk_count) {
+        return;
+    }
+
+    // 续传只跳过接收端持有、且与本地日志记录的摘要一致的分块；日志未记录的分块(确认后未刷盘)照常重发。
+    // CDC 文件的位图由接收端按指纹比对得出，直接采用
+    file.held.assign(remote_bitmap.size(), 0);
+    uint64_t held_bytes = 0;
+    for (uint32_t i = 0; i < chunk_count; ++i) {
+        const bool remote_has = (remote_bitmap[i / 64] & (uint64_t(1) << (i % 64))) != 0;
+        if (remote_has && (!file.journal || (file.journal->is_marked(i) && file.journal->digest(i) == remote_digests[i]))) {
+            file.held[i / 64] |= uint64_t(1) << (i % 64);
+            ++file.held_count;
+            held_bytes += file.chunk_length(i);
+        }
+    }
+    file.bytes_done.store(held_bytes, std::memory_order_relaxed);
+    if (file.held_count == 0) {
+        return;
+    }
+    if (file.journal) {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO, "Resuming file id " + std::to_string(file.task.file_id) +
+            (file.transfer_id != file.task.file_id ? " (journal of file id " + std::to_string(file.transfer_id) + ")" : std::string()) + ": " + std::to_string(file.held_count) + "/" + std::to_string(file.chunk_count) + " chunks already on remote");
+    }
+    else {
+        chunks_deduplicated_.fetch_add(file.held_count, std::memory_order_relaxed);
+        bytes_deduplicated_.fetch_add(held_bytes, std::memory_order_relaxed);
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO, "Deduplicated file id " + std::to_string(file.task.file_id) +
+            ": " + std::to_string(file.held_count) + "/" + std::to_string(file.chunk_count) + " chunks (" +
+            std::to_string(held_bytes) + " bytes) already on remote");
+    }
+}
+
+bool Lusp_BackgroundUploader::send_chunk(Connection& connection, Lusp_ChunkBuffer& buffer, Lusp_AdaptiveCompressor* compressor,
+    FileState& file, uint32_t chunk_index, uint32_t& digest, std::string& error) {
+    Chunk chunk;
+    chunk.file_id = file.transfer_id;
+    chunk.offset = file.chunk_offset(chunk_index);
+    chunk.chunk_index = chunk_index;
+    chunk.length = file.chunk_length(chunk_index);
+    if (!file.handle.read_at(buffer.data(), chunk.length, chunk.offset)) {
+        error = "读取文件失败 (偏移 " + std::to_string(chunk.offset) + ", 错误码 " + std::to_string(file.handle.last_error()) + ")";
+        return false;
+    }
+    uint16_t flags = 0;
+    const uint8_t* body = buffer.data();
+    size_t body_size = chunk.length;
+    uint64_t cpu_ns = 0;
+    const bool checksum = config_.enable_checksum || file.journal;     // 续传日志需要摘要，即使不随帧发送
+    const bool compress = compressor && file.compress_mode.load(std::memory_order_relaxed) != 0;
+    bool verified = true;
+    if (checksum || compress || file.verify_client) {
+        // 校验与压缩交给 CPU 线程池，本连接线程等待结果
+        Lusp_TaskGroup stage(cpu_pool_.get(), Lusp_TaskPriority::High);
+        stage.run([&]() {
+            verified = file.verify_client_chunks(buffer.data(), chunk.offset, chunk.length, error);
+            if (!verified) {
+                return;
+            }
+            if (checksum) {
+                chunk.digest = chunk_digest(buffer.data(), chunk.length);
+                flags |= config_.enable_checksum ? kFlagDigest : 0;
+            }
+            int mode = compress ? file.compress_mode.load(std::memory_order_relaxed) : 0;
+            if (mode < 0) {
+                // 首个发送的分块做熵探测，决定整个文件是否压缩；并发的分块各自探测，结果相同
+                mode = Lusp_ChunkCodec::byte_entropy(buffer.data(), chunk.length) < config_.compression_max_entropy ? 1 : 0;
+                file.compress_mode.store(mode, std::memory_order_relaxed);
+            }
+            if (mode > 0 && compressor->should_try()) {
+                const size_t compressed = compressor->compress(buffer.data(), chunk.length);
+                cpu_ns = compressor->last_cpu_ns();
+                if (compressed > 0) {
+                    body = compressor->output();
+                    body_size = compressed;
+                    flags |= kFlagCompressed;
+                    file.incompressible.store(0, std::memory_order_relaxed);
+                }
+                else if (file.incompressible.fetch_add(1, std::memory_order_relaxed) + 1 >= kMaxIncompressibleChunks) {
+                    file.compress_mode.store(0, std::memory_order_relaxed);
+                }
+            }
+        });
+        try {
+            stage.wait();
+        }
+        catch (const std::exception& e) {
+            error = std::string("分块处理异常: ") + e.what();
+            return false;
+        }
+        if (!verified) {
+            return false;
+        }
+    }
+    digest = chunk.digest;
+
+    // 限速按线路字节计算，压缩后的分块占用更少的额度
+    if (rate_limiter_ && !throttle(rate_limiter_->acquire(body_size, file.device_bucket.get(), file.rate_bucket))) {
+        error = "上传已停止";
+        return false;
+    }
+
+    uint8_t head[kHeaderSize + kChunkFixedSize];
+    encode_header(head, FrameType::Chunk, flags, static_cast<uint32_t>(kChunkFixedSize + body_size));
+    encode_chunk(head + kHeaderSize, chunk);
+    const auto begin = std::chrono::steady_clock::now();
+    if (!exchange(connection, head, sizeof(head), body, body_size, chunk.file_id, chunk_index, nullptr, error)) {
+        return false;
+    }
+    if (compressor) {
+        compressor->record_transfer(sizeof(head) + body_size, std::chrono::steady_clock::now() - begin);
+    }
+
+    const size_t type = std::min(static_cast<size_t>(file.task.file_type), kUploadFileTypeCount - 1);
+    CompressionCounters& counters = compression_[type];
+    counters.raw_bytes.fetch_add(chunk.length, std::memory_order_relaxed);
+    counters.wire_bytes.fetch_add(body_size, std::memory_order_relaxed);
+    counters.cpu_ns.fetch_add(cpu_ns, std::memory_order_relaxed);
+    ((flags & kFlagCompressed) ? counters.chunks_compressed : counters.chunks_raw).fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Lusp_BackgroundUploader::throttle(std::chrono::nanoseconds wait) {
+    if (wait.count() <= 0) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !work_cv_.wait_for(lock, wait, [this]() { return !running_.load(std::memory_order_acquire); });
+}
+
+bool Lusp_BackgroundUploader::finish_file(Connection& connection, FileState& file, std::string& error) {
+    uint8_t frame[kHeaderSize + kFileEndSize];
+    FileEnd end;
+    end.file_id = file.transfer_id;
+    end.chunk_count = file.chunk_count;
+    encode_header(frame, FrameType::FileEnd, 0, static_cast<uint32_t>(kFileEndSize));
+    encode_file_end(frame + kHeaderSize, end);
+    return exchange(connection, frame, sizeof(frame), nullptr, 0, file.transfer_id, kControlIndex, nullptr, error);
+}
+
+void Lusp_BackgroundUploader::send_pack(Connection& connection, Lusp_PackWriter& writer,
+    std::vector<std::shared_ptr<FileState>>& files) {
+    uint64_t pack_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pack_id = next_pack_id_++;
+    }
+    writer.reset(pack_id);
+    std::vector<std::shared_ptr<FileState>> packed;
+    std::vector<std::shared_ptr<FileState>> grown;      // 提交后变大，改走普通上传
+    std::vector<std::shared_ptr<FileState>> deferred;   // 本容器放不下，留给下一个容器
+    std::chrono::nanoseconds wait{ 0 };
+    packed.reserve(files.size());
+    for (auto& file : files) {
+        uint64_t size = 0;
+        if (!file->handle.open_read(file->task.file_path) || !file->handle.size(size)) {
+            complete_file(file, false, "打开文件失败: " + file->task.file_path + " (错误码 " + std::to_string(file->handle.last_error()) + ")");
+            continue;
+        }
+        if (size > config_.pack_file_threshold || writer.data_size() + size > config_.pack_max_bytes) {
+            file->handle.close();
+            if (size > config_.pack_file_threshold) {
+                file->file_size = size;
+                file->packable = false;
+                file->lane = size <= config_.small_file_threshold ? Lusp_UploadLane::Small : Lusp_UploadLane::Large;
+                grown.push_back(std::move(file));
+            }
+            else {
+                deferred.push_back(std::move(file));
+            }
+            continue;
+        }
+        uint8_t* data = writer.begin_file(static_cast<uint32_t>(size));
+        if (size > 0 && !file->handle.read_at(data, static_cast<size_t>(size), 0)) {
+            writer.cancel_file();
+            complete_file(file, false, "读取文件失败 (错误码 " + std::to_string(file->handle.last_error()) + ")");
+            continue;
+        }
+        file->file_size = size;
+        std::string error;
+        if (!file->verify_client_chunks(data, 0, static_cast<size_t>(size), error)) {
+            writer.cancel_file();
+            complete_file(file, false, error);
+            continue;
+        }
+        file->handle.close();
+        writer.end_file(file->transfer_id, remote_name(*file), config_.enable_checksum ? chunk_digest(data, static_cast<size_t>(size)) : 0);
+        if (rate_limiter_) {
+            file->device_bucket = rate_limiter_->device_bucket(file->task.client_device);
+            wait = std::max(wait, rate_limiter_->acquire(size, file->device_bucket.get(), file->rate_bucket));
+        }
+        packed.push_back(std::move(file));
+    }
+
+    if (!grown.empty() || !deferred.empty()) {
+        bool requeued = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (running_.load(std::memory_order_acquire)) {
+                for (auto& file : grown) {
+                    enqueue(file);
+                }
+                for (auto& file : deferred) {
+                    enqueue(file);
+                }
+                requeued = true;
+            }
+        }
+        if (requeued) {
+            work_cv_.notify_all();
+        }
+        else {
+            // 引擎已停止，stop 收集不到这些文件
+            for (auto& file : grown) {
+                complete_file(file, false, "上传已停止");
+            }
+            for (auto& file : deferred) {
+                complete_file(file, false, "上传已停止");
+            }
+        }
+    }
+    if (packed.empty()) {
+        return;
+    }
+
+    std::string error;
+    bool success = throttle(wait);
+    if (!success) {
+        error = "上传已停止";
+    }
+    else {
+        const auto& payload = writer.finish();
+        uint8_t head[kHeaderSize];
+        encode_header(head, FrameType::Pack, config_.enable_checksum ? kFlagDigest : 0, static_cast<uint32_t>(payload.size()));
+        success = exchange(connection, head, sizeof(head), payload.data(), payload.size(), pack_id, kControlIndex, nullptr, error);
+    }
+    if (success) {
+        packs_sent_.fetch_add(1, std::memory_order_relaxed);
+        files_packed_.fetch_add(packed.size(), std::memory_order_relaxed);
+        // 容器的往返时间随文件数变化，不作为往返时间样本
+        std::string concurrency_message;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            concurrency_message = record_ack(writer.data_size(), std::chrono::steady_clock::duration::zero());
+        }
+        if (!concurrency_message.empty()) {
+            work_cv_.notify_all();
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_DEBUG, concurrency_message);
+        }
+    }
+    for (auto& file : packed) {
+        if (success) {
+            file->bytes_done.store(file->file_size, std::memory_order_relaxed);
+            bytes_sent_.fetch_add(file->file_size, std::memory_order_relaxed);
+            const size_t type = std::min(static_cast<size_t>(file->task.file_type), kUploadFileTypeCount - 1);
+            compression_[type].raw_bytes.fetch_add(file->file_size, std::memory_order_relaxed);
+            compression_[type].wire_bytes.fetch_add(file->file_size, std::memory_order_relaxed);
+            if (progress_callback_) {
+                progress_callback_(file->task.file_id, file->file_size, file->file_size);
+            }
+        }
+        complete_file(file, success, success ? std::string() : error);
+    }
+}
+
+bool Lusp_BackgroundUploader::exchange(Connection& connection, const uint8_t* head, size_t head_size,
+    const uint8_t* body, size_t body_size, uint64_t file_id, uint32_t chunk_index,
+    std::vector<uint8_t>* resume_payload, std::string& error) {
+    for (uint32_t attempt = 0; ; ++attempt) {
+        if (attempt > 0) {
+            chunk_retries_.fetch_add(1, std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (work_cv_.wait_for(lock, std::chrono::milliseconds(config_.retry_delay_ms),
+                [this]() { return !running_.load(std::memory_order_acquire); })) {
+                error = "上传已停止";
+                return false;
+            }
+        }
+
+        Ack ack;
+        if (connection.transact(head, head_size, body, body_size, ack, resume_payload, error)) {
+            if (ack.file_id != file_id || ack.chunk_index != chunk_index) {
+                error = "确认与请求不匹配";
+                connection.reset();
+            }
+            else {
+                switch (ack.status) {
+                case AckStatus::Ok:
+                    return true;
+                case AckStatus::DigestMismatch:
+                    error = "分块校验失败";
+                    break;
+                case AckStatus::UnknownFile:
+                    error = "远端不存在该文件的上传会话";
+                    return false;
+                case AckStatus::Incomplete:
+                    error = "远端报告分块缺失";
+                    return false;
+                default:
+                    error = "远端写入失败";
+                    return false;
+                }
+            }
+        }
+        if (attempt >= config_.retry_count || !running_.load(std::memory_order_acquire)) {
+            return false;
+        }
+    }
+}
+
+void Lusp_BackgroundUploader::on_begin_done(Connection& connection, const std::shared_ptr<FileState>& file,
+    bool success, const std::string& error) {
+    if (success && file->held_count == file->chunk_count) {
+        // 空文件或接收端已持有全部分块：FILE_BEGIN 之后直接 FILE_END
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            file->finishing = true;
+            remove_active(file);
+        }
+        work_cv_.notify_all();
+        std::string end_error;
+        const bool finished = finish_file(connection, *file, end_error);
+        complete_file(file, finished, end_error);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file->inflight = 0;
+        if (success) {
+            file->opened = true;
+            file->skip_held();
+        }
+        else {
+            file->failed = true;
+            file->finishing = true;
+            remove_active(file);
+        }
+    }
+    work_cv_.notify_all();
+    if (!success) {
+        complete_file(file, false, error);
+    }
+}
+
+void Lusp_BackgroundUploader::on_chunk_done(Connection& connection, const std::shared_ptr<FileState>& file,
+    uint32_t chunk_index, uint32_t digest, bool success, const std::string& error) {
+    uint64_t bytes_done = 0;
+    bool finish = false;
+    bool abandon = false;
+    bool flush_journal = false;
+    std::string stripe_message;
+    std::string concurrency_message;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --file->inflight;
+        if (success) {
+            ++file->acked;
+            if (file->journal) {
+                file->journal->mark(chunk_index, digest);
+                if (++file->unflushed >= config_.journal_flush_chunks) {
+                    file->unflushed = 0;
+                    flush_journal = true;
+                }
+            }
+            const uint64_t length = file->chunk_length(chunk_index);
+            bytes_done = file->bytes_done.fetch_add(length, std::memory_order_relaxed) + length;
+            chunks_sent_.fetch_add(1, std::memory_order_relaxed);
+            bytes_sent_.fetch_add(length, std::memory_order_relaxed);
+            // 往返时间含传输时间，只取接近整块的分块，避免小文件的短块拉低基准
+            concurrency_message = record_ack(length, length >= rtt_sample_bytes_ ? connection.last_rtt()
+                : std::chrono::steady_clock::duration::zero());
+            if (config_.adaptive_streams) {
+                const auto decision = file->stripes.on_chunk_acked(length, std::chrono::steady_clock::now());
+                if (decision != Lusp_StripeController::Decision::None) {
+                    (decision == Lusp_StripeController::Decision::Increased ? stripe_increases_ : stripe_decreases_)
+                        .fetch_add(1, std::memory_order_relaxed);
+                    stripe_message = "File id " + std::to_string(file->task.file_id) + " stripes -> " +
+                        std::to_string(file->stripes.stripes()) + " (last window " +
+                        std::to_string(static_cast<uint64_t>(file->stripes.last_rate() / (1024 * 1024))) + " MB/s)";
+                }
+            }
+        }
+        else if (!file->failed) {
+            file->failed = true;
+            file->error = error;
+        }
+
+        if (file->failed) {
+            // 失败的文件等最后一个在途分块返回后再完成
+            if (file->inflight == 0 && !file->finishing) {
+                file->finishing = true;
+                remove_active(file);
+                abandon = true;
+            }
+        }
+        else if (file->acked + file->held_count == file->chunk_count) {
+            file->finishing = true;
+            remove_active(file);
+            finish = true;
+        }
+    }
+    work_cv_.notify_all();
+
+    if (!stripe_message.empty()) {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_DEBUG, stripe_message);
+    }
+    if (!concurrency_message.empty()) {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_DEBUG, concurrency_message);
+    }
+    if (flush_journal && !finish) {
+        file->journal->flush();
+    }
+    if (success && progress_callback_) {
+        progress_callback_(file->task.file_id, bytes_done, file->file_size);
+    }
+    if (abandon) {
+        complete_file(file, false, file->error);
+    }
+    else if (finish) {
+        std::string end_error;
+        const bool finished = finish_file(connection, *file, end_error);
+        complete_file(file, finished, end_error);
+    }
+}
+
+void Lusp_BackgroundUploader::complete_file(const std::shared_ptr<FileState>& file, bool success, const std::string& message) {
+    file->handle.close();
+    if (file->journal) {
+        // 成功后日志不再需要；失败时保留进度，下次提交同一文件时续传
+        const std::string path = file->journal->path();
+        if (success) {
+            file->journal->remove();
+        }
+        else {
+            file->journal->flush();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        journals_in_use_.erase(path);
+    }
+    if (success) {
+        files_completed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        files_failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (complete_callback_) {
+        complete_callback_(file->task.file_id, success, message);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --unfinished_;
+    }
+    idle_cv_.notify_all();
+}
+
+std::string Lusp_BackgroundUploader::journal_path(const std::string& file_path) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.journal", static_cast<unsigned long long>(path_hash(file_path)));
+    return path_to_utf8(std::filesystem::u8path(config_.journal_dir) / name);
+}
+
+size_t Lusp_BackgroundUploader::recover_journals() {
+    std::error_code ec;
+    const auto dir = std::filesystem::u8path(config_.journal_dir);
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Failed to create journal directory " + config_.journal_dir + ": " + ec.message());
+        return 0;
+    }
+
+    // 先收集再提交，submit 期间不持有目录迭代器
+    std::vector<Lusp_UploadTask> tasks;
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> renames;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != ".journal") {
+            continue;
+        }
+        Lusp_ChunkJournal journal;
+        if (!journal.load(path_to_utf8(entry.path()))) {
+            std::filesystem::remove(entry.path(), ec);
+            continue;
+        }
+        if (!std::filesystem::exists(std::filesystem::u8path(journal.meta().file_path), ec)) {
+            journal.remove();
+            continue;
+        }
+        // 旧版本按文件ID命名的日志改名为按源文件路径命名(关闭后再改)，否则提交时找不到
+        const auto expected = std::filesystem::u8path(journal_path(journal.meta().file_path));
+        if (entry.path() != expected) {
+            renames.emplace_back(entry.path(), expected);
+        }
+        Lusp_UploadTask task;
+        task.file_id = journal.meta().file_id;
+        task.file_path = journal.meta().file_path;
+        task.remote_name = journal.meta().remote_name;
+        tasks.push_back(std::move(task));
+    }
+    for (const auto& rename : renames) {
+        std::filesystem::rename(rename.first, rename.second, ec);
+    }
+    for (const auto& task : tasks) {
+        submit(task);
+    }
+    return tasks.size();
+}
+
+void Lusp_BackgroundUploader::log_compression_statistics() const {
+    for (size_t t = 0; t < kUploadFileTypeCount; ++t) {
+        const CompressionCounters& counters = compression_[t];
+        const uint64_t raw = counters.raw_bytes.load(std::memory_order_relaxed);
+        if (raw == 0) {
+            continue;
+        }
+        const uint64_t wire = counters.wire_bytes.load(std::memory_order_relaxed);
+        const double cpu_ms_per_mb = counters.cpu_ns.load(std::memory_order_relaxed) / 1e6 / (raw / (1024.0 * 1024.0));
+        char line[256];
+        std::snprintf(line, sizeof(line), "Compression [%s]: %.1f MB -> %.1f MB (ratio %.3f), %llu chunk(s) compressed, %llu raw, CPU %.2f ms/MB",
+            upload_file_type_name(static_cast<Lusp_UploadFileTyped>(t)), raw / (1024.0 * 1024.0), wire / (1024.0 * 1024.0),
+            static_cast<double>(wire) / raw,
+            static_cast<unsigned long long>(counters.chunks_compressed.load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(counters.chunks_raw.load(std::memory_order_relaxed)), cpu_ms_per_mb);
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO, line);
+    }
+}
+
+void Lusp_BackgroundUploader::log_lane_statistics() const {
+    std::array<Lusp_WaitHistogram, kUploadLaneCount> waits;
+    std::array<uint64_t, kUploadLaneCount> dispatched{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        waits = queue_wait_;
+        dispatched = lane_dispatched_;
+    }
+    for (size_t lane = 0; lane < kUploadLaneCount; ++lane) {
+        const Lusp_WaitHistogram& wait = waits[lane];
+        if (wait.count == 0) {
+            continue;
+        }
+        char line[256];
+        std::snprintf(line, sizeof(line), "Upload lane [%s]: %llu file(s) started, %llu task(s) dispatched, queue wait p50 %llu ms, p99 %llu ms, max %llu ms",
+            upload_lane_name(static_cast<Lusp_UploadLane>(lane)), static_cast<unsigned long long>(wait.count),
+            static_cast<unsigned long long>(dispatched[lane]), static_cast<unsigned long long>(wait.quantile_ms(0.5)),
+            static_cast<unsigned long long>(wait.quantile_ms(0.99)), static_cast<unsigned long long>(wait.max_ms));
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO, line);
+    }
+}
+
+uint64_t Lusp_BackgroundUploader::window_room() const {
+    // 窗口为空时总放行一个任务，CDC 等略大于 chunk_size 的分块也不会卡住
+    if (inflight_bytes_ == 0) {
+        return UINT64_MAX;
+    }
+    const uint64_t window = static_cast<uint64_t>(concurrency_.limit()) * config_.chunk_size;
+    return window > inflight_bytes_ ? window - inflight_bytes_ : 0;
+}
+
+std::string Lusp_BackgroundUploader::record_ack(uint64_t bytes, std::chrono::steady_clock::duration rtt) {
+    // 未启用自适应时上下限相同，控制器只负责测量
+    const auto decision = concurrency_.on_acked(bytes, rtt, chunk_retries_.load(std::memory_order_relaxed),
+        std::chrono::steady_clock::now());
+    if (decision == Lusp_ConcurrencyController::Decision::None) {
+        return std::string();
+    }
+    ++(decision == Lusp_ConcurrencyController::Decision::Increased ? concurrency_increases_ : concurrency_decreases_);
+    char line[160];
+    std::snprintf(line, sizeof(line), "Upload concurrency -> %u (goodput %.1f MB/s, chunk RTT %.2f ms, base %.2f ms, queued %.1f)",
+        concurrency_.limit(), concurrency_.last_goodput() / (1024 * 1024), concurrency_.last_rtt_us() / 1000,
+        concurrency_.base_rtt_us() / 1000, concurrency_.last_queued());
+    return line;
+}
+
+void Lusp_BackgroundUploader::remove_active(const std::shared_ptr<FileState>& file) {
+    auto& active = active_files_[static_cast<size_t>(file->lane)];
+    active.erase(std::remove(active.begin(), active.end(), file), active.end());
+}
@@ -0,0 +1,113 @@
+#include "UploadEngine/Lusp_ChunkBufferPool.h"
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <cstdlib>
+#endif
+
+namespace {
+    uint8_t* aligned_allocate(size_t alignment, size_t size) {
+#ifdef _WIN32
+        void* block = _aligned_malloc(size, alignment);
+#else
+        void* block = nullptr;
+        if (posix_memalign(&block, alignment, size) != 0) {
+            block = nullptr;
+        }
+#endif
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        return static_cast<uint8_t*>(block);
+    }
+
+    void aligned_free(uint8_t* block) {
+#ifdef _WIN32
+        _aligned_free(block);
+#else
+        std::free(block);
+#endif
+    }
+}
+
+// ---- Lusp_ChunkBuffer ----
+Lusp_ChunkBuffer::Lusp_ChunkBuffer(Lusp_ChunkBuffer&& other) noexcept
+    : pool_(other.pool_), data_(other.data_), capacity_(other.capacity_) {
+    other.pool_ = nullptr;
+    other.data_ = nullptr;
+    other.capacity_ = 0;
+}
+
+Lusp_ChunkBuffer& Lusp_ChunkBuffer::operator=(Lusp_ChunkBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        other.pool_ = nullptr;
+        other.data_ = nullptr;
+        other.capacity_ = 0;
+    }
+    return *this;
+}
+
+Lusp_ChunkBuffer::~Lusp_ChunkBuffer() {
+    release();
+}
+
+void Lusp_ChunkBuffer::release() {
+    if (pool_ && data_) {
+        pool_->give_back(data_);
+    }
+    pool_ = nullptr;
+    data_ = nullptr;
+    capacity_ = 0;
+}
+
+// ---- Lusp_ChunkBufferPool ----
+Lusp_ChunkBufferPool::Lusp_ChunkBufferPool(size_t buffer_size, size_t count)
+    : buffer_size_((buffer_size + kAlignment - 1) / kAlignment * kAlignment),
+    count_(count == 0 ? 1 : count) {
+    arena_ = aligned_allocate(kAlignment, buffer_size_ * count_);
+    free_list_.reserve(count_);
+    for (size_t i = 0; i < count_; ++i) {
+        free_list_.push_back(arena_ + i * buffer_size_);
+    }
+}
+
+Lusp_ChunkBufferPool::~Lusp_ChunkBufferPool() {
+    aligned_free(arena_);
+}
+
+Lusp_ChunkBuffer Lusp_ChunkBufferPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_cv_.wait(lock, [this]() { return !free_list_.empty(); });
+    uint8_t* data = free_list_.back();
+    free_list_.pop_back();
+    return Lusp_ChunkBuffer(this, data, buffer_size_);
+}
+
+Lusp_ChunkBuffer Lusp_ChunkBufferPool::try_acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_list_.empty()) {
+        return Lusp_ChunkBuffer();
+    }
+    uint8_t* data = free_list_.back();
+    free_list_.pop_back();
+    return Lusp_ChunkBuffer(this, data, buffer_size_);
+}
+
+size_t Lusp_ChunkBufferPool::available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_list_.size();
+}
+
+void Lusp_ChunkBufferPool::give_back(uint8_t* data) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_list_.push_back(data);
+    }
+    available_cv_.notify_one();
+}
@@ -0,0 +1,262 @@
+#include "UploadEngine/Lusp_ChunkCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace Lusp_ChunkProtocol;
+
+namespace {
+    constexpr size_t    kMinMatch       = 4;
+    constexpr size_t    kLastLiterals   = 5;     // 最后 5 字节必须是字面量
+    constexpr size_t    kMatchFindLimit = 12;    // 距结尾不足 12 字节时不再找匹配
+    constexpr size_t    kMaxOffset      = 65535;
+    constexpr int       kHashBits       = 14;
+    constexpr size_t    kEntropySample  = 64 * 1024;
+
+    inline uint32_t read32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t hash4(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - kHashBits);
+    }
+
+    /**
+     * @brief 写出一个序列(字面量 + 可选匹配)，空间不足返回 nullptr
+     */
+    uint8_t* write_sequence(uint8_t* op, uint8_t* oend, const uint8_t* literals, size_t literal_length,
+        size_t offset, size_t match_length) {
+        const size_t needed = 1 + literal_length / 255 + 1 + literal_length + (match_length ? 2 + match_length / 255 + 1 : 0);
+        if (needed > static_cast<size_t>(oend - op)) {
+            return nullptr;
+        }
+        uint8_t* token = op++;
+        if (literal_length >= 15) {
+            *token = 15 << 4;
+            size_t rest = literal_length - 15;
+            for (; rest >= 255; rest -= 255) {
+                *op++ = 255;
+            }
+            *op++ = static_cast<uint8_t>(rest);
+        }
+        else {
+            *token = static_cast<uint8_t>(literal_length << 4);
+        }
+        if (literal_length) {
+            std::memcpy(op, literals, literal_length);
+        }
+        op += literal_length;
+        if (match_length == 0) {
+            return op;
+        }
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        size_t rest = match_length - kMinMatch;
+        if (rest >= 15) {
+            *token |= 15;
+            for (rest -= 15; rest >= 255; rest -= 255) {
+                *op++ = 255;
+            }
+            *op++ = static_cast<uint8_t>(rest);
+        }
+        else {
+            *token |= static_cast<uint8_t>(rest);
+        }
+        return op;
+    }
+}
+
+size_t Lusp_ChunkCodec::lz4_compress_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t Lusp_ChunkCodec::lz4_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + capacity;
+    size_t anchor = 0;
+
+    if (size > kMatchFindLimit) {
+        // 表中存 位置+1，0 表示空
+        uint32_t table[1u << kHashBits];
+        std::memset(table, 0, sizeof(table));
+        const size_t search_limit = size - kMatchFindLimit;
+        const size_t match_limit = size - kLastLiterals;
+        size_t ip = 0;
+        uint32_t misses = 0;
+        while (ip <= search_limit) {
+            const uint32_t sequence = read32(src + ip);
+            const uint32_t h = hash4(sequence);
+            const size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(ip + 1);
+            if (candidate == 0 || ip - (candidate - 1) > kMaxOffset || read32(src + candidate - 1) != sequence) {
+                // 连续未命中时加大步长，不可压缩的数据很快扫过
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            size_t ref = candidate - 1;
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                --ip;
+                --ref;
+            }
+            size_t length = kMinMatch;
+            while (ip + length < match_limit && src[ref + length] == src[ip + length]) {
+                ++length;
+            }
+            op = write_sequence(op, oend, src + anchor, ip - anchor, ip - ref, length);
+            if (!op) {
+                return 0;
+            }
+            ip += length;
+            anchor = ip;
+            misses = 0;
+            table[hash4(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2 + 1);
+        }
+    }
+    op = write_sequence(op, oend, src + anchor, size - anchor, 0, 0);
+    return op ? static_cast<size_t>(op - dst) : 0;
+}
+
+bool Lusp_ChunkCodec::lz4_decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size) {
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < size) {
+        const uint8_t token = src[ip++];
+        size_t literal_length = token >> 4;
+        if (literal_length == 15) {
+            uint8_t byte;
+            do {
+                if (ip >= size) {
+                    return false;
+                }
+                byte = src[ip++];
+                literal_length += byte;
+            } while (byte == 255);
+        }
+        if (literal_length > size - ip || literal_length > raw_size - op) {
+            return false;
+        }
+        if (literal_length) {
+            std::memcpy(dst + op, src + ip, literal_length);
+        }
+        ip += literal_length;
+        op += literal_length;
+        if (ip == size) {
+            break;      // 最后一个序列只有字面量
+        }
+
+        if (size - ip < 2) {
+            return false;
+        }
+        const size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return false;
+        }
+        size_t match_length = token & 15;
+        if (match_length == 15) {
+            uint8_t byte;
+            do {
+                if (ip >= size) {
+                    return false;
+                }
+                byte = src[ip++];
+                match_length += byte;
+            } while (byte == 255);
+        }
+        match_length += kMinMatch;
+        if (match_length > raw_size - op) {
+            return false;
+        }
+        if (offset >= match_length) {
+            std::memcpy(dst + op, dst + op - offset, match_length);
+        }
+        else {
+            // 重叠复制(如 offset=1 的游程)必须逐字节
+            for (size_t i = 0; i < match_length; ++i) {
+                dst[op + i] = dst[op - offset + i];
+            }
+        }
+        op += match_length;
+    }
+    return op == raw_size;
+}
+
+double Lusp_ChunkCodec::byte_entropy(const uint8_t* data, size_t size) {
+    size = std::min(size, kEntropySample);
+    if (size == 0) {
+        return 0;
+    }
+    uint32_t counts[256] = {};
+    for (size_t i = 0; i < size; ++i) {
+        ++counts[data[i]];
+    }
+    double entropy = 0;
+    for (uint32_t count : counts) {
+        if (count) {
+            const double p = static_cast<double>(count) / size;
+            entropy -= p * std::log2(p);
+        }
+    }
+    return entropy;
+}
+
+bool Lusp_ChunkCodec::chunk_data(uint16_t flags, const uint8_t* payload, size_t size, Chunk& chunk,
+    const uint8_t*& data, std::vector<uint8_t>& scratch) {
+    if (size < kChunkFixedSize) {
+        return false;
+    }
+    decode_chunk(payload, chunk);
+    if (!(flags & kFlagCompressed)) {
+        data = payload + kChunkFixedSize;
+        return size == kChunkFixedSize + chunk.length;
+    }
+    if (chunk.length > kMaxPayloadSize - kChunkFixedSize) {
+        return false;
+    }
+    scratch.resize(chunk.length);
+    data = scratch.data();
+    return lz4_decompress(payload + kChunkFixedSize, size - kChunkFixedSize, scratch.data(), chunk.length);
+}
+
+// ---- Lusp_AdaptiveCompressor ----
+Lusp_AdaptiveCompressor::Lusp_AdaptiveCompressor(uint32_t max_chunk_size)
+    : output_(Lusp_ChunkCodec::lz4_compress_bound(max_chunk_size)) {}
+
+bool Lusp_AdaptiveCompressor::should_try() {
+    if (skip_remaining_ > 0) {
+        --skip_remaining_;
+        return false;
+    }
+    return true;
+}
+
+size_t Lusp_AdaptiveCompressor::compress(const uint8_t* data, size_t size) {
+    const auto begin = std::chrono::steady_clock::now();
+    const size_t compressed = Lusp_ChunkCodec::lz4_compress(data, size, output_.data(), size - size / 8);
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    last_cpu_ns_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+    const double rate = size / std::max(std::chrono::duration<double>(elapsed).count(), 1e-9);
+    const double saving = compressed ? 1.0 - static_cast<double>(compressed) / size : 0.0;
+    compress_rate_ = compress_rate_ == 0 ? rate : compress_rate_ + kAlpha * (rate - compress_rate_);
+    saving_ = saving_ < 0 ? saving : saving_ + kAlpha * (saving - saving_);
+    // 压缩耗时 size / compress_rate 大于省下的传输时间 size * saving / link_rate 时退避
+    if (link_rate_ > 0 && compress_rate_ * saving_ < link_rate_) {
+        backoff_ = backoff_ == 0 ? 1 : std::min(backoff_ * 2, kMaxBackoff);
+        skip_remaining_ = backoff_;
+    }
+    else {
+        backoff_ = 0;
+    }
+    return compressed;
+}
+
+void Lusp_AdaptiveCompressor::record_transfer(size_t wire_bytes, std::chrono::nanoseconds elapsed) {
+    if (elapsed.count() <= 0) {
+        return;
+    }
+    const double rate = wire_bytes * 1e9 / elapsed.count();
+    link_rate_ = link_rate_ == 0 ? rate : link_rate_ + kAlpha * (rate - link_rate_);
+}
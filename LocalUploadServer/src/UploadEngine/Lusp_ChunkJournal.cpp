@@ -0,0 +1,232 @@
+#include "UploadEngine/Lusp_ChunkJournal.h"
+#include <algorithm>
+#include <filesystem>
+#include "UploadEngine/Lusp_ChunkProtocol.h"
+
+using namespace Lusp_ChunkProtocol;
+
+namespace {
+    size_t align8(size_t value) {
+        return (value + 7) & ~size_t(7);
+    }
+
+    size_t meta_length(const Lusp_ChunkJournal::Meta& meta) {
+        return 2 + meta.file_path.size() + 2 + meta.remote_name.size();
+    }
+}
+
+void Lusp_ChunkJournal::layout() {
+    const size_t words = (static_cast<size_t>(meta_.chunk_count) + 63) / 64;
+    bitmap_offset_ = kHeaderSize + align8(meta_length(meta_));
+    digest_offset_ = bitmap_offset_ + words * 8;
+    bitmap_.assign(words, 0);
+    digests_.assign(meta_.chunk_count, 0);
+    dirty_flags_.assign(words, 0);
+    dirty_words_.clear();
+    marked_count_ = 0;
+}
+
+bool Lusp_ChunkJournal::create(const std::string& journal_path, const Meta& meta) {
+    if (meta.file_path.size() > 0xFFFF || meta.remote_name.size() > 0xFFFF) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    meta_ = meta;
+    journal_path_ = journal_path;
+    layout();
+
+    std::vector<uint8_t> head(bitmap_offset_, 0);
+    put_u64(head.data(), kMagic);
+    put_u64(head.data() + 8, meta_.file_id);
+    put_u64(head.data() + 16, meta_.file_size);
+    put_u64(head.data() + 24, static_cast<uint64_t>(meta_.mtime));
+    put_u32(head.data() + 32, meta_.chunk_size);
+    put_u32(head.data() + 36, meta_.chunk_count);
+    put_u32(head.data() + 40, static_cast<uint32_t>(meta_length(meta_)));
+    std::copy(meta_.content_root.begin(), meta_.content_root.end(), head.data() + 44);
+    uint8_t* cursor = head.data() + kHeaderSize;
+    put_u16(cursor, static_cast<uint16_t>(meta_.file_path.size()));
+    std::copy(meta_.file_path.begin(), meta_.file_path.end(), cursor + 2);
+    cursor += 2 + meta_.file_path.size();
+    put_u16(cursor, static_cast<uint16_t>(meta_.remote_name.size()));
+    std::copy(meta_.remote_name.begin(), meta_.remote_name.end(), cursor + 2);
+
+    // 位图与摘要区由 truncate 补零
+    return file_.open_write(journal_path_) &&
+        file_.truncate(digest_offset_ + 4ull * meta_.chunk_count) &&
+        file_.write_at(head.data(), head.size(), 0) &&
+        file_.sync();
+}
+
+bool Lusp_ChunkJournal::load(const std::string& journal_path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    journal_path_ = journal_path;
+    uint64_t size = 0;
+    uint8_t head[kHeaderSize];
+    if (!file_.open_write(journal_path_) || !file_.size(size) || size < kHeaderSize || !file_.read_at(head, kHeaderSize, 0)) {
+        file_.close();
+        return false;
+    }
+    if (get_u64(head) != kMagic) {
+        file_.close();
+        return false;
+    }
+    meta_ = Meta();
+    meta_.file_id = get_u64(head + 8);
+    meta_.file_size = get_u64(head + 16);
+    meta_.mtime = static_cast<int64_t>(get_u64(head + 24));
+    meta_.chunk_size = get_u32(head + 32);
+    meta_.chunk_count = get_u32(head + 36);
+    const uint32_t length = get_u32(head + 40);
+    std::copy(head + 44, head + 60, meta_.content_root.begin());
+
+    std::vector<uint8_t> meta(length);
+    if (length < 4 || size < kHeaderSize + length || !file_.read_at(meta.data(), length, kHeaderSize)) {
+        file_.close();
+        return false;
+    }
+    const size_t path_length = get_u16(meta.data());
+    if (2 + path_length + 2 > length) {
+        file_.close();
+        return false;
+    }
+    const size_t name_length = get_u16(meta.data() + 2 + path_length);
+    if (2 + path_length + 2 + name_length != length) {
+        file_.close();
+        return false;
+    }
+    meta_.file_path.assign(reinterpret_cast<const char*>(meta.data() + 2), path_length);
+    meta_.remote_name.assign(reinterpret_cast<const char*>(meta.data() + 4 + path_length), name_length);
+
+    layout();
+    if (size != digest_offset_ + 4ull * meta_.chunk_count) {
+        file_.close();
+        return false;
+    }
+    std::vector<uint8_t> raw(static_cast<size_t>(size - bitmap_offset_));
+    if (!raw.empty() && !file_.read_at(raw.data(), raw.size(), bitmap_offset_)) {
+        file_.close();
+        return false;
+    }
+    for (size_t w = 0; w < bitmap_.size(); ++w) {
+        bitmap_[w] = get_u64(raw.data() + w * 8);
+    }
+    // 最后一个字中超出 chunk_count 的位不应置位
+    if (meta_.chunk_count % 64 != 0 && !bitmap_.empty()) {
+        bitmap_.back() &= (uint64_t(1) << (meta_.chunk_count % 64)) - 1;
+    }
+    const uint8_t* digests = raw.data() + bitmap_.size() * 8;
+    for (uint32_t i = 0; i < meta_.chunk_count; ++i) {
+        digests_[i] = get_u32(digests + 4ull * i);
+        if (bitmap_[i / 64] & (uint64_t(1) << (i % 64))) {
+            ++marked_count_;
+        }
+    }
+    return true;
+}
+
+void Lusp_ChunkJournal::mark(uint32_t chunk_index, uint32_t digest) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (chunk_index >= meta_.chunk_count) {
+        return;
+    }
+    const uint32_t word = chunk_index / 64;
+    const uint64_t bit = uint64_t(1) << (chunk_index % 64);
+    if (!(bitmap_[word] & bit)) {
+        bitmap_[word] |= bit;
+        ++marked_count_;
+    }
+    digests_[chunk_index] = digest;
+    if (!dirty_flags_[word]) {
+        dirty_flags_[word] = 1;
+        dirty_words_.push_back(word);
+    }
+}
+
+bool Lusp_ChunkJournal::is_marked(uint32_t chunk_index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return chunk_index < meta_.chunk_count && (bitmap_[chunk_index / 64] & (uint64_t(1) << (chunk_index % 64))) != 0;
+}
+
+uint32_t Lusp_ChunkJournal::digest(uint32_t chunk_index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return chunk_index < meta_.chunk_count ? digests_[chunk_index] : 0;
+}
+
+uint32_t Lusp_ChunkJournal::marked_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return marked_count_;
+}
+
+size_t Lusp_ChunkJournal::dirty_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dirty_words_.size();
+}
+
+bool Lusp_ChunkJournal::flush(const std::function<bool()>& before_write) {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    // 在锁内把脏区拷出来，写盘时不阻塞 mark
+    struct DirtyWord {
+        uint32_t    word;
+        uint8_t     bits[8];
+        uint8_t     digests[64 * 4];
+        size_t      digest_count;
+    };
+    std::vector<DirtyWord> dirty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (dirty_words_.empty() || !file_.is_open()) {
+            return true;
+        }
+        dirty.resize(dirty_words_.size());
+        for (size_t i = 0; i < dirty_words_.size(); ++i) {
+            const uint32_t word = dirty_words_[i];
+            DirtyWord& entry = dirty[i];
+            entry.word = word;
+            put_u64(entry.bits, bitmap_[word]);
+            const uint32_t first = word * 64;
+            entry.digest_count = std::min<size_t>(64, meta_.chunk_count - first);
+            for (size_t d = 0; d < entry.digest_count; ++d) {
+                put_u32(entry.digests + d * 4, digests_[first + d]);
+            }
+            dirty_flags_[word] = 0;
+        }
+        dirty_words_.clear();
+    }
+
+    if (before_write && !before_write()) {
+        // 放回脏区，下次 flush 重试
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : dirty) {
+            if (!dirty_flags_[entry.word]) {
+                dirty_flags_[entry.word] = 1;
+                dirty_words_.push_back(entry.word);
+            }
+        }
+        return false;
+    }
+    bool ok = true;
+    for (const auto& entry : dirty) {
+        // 位图落盘而摘要未落盘时，续传比对摘要不一致只会导致重发
+        ok = ok && file_.write_at(entry.digests, entry.digest_count * 4, digest_offset_ + 4ull * entry.word * 64);
+        ok = ok && file_.write_at(entry.bits, 8, bitmap_offset_ + 8ull * entry.word);
+    }
+    return ok && file_.sync();
+}
+
+void Lusp_ChunkJournal::remove() {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.close();
+    if (!journal_path_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(std::filesystem::u8path(journal_path_), ec);
+    }
+}
+
+void Lusp_ChunkJournal::snapshot(std::vector<uint64_t>& bitmap, std::vector<uint32_t>& digests) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bitmap = bitmap_;
+    digests = digests_;
+}
@@ -0,0 +1,206 @@
+#include "UploadEngine/Lusp_ChunkStore.h"
+#include "UploadEngine/Lusp_Sha256.h"
+
+using namespace Lusp_ChunkProtocol;
+
+namespace {
+    constexpr size_t kRecordHeaderSize = 6;     // magic(u32) | path_length(u16)
+}
+
+Lusp_ChunkStore::Lusp_ChunkStore(size_t max_entries)
+    : max_entries_(max_entries) {}
+
+bool Lusp_ChunkStore::open(const std::string& index_path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!index_.open_write(index_path)) {
+        return false;
+    }
+    load_index();
+    return true;
+}
+
+void Lusp_ChunkStore::load_index() {
+    uint64_t file_size = 0;
+    if (!index_.size(file_size)) {
+        return;
+    }
+    uint64_t offset = 0;
+    std::vector<uint8_t> manifest;
+    for (;;) {
+        uint8_t head[kRecordHeaderSize];
+        if (offset + sizeof(head) > file_size || !index_.read_at(head, sizeof(head), offset) || get_u32(head) != kRecordMagic) {
+            break;
+        }
+        const uint16_t path_length = get_u16(head + 4);
+        std::string path(path_length, '\0');
+        uint8_t count_bytes[4];
+        const uint64_t count_offset = offset + sizeof(head) + path_length;
+        if (count_offset + sizeof(count_bytes) > file_size ||
+            !index_.read_at(&path[0], path_length, offset + sizeof(head)) ||
+            !index_.read_at(count_bytes, sizeof(count_bytes), count_offset)) {
+            break;
+        }
+        const uint32_t chunk_count = get_u32(count_bytes);
+        const uint64_t manifest_size = static_cast<uint64_t>(chunk_count) * kManifestEntrySize;
+        if (count_offset + sizeof(count_bytes) + manifest_size > file_size) {
+            break;
+        }
+        manifest.resize(static_cast<size_t>(manifest_size));
+        if (!index_.read_at(manifest.data(), manifest.size(), count_offset + sizeof(count_bytes))) {
+            break;
+        }
+        insert_manifest(std::make_shared<const std::string>(std::move(path)), manifest.data(), chunk_count);
+        offset = count_offset + sizeof(count_bytes) + manifest_size;
+    }
+    // 丢弃尾部不完整的记录(写入中途崩溃)，之后从这里追加
+    if (offset != file_size) {
+        index_.truncate(offset);
+    }
+    index_size_ = offset;
+}
+
+bool Lusp_ChunkStore::layout(const uint8_t* manifest, uint32_t chunk_count, uint64_t file_size, uint32_t max_chunk_size,
+    std::vector<uint64_t>& offsets) {
+    if (chunk_count > file_size) {
+        return false;
+    }
+    offsets.resize(static_cast<size_t>(chunk_count) + 1);
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < chunk_count; ++i) {
+        const uint32_t length = get_u32(manifest + static_cast<size_t>(i) * kManifestEntrySize);
+        if (length == 0 || length > max_chunk_size) {
+            return false;
+        }
+        offsets[i] = offset;
+        offset += length;
+    }
+    offsets[chunk_count] = offset;
+    return offset == file_size;
+}
+
+void Lusp_ChunkStore::prepare(const uint8_t* manifest, uint32_t chunk_count, const std::vector<uint64_t>& offsets,
+    const Lusp_PositionalFile* output, Lusp_ManifestPlan& plan) {
+    plan.held.assign((static_cast<size_t>(chunk_count) + 63) / 64, 0);
+    plan.present.clear();
+    plan.present_bytes = 0;
+    plan.duplicates.clear();
+
+    // 清单内的重复分块：首次出现的分块在库中时各自从库复制，否则只发送首个，收到后由接收端复制
+    struct FirstSeen {
+        uint32_t    index;
+        bool        stored;
+    };
+    std::unordered_map<ChunkFingerprint, FirstSeen, FingerprintHash> seen;
+    seen.reserve(chunk_count);
+    std::vector<uint8_t> buffer;
+    std::shared_ptr<const std::string> source_path;
+    Lusp_PositionalFile source;
+    uint8_t digest[Lusp_Sha256::kDigestSize];
+
+    for (uint32_t i = 0; i < chunk_count; ++i) {
+        uint32_t length = 0;
+        ChunkFingerprint fingerprint;
+        decode_manifest_entry(manifest + static_cast<size_t>(i) * kManifestEntrySize, length, fingerprint);
+        auto result = seen.emplace(fingerprint, FirstSeen{ i, false });
+        if (!result.second && !result.first->second.stored) {
+            plan.duplicates[result.first->second.index].push_back(i);
+            plan.held[i / 64] |= uint64_t(1) << (i % 64);
+            continue;
+        }
+
+        Location location;
+        if (!locate(fingerprint, length, location)) {
+            continue;
+        }
+        if (output) {
+            if (!location.path) {
+                continue;
+            }
+            if (source_path != location.path) {
+                source.close();
+                source_path = location.path;
+                source.open_read(*source_path);
+            }
+            buffer.resize(length);
+            bool valid = source.is_open() && source.read_at(buffer.data(), length, location.offset);
+            if (valid) {
+                Lusp_Sha256::digest(buffer.data(), length, digest);
+                valid = std::memcmp(digest, fingerprint.data(), sizeof(digest)) == 0;
+            }
+            if (!valid) {
+                forget(fingerprint, location);
+                continue;
+            }
+            if (!output->write_at(buffer.data(), length, offsets[i])) {
+                continue;
+            }
+        }
+        result.first->second.stored = true;
+        plan.held[i / 64] |= uint64_t(1) << (i % 64);
+        plan.present.push_back(i);
+        plan.present_bytes += length;
+    }
+}
+
+void Lusp_ChunkStore::add_file(const std::string& path, const uint8_t* manifest, uint32_t chunk_count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert_manifest(path.empty() ? nullptr : std::make_shared<const std::string>(path), manifest, chunk_count);
+    if (!index_.is_open() || path.empty() || path.size() > UINT16_MAX) {
+        return;
+    }
+    const size_t manifest_size = static_cast<size_t>(chunk_count) * kManifestEntrySize;
+    std::vector<uint8_t> record(kRecordHeaderSize + path.size() + 4 + manifest_size);
+    put_u32(record.data(), kRecordMagic);
+    put_u16(record.data() + 4, static_cast<uint16_t>(path.size()));
+    std::memcpy(record.data() + kRecordHeaderSize, path.data(), path.size());
+    put_u32(record.data() + kRecordHeaderSize + path.size(), chunk_count);
+    std::memcpy(record.data() + kRecordHeaderSize + path.size() + 4, manifest, manifest_size);
+    if (index_.write_at(record.data(), record.size(), index_size_)) {
+        index_size_ += record.size();
+    }
+}
+
+size_t Lusp_ChunkStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+bool Lusp_ChunkStore::locate(const ChunkFingerprint& fingerprint, uint32_t length, Location& location) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(fingerprint);
+    if (it == entries_.end() || it->second.length != length) {
+        return false;
+    }
+    location = it->second;
+    return true;
+}
+
+void Lusp_ChunkStore::forget(const ChunkFingerprint& fingerprint, const Location& location) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(fingerprint);
+    // 期间被更新的文件重新登记过则保留新位置
+    if (it != entries_.end() && it->second.path == location.path && it->second.offset == location.offset) {
+        entries_.erase(it);
+    }
+}
+
+void Lusp_ChunkStore::insert_manifest(const std::shared_ptr<const std::string>& path, const uint8_t* manifest, uint32_t chunk_count) {
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < chunk_count; ++i) {
+        Location location;
+        ChunkFingerprint fingerprint;
+        decode_manifest_entry(manifest + static_cast<size_t>(i) * kManifestEntrySize, location.length, fingerprint);
+        location.path = path;
+        location.offset = offset;
+        offset += location.length;
+        // 同一指纹指向最新登记的文件，旧文件更可能已被覆盖
+        auto result = entries_.insert_or_assign(fingerprint, std::move(location));
+        if (result.second) {
+            order_.push_back(fingerprint);
+        }
+    }
+    while (entries_.size() > max_entries_ && !order_.empty()) {
+        entries_.erase(order_.front());
+        order_.pop_front();
+    }
+}
@@ -0,0 +1,75 @@
+#include "UploadEngine/Lusp_ConcurrencyController.h"
+#include <algorithm>
+#include <cmath>
+
+Lusp_ConcurrencyController::Lusp_ConcurrencyController(uint32_t initial, uint32_t min, uint32_t max)
+    : min_(std::max<uint32_t>(min, 1)), max_(std::max(max, std::max<uint32_t>(min, 1))) {
+    limit_ = std::clamp(initial, min_, max_);
+    warmup_ = limit_;
+}
+
+void Lusp_ConcurrencyController::restart_window(Clock::time_point now, uint64_t retries) {
+    window_acks_ = 0;
+    window_bytes_ = 0;
+    window_rtt_count_ = 0;
+    window_rtt_sum_us_ = 0;
+    window_rtt_min_us_ = 0;
+    window_retries_ = retries;
+    window_start_ = now;
+    limited_ = false;
+}
+
+Lusp_ConcurrencyController::Decision Lusp_ConcurrencyController::on_acked(uint64_t bytes, Clock::duration rtt,
+    uint64_t retries, Clock::time_point now) {
+    if (warmup_ > 0) {
+        // 这些请求在上限改变前就已发出，不计入新窗口
+        if (--warmup_ == 0) {
+            restart_window(now, retries);
+        }
+        return Decision::None;
+    }
+    ++window_acks_;
+    window_bytes_ += bytes;
+    if (rtt > Clock::duration::zero()) {
+        const double us = std::chrono::duration<double, std::micro>(rtt).count();
+        window_rtt_min_us_ = window_rtt_count_ == 0 ? us : std::min(window_rtt_min_us_, us);
+        window_rtt_sum_us_ += us;
+        ++window_rtt_count_;
+    }
+    if (window_acks_ < std::max(kMinWindowAcks, 2 * limit_)) {
+        return Decision::None;
+    }
+    const auto min_window = std::max<Clock::duration>(kMinWindow,
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(kWindowRtts * base_rtt_us_)));
+    if (now - window_start_ < min_window) {
+        return Decision::None;
+    }
+
+    const double seconds = std::chrono::duration<double>(now - window_start_).count();
+    const double goodput = window_bytes_ / seconds;
+    const double previous_goodput = last_goodput_;
+    const bool lost = retries > window_retries_;
+    const bool limited = limited_;
+    if (window_rtt_count_ > 0) {
+        window_minimums_[window_count_++ % kBaseWindows] = window_rtt_min_us_;
+        const size_t filled = std::min(window_count_, kBaseWindows);
+        base_rtt_us_ = *std::min_element(window_minimums_.begin(), window_minimums_.begin() + filled);
+        last_rtt_us_ = window_rtt_sum_us_ / window_rtt_count_;
+        last_queued_ = limit_ * (1 - base_rtt_us_ / last_rtt_us_);
+    }
+    const bool queueing = last_queued_ > kMaxQueued;
+    last_goodput_ = goodput;
+    restart_window(now, retries);
+
+    if ((lost || (queueing && goodput < previous_goodput * (1 + kMinGain))) && limit_ > min_) {
+        limit_ = std::max(min_, static_cast<uint32_t>(std::floor(limit_ * kBackoff)));
+        warmup_ = limit_;
+        return Decision::Decreased;
+    }
+    if (limited && !lost && !queueing && limit_ < max_) {
+        ++limit_;
+        warmup_ = limit_;
+        return Decision::Increased;
+    }
+    return Decision::None;
+}
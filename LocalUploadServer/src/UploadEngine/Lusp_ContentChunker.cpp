@@ -0,0 +1,102 @@
+#include "UploadEngine/Lusp_ContentChunker.h"
+#include <algorithm>
+
+namespace {
+    constexpr size_t   kWindow          = 64;       // 64 位 gear 哈希每字节左移一位，64 字节后移出
+    constexpr uint32_t kMinAverageSize  = 4096;
+    constexpr int      kNormalization   = 2;        // 归一化级别：两段掩码比 avg 对应的位数各多/少 2 位
+
+    struct GearTables {
+        uint64_t    gear[256] = {};
+        uint64_t    shifted[256] = {};      // gear << 1，两字节滚动时用于前一个字节
+    };
+
+    constexpr GearTables make_gear_tables() {
+        GearTables tables;
+        uint64_t seed = 0x4C5553505F434443ull;      // "LUSP_CDC"，改动会使已有的去重索引全部失效
+        for (int i = 0; i < 256; ++i) {
+            // splitmix64
+            uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            tables.gear[i] = z ^ (z >> 31);
+            tables.shifted[i] = tables.gear[i] << 1;
+        }
+        return tables;
+    }
+
+    constexpr GearTables kTables = make_gear_tables();
+
+    /**
+     * @brief 取哈希的高位(第 62 位往下)：gear 哈希的高位覆盖更长的窗口；
+     *        留出最高位，使掩码左移一位后仍然完整(两字节滚动时判定前一个位置用)
+     */
+    uint64_t make_mask(int bits) {
+        return ((uint64_t(1) << bits) - 1) << (63 - bits);
+    }
+
+    int floor_log2(uint32_t value) {
+        int bits = 0;
+        while (value >>= 1) {
+            ++bits;
+        }
+        return bits;
+    }
+}
+
+Lusp_ContentChunker::Lusp_ContentChunker(uint32_t average_size, uint32_t max_size) {
+    const int bits = floor_log2(std::max(average_size, kMinAverageSize));
+    average_size_ = uint32_t(1) << bits;
+    min_size_ = average_size_ / 4;
+    max_size_ = std::max(max_size, average_size_);
+    mask_small_ = make_mask(bits + kNormalization);
+    mask_large_ = make_mask(bits - kNormalization);
+}
+
+size_t Lusp_ContentChunker::cut(const uint8_t* data, size_t size) const {
+    if (size <= min_size_) {
+        return size;
+    }
+    const size_t limit = std::min<size_t>(size, max_size_);
+    const size_t normal = std::min<size_t>(limit, average_size_);
+    const uint64_t* gear = kTables.gear;
+    const uint64_t* shifted = kTables.shifted;
+
+    // 从 min - 64 开始预热，第一个判定位置的哈希已覆盖完整窗口(与分块起点无关)
+    size_t i = min_size_ - kWindow;
+    uint64_t hash = 0;
+    for (; i < min_size_; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+    }
+
+    // (hash << 2) + shifted[b0] 等于吃进 b0 后的哈希左移一位，用左移一位的掩码判定 b0 处的边界
+    const uint64_t small_first = mask_small_ << 1;
+    for (; i + 2 <= normal; i += 2) {
+        hash = (hash << 2) + shifted[data[i]];
+        if (!(hash & small_first)) {
+            return i + 1;
+        }
+        hash += gear[data[i + 1]];
+        if (!(hash & mask_small_)) {
+            return i + 2;
+        }
+    }
+    const uint64_t large_first = mask_large_ << 1;
+    for (; i + 2 <= limit; i += 2) {
+        hash = (hash << 2) + shifted[data[i]];
+        if (!(hash & large_first)) {
+            return i + 1;
+        }
+        hash += gear[data[i + 1]];
+        if (!(hash & mask_large_)) {
+            return i + 2;
+        }
+    }
+    if (i < limit) {
+        hash = (hash << 1) + gear[data[i]];
+        if (!(hash & mask_large_)) {
+            return i + 1;
+        }
+    }
+    return limit;
+}
@@ -0,0 +1,94 @@
+#include "UploadEngine/Lusp_FilePack.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace Lusp_ChunkProtocol;
+
+// ---- Lusp_PackWriter ----
+void Lusp_PackWriter::reset(uint64_t pack_id) {
+    buffer_.resize(kPackFixedSize);
+    put_u64(buffer_.data(), pack_id);
+    index_.clear();
+    data_end_ = kPackFixedSize;
+    pending_size_ = 0;
+    file_count_ = 0;
+}
+
+uint8_t* Lusp_PackWriter::begin_file(uint32_t size) {
+    buffer_.resize(data_end_ + size);
+    pending_size_ = size;
+    return buffer_.data() + data_end_;
+}
+
+void Lusp_PackWriter::end_file(uint64_t file_id, const std::string& name, uint32_t digest) {
+    PackEntry entry;
+    entry.file_id = file_id;
+    entry.size = pending_size_;
+    entry.digest = digest;
+    entry.name_length = static_cast<uint16_t>(std::min<size_t>(name.size(), kMaxNameLength));
+    const size_t offset = index_.size();
+    index_.resize(offset + kPackEntryFixedSize + entry.name_length);
+    encode_pack_entry(index_.data() + offset, entry);
+    std::memcpy(index_.data() + offset + kPackEntryFixedSize, name.data(), entry.name_length);
+    data_end_ += pending_size_;
+    pending_size_ = 0;
+    ++file_count_;
+}
+
+void Lusp_PackWriter::cancel_file() {
+    buffer_.resize(data_end_);
+    pending_size_ = 0;
+}
+
+const std::vector<uint8_t>& Lusp_PackWriter::finish() {
+    buffer_.resize(data_end_);
+    buffer_.insert(buffer_.end(), index_.begin(), index_.end());
+    buffer_.resize(buffer_.size() + kPackTrailerSize);
+    encode_pack_trailer(buffer_.data() + buffer_.size() - kPackTrailerSize, static_cast<uint32_t>(index_.size()), file_count_);
+    return buffer_;
+}
+
+// ---- Lusp_PackReader ----
+bool Lusp_PackReader::parse(const uint8_t* payload, size_t size) {
+    files_.clear();
+    if (size < kPackFixedSize + kPackTrailerSize) {
+        return false;
+    }
+    const uint8_t* trailer = payload + size - kPackTrailerSize;
+    const uint32_t index_length = get_u32(trailer);
+    const uint32_t file_count = get_u32(trailer + 4);
+    if (get_u32(trailer + 8) != kPackMagic || index_length > size - kPackFixedSize - kPackTrailerSize ||
+        static_cast<uint64_t>(file_count) * kPackEntryFixedSize > index_length) {
+        return false;
+    }
+    pack_id_ = get_u64(payload);
+    data_size_ = size - kPackFixedSize - kPackTrailerSize - index_length;
+
+    const uint8_t* data = payload + kPackFixedSize;
+    const uint8_t* cursor = data + data_size_;
+    const uint8_t* index_end = cursor + index_length;
+    uint64_t offset = 0;
+    files_.reserve(file_count);
+    for (uint32_t i = 0; i < file_count; ++i) {
+        if (static_cast<size_t>(index_end - cursor) < kPackEntryFixedSize) {
+            return false;
+        }
+        PackEntry entry;
+        decode_pack_entry(cursor, entry);
+        cursor += kPackEntryFixedSize;
+        if (static_cast<size_t>(index_end - cursor) < entry.name_length || entry.size > data_size_ - offset) {
+            return false;
+        }
+        Lusp_PackedFile file;
+        file.file_id = entry.file_id;
+        file.size = entry.size;
+        file.digest = entry.digest;
+        file.name = reinterpret_cast<const char*>(cursor);
+        file.name_length = entry.name_length;
+        file.data = data + offset;
+        files_.push_back(file);
+        cursor += entry.name_length;
+        offset += entry.size;
+    }
+    return cursor == index_end && offset == data_size_;
+}
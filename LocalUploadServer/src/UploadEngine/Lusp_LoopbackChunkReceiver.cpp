@@ -0,0 +1,416 @@
+#include "UploadEngine/Lusp_LoopbackChunkReceiver.h"
+#include <filesystem>
+#include "UploadEngine/Lusp_ChunkCodec.h"
+#include "UploadEngine/Lusp_ChunkProtocol.h"
+#include "UploadEngine/Lusp_PathUtf8.h"
+#include "UploadEngine/Lusp_PositionalFile.h"
+#include "log_headers.h"
+
+using namespace Lusp_ChunkProtocol;
+
+struct Lusp_LoopbackChunkReceiver::ReceiveFile {
+    uint64_t                file_size = 0;
+    uint32_t                chunk_size = 0;
+    uint32_t                chunk_count = 0;
+    uint32_t                received_count = 0;     // files_mutex_ 保护
+    std::vector<uint8_t>    received;               // 分块位图(每块一字节)，files_mutex_ 保护
+    Lusp_PositionalFile     output;                 // 未配置输出目录时不打开
+    std::string             path;                   // 输出路径(UTF-8)，未配置输出目录时为空
+
+    // 内容定义分块
+    std::vector<uint64_t>   chunk_offsets;          // 各分块起始偏移(chunk_count + 1 个)；固定分块时为空
+    std::vector<uint8_t>    manifest;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> duplicates;   // files_mutex_ 保护
+};
+
+namespace {
+    void make_ack(std::vector<uint8_t>& reply, uint64_t file_id, uint32_t chunk_index, AckStatus status) {
+        Ack ack;
+        ack.file_id = file_id;
+        ack.chunk_index = chunk_index;
+        ack.status = status;
+        reply.resize(kHeaderSize + kAckSize);
+        encode_header(reply.data(), FrameType::Ack, 0, static_cast<uint32_t>(kAckSize));
+        encode_ack(reply.data() + kHeaderSize, ack);
+    }
+}
+
+Lusp_LoopbackChunkReceiver::Lusp_LoopbackChunkReceiver(const Lusp_LoopbackReceiverConfig& config)
+    : config_(config), acceptor_(io_context_) {}
+
+Lusp_LoopbackChunkReceiver::~Lusp_LoopbackChunkReceiver() {
+    stop();
+}
+
+bool Lusp_LoopbackChunkReceiver::start() {
+    if (running_.load(std::memory_order_acquire)) {
+        return true;
+    }
+    asio::error_code ec;
+    const asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), config_.port);
+    acceptor_.open(endpoint.protocol(), ec);
+    if (!ec) {
+        acceptor_.set_option(asio::socket_base::reuse_address(true), ec);
+        acceptor_.bind(endpoint, ec);
+    }
+    if (!ec) {
+        acceptor_.listen(asio::socket_base::max_listen_connections, ec);
+    }
+    if (ec) {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR, "Loopback receiver failed to listen: " + ec.message());
+        acceptor_.close(ec);
+        return false;
+    }
+    bound_port_ = acceptor_.local_endpoint(ec).port();
+    if (!config_.output_dir.empty()) {
+        std::filesystem::create_directories(std::filesystem::u8path(config_.output_dir), ec);
+    }
+
+    running_.store(true, std::memory_order_release);
+    do_accept();
+    io_thread_ = std::thread([this]() { io_context_.run(); });
+    g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_INFO, "Loopback receiver listening on port " + std::to_string(bound_port_));
+    return true;
+}
+
+void Lusp_LoopbackChunkReceiver::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    io_context_.stop();
+    if (io_thread_.joinable()) {
+        io_thread_.join();
+    }
+    asio::error_code ec;
+    acceptor_.close(ec);
+
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        // shutdown 唤醒阻塞在读上的连接线程
+        for (auto& socket : sockets_) {
+            socket->shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+        }
+        threads.swap(connection_threads_);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        sockets_.clear();
+    }
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    files_.clear();
+}
+
+Lusp_LoopbackReceiverStats Lusp_LoopbackChunkReceiver::get_statistics() const {
+    Lusp_LoopbackReceiverStats stats;
+    stats.files_completed = files_completed_.load(std::memory_order_relaxed);
+    stats.chunks_received = chunks_received_.load(std::memory_order_relaxed);
+    stats.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+    stats.digest_errors = digest_errors_.load(std::memory_order_relaxed);
+    stats.chunks_deduplicated = chunks_deduplicated_.load(std::memory_order_relaxed);
+    stats.bytes_deduplicated = bytes_deduplicated_.load(std::memory_order_relaxed);
+    stats.packs_received = packs_received_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Lusp_LoopbackChunkReceiver::do_accept() {
+    auto socket = std::make_shared<asio::ip::tcp::socket>(io_context_);
+    acceptor_.async_accept(*socket, [this, socket](std::error_code ec) {
+        if (ec || !running_.load(std::memory_order_acquire)) {
+            return;
+        }
+        socket->set_option(asio::ip::tcp::no_delay(true), ec);
+        socket->set_option(asio::socket_base::receive_buffer_size(4 * 1024 * 1024), ec);
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            sockets_.push_back(socket);
+            connection_threads_.emplace_back(&Lusp_LoopbackChunkReceiver::serve, this, socket);
+        }
+        do_accept();
+        });
+}
+
+void Lusp_LoopbackChunkReceiver::serve(SocketPtr socket) {
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> scratch;   // 压缩分块的解压缓冲
+    uint8_t head[kHeaderSize];
+    std::vector<uint8_t> reply;     // ACK 或 RESUME
+    Lusp_PackReader pack;
+    asio::error_code ec;
+
+    while (running_.load(std::memory_order_acquire)) {
+        asio::read(*socket, asio::buffer(head), ec);
+        if (ec) {
+            break;
+        }
+        FrameHeader header;
+        if (!decode_header(head, header)) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Loopback receiver got an invalid frame header, closing connection");
+            break;
+        }
+        payload.resize(header.payload_length);
+        asio::read(*socket, asio::buffer(payload), ec);
+        if (ec) {
+            break;
+        }
+
+        bool handled = false;
+        switch (header.type) {
+        case FrameType::FileBegin:
+            handled = handle_file_begin(header.flags, payload.data(), payload.size(), reply);
+            break;
+        case FrameType::Chunk:
+            handled = handle_chunk(header.flags, payload.data(), payload.size(), scratch, reply);
+            break;
+        case FrameType::FileEnd:
+            handled = handle_file_end(payload.data(), payload.size(), reply);
+            break;
+        case FrameType::Pack:
+            handled = handle_pack(header.flags, payload.data(), payload.size(), pack, reply);
+            break;
+        default:
+            break;
+        }
+        if (!handled) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Loopback receiver got a malformed frame, closing connection");
+            break;
+        }
+        if (config_.link_rate > 0) {
+            // 帧按到达顺序占用瓶颈链路，排在前面的帧发完才轮到它
+            const auto transmit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(static_cast<double>(kHeaderSize + header.payload_length) / config_.link_rate));
+            std::chrono::steady_clock::time_point done;
+            {
+                std::lock_guard<std::mutex> lock(link_mutex_);
+                link_free_ = std::max(link_free_, std::chrono::steady_clock::now()) + transmit;
+                done = link_free_;
+            }
+            std::this_thread::sleep_until(done);
+        }
+        if (config_.ack_delay_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(config_.ack_delay_us));
+        }
+        asio::write(*socket, asio::buffer(reply), ec);
+        if (ec) {
+            break;
+        }
+    }
+    socket->close(ec);
+}
+
+bool Lusp_LoopbackChunkReceiver::handle_file_begin(uint16_t flags, const uint8_t* payload, size_t size, std::vector<uint8_t>& reply) {
+    if (size < kFileBeginFixedSize) {
+        return false;
+    }
+    FileBegin begin;
+    decode_file_begin(payload, begin);
+    const bool content_defined = (flags & kFlagContentDefined) != 0;
+    const uint64_t manifest_size = content_defined ? static_cast<uint64_t>(begin.chunk_count) * kManifestEntrySize : 0;
+    if (size != kFileBeginFixedSize + begin.name_length + manifest_size || begin.chunk_size == 0) {
+        return false;
+    }
+    const uint8_t* manifest = payload + kFileBeginFixedSize + begin.name_length;
+
+    auto file = std::make_shared<ReceiveFile>();
+    file->file_size = begin.file_size;
+    file->chunk_size = begin.chunk_size;
+    file->chunk_count = begin.chunk_count;
+    file->received.assign(begin.chunk_count, 0);
+
+    AckStatus status = AckStatus::Ok;
+    if (content_defined ? !Lusp_ChunkStore::layout(manifest, begin.chunk_count, begin.file_size, begin.chunk_size, file->chunk_offsets)
+        : (begin.file_size + begin.chunk_size - 1) / begin.chunk_size != begin.chunk_count) {
+        status = AckStatus::Failed;
+    }
+    else if (!config_.output_dir.empty()) {
+        const std::string name(reinterpret_cast<const char*>(payload + kFileBeginFixedSize), begin.name_length);
+        // 只取文件名部分，防止远端名称中带路径
+        const auto path = std::filesystem::u8path(config_.output_dir) / std::filesystem::u8path(name).filename();
+        file->path = path_to_utf8(path);
+        if (!file->output.open_write(file->path) || !file->output.truncate(begin.file_size)) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR,
+                "Loopback receiver failed to open " + file->path + " (error " + std::to_string(file->output.last_error()) + ")");
+            status = AckStatus::Failed;
+        }
+    }
+
+    Lusp_ManifestPlan plan;
+    if (status == AckStatus::Ok && content_defined) {
+        store_.prepare(manifest, begin.chunk_count, file->chunk_offsets, file->output.is_open() ? &file->output : nullptr, plan);
+        file->manifest.assign(manifest, manifest + manifest_size);
+        file->duplicates = std::move(plan.duplicates);
+        for (uint32_t index : plan.present) {
+            file->received[index] = 1;
+        }
+        file->received_count = static_cast<uint32_t>(plan.present.size());
+        chunks_deduplicated_.fetch_add(plan.present.size(), std::memory_order_relaxed);
+        bytes_deduplicated_.fetch_add(plan.present_bytes, std::memory_order_relaxed);
+    }
+    if (status == AckStatus::Ok) {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        files_[begin.file_id] = std::move(file);
+    }
+    if (status != AckStatus::Ok || !content_defined) {
+        make_ack(reply, begin.file_id, kControlIndex, status);
+        return true;
+    }
+
+    // 内容定义分块以 RESUME 回复无需发送的分块
+    Ack ack;
+    ack.file_id = begin.file_id;
+    ack.chunk_index = kControlIndex;
+    const std::vector<uint32_t> digests(begin.chunk_count, 0);
+    const size_t length = resume_state_size(begin.chunk_count);
+    reply.resize(kHeaderSize + length);
+    encode_header(reply.data(), FrameType::ResumeState, 0, static_cast<uint32_t>(length));
+    encode_resume_state(reply.data() + kHeaderSize, ack, begin.chunk_count, plan.held.data(), digests.data());
+    return true;
+}
+
+bool Lusp_LoopbackChunkReceiver::handle_chunk(uint16_t flags, const uint8_t* payload, size_t size,
+    std::vector<uint8_t>& scratch, std::vector<uint8_t>& reply) {
+    Chunk chunk;
+    const uint8_t* data = nullptr;
+    if (!Lusp_ChunkCodec::chunk_data(flags, payload, size, chunk, data, scratch)) {
+        return false;
+    }
+
+    std::shared_ptr<ReceiveFile> file;
+    {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        auto it = files_.find(chunk.file_id);
+        if (it != files_.end()) {
+            file = it->second;
+        }
+    }
+    if (!file) {
+        make_ack(reply, chunk.file_id, chunk.chunk_index, AckStatus::UnknownFile);
+        return true;
+    }
+
+    AckStatus status = AckStatus::Ok;
+    const bool content_defined = !file->chunk_offsets.empty() && chunk.chunk_index < file->chunk_count;
+    const uint64_t expected_offset = content_defined ? file->chunk_offsets[chunk.chunk_index]
+        : static_cast<uint64_t>(chunk.chunk_index) * file->chunk_size;
+    if (chunk.chunk_index >= file->chunk_count || chunk.offset != expected_offset ||
+        chunk.offset + chunk.length > file->file_size ||
+        (content_defined && chunk.offset + chunk.length != file->chunk_offsets[chunk.chunk_index + 1])) {
+        status = AckStatus::Failed;
+    }
+    else if (config_.verify_checksum && (flags & kFlagDigest) && chunk_digest(data, chunk.length) != chunk.digest) {
+        digest_errors_.fetch_add(1, std::memory_order_relaxed);
+        status = AckStatus::DigestMismatch;
+    }
+    else if (file->output.is_open() && !file->output.write_at(data, chunk.length, chunk.offset)) {
+        status = AckStatus::Failed;
+    }
+
+    std::vector<uint32_t> copies;
+    if (status == AckStatus::Ok) {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        if (!file->received[chunk.chunk_index]) {
+            file->received[chunk.chunk_index] = 1;
+            ++file->received_count;
+        }
+        auto it = file->duplicates.find(chunk.chunk_index);
+        if (it != file->duplicates.end()) {
+            copies = std::move(it->second);
+            file->duplicates.erase(it);
+        }
+        chunks_received_.fetch_add(1, std::memory_order_relaxed);
+        bytes_received_.fetch_add(chunk.length, std::memory_order_relaxed);
+    }
+    // 清单内内容相同的后续分块直接复制
+    for (uint32_t index : copies) {
+        if (file->output.is_open()) {
+            file->output.write_at(data, chunk.length, file->chunk_offsets[index]);
+        }
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        if (!file->received[index]) {
+            file->received[index] = 1;
+            ++file->received_count;
+        }
+    }
+    chunks_deduplicated_.fetch_add(copies.size(), std::memory_order_relaxed);
+    bytes_deduplicated_.fetch_add(static_cast<uint64_t>(chunk.length) * copies.size(), std::memory_order_relaxed);
+    make_ack(reply, chunk.file_id, chunk.chunk_index, status);
+    return true;
+}
+
+bool Lusp_LoopbackChunkReceiver::handle_file_end(const uint8_t* payload, size_t size, std::vector<uint8_t>& reply) {
+    if (size != kFileEndSize) {
+        return false;
+    }
+    FileEnd end;
+    decode_file_end(payload, end);
+
+    AckStatus status = AckStatus::Ok;
+    std::shared_ptr<ReceiveFile> file;
+    {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        auto it = files_.find(end.file_id);
+        if (it == files_.end()) {
+            status = AckStatus::UnknownFile;
+        }
+        else if (it->second->received_count != it->second->chunk_count || end.chunk_count != it->second->chunk_count) {
+            status = AckStatus::Incomplete;
+        }
+        else {
+            file = std::move(it->second);
+            files_.erase(it);
+        }
+    }
+    if (status == AckStatus::Ok) {
+        if (!file->manifest.empty()) {
+            store_.add_file(file->path, file->manifest.data(), file->chunk_count);
+        }
+        files_completed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    make_ack(reply, end.file_id, kControlIndex, status);
+    return true;
+}
+
+bool Lusp_LoopbackChunkReceiver::handle_pack(uint16_t flags, const uint8_t* payload, size_t size, Lusp_PackReader& pack,
+    std::vector<uint8_t>& reply) {
+    if (!pack.parse(payload, size)) {
+        return false;
+    }
+    // 先校验全部文件，摘要不符时整个容器重发
+    if (config_.verify_checksum && (flags & kFlagDigest)) {
+        for (const auto& file : pack.files()) {
+            if (chunk_digest(file.data, file.size) != file.digest) {
+                digest_errors_.fetch_add(1, std::memory_order_relaxed);
+                make_ack(reply, pack.pack_id(), kControlIndex, AckStatus::DigestMismatch);
+                return true;
+            }
+        }
+    }
+    AckStatus status = AckStatus::Ok;
+    if (!config_.output_dir.empty()) {
+        for (const auto& file : pack.files()) {
+            auto leaf = std::filesystem::u8path(std::string(file.name, file.name_length)).filename();
+            if (leaf.empty() || leaf == "." || leaf == "..") {
+                leaf = std::to_string(file.file_id);
+            }
+            const auto path = std::filesystem::u8path(config_.output_dir) / leaf;
+            Lusp_PositionalFile output;
+            if (!output.open_write(path_to_utf8(path)) || !output.truncate(file.size) ||
+                (file.size > 0 && !output.write_at(file.data, file.size, 0))) {
+                g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR,
+                    "Loopback receiver failed to write " + path_to_utf8(path) + " (error " + std::to_string(output.last_error()) + ")");
+                status = AckStatus::Failed;
+                break;
+            }
+        }
+    }
+    if (status == AckStatus::Ok) {
+        packs_received_.fetch_add(1, std::memory_order_relaxed);
+        files_completed_.fetch_add(pack.files().size(), std::memory_order_relaxed);
+        bytes_received_.fetch_add(pack.data_size(), std::memory_order_relaxed);
+    }
+    make_ack(reply, pack.pack_id(), kControlIndex, status);
+    return true;
+}
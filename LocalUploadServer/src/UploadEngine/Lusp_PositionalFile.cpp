@@ -0,0 +1,259 @@
+#include "UploadEngine/Lusp_PositionalFile.h"
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Lusp_PositionalFile::~Lusp_PositionalFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+namespace {
+    HANDLE open_handle(const std::string& path, DWORD access, DWORD disposition) {
+        const std::wstring wide = std::filesystem::u8path(path).wstring();
+        return CreateFileW(wide.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, disposition, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    }
+}
+
+bool Lusp_PositionalFile::open_read(const std::string& path) {
+    close();
+    HANDLE handle = open_handle(path, GENERIC_READ, OPEN_EXISTING);
+    if (handle == INVALID_HANDLE_VALUE) {
+        last_error_ = static_cast<int>(GetLastError());
+        return false;
+    }
+    handle_ = handle;
+    return true;
+}
+
+bool Lusp_PositionalFile::open_write(const std::string& path) {
+    close();
+    HANDLE handle = open_handle(path, GENERIC_READ | GENERIC_WRITE, OPEN_ALWAYS);
+    if (handle == INVALID_HANDLE_VALUE) {
+        last_error_ = static_cast<int>(GetLastError());
+        return false;
+    }
+    handle_ = handle;
+    return true;
+}
+
+void Lusp_PositionalFile::close() {
+    if (handle_) {
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+    }
+}
+
+bool Lusp_PositionalFile::is_open() const {
+    return handle_ != nullptr;
+}
+
+bool Lusp_PositionalFile::size(uint64_t& out) const {
+    LARGE_INTEGER value;
+    if (!GetFileSizeEx(static_cast<HANDLE>(handle_), &value)) {
+        last_error_ = static_cast<int>(GetLastError());
+        return false;
+    }
+    out = static_cast<uint64_t>(value.QuadPart);
+    return true;
+}
+
+bool Lusp_PositionalFile::read_at(void* buffer, size_t length, uint64_t offset) const {
+    auto* out = static_cast<uint8_t*>(buffer);
+    while (length > 0) {
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD request = static_cast<DWORD>(length > 0x40000000 ? 0x40000000 : length);
+        DWORD done = 0;
+        if (!ReadFile(static_cast<HANDLE>(handle_), out, request, &done, &overlapped) || done == 0) {
+            last_error_ = static_cast<int>(GetLastError());
+            return false;
+        }
+        out += done;
+        offset += done;
+        length -= done;
+    }
+    return true;
+}
+
+bool Lusp_PositionalFile::write_at(const void* buffer, size_t length, uint64_t offset) const {
+    const auto* in = static_cast<const uint8_t*>(buffer);
+    while (length > 0) {
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD request = static_cast<DWORD>(length > 0x40000000 ? 0x40000000 : length);
+        DWORD done = 0;
+        if (!WriteFile(static_cast<HANDLE>(handle_), in, request, &done, &overlapped) || done == 0) {
+            last_error_ = static_cast<int>(GetLastError());
+            return false;
+        }
+        in += done;
+        offset += done;
+        length -= done;
+    }
+    return true;
+}
+
+bool Lusp_PositionalFile::truncate(uint64_t length) const {
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(length);
+    if (!SetFileInformationByHandle(static_cast<HANDLE>(handle_), FileEndOfFileInfo, &info, sizeof(info))) {
+        last_error_ = static_cast<int>(GetLastError());
+        return false;
+    }
+    return true;
+}
+
+bool Lusp_PositionalFile::preallocate(uint64_t length) const {
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = static_cast<LONGLONG>(length);
+    // 预留失败(如 FAT32/网络盘)不影响写入，继续设置文件长度
+    SetFileInformationByHandle(static_cast<HANDLE>(handle_), FileAllocationInfo, &info, sizeof(info));
+    return truncate(length);
+}
+
+bool Lusp_PositionalFile::sync() const {
+    if (!FlushFileBuffers(static_cast<HANDLE>(handle_))) {
+        last_error_ = static_cast<int>(GetLastError());
+        return false;
+    }
+    return true;
+}
+
+#else
+
+bool Lusp_PositionalFile::open_read(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        last_error_ = errno;
+        return false;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    fd_ = fd;
+    return true;
+}
+
+bool Lusp_PositionalFile::open_write(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        last_error_ = errno;
+        return false;
+    }
+    fd_ = fd;
+    return true;
+}
+
+void Lusp_PositionalFile::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool Lusp_PositionalFile::is_open() const {
+    return fd_ >= 0;
+}
+
+bool Lusp_PositionalFile::size(uint64_t& out) const {
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        last_error_ = errno;
+        return false;
+    }
+    out = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+bool Lusp_PositionalFile::read_at(void* buffer, size_t length, uint64_t offset) const {
+    auto* out = static_cast<uint8_t*>(buffer);
+    while (length > 0) {
+        ssize_t done = ::pread(fd_, out, length, static_cast<off_t>(offset));
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            last_error_ = errno;
+            return false;
+        }
+        if (done == 0) {
+            last_error_ = EIO;  // 文件在上传期间被截断
+            return false;
+        }
+        out += done;
+        offset += static_cast<uint64_t>(done);
+        length -= static_cast<size_t>(done);
+    }
+    return true;
+}
+
+bool Lusp_PositionalFile::write_at(const void* buffer, size_t length, uint64_t offset) const {
+    const auto* in = static_cast<const uint8_t*>(buffer);
+    while (length > 0) {
+        ssize_t done = ::pwrite(fd_, in, length, static_cast<off_t>(offset));
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            last_error_ = errno;
+            return false;
+        }
+        in += done;
+        offset += static_cast<uint64_t>(done);
+        length -= static_cast<size_t>(done);
+    }
+    return true;
+}
+
+bool Lusp_PositionalFile::truncate(uint64_t length) const {
+    if (::ftruncate(fd_, static_cast<off_t>(length)) != 0) {
+        last_error_ = errno;
+        return false;
+    }
+    return true;
+}
+
+bool Lusp_PositionalFile::preallocate(uint64_t length) const {
+    if (length == 0) {
+        return truncate(0);
+    }
+#if defined(__linux__)
+    if (::fallocate(fd_, 0, 0, static_cast<off_t>(length)) == 0) {
+        return truncate(length);    // 复用的旧文件可能比 length 长
+    }
+    if (errno != EOPNOTSUPP && errno != ENOSYS) {
+        last_error_ = errno;
+        return false;
+    }
+#endif
+    return truncate(length);
+}
+
+bool Lusp_PositionalFile::sync() const {
+#if defined(__APPLE__)
+    const int result = ::fsync(fd_);
+#else
+    const int result = ::fdatasync(fd_);
+#endif
+    if (result != 0) {
+        last_error_ = errno;
+        return false;
+    }
+    return true;
+}
+
+#endif
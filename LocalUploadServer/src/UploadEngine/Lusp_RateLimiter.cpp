@@ -0,0 +1,108 @@
+#include "UploadEngine/Lusp_RateLimiter.h"
+#include <algorithm>
+#include <ctime>
+
+namespace {
+    bool is_limited(const Lusp_RateLimits& limits) {
+        return limits.global_speed != 0 || limits.device_speed != 0 || limits.file_speed != 0;
+    }
+
+    int64_t steady_now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+// ---- Lusp_TokenBucket ----
+int64_t Lusp_TokenBucket::reserve(uint64_t bytes, uint64_t rate, int64_t burst_ns, int64_t now_ns) {
+    if (rate == 0) {
+        return 0;
+    }
+    // 分块不超过 64MB，bytes * 1e9 不会溢出
+    const int64_t cost = static_cast<int64_t>(bytes * 1000000000ull / rate);
+    int64_t tat = tat_ns_.load(std::memory_order_relaxed);
+    for (;;) {
+        const int64_t base = std::max(tat, now_ns - burst_ns);
+        if (tat_ns_.compare_exchange_weak(tat, base + cost, std::memory_order_relaxed)) {
+            return std::max<int64_t>(0, base - now_ns);
+        }
+    }
+}
+
+// ---- Lusp_RateLimiter ----
+Lusp_RateLimiter::Lusp_RateLimiter(const Lusp_RateLimits& defaults, const std::vector<Lusp_RateWindow>& schedule, uint32_t burst_ms)
+    : defaults_(defaults),
+    schedule_(schedule),
+    burst_ns_(static_cast<int64_t>(burst_ms) * 1000000),
+    enabled_(is_limited(defaults) || std::any_of(schedule.begin(), schedule.end(),
+        [](const Lusp_RateWindow& window) { return is_limited(window.limits); })) {
+    refresh(steady_now_ns());
+}
+
+std::shared_ptr<Lusp_TokenBucket> Lusp_RateLimiter::device_bucket(const std::string& device) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    auto& bucket = devices_[device];
+    if (!bucket) {
+        bucket = std::make_shared<Lusp_TokenBucket>();
+    }
+    return bucket;
+}
+
+std::chrono::nanoseconds Lusp_RateLimiter::acquire(uint64_t bytes, Lusp_TokenBucket* device, Lusp_TokenBucket& file) {
+    const int64_t now = steady_now_ns();
+    refresh(now);
+    int64_t wait = global_.reserve(bytes, global_speed_.load(std::memory_order_relaxed), burst_ns_, now);
+    if (device) {
+        wait = std::max(wait, device->reserve(bytes, device_speed_.load(std::memory_order_relaxed), burst_ns_, now));
+    }
+    wait = std::max(wait, file.reserve(bytes, file_speed_.load(std::memory_order_relaxed), burst_ns_, now));
+    if (wait > 0) {
+        throttled_chunks_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return std::chrono::nanoseconds(wait);
+}
+
+Lusp_RateLimits Lusp_RateLimiter::current_limits() {
+    refresh(steady_now_ns());
+    Lusp_RateLimits limits;
+    limits.global_speed = global_speed_.load(std::memory_order_relaxed);
+    limits.device_speed = device_speed_.load(std::memory_order_relaxed);
+    limits.file_speed = file_speed_.load(std::memory_order_relaxed);
+    return limits;
+}
+
+Lusp_RateLimits Lusp_RateLimiter::limits_at(const Lusp_RateLimits& defaults, const std::vector<Lusp_RateWindow>& schedule,
+    int weekday, int minute_of_day) {
+    for (const auto& window : schedule) {
+        if (!(window.weekdays & (1u << weekday))) {
+            continue;
+        }
+        const bool inside = window.begin_minute <= window.end_minute
+            ? minute_of_day >= window.begin_minute && minute_of_day < window.end_minute
+            : minute_of_day >= window.begin_minute || minute_of_day < window.end_minute;
+        if (inside) {
+            return window.limits;
+        }
+    }
+    return defaults;
+}
+
+void Lusp_RateLimiter::refresh(int64_t now_ns) {
+    int64_t next = next_refresh_ns_.load(std::memory_order_relaxed);
+    if (now_ns < next || !next_refresh_ns_.compare_exchange_strong(next, now_ns + kRefreshIntervalNs, std::memory_order_relaxed)) {
+        return;
+    }
+    Lusp_RateLimits limits = defaults_;
+    if (!schedule_.empty()) {
+        const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        limits = limits_at(defaults_, schedule_, local.tm_wday, local.tm_hour * 60 + local.tm_min);
+    }
+    global_speed_.store(limits.global_speed, std::memory_order_relaxed);
+    device_speed_.store(limits.device_speed, std::memory_order_relaxed);
+    file_speed_.store(limits.file_speed, std::memory_order_relaxed);
+}
@@ -0,0 +1,158 @@
+#include "UploadEngine/Lusp_Sha256.h"
+#include <cstring>
+#include "hash-library/sha256.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LUSP_SHA256_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define LUSP_SHA_TARGET
+#else
+#include <cpuid.h>
+#define LUSP_SHA_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+#endif
+
+namespace {
+#ifdef LUSP_SHA256_X86
+    alignas(16) const uint32_t kRoundConstants[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    };
+
+    bool detect_sha_ni() {
+        int leaf1[4] = {};
+        int leaf7[4] = {};
+#ifdef _MSC_VER
+        __cpuid(leaf1, 0);
+        if (leaf1[0] < 7) {
+            return false;
+        }
+        __cpuidex(leaf1, 1, 0);
+        __cpuidex(leaf7, 7, 0);
+#else
+        unsigned int a, b, c, d;
+        if (!__get_cpuid_count(1, 0, &a, &b, &c, &d)) {
+            return false;
+        }
+        leaf1[2] = static_cast<int>(c);
+        if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+            return false;
+        }
+        leaf7[1] = static_cast<int>(b);
+#endif
+        const bool ssse3 = (leaf1[2] & (1 << 9)) != 0;
+        const bool sse41 = (leaf1[2] & (1 << 19)) != 0;
+        const bool sha = (leaf7[1] & (1 << 29)) != 0;
+        return ssse3 && sse41 && sha;
+    }
+
+    /**
+     * @brief SHA-NI 压缩函数，每 4 轮一组：消息扩展用 sha256msg1/msg2，轮函数用 sha256rnds2
+     */
+    LUSP_SHA_TARGET void compress_sha_ni(uint32_t state[8], const uint8_t* data, size_t blocks) {
+        const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+        // 状态字重排为指令要求的 ABEF / CDGH
+        __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+        __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+        tmp = _mm_shuffle_epi32(tmp, 0xB1);
+        state1 = _mm_shuffle_epi32(state1, 0x1B);
+        __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+        state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+        for (; blocks > 0; --blocks, data += 64) {
+            const __m128i abef = state0;
+            const __m128i cdgh = state1;
+            __m128i words[4];
+            for (int group = 0; group < 16; ++group) {
+                __m128i& w = words[group & 3];
+                if (group < 4) {
+                    w = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + group * 16)), byte_swap);
+                }
+                else {
+                    // W[t] = σ1(W[t-2]) + W[t-7] + σ0(W[t-15]) + W[t-16]
+                    const __m128i& w1 = words[(group - 1) & 3];
+                    const __m128i& w2 = words[(group - 2) & 3];
+                    const __m128i& w3 = words[(group - 3) & 3];
+                    w = _mm_sha256msg1_epu32(w, w3);
+                    w = _mm_add_epi32(w, _mm_alignr_epi8(w1, w2, 4));
+                    w = _mm_sha256msg2_epu32(w, w1);
+                }
+                __m128i message = _mm_add_epi32(w, _mm_load_si128(reinterpret_cast<const __m128i*>(&kRoundConstants[group * 4])));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+                message = _mm_shuffle_epi32(message, 0x0E);
+                state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+            }
+            state0 = _mm_add_epi32(state0, abef);
+            state1 = _mm_add_epi32(state1, cdgh);
+        }
+
+        tmp = _mm_shuffle_epi32(state0, 0x1B);
+        state1 = _mm_shuffle_epi32(state1, 0xB1);
+        state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+        state1 = _mm_alignr_epi8(state1, tmp, 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+    }
+
+    void digest_sha_ni(const uint8_t* data, size_t size, uint8_t out[Lusp_Sha256::kDigestSize]) {
+        uint32_t state[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+        };
+        const size_t full_blocks = size / 64;
+        compress_sha_ni(state, data, full_blocks);
+
+        // 尾部 + 0x80 + 补零 + 64 位比特长度(大端)，共 1 或 2 块
+        uint8_t tail[128] = {};
+        const size_t rest = size - full_blocks * 64;
+        if (rest) {
+            std::memcpy(tail, data + full_blocks * 64, rest);
+        }
+        tail[rest] = 0x80;
+        const size_t tail_size = rest < 56 ? 64 : 128;
+        const uint64_t bits = static_cast<uint64_t>(size) * 8;
+        for (int i = 0; i < 8; ++i) {
+            tail[tail_size - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        compress_sha_ni(state, tail, tail_size / 64);
+
+        for (int i = 0; i < 8; ++i) {
+            out[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+            out[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+            out[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+            out[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+        }
+    }
+#endif
+
+    const bool kAccelerated =
+#ifdef LUSP_SHA256_X86
+        detect_sha_ni();
+#else
+        false;
+#endif
+}
+
+void Lusp_Sha256::digest(const void* data, size_t size, uint8_t out[kDigestSize]) {
+#ifdef LUSP_SHA256_X86
+    if (kAccelerated) {
+        digest_sha_ni(static_cast<const uint8_t*>(data), size, out);
+        return;
+    }
+#endif
+    SHA256 sha;
+    sha.add(data, size);
+    sha.getHash(out);
+}
+
+bool Lusp_Sha256::accelerated() {
+    return kAccelerated;
+}
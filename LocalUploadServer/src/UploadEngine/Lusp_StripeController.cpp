@@ -0,0 +1,56 @@
+#include "UploadEngine/Lusp_StripeController.h"
+#include <algorithm>
+
+Lusp_StripeController::Lusp_StripeController(uint32_t initial, uint32_t max)
+    : stripes_(std::clamp<uint32_t>(initial, 1, std::max<uint32_t>(max, 1))), max_(std::max<uint32_t>(max, 1)), warmup_(stripes_) {}
+
+void Lusp_StripeController::restart_window(Clock::time_point now) {
+    window_chunks_ = 0;
+    window_bytes_ = 0;
+    window_start_ = now;
+    limited_ = false;
+}
+
+Lusp_StripeController::Decision Lusp_StripeController::on_chunk_acked(uint64_t bytes, Clock::time_point now) {
+    if (warmup_ > 0) {
+        // 这些分块在条带数改变前就已分派，不计入新窗口
+        if (--warmup_ == 0) {
+            restart_window(now);
+        }
+        return Decision::None;
+    }
+    ++window_chunks_;
+    window_bytes_ += bytes;
+    if (window_chunks_ < std::max(kMinWindowChunks, 2 * stripes_)) {
+        return Decision::None;
+    }
+
+    const double seconds = std::chrono::duration<double>(now - window_start_).count();
+    const double rate = seconds > 0 ? window_bytes_ / seconds : 0;
+    const bool limited = limited_;
+    last_rate_ = rate;
+    restart_window(now);
+
+    if (probing_) {
+        probing_ = false;
+        const double per_stripe = base_rate_ / (stripes_ - 1);
+        if (rate < base_rate_ + kMinGain * per_stripe) {
+            --stripes_;
+            hold_windows_ = kProbeInterval;
+            warmup_ = stripes_;
+            return Decision::Decreased;
+        }
+    }
+    else if (hold_windows_ > 0) {
+        --hold_windows_;
+        return Decision::None;
+    }
+    if (limited && stripes_ < max_) {
+        base_rate_ = rate;
+        ++stripes_;
+        probing_ = true;
+        warmup_ = stripes_;
+        return Decision::Increased;
+    }
+    return Decision::None;
+}
@@ -0,0 +1,356 @@
+#include "UploadEngine/Lusp_WorkStealingPool.h"
+#include <algorithm>
+#include <exception>
+#include <string>
+#include "log_headers.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    // 当前线程所属的线程池与工作线程下标(池外线程为 nullptr)
+    thread_local Lusp_WorkStealingPool* t_pool = nullptr;
+    thread_local size_t t_worker_index = 0;
+
+    uint64_t next_random(uint64_t& state) {
+        // xorshift64*，只用于挑选窃取对象
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+}
+
+// ---- Lusp_WorkStealingDeque ----
+
+Lusp_WorkStealingDeque::Lusp_WorkStealingDeque(size_t capacity) {
+    size_t rounded = 1;
+    while (rounded < std::max<size_t>(capacity, 2)) {
+        rounded <<= 1;
+    }
+    rings_.push_back(std::make_unique<Ring>(rounded));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+}
+
+Lusp_WorkStealingDeque::~Lusp_WorkStealingDeque() {
+    // 剩余任务由线程池在 stop 中取出执行，这里只释放数组
+}
+
+Lusp_WorkStealingDeque::Ring* Lusp_WorkStealingDeque::grow(Ring* ring, int64_t bottom, int64_t top) {
+    auto bigger = std::make_unique<Ring>(ring->capacity() * 2);
+    for (int64_t i = top; i < bottom; ++i) {
+        bigger->put(i, ring->get(i));
+    }
+    Ring* result = bigger.get();
+    rings_.push_back(std::move(bigger));
+    ring_.store(result, std::memory_order_release);
+    return result;
+}
+
+void Lusp_WorkStealingDeque::push(Lusp_PoolTask* task) {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_acquire);
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    if (bottom - top > static_cast<int64_t>(ring->capacity()) - 1) {
+        ring = grow(ring, bottom, top);
+    }
+    ring->put(bottom, task);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+Lusp_PoolTask* Lusp_WorkStealingDeque::pop() {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+        // 空
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Lusp_PoolTask* task = ring->get(bottom);
+    if (top == bottom) {
+        // 最后一项，与窃取者竞争
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            task = nullptr;
+        }
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+Lusp_PoolTask* Lusp_WorkStealingDeque::steal() {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+        return nullptr;
+    }
+    Ring* ring = ring_.load(std::memory_order_acquire);
+    Lusp_PoolTask* task = ring->get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return task;
+}
+
+// ---- Lusp_WorkStealingPool ----
+
+Lusp_WorkStealingPool::Lusp_WorkStealingPool(const Lusp_WorkStealingPoolConfig& config)
+    : config_(config) {
+    uint32_t count = config_.thread_count;
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    config_.thread_count = count;
+    for (uint32_t i = 0; i < count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+        workers_.back()->steal_seed = 0x9E3779B97F4A7C15ull * (i + 1);
+    }
+    // 所有 Worker 建好后再启动线程，窃取时不会看到未初始化的队列
+    for (uint32_t i = 0; i < count; ++i) {
+        threads_.emplace_back(&Lusp_WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+Lusp_WorkStealingPool::~Lusp_WorkStealingPool() {
+    stop();
+    // asio 服务(如 strand)可能持有投递到本池的处理器，先于本池的成员销毁
+    shutdown();
+    destroy();
+}
+
+void Lusp_WorkStealingPool::stop() {
+    {
+        // 与 push 在同一把锁下修改: 此后池外线程提交的任务就地执行，之前进入注入队列的由下面取出
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (!running_.exchange(false, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_all();
+    }
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    // 线程都已退出，队列里剩下的任务在本线程上执行完(等待它们的 Lusp_TaskGroup 不会永远阻塞)
+    for (size_t level = 0; level < kTaskPriorityCount; ++level) {
+        for (auto& worker : workers_) {
+            while (Lusp_PoolTask* task = worker->deques[level].steal()) {
+                run_task(task);
+            }
+        }
+        while (Lusp_PoolTask* task = take_injected(level)) {
+            run_task(task);
+        }
+    }
+    pending_.store(0, std::memory_order_relaxed);
+}
+
+bool Lusp_WorkStealingPool::in_worker_thread() const {
+    return t_pool == this;
+}
+
+void Lusp_WorkStealingPool::push(Lusp_PoolTask* task, Lusp_TaskPriority priority) {
+    const size_t level = static_cast<size_t>(priority);
+    submitted_[level].fetch_add(1, std::memory_order_relaxed);
+    if (t_pool == this) {
+        // 工作线程退出前压入的任务都由 stop 在 join 之后取出执行
+        workers_[t_worker_index]->deques[level].push(task);
+    }
+    else {
+        std::unique_lock<std::mutex> lock(inject_mutex_);
+        if (!running_.load(std::memory_order_acquire)) {
+            // 已停止：就地执行
+            lock.unlock();
+            run_task(task);
+            return;
+        }
+        injected_[level].push_back(task);
+        injected_count_.fetch_add(1, std::memory_order_release);
+        injected_total_.fetch_add(1, std::memory_order_relaxed);
+    }
+    pending_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_one();
+    }
+}
+
+Lusp_PoolTask* Lusp_WorkStealingPool::take_injected(size_t priority) {
+    if (injected_count_.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(inject_mutex_);
+    auto& queue = injected_[priority];
+    if (queue.empty()) {
+        return nullptr;
+    }
+    Lusp_PoolTask* task = queue.front();
+    queue.pop_front();
+    injected_count_.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+Lusp_PoolTask* Lusp_WorkStealingPool::find_task(size_t index, bool& stolen) {
+    Worker& self = *workers_[index];
+    const size_t count = workers_.size();
+    for (size_t level = 0; level < kTaskPriorityCount; ++level) {
+        if (Lusp_PoolTask* task = self.deques[level].pop()) {
+            stolen = false;
+            return task;
+        }
+        if (Lusp_PoolTask* task = take_injected(level)) {
+            stolen = false;
+            return task;
+        }
+        // 从随机位置开始依次尝试其他线程，避免所有空闲线程同时挤向同一个队列
+        const size_t start = count > 1 ? static_cast<size_t>(next_random(self.steal_seed) % count) : 0;
+        for (size_t offset = 0; offset < count; ++offset) {
+            const size_t victim = (start + offset) % count;
+            if (victim == index) {
+                continue;
+            }
+            if (Lusp_PoolTask* task = workers_[victim]->deques[level].steal()) {
+                stolen = true;
+                return task;
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool Lusp_WorkStealingPool::run_one() {
+    if (t_pool != this) {
+        return false;
+    }
+    bool stolen = false;
+    Lusp_PoolTask* task = find_task(t_worker_index, stolen);
+    if (!task) {
+        return false;
+    }
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    Worker& self = *workers_[t_worker_index];
+    self.executed.fetch_add(1, std::memory_order_relaxed);
+    if (stolen) {
+        self.stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+    run_task(task);
+    return true;
+}
+
+void Lusp_WorkStealingPool::run_task(Lusp_PoolTask* task) {
+    try {
+        task->run();
+    }
+    catch (const std::exception& e) {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR, std::string("Thread pool task threw: ") + e.what());
+    }
+    catch (...) {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR, "Thread pool task threw an unknown exception");
+    }
+    delete task;
+}
+
+void Lusp_WorkStealingPool::worker_loop(size_t index) {
+    t_pool = this;
+    t_worker_index = index;
+    if (config_.pin_threads) {
+        pin_current_thread(index);
+    }
+    uint32_t idle_rounds = 0;
+    while (running_.load(std::memory_order_acquire)) {
+        if (run_one()) {
+            idle_rounds = 0;
+            continue;
+        }
+        if (idle_rounds++ < config_.spin_rounds) {
+            std::this_thread::yield();
+            continue;
+        }
+        idle_rounds = 0;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        if (pending_.load(std::memory_order_seq_cst) <= 0 && running_.load(std::memory_order_acquire)) {
+            parked_.fetch_add(1, std::memory_order_relaxed);
+            sleep_cv_.wait(lock, [this]() {
+                return pending_.load(std::memory_order_seq_cst) > 0 || !running_.load(std::memory_order_acquire);
+            });
+        }
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    t_pool = nullptr;
+}
+
+void Lusp_WorkStealingPool::pin_current_thread(size_t index) const {
+    const size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    const size_t cpu = index % cpus;
+#ifdef _WIN32
+    if (cpu < sizeof(DWORD_PTR) * 8) {
+        SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu);
+    }
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+Lusp_WorkStealingPoolStats Lusp_WorkStealingPool::get_statistics() const {
+    Lusp_WorkStealingPoolStats stats;
+    stats.threads = static_cast<uint32_t>(workers_.size());
+    for (const auto& worker : workers_) {
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+    }
+    stats.injected = injected_total_.load(std::memory_order_relaxed);
+    stats.parked = parked_.load(std::memory_order_relaxed);
+    for (size_t level = 0; level < kTaskPriorityCount; ++level) {
+        stats.submitted[level] = submitted_[level].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+// ---- Lusp_TaskGroup ----
+
+void Lusp_TaskGroup::wait() {
+    join();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error.swap(error_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void Lusp_TaskGroup::join() {
+    if (pool_ && pool_->in_worker_thread()) {
+        // 工作线程上边等边做，本组的任务可能就在自己的队列里
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (pending_ == 0) {
+                    return;
+                }
+            }
+            if (!pool_->run_one()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() { return pending_ == 0; });
+}
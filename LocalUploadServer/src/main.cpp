@@ -1,13 +1,19 @@
 #include "AsioLoopbackIpcServer/Lusp_AsioLoopbackIpcServer.h"
+#include "Config/Lusp_ServerConfigLoader.h"
+#include "UploadEngine/Lusp_BackgroundUploader.h"
+#include "UploadEngine/Lusp_WorkStealingPool.h"
 #include "upload_file_info_generated.h"
 #include "flatbuffers/flatbuffers.h"
 #include "stl_headers.h"
+#include <filesystem>
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include "log_headers.h"
 #include "log/LightLogWriteImpl.h"
 #include "tabulate/tabulate.hpp"
 
-void on_flatbuffer_message(const void* data, size_t size) {
+void on_flatbuffer_message(const void* data, size_t size, Lusp_BackgroundUploader& uploader) {
     flatbuffers::Verifier verifier(reinterpret_cast<const uint8_t*>(data), size);
     if (UploadClient::Sync::VerifyFBS_SyncUploadFileInfoBuffer(verifier)) {
         auto fb_msg = UploadClient::Sync::GetFBS_SyncUploadFileInfo(data);
@@ -15,7 +21,7 @@ void on_flatbuffer_message(const void* data, size_t size) {
         //std::cout << "[FlatBuffer] file_name: " << native_msg->s_file_full_name_value << std::endl;
         tabulate::Table table;
         table.add_row({
-            "ClientDevice", "UploadFileType", "SyncFileFullName", "SyncFileOnlyName",
+            "FileId", "ClientDevice", "UploadFileType", "SyncFileFullName", "SyncFileOnlyName",
             "SyncFileSizeVaule", "SyncFileRecordTime", "SyncFileMd5ValueInfo",
             "FileExistPolicyValue", "SyncAuthTokenValue", "SyncUploadTimeStamp",
             "UploadStatusInf", "DescriptionInfo"
@@ -24,13 +30,16 @@ void on_flatbuffer_message(const void* data, size_t size) {
             .font_style({ tabulate::FontStyle::bold })
             .font_align({ tabulate::FontAlign::center });
         table.add_row({
+            std::to_string(native_msg->u_file_id),
             native_msg->s_lan_client_device,
             std::to_string(native_msg->e_upload_file_typed),
             LUSP_UNICONV->ToLocaleFromUtf8(native_msg->s_file_full_name_value),
             LUSP_UNICONV->ToLocaleFromUtf8(native_msg->s_only_file_name_value),
             std::to_string(native_msg->s_sync_file_size_value),
             native_msg->s_file_record_time_value,
-            native_msg->s_file_md5_value_info,
+            native_msg->u_chunk_size != 0
+                ? "chunk(" + std::to_string(native_msg->u_chunk_size) + "):" + native_msg->s_chunk_root_digest
+                : native_msg->s_file_md5_value_info,
             std::to_string(native_msg->e_file_exist_policy),
             native_msg->s_auth_token_values,
             std::to_string(native_msg->e_upload_status_inf),
@@ -38,27 +47,87 @@ void on_flatbuffer_message(const void* data, size_t size) {
             native_msg->s_description_info
         });
         std::cout << table << std::endl;
+
+        Lusp_UploadTask task;
+        task.file_id = native_msg->u_file_id;
+        task.file_path = native_msg->s_file_full_name_value;
+        // 远端按 "<设备>/<源文件路径>" 存放，不同设备、不同目录下的同名文件互不覆盖
+        task.remote_name = (native_msg->s_lan_client_device.empty() ? std::string("unknown") : native_msg->s_lan_client_device) +
+            "/" + native_msg->s_file_full_name_value;
+        task.client_device = native_msg->s_lan_client_device;
+        task.file_type = native_msg->e_upload_file_typed <= UploadClient::Sync::FBS_SyncUploadFileTyped_MAX
+            ? static_cast<Lusp_UploadFileTyped>(native_msg->e_upload_file_typed)
+            : Lusp_UploadFileTyped::LUSP_UPLOADTYPE_UNDEFINED;
+        task.payload_compressed = native_msg->b_payload_compressed;
+        // 分块 MD5 由引擎在读取时逐块比对，文件在入队后被改写则上传失败
+        task.chunk_hash_size = native_msg->u_chunk_size;
+        task.chunk_digests = std::move(native_msg->v_chunk_digests);
+        task.chunk_root_digest = native_msg->s_chunk_root_digest;
+        if (!uploader.submit(task)) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, "Upload engine not running, dropped file id " + std::to_string(task.file_id));
+        }
     } else {
         std::cout << "[Callback] 收到未知或非法FlatBuffer消息" << std::endl;
     }
 }
+// 相对于工作目录
+constexpr const char* kServerConfigPath = "config/server_config.toml";
+
 void run_server() {
     asio::io_context io_context;
 	Lusp_AsioIpcConfig config;
-    // 注册回调
+
+    // 后台上传引擎：[upload] 表覆盖默认值，配置有误时不启动
+    Lusp_UploadEngineConfig upload_config;
+    std::error_code exists_error;
+    if (!std::filesystem::exists(kServerConfigPath, exists_error)) {
+        g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_WARN, std::string(kServerConfigPath) + " not found, using default upload settings");
+    }
+    else {
+        std::string config_error;
+        if (!load_upload_engine_config(kServerConfigPath, upload_config, config_error)) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_FATAL, std::string("Invalid ") + kServerConfigPath + ": " + config_error);
+            std::cerr << "[LocalUploadServer] Invalid " << kServerConfigPath << ": " << config_error << std::endl;
+            return;
+        }
+    }
+    // CPU 线程池：上传引擎的校验/压缩/指纹与 IPC 消息处理共用
+    Lusp_WorkStealingPoolConfig pool_config;
+    pool_config.thread_count = upload_config.cpu_threads;
+    pool_config.pin_threads = upload_config.pin_cpu_threads;
+    auto cpu_pool = std::make_shared<Lusp_WorkStealingPool>(pool_config);
+    Lusp_BackgroundUploader uploader(upload_config, cpu_pool);
+    uploader.set_complete_callback([](uint64_t file_id, bool success, const std::string& message) {
+        if (success) {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_OK, "Upload completed, file id " + std::to_string(file_id));
+        }
+        else {
+            g_LogAsioLoopbackIpcServer.WriteLogContent(LOG_ERROR, "Upload failed, file id " + std::to_string(file_id) + ": " + message);
+        }
+        });
+    uploader.start();
+
+    // 注册回调：校验、解包与打印投递到线程池上的 strand 执行(保持消息顺序)，I/O 线程立即回去读下一帧
+    auto message_strand = asio::make_strand(cpu_pool->get_executor());
     Lusp_AsioLoopbackIpcServer server(io_context, config);
-    server.start([](const std::string& data, std::shared_ptr<asio::ip::tcp::socket>) {
-        on_flatbuffer_message(data.data(), data.size());
+    server.start([&uploader, message_strand](const std::string& data, std::shared_ptr<asio::ip::tcp::socket>) {
+        asio::post(message_strand, [&uploader, data]() {
+            on_flatbuffer_message(data.data(), data.size(), uploader);
+            });
         });
 	std::cout << "[LocalUploadServer] Server started and listening on port " << config.port << std::endl;
     io_context.run();
+    // 先停线程池，把还在 strand 上的消息在上传引擎析构前处理完
+    cpu_pool->stop();
 }
 
 
 
 int main() {
     
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
+#endif
 	initializeLogger();
     // 启动服务器线程
     std::thread server_thread(run_server);
@@ -0,0 +1,63 @@
+#ifndef LUSP_CHUNK_RECEIVER_SERVER_H
+#define LUSP_CHUNK_RECEIVER_SERVER_H
+
+#include "asio/asio.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Lusp_ReceiveFileTable.h"
+
+/**
+ * @brief 接收端配置
+ */
+struct Lusp_ChunkReceiverConfig {
+    std::string address                 = "0.0.0.0";    // 监听地址
+    uint16_t    port                    = 9100;         // 监听端口(与 LocalUploadServer [upload] remote_port 一致)
+    std::string output_dir              = "received";   // 输出目录(UTF-8)
+    bool        preallocate             = true;         // FILE_BEGIN 时 fallocate 预分配
+    bool        verify_checksum         = true;         // 校验分块 CRC32
+    uint32_t    idle_timeout_seconds    = 600;          // 未完成文件的空闲超时，超时后丢弃 .part(有续传日志的保留在磁盘上)
+    uint32_t    journal_flush_chunks    = 64;           // 续传日志每收到多少个分块刷一次盘
+    uint32_t    expire_check_seconds    = 30;           // 空闲检查间隔
+    uint32_t    dedup_entries           = 1u << 20;     // 内容定义分块指纹库条目上限(0=不做跨文件去重)
+};
+
+/**
+ * @brief 分块上传接收端(Asio 异步，多线程跑同一个 io_context)
+ *
+ * 每条连接按 帧头 -> 负载 -> 处理 -> 回 ACK 的顺序循环；连接之间完全并行，
+ * 文件状态集中在 Lusp_ReceiveFileTable 中，同一文件的分块可以来自任意连接。
+ * 线路协议见 LocalUploadServer/include/UploadEngine/Lusp_ChunkProtocol.h。
+ */
+class Lusp_ChunkReceiverServer {
+public:
+    Lusp_ChunkReceiverServer(asio::io_context& io_context, const Lusp_ChunkReceiverConfig& config);
+    ~Lusp_ChunkReceiverServer();
+
+    bool start();
+    void stop();
+
+    uint16_t port() const { return bound_port_; }
+    size_t connection_count() const { return connections_.load(std::memory_order_relaxed); }
+    Lusp_ReceiveStats get_statistics() const { return table_.get_statistics(); }
+
+private:
+    class Session;
+
+    void do_accept();
+    void schedule_expire();
+
+    asio::io_context&           io_context_;
+    Lusp_ChunkReceiverConfig    config_;
+    asio::ip::tcp::acceptor     acceptor_;          // 与 expire_timer_ 共用一个 strand
+    asio::steady_timer          expire_timer_;
+    Lusp_ReceiveFileTable       table_;
+    uint16_t                    bound_port_ = 0;
+    std::atomic<size_t>         connections_{ 0 };
+    std::atomic<bool>           running_{ false };
+};
+
+#endif // LUSP_CHUNK_RECEIVER_SERVER_H
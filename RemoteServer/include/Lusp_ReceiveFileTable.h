@@ -0,0 +1,161 @@
+#ifndef LUSP_RECEIVE_FILE_TABLE_H
+#define LUSP_RECEIVE_FILE_TABLE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "UploadEngine/Lusp_ChunkJournal.h"
+#include "UploadEngine/Lusp_ChunkProtocol.h"
+#include "UploadEngine/Lusp_ChunkStore.h"
+#include "UploadEngine/Lusp_FilePack.h"
+#include "UploadEngine/Lusp_PositionalFile.h"
+
+/**
+ * @brief 接收中的文件
+ *
+ * 数据先写入 "<output_dir>/.<file_id>.part"，所有分块到齐并收到 FILE_END 后改名为最终文件
+ * "<output_dir>/<客户端设备>/<源文件路径>"(见 output_relative_path)。
+ * 发送端请求续传时另建 "<output_dir>/.<file_id>.journal"，进程重启或会话超时后凭它恢复已收分块。
+ * 内容定义分块的文件按清单定位分块，本地已有的分块在 FILE_BEGIN 时直接从其他文件复制。
+ */
+struct Lusp_ReceiveFile {
+    uint64_t                file_id = 0;
+    uint64_t                file_size = 0;
+    uint32_t                chunk_size = 0;
+    uint32_t                chunk_count = 0;
+    std::string             part_path;              // UTF-8
+    std::string             final_path;             // UTF-8
+    Lusp_PositionalFile     output;                 // 多条连接并发 pwrite，不加锁
+    std::unique_ptr<Lusp_ChunkJournal> journal;     // 续传日志，未请求续传时为空(自带锁)
+    std::vector<uint64_t>   chunk_offsets;          // 内容定义分块的起始偏移(chunk_count + 1 个)；固定分块时为空
+    std::vector<uint8_t>    manifest;               // 分块清单，收齐后登记到指纹库
+
+    std::mutex              mutex;                  // 保护以下字段
+    std::vector<uint64_t>   bitmap;                 // 分块到达位图
+    uint32_t                received_count = 0;
+    uint32_t                unflushed = 0;          // 日志中未刷盘的分块数
+    std::vector<uint64_t>   held;                   // 无需发送的分块(内容定义分块的 RESUME 回复)
+    std::unordered_map<uint32_t, std::vector<uint32_t>> duplicates;   // 收到后复制到的清单内重复分块
+    std::chrono::steady_clock::time_point last_activity;
+};
+
+/**
+ * @brief 接收端统计
+ */
+struct Lusp_ReceiveStats {
+    uint64_t    files_started   = 0;
+    uint64_t    files_completed = 0;
+    uint64_t    files_expired   = 0;
+    uint64_t    chunks_received = 0;
+    uint64_t    chunks_duplicate = 0;   // 重发导致的重复分块(已覆盖写入)
+    uint64_t    files_resumed   = 0;    // 从磁盘日志恢复的会话
+    uint64_t    chunks_deduplicated = 0;    // 从本地数据复制、无需发送的分块(含清单内重复的分块)
+    uint64_t    bytes_deduplicated  = 0;
+    uint64_t    packs_received  = 0;    // 小文件容器数(其中的文件计入 files_completed)
+    uint64_t    bytes_received  = 0;
+    uint64_t    digest_errors   = 0;
+    uint64_t    write_errors    = 0;
+    uint64_t    open_files      = 0;
+};
+
+/**
+ * @brief 所有连接共享的文件表(线程安全)
+ *
+ * 同一文件的分块可经任意连接、以任意顺序到达，按偏移直接写入预分配好的文件，
+ * 通过位图判断是否收齐；FILE_BEGIN/FILE_END 的重发是幂等的。
+ */
+class Lusp_ReceiveFileTable {
+public:
+    /**
+     * @param output_dir 输出目录(UTF-8)
+     * @param preallocate FILE_BEGIN 时按文件大小预分配磁盘空间
+     * @param journal_flush_chunks 续传日志每收到多少个分块刷一次盘
+     * @param dedup_entries 分块指纹库条目上限(索引保存在 "<output_dir>/.chunk_index")，0 表示不做跨文件去重
+     */
+    Lusp_ReceiveFileTable(const std::string& output_dir, bool preallocate, uint32_t journal_flush_chunks, size_t dedup_entries);
+    ~Lusp_ReceiveFileTable();
+
+    /**
+     * @param resume 发送端请求续传：内存中没有会话时尝试从磁盘日志恢复，并为会话维护日志
+     * @param manifest 内容定义分块的清单(chunk_count 项)；固定分块时为空
+     */
+    Lusp_ChunkProtocol::AckStatus begin(const Lusp_ChunkProtocol::FileBegin& begin, const std::string& name, bool resume,
+        const uint8_t* manifest = nullptr);
+
+    /**
+     * @brief 已收分块的位图与摘要(回复 RESUME 用)；会话没有日志时位图全零，
+     *        内容定义分块的会话返回无需发送的分块、摘要全零
+     */
+    bool resume_state(uint64_t file_id, std::vector<uint64_t>& bitmap, std::vector<uint32_t>& digests);
+
+    Lusp_ChunkProtocol::AckStatus write_chunk(const Lusp_ChunkProtocol::Chunk& chunk, uint16_t flags,
+        const uint8_t* data, bool verify_checksum);
+
+    Lusp_ChunkProtocol::AckStatus finish(const Lusp_ChunkProtocol::FileEnd& end);
+
+    /**
+     * @brief 解出小文件容器：先校验全部文件的摘要，再按容器顺序逐个写出(每个文件一次写入 .part 后改名)
+     *
+     * 容器不建会话、不预分配、不写日志；确认丢失后的重发整体重写一遍。
+     */
+    Lusp_ChunkProtocol::AckStatus unpack(const Lusp_PackReader& pack, bool verify_checksum);
+
+    /**
+     * @brief 丢弃超过 idle_timeout 没有活动的文件
+     *
+     * 无日志的会话删除 .part；有日志的会话只释放内存，.part 与日志留在磁盘上等待续传。
+     * @return 丢弃的文件数
+     */
+    size_t expire_idle(std::chrono::seconds idle_timeout);
+
+    Lusp_ReceiveStats get_statistics() const;
+
+private:
+    std::shared_ptr<Lusp_ReceiveFile> find(uint64_t file_id);
+    std::shared_ptr<Lusp_ReceiveFile> restore(const Lusp_ChunkProtocol::FileBegin& begin, const std::string& journal_path);   // 调用方持有 mutex_
+    bool flush_journal(Lusp_ReceiveFile& file);
+    void prepare_manifest(Lusp_ReceiveFile& file, const uint8_t* manifest);
+    /**
+     * @brief 把收到的分块写到清单中内容相同的后续位置
+     */
+    bool copy_repeated(Lusp_ReceiveFile& file, uint32_t chunk_index, const uint8_t* data, uint32_t length,
+        const std::vector<uint32_t>& copies);
+    void remember_completed(uint64_t file_id);     // 调用方持有 mutex_
+
+    static constexpr size_t kCompletedHistory = 4096;   // 记录最近完成的文件，用于应答重发的 FILE_END
+
+    std::string                                                     output_dir_;
+    bool                                                            preallocate_;
+    uint32_t                                                        journal_flush_chunks_;
+    Lusp_ChunkStore                                                 store_;
+
+    mutable std::mutex                                              mutex_;
+    std::unordered_map<uint64_t, std::shared_ptr<Lusp_ReceiveFile>> files_;
+    std::unordered_set<uint64_t>                                    preparing_;     // 正在准备清单、尚未发布的文件
+    std::condition_variable                                         prepared_cv_;
+    std::unordered_set<uint64_t>                                    completed_;
+    std::deque<uint64_t>                                            completed_order_;
+
+    std::atomic<uint64_t>                                           files_started_{ 0 };
+    std::atomic<uint64_t>                                           files_completed_{ 0 };
+    std::atomic<uint64_t>                                           files_expired_{ 0 };
+    std::atomic<uint64_t>                                           chunks_received_{ 0 };
+    std::atomic<uint64_t>                                           chunks_duplicate_{ 0 };
+    std::atomic<uint64_t>                                           files_resumed_{ 0 };
+    std::atomic<uint64_t>                                           chunks_deduplicated_{ 0 };
+    std::atomic<uint64_t>                                           bytes_deduplicated_{ 0 };
+    std::atomic<uint64_t>                                           packs_received_{ 0 };
+    std::atomic<uint64_t>                                           bytes_received_{ 0 };
+    std::atomic<uint64_t>                                           digest_errors_{ 0 };
+    std::atomic<uint64_t>                                           write_errors_{ 0 };
+};
+
+#endif // LUSP_RECEIVE_FILE_TABLE_H
@@ -0,0 +1,235 @@
+#include "Lusp_ChunkReceiverServer.h"
+#include "log_headers.h"
+#include "UploadEngine/Lusp_ChunkCodec.h"
+
+using namespace Lusp_ChunkProtocol;
+
+// ---- Session ----
+class Lusp_ChunkReceiverServer::Session : public std::enable_shared_from_this<Session> {
+public:
+    Session(asio::ip::tcp::socket socket, Lusp_ChunkReceiverServer& server)
+        : socket_(std::move(socket)), server_(server) {
+        server_.connections_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~Session() {
+        server_.connections_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void start() {
+        asio::error_code ec;
+        socket_.set_option(asio::ip::tcp::no_delay(true), ec);
+        socket_.set_option(asio::socket_base::receive_buffer_size(4 * 1024 * 1024), ec);
+        do_read_header();
+    }
+
+private:
+    void do_read_header() {
+        auto self = shared_from_this();
+        asio::async_read(socket_, asio::buffer(head_), [this, self](std::error_code ec, size_t) {
+            if (ec) {
+                return;
+            }
+            if (!decode_header(head_, header_)) {
+                g_LogRemoteServer.WriteLogContent(LOG_WARN, "Invalid frame header from " + peer() + ", closing connection");
+                return;
+            }
+            payload_.resize(header_.payload_length);
+            do_read_payload();
+            });
+    }
+
+    void do_read_payload() {
+        auto self = shared_from_this();
+        asio::async_read(socket_, asio::buffer(payload_), [this, self](std::error_code ec, size_t) {
+            if (ec) {
+                return;
+            }
+            if (!handle_frame()) {
+                g_LogRemoteServer.WriteLogContent(LOG_WARN, "Malformed frame from " + peer() + ", closing connection");
+                return;
+            }
+            do_write_ack();
+            });
+    }
+
+    void do_write_ack() {
+        auto self = shared_from_this();
+        asio::async_write(socket_, asio::buffer(reply_), [this, self](std::error_code ec, size_t) {
+            if (!ec) {
+                do_read_header();
+            }
+            });
+    }
+
+    /**
+     * @brief 处理一帧并在 reply_ 中填好 ACK，帧格式错误返回 false
+     */
+    bool handle_frame() {
+        const uint8_t* payload = payload_.data();
+        const size_t size = payload_.size();
+        Ack ack;
+        ack.chunk_index = kControlIndex;
+
+        switch (header_.type) {
+        case FrameType::FileBegin: {
+            if (size < kFileBeginFixedSize) {
+                return false;
+            }
+            FileBegin begin;
+            decode_file_begin(payload, begin);
+            const bool content_defined = (header_.flags & kFlagContentDefined) != 0;
+            const uint64_t manifest_size = content_defined ? static_cast<uint64_t>(begin.chunk_count) * kManifestEntrySize : 0;
+            if (size != kFileBeginFixedSize + begin.name_length + manifest_size) {
+                return false;
+            }
+            const std::string name(reinterpret_cast<const char*>(payload + kFileBeginFixedSize), begin.name_length);
+            ack.file_id = begin.file_id;
+            const bool resume = (header_.flags & kFlagResume) != 0;
+            ack.status = server_.table_.begin(begin, name, resume,
+                content_defined ? payload + kFileBeginFixedSize + begin.name_length : nullptr);
+            if ((resume || content_defined) && ack.status == AckStatus::Ok &&
+                server_.table_.resume_state(begin.file_id, bitmap_, digests_)) {
+                // 续传请求以 RESUME 回复，携带已收分块的位图与摘要；内容定义分块回复无需发送的分块
+                const size_t length = resume_state_size(begin.chunk_count);
+                reply_.resize(kHeaderSize + length);
+                encode_header(reply_.data(), FrameType::ResumeState, 0, static_cast<uint32_t>(length));
+                encode_resume_state(reply_.data() + kHeaderSize, ack, begin.chunk_count, bitmap_.data(), digests_.data());
+                return true;
+            }
+            break;
+        }
+        case FrameType::Chunk: {
+            Chunk chunk;
+            const uint8_t* data = nullptr;
+            if (!Lusp_ChunkCodec::chunk_data(header_.flags, payload, size, chunk, data, raw_)) {
+                return false;
+            }
+            ack.file_id = chunk.file_id;
+            ack.chunk_index = chunk.chunk_index;
+            ack.status = server_.table_.write_chunk(chunk, header_.flags, data, server_.config_.verify_checksum);
+            break;
+        }
+        case FrameType::FileEnd: {
+            if (size != kFileEndSize) {
+                return false;
+            }
+            FileEnd end;
+            decode_file_end(payload, end);
+            ack.file_id = end.file_id;
+            ack.status = server_.table_.finish(end);
+            break;
+        }
+        case FrameType::Pack: {
+            if (!pack_.parse(payload, size)) {
+                return false;
+            }
+            ack.file_id = pack_.pack_id();
+            ack.status = server_.table_.unpack(pack_, server_.config_.verify_checksum && (header_.flags & kFlagDigest));
+            break;
+        }
+        default:
+            return false;
+        }
+
+        reply_.resize(kHeaderSize + kAckSize);
+        encode_header(reply_.data(), FrameType::Ack, 0, static_cast<uint32_t>(kAckSize));
+        encode_ack(reply_.data() + kHeaderSize, ack);
+        return true;
+    }
+
+    std::string peer() const {
+        asio::error_code ec;
+        const auto endpoint = socket_.remote_endpoint(ec);
+        return ec ? std::string("<unknown>") : endpoint.address().to_string() + ":" + std::to_string(endpoint.port());
+    }
+
+    asio::ip::tcp::socket       socket_;
+    Lusp_ChunkReceiverServer&   server_;
+    uint8_t                     head_[kHeaderSize];
+    FrameHeader                 header_;
+    std::vector<uint8_t>        payload_;       // 每条连接复用，容量增长到最大分块后不再分配
+    std::vector<uint8_t>        raw_;           // 压缩分块解压后的原文
+    std::vector<uint8_t>        reply_;         // ACK 或 RESUME
+    std::vector<uint64_t>       bitmap_;        // RESUME 回复用的位图与摘要快照
+    std::vector<uint32_t>       digests_;
+    Lusp_PackReader             pack_;          // 小文件容器的索引(指向 payload_)
+};
+
+// ---- Server ----
+Lusp_ChunkReceiverServer::Lusp_ChunkReceiverServer(asio::io_context& io_context, const Lusp_ChunkReceiverConfig& config)
+    : io_context_(io_context),
+    config_(config),
+    acceptor_(asio::make_strand(io_context)),
+    expire_timer_(acceptor_.get_executor()),
+    table_(config.output_dir, config.preallocate, config.journal_flush_chunks, config.dedup_entries) {}
+
+Lusp_ChunkReceiverServer::~Lusp_ChunkReceiverServer() {
+    stop();
+}
+
+bool Lusp_ChunkReceiverServer::start() {
+    asio::error_code ec;
+    const auto address = asio::ip::make_address(config_.address, ec);
+    if (ec) {
+        g_LogRemoteServer.WriteLogContent(LOG_ERROR, "Invalid listen address " + config_.address + ": " + ec.message());
+        return false;
+    }
+    const asio::ip::tcp::endpoint endpoint(address, config_.port);
+    acceptor_.open(endpoint.protocol(), ec);
+    if (!ec) {
+        acceptor_.set_option(asio::socket_base::reuse_address(true), ec);
+        acceptor_.bind(endpoint, ec);
+    }
+    if (!ec) {
+        acceptor_.listen(asio::socket_base::max_listen_connections, ec);
+    }
+    if (ec) {
+        g_LogRemoteServer.WriteLogContent(LOG_ERROR, "Failed to listen on " + config_.address + ":" +
+            std::to_string(config_.port) + ": " + ec.message());
+        acceptor_.close(ec);
+        return false;
+    }
+    bound_port_ = acceptor_.local_endpoint(ec).port();
+    running_.store(true, std::memory_order_release);
+    do_accept();
+    schedule_expire();
+    g_LogRemoteServer.WriteLogContent(LOG_INFO, "Chunk receiver listening on " + config_.address + ":" +
+        std::to_string(bound_port_) + ", output " + config_.output_dir);
+    return true;
+}
+
+void Lusp_ChunkReceiverServer::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    asio::post(acceptor_.get_executor(), [this]() {
+        asio::error_code ec;
+        acceptor_.close(ec);
+        expire_timer_.cancel();
+        });
+}
+
+void Lusp_ChunkReceiverServer::do_accept() {
+    // 每条连接各自一个 strand，连接之间在多个 io 线程上并行
+    acceptor_.async_accept(asio::make_strand(io_context_), [this](std::error_code ec, asio::ip::tcp::socket socket) {
+        if (!acceptor_.is_open()) {
+            return;
+        }
+        if (!ec) {
+            std::make_shared<Session>(std::move(socket), *this)->start();
+        }
+        do_accept();
+        });
+}
+
+void Lusp_ChunkReceiverServer::schedule_expire() {
+    expire_timer_.expires_after(std::chrono::seconds(config_.expire_check_seconds));
+    expire_timer_.async_wait([this](std::error_code ec) {
+        if (ec || !running_.load(std::memory_order_acquire)) {
+            return;
+        }
+        table_.expire_idle(std::chrono::seconds(config_.idle_timeout_seconds));
+        schedule_expire();
+        });
+}
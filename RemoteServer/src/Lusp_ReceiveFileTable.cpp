@@ -0,0 +1,519 @@
+#include "Lusp_ReceiveFileTable.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include "log_headers.h"
+#include "UploadEngine/Lusp_PathUtf8.h"
+
+using namespace Lusp_ChunkProtocol;
+
+namespace {
+    std::string file_id_text(uint64_t file_id) {
+        char text[17];
+        std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(file_id));
+        return text;
+    }
+
+    /**
+     * @brief 远端名称转为输出目录下的相对路径，防止路径穿越
+     *
+     * 发送端以 "<客户端设备>/<源文件路径>" 命名，不同设备、不同目录下的同名文件互不覆盖。
+     * 按 '/' 与 '\\' 拆分，丢弃空段、"." 与 ".."，控制字符和 Windows 不允许的字符替换为 '_'；
+     * 顶层以 '.' 开头的名称加 '_' 前缀，避开 .part/.journal/.chunk_index。取不到名称时以 file_id 命名。
+     */
+    std::filesystem::path output_relative_path(const std::string& name, uint64_t file_id) {
+        std::filesystem::path relative;
+        size_t start = 0;
+        while (start < name.size()) {
+            size_t end = name.find_first_of("/\\", start);
+            if (end == std::string::npos) {
+                end = name.size();
+            }
+            std::string part = name.substr(start, end - start);
+            start = end + 1;
+            if (part.empty() || part == "." || part == "..") {
+                continue;
+            }
+            for (char& c : part) {
+                if (static_cast<unsigned char>(c) < 0x20 || std::strchr("<>:\"|?*", c) != nullptr) {
+                    c = '_';
+                }
+            }
+            if (relative.empty() && part[0] == '.') {
+                part.insert(0, "_");
+            }
+            relative /= std::filesystem::u8path(part);
+        }
+        if (relative.empty()) {
+            relative = std::filesystem::u8path(file_id_text(file_id));
+        }
+        return relative;
+    }
+
+    /**
+     * @brief 改名为最终文件前创建所在目录
+     */
+    bool rename_to_final(const std::filesystem::path& part_path, const std::filesystem::path& final_path, std::error_code& ec) {
+        std::filesystem::create_directories(final_path.parent_path(), ec);
+        if (ec) {
+            return false;
+        }
+        std::filesystem::rename(part_path, final_path, ec);
+        return !ec;
+    }
+}
+
+Lusp_ReceiveFileTable::Lusp_ReceiveFileTable(const std::string& output_dir, bool preallocate, uint32_t journal_flush_chunks,
+    size_t dedup_entries)
+    : output_dir_(output_dir), preallocate_(preallocate), journal_flush_chunks_(std::max<uint32_t>(journal_flush_chunks, 1)),
+    store_(dedup_entries) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::u8path(output_dir_), ec);
+    if (dedup_entries > 0) {
+        const std::string index_path = path_to_utf8(std::filesystem::u8path(output_dir_) / ".chunk_index");
+        if (store_.open(index_path)) {
+            g_LogRemoteServer.WriteLogContent(LOG_INFO, "Chunk index " + index_path + " loaded, " + std::to_string(store_.size()) + " chunk(s)");
+        }
+        else {
+            g_LogRemoteServer.WriteLogContent(LOG_WARN, "Failed to open chunk index " + index_path + ", deduplicating in memory only");
+        }
+    }
+}
+
+Lusp_ReceiveFileTable::~Lusp_ReceiveFileTable() {
+    // 正常退出时把未刷盘的进度写回，重启后续传少重发一些分块
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : files_) {
+        if (entry.second->journal) {
+            flush_journal(*entry.second);
+        }
+    }
+}
+
+AckStatus Lusp_ReceiveFileTable::begin(const FileBegin& begin, const std::string& name, bool resume, const uint8_t* manifest) {
+    std::vector<uint64_t> chunk_offsets;
+    // 位图按 chunk_count 分配，先限制上限；固定分块还要求与 file_size / chunk_size 一致，清单由 layout() 校验总长
+    if (begin.chunk_count == 0 || begin.chunk_count > kMaxChunkCount) {
+        return AckStatus::Failed;
+    }
+    if (manifest) {
+        // 内容定义分块不与续传日志同时使用
+        resume = false;
+        if (begin.chunk_size == 0 ||
+            !Lusp_ChunkStore::layout(manifest, begin.chunk_count, begin.file_size, begin.chunk_size, chunk_offsets)) {
+            return AckStatus::Failed;
+        }
+    }
+    else if (begin.chunk_size == 0 || (begin.file_size + begin.chunk_size - 1) / begin.chunk_size != begin.chunk_count) {
+        return AckStatus::Failed;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // 同一文件的另一条 FILE_BEGIN 正在准备清单，等它发布后按重发处理
+    prepared_cv_.wait(lock, [&]() { return preparing_.count(begin.file_id) == 0; });
+    auto it = files_.find(begin.file_id);
+    if (it != files_.end()) {
+        // 发送端超时重发的 FILE_BEGIN：参数一致则沿用已有会话
+        const auto& file = it->second;
+        const bool same = file->file_size == begin.file_size && file->chunk_size == begin.chunk_size &&
+            file->chunk_count == begin.chunk_count && file->chunk_offsets == chunk_offsets;
+        return same ? AckStatus::Ok : AckStatus::Failed;
+    }
+
+    const std::filesystem::path dir = std::filesystem::u8path(output_dir_);
+    const std::filesystem::path relative = output_relative_path(name, begin.file_id);
+    const std::string journal_path = path_to_utf8(dir / ("." + file_id_text(begin.file_id) + ".journal"));
+
+    if (resume) {
+        if (auto file = restore(begin, journal_path)) {
+            file->final_path = path_to_utf8(dir / relative);
+            g_LogRemoteServer.WriteLogContent(LOG_INFO, "Resumed upload " + file_id_text(begin.file_id) + " (" +
+                std::to_string(file->received_count) + "/" + std::to_string(file->chunk_count) + " chunks on disk)");
+            completed_.erase(begin.file_id);
+            files_.emplace(begin.file_id, std::move(file));
+            files_resumed_.fetch_add(1, std::memory_order_relaxed);
+            return AckStatus::Ok;
+        }
+    }
+
+    auto file = std::make_shared<Lusp_ReceiveFile>();
+    file->file_id = begin.file_id;
+    file->file_size = begin.file_size;
+    file->chunk_size = begin.chunk_size;
+    file->chunk_count = begin.chunk_count;
+    file->chunk_offsets = std::move(chunk_offsets);
+    file->bitmap.assign((static_cast<size_t>(begin.chunk_count) + 63) / 64, 0);
+    file->last_activity = std::chrono::steady_clock::now();
+    file->final_path = path_to_utf8(dir / relative);
+    file->part_path = path_to_utf8(dir / ("." + file_id_text(begin.file_id) + ".part"));
+
+    // 预分配在锁内完成：fallocate 只分配区段，不写数据，耗时与文件大小基本无关
+    const bool allocated = preallocate_ ? file->output.open_write(file->part_path) && file->output.preallocate(begin.file_size)
+        : file->output.open_write(file->part_path) && file->output.truncate(begin.file_size);
+    if (!allocated) {
+        g_LogRemoteServer.WriteLogContent(LOG_ERROR, "Failed to create " + file->part_path + " (" +
+            std::to_string(begin.file_size) + " bytes, error " + std::to_string(file->output.last_error()) + ")");
+        return AckStatus::Failed;
+    }
+    if (resume) {
+        Lusp_ChunkJournal::Meta meta;
+        meta.file_id = begin.file_id;
+        meta.file_size = begin.file_size;
+        meta.chunk_size = begin.chunk_size;
+        meta.chunk_count = begin.chunk_count;
+        meta.file_path = file->part_path;
+        meta.remote_name = generic_path_to_utf8(relative);
+        auto journal = std::make_unique<Lusp_ChunkJournal>();
+        if (journal->create(journal_path, meta)) {
+            file->journal = std::move(journal);
+        }
+        else {
+            // 没有日志也能上传，只是中断后需要从头开始
+            g_LogRemoteServer.WriteLogContent(LOG_WARN, "Failed to create resume journal " + journal_path);
+        }
+    }
+
+    if (manifest) {
+        // 从本地文件复制分块可能较慢，不持有表锁；准备完成后才发布，重发的 FILE_BEGIN 不会读到未填好的 held/duplicates
+        preparing_.insert(begin.file_id);
+        lock.unlock();
+        prepare_manifest(*file, manifest);
+        lock.lock();
+        preparing_.erase(begin.file_id);
+        prepared_cv_.notify_all();
+    }
+    completed_.erase(begin.file_id);
+    files_.emplace(begin.file_id, file);
+    files_started_.fetch_add(1, std::memory_order_relaxed);
+    return AckStatus::Ok;
+}
+
+void Lusp_ReceiveFileTable::prepare_manifest(Lusp_ReceiveFile& file, const uint8_t* manifest) {
+    Lusp_ManifestPlan plan;
+    store_.prepare(manifest, file.chunk_count, file.chunk_offsets, &file.output, plan);
+    file.manifest.assign(manifest, manifest + static_cast<size_t>(file.chunk_count) * kManifestEntrySize);
+
+    size_t duplicates = 0;
+    for (const auto& entry : plan.duplicates) {
+        duplicates += entry.second.size();
+    }
+    {
+        std::lock_guard<std::mutex> file_lock(file.mutex);
+        for (uint32_t index : plan.present) {
+            uint64_t& word = file.bitmap[index / 64];
+            const uint64_t bit = uint64_t(1) << (index % 64);
+            if (!(word & bit)) {
+                word |= bit;
+                ++file.received_count;
+            }
+        }
+        file.held = std::move(plan.held);
+        file.duplicates = std::move(plan.duplicates);
+    }
+    chunks_deduplicated_.fetch_add(plan.present.size(), std::memory_order_relaxed);
+    bytes_deduplicated_.fetch_add(plan.present_bytes, std::memory_order_relaxed);
+    if (!plan.present.empty() || duplicates > 0) {
+        g_LogRemoteServer.WriteLogContent(LOG_INFO, "Upload " + file_id_text(file.file_id) + ": " +
+            std::to_string(plan.present.size()) + "/" + std::to_string(file.chunk_count) + " chunks (" +
+            std::to_string(plan.present_bytes) + " bytes) copied from local data, " + std::to_string(duplicates) +
+            " repeated within the file");
+    }
+}
+
+std::shared_ptr<Lusp_ReceiveFile> Lusp_ReceiveFileTable::restore(const FileBegin& begin, const std::string& journal_path) {
+    std::error_code ec;
+    if (!std::filesystem::exists(std::filesystem::u8path(journal_path), ec)) {
+        return nullptr;
+    }
+    auto journal = std::make_unique<Lusp_ChunkJournal>();
+    if (!journal->load(journal_path)) {
+        return nullptr;
+    }
+    const auto& meta = journal->meta();
+    if (meta.file_id != begin.file_id || meta.file_size != begin.file_size ||
+        meta.chunk_size != begin.chunk_size || meta.chunk_count != begin.chunk_count) {
+        return nullptr;
+    }
+
+    // .part 必须仍是完整长度，否则日志记录的分块不可信
+    auto file = std::make_shared<Lusp_ReceiveFile>();
+    uint64_t part_size = 0;
+    if (!file->output.open_write(meta.file_path) || !file->output.size(part_size) || part_size != begin.file_size) {
+        return nullptr;
+    }
+    file->file_id = begin.file_id;
+    file->file_size = begin.file_size;
+    file->chunk_size = begin.chunk_size;
+    file->chunk_count = begin.chunk_count;
+    file->part_path = meta.file_path;
+    std::vector<uint32_t> digests;
+    journal->snapshot(file->bitmap, digests);
+    file->received_count = journal->marked_count();
+    file->last_activity = std::chrono::steady_clock::now();
+    file->journal = std::move(journal);
+    return file;
+}
+
+bool Lusp_ReceiveFileTable::resume_state(uint64_t file_id, std::vector<uint64_t>& bitmap, std::vector<uint32_t>& digests) {
+    auto file = find(file_id);
+    if (!file) {
+        return false;
+    }
+    if (file->journal) {
+        file->journal->snapshot(bitmap, digests);
+    }
+    else if (!file->chunk_offsets.empty()) {
+        std::lock_guard<std::mutex> file_lock(file->mutex);
+        bitmap = file->held;
+        bitmap.resize((static_cast<size_t>(file->chunk_count) + 63) / 64, 0);
+        digests.assign(file->chunk_count, 0);
+    }
+    else {
+        bitmap.assign((static_cast<size_t>(file->chunk_count) + 63) / 64, 0);
+        digests.assign(file->chunk_count, 0);
+    }
+    return true;
+}
+
+bool Lusp_ReceiveFileTable::flush_journal(Lusp_ReceiveFile& file) {
+    // 先把分块数据刷盘再写日志，日志里标记的分块一定已经落盘
+    return file.journal->flush([&file]() { return file.output.sync(); });
+}
+
+AckStatus Lusp_ReceiveFileTable::write_chunk(const Chunk& chunk, uint16_t flags, const uint8_t* data, bool verify_checksum) {
+    auto file = find(chunk.file_id);
+    if (!file) {
+        return AckStatus::UnknownFile;
+    }
+    if (chunk.chunk_index >= file->chunk_count) {
+        return AckStatus::Failed;
+    }
+    const bool valid = file->chunk_offsets.empty()
+        ? chunk.offset == static_cast<uint64_t>(chunk.chunk_index) * file->chunk_size &&
+          chunk.length == std::min<uint64_t>(file->chunk_size, file->file_size - chunk.offset)
+        : chunk.offset == file->chunk_offsets[chunk.chunk_index] &&
+          chunk.length == file->chunk_offsets[chunk.chunk_index + 1] - chunk.offset;
+    if (!valid) {
+        return AckStatus::Failed;
+    }
+    if (verify_checksum && (flags & kFlagDigest) && chunk_digest(data, chunk.length) != chunk.digest) {
+        digest_errors_.fetch_add(1, std::memory_order_relaxed);
+        return AckStatus::DigestMismatch;
+    }
+    if (!file->output.write_at(data, chunk.length, chunk.offset)) {
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        g_LogRemoteServer.WriteLogContent(LOG_ERROR, "Write failed for " + file->part_path + " at offset " +
+            std::to_string(chunk.offset) + " (error " + std::to_string(file->output.last_error()) + ")");
+        return AckStatus::Failed;
+    }
+    if (file->journal) {
+        file->journal->mark(chunk.chunk_index, (flags & kFlagDigest) ? chunk.digest : chunk_digest(data, chunk.length));
+    }
+
+    bool duplicate = false;
+    bool flush = false;
+    std::vector<uint32_t> copies;
+    {
+        std::lock_guard<std::mutex> lock(file->mutex);
+        uint64_t& word = file->bitmap[chunk.chunk_index / 64];
+        const uint64_t bit = uint64_t(1) << (chunk.chunk_index % 64);
+        duplicate = (word & bit) != 0;
+        if (!duplicate) {
+            word |= bit;
+            ++file->received_count;
+        }
+        auto it = file->duplicates.find(chunk.chunk_index);
+        if (it != file->duplicates.end()) {
+            copies = std::move(it->second);
+            file->duplicates.erase(it);
+        }
+        if (file->journal && ++file->unflushed >= journal_flush_chunks_) {
+            file->unflushed = 0;
+            flush = true;
+        }
+        file->last_activity = std::chrono::steady_clock::now();
+    }
+    if (flush) {
+        flush_journal(*file);
+    }
+    if (!copies.empty() && !copy_repeated(*file, chunk.chunk_index, data, chunk.length, copies)) {
+        return AckStatus::Failed;
+    }
+    (duplicate ? chunks_duplicate_ : chunks_received_).fetch_add(1, std::memory_order_relaxed);
+    bytes_received_.fetch_add(chunk.length, std::memory_order_relaxed);
+    return AckStatus::Ok;
+}
+
+bool Lusp_ReceiveFileTable::copy_repeated(Lusp_ReceiveFile& file, uint32_t chunk_index, const uint8_t* data, uint32_t length,
+    const std::vector<uint32_t>& copies) {
+    for (uint32_t index : copies) {
+        if (!file.output.write_at(data, length, file.chunk_offsets[index])) {
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            g_LogRemoteServer.WriteLogContent(LOG_ERROR, "Write failed for " + file.part_path + " at offset " +
+                std::to_string(file.chunk_offsets[index]) + " (error " + std::to_string(file.output.last_error()) + ")");
+            // 放回待复制列表，发送端重发该分块时再试
+            std::lock_guard<std::mutex> lock(file.mutex);
+            auto& pending = file.duplicates[chunk_index];
+            pending.insert(pending.end(), copies.begin(), copies.end());
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(file.mutex);
+    for (uint32_t index : copies) {
+        uint64_t& word = file.bitmap[index / 64];
+        const uint64_t bit = uint64_t(1) << (index % 64);
+        if (!(word & bit)) {
+            word |= bit;
+            ++file.received_count;
+        }
+    }
+    chunks_deduplicated_.fetch_add(copies.size(), std::memory_order_relaxed);
+    bytes_deduplicated_.fetch_add(static_cast<uint64_t>(length) * copies.size(), std::memory_order_relaxed);
+    return true;
+}
+
+AckStatus Lusp_ReceiveFileTable::finish(const FileEnd& end) {
+    std::shared_ptr<Lusp_ReceiveFile> file;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = files_.find(end.file_id);
+        if (it == files_.end()) {
+            // FILE_END 的确认丢失后发送端会重发
+            return completed_.count(end.file_id) ? AckStatus::Ok : AckStatus::UnknownFile;
+        }
+        {
+            std::lock_guard<std::mutex> file_lock(it->second->mutex);
+            if (end.chunk_count != it->second->chunk_count || it->second->received_count != it->second->chunk_count) {
+                return AckStatus::Incomplete;
+            }
+        }
+        file = std::move(it->second);
+        files_.erase(it);
+        remember_completed(end.file_id);
+    }
+
+    // 重发中的重复分块可能仍持有句柄，不主动关闭，由最后一个持有者析构时关闭
+    std::error_code ec;
+    if (!rename_to_final(std::filesystem::u8path(file->part_path), std::filesystem::u8path(file->final_path), ec)) {
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        g_LogRemoteServer.WriteLogContent(LOG_ERROR, "Failed to rename " + file->part_path + " -> " + file->final_path + ": " + ec.message());
+        return AckStatus::Failed;
+    }
+    if (file->journal) {
+        file->journal->remove();
+    }
+    if (!file->manifest.empty()) {
+        store_.add_file(file->final_path, file->manifest.data(), file->chunk_count);
+    }
+    files_completed_.fetch_add(1, std::memory_order_relaxed);
+    return AckStatus::Ok;
+}
+
+AckStatus Lusp_ReceiveFileTable::unpack(const Lusp_PackReader& pack, bool verify_checksum) {
+    if (verify_checksum) {
+        for (const auto& file : pack.files()) {
+            if (chunk_digest(file.data, file.size) != file.digest) {
+                digest_errors_.fetch_add(1, std::memory_order_relaxed);
+                return AckStatus::DigestMismatch;
+            }
+        }
+    }
+    const std::filesystem::path dir = std::filesystem::u8path(output_dir_);
+    for (const auto& file : pack.files()) {
+        const std::string part_path = path_to_utf8(dir / ("." + file_id_text(file.file_id) + ".part"));
+        const auto final_path = dir / output_relative_path(std::string(file.name, file.name_length), file.file_id);
+        {
+            Lusp_PositionalFile output;
+            if (!output.open_write(part_path) || !output.truncate(file.size) ||
+                (file.size > 0 && !output.write_at(file.data, file.size, 0))) {
+                write_errors_.fetch_add(1, std::memory_order_relaxed);
+                g_LogRemoteServer.WriteLogContent(LOG_ERROR, "Write failed for " + part_path + " (" + std::to_string(file.size) +
+                    " bytes, error " + std::to_string(output.last_error()) + ")");
+                return AckStatus::Failed;
+            }
+        }
+        std::error_code ec;
+        if (!rename_to_final(std::filesystem::u8path(part_path), final_path, ec)) {
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            g_LogRemoteServer.WriteLogContent(LOG_ERROR, "Failed to rename " + part_path + " -> " + path_to_utf8(final_path) + ": " + ec.message());
+            return AckStatus::Failed;
+        }
+    }
+    packs_received_.fetch_add(1, std::memory_order_relaxed);
+    files_completed_.fetch_add(pack.files().size(), std::memory_order_relaxed);
+    bytes_received_.fetch_add(pack.data_size(), std::memory_order_relaxed);
+    return AckStatus::Ok;
+}
+
+size_t Lusp_ReceiveFileTable::expire_idle(std::chrono::seconds idle_timeout) {
+    const auto deadline = std::chrono::steady_clock::now() - idle_timeout;
+    std::vector<std::shared_ptr<Lusp_ReceiveFile>> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = files_.begin(); it != files_.end();) {
+            bool idle = false;
+            {
+                std::lock_guard<std::mutex> file_lock(it->second->mutex);
+                idle = it->second->last_activity < deadline;
+            }
+            if (idle) {
+                expired.push_back(std::move(it->second));
+                it = files_.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+    for (const auto& file : expired) {
+        const std::string progress = " (" + std::to_string(file->received_count) + "/" + std::to_string(file->chunk_count) + " chunks)";
+        if (file->journal && flush_journal(*file)) {
+            g_LogRemoteServer.WriteLogContent(LOG_WARN, "Suspended idle upload " + file_id_text(file->file_id) + progress + ", kept on disk for resume");
+            continue;
+        }
+        std::error_code ec;
+        std::filesystem::remove(std::filesystem::u8path(file->part_path), ec);
+        if (file->journal) {
+            file->journal->remove();
+        }
+        g_LogRemoteServer.WriteLogContent(LOG_WARN, "Discarded idle upload " + file_id_text(file->file_id) + progress);
+    }
+    files_expired_.fetch_add(expired.size(), std::memory_order_relaxed);
+    return expired.size();
+}
+
+Lusp_ReceiveStats Lusp_ReceiveFileTable::get_statistics() const {
+    Lusp_ReceiveStats stats;
+    stats.files_started = files_started_.load(std::memory_order_relaxed);
+    stats.files_completed = files_completed_.load(std::memory_order_relaxed);
+    stats.files_expired = files_expired_.load(std::memory_order_relaxed);
+    stats.chunks_received = chunks_received_.load(std::memory_order_relaxed);
+    stats.chunks_duplicate = chunks_duplicate_.load(std::memory_order_relaxed);
+    stats.files_resumed = files_resumed_.load(std::memory_order_relaxed);
+    stats.chunks_deduplicated = chunks_deduplicated_.load(std::memory_order_relaxed);
+    stats.bytes_deduplicated = bytes_deduplicated_.load(std::memory_order_relaxed);
+    stats.packs_received = packs_received_.load(std::memory_order_relaxed);
+    stats.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+    stats.digest_errors = digest_errors_.load(std::memory_order_relaxed);
+    stats.write_errors = write_errors_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.open_files = files_.size();
+    return stats;
+}
+
+std::shared_ptr<Lusp_ReceiveFile> Lusp_ReceiveFileTable::find(uint64_t file_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(file_id);
+    return it != files_.end() ? it->second : nullptr;
+}
+
+void Lusp_ReceiveFileTable::remember_completed(uint64_t file_id) {
+    if (completed_.insert(file_id).second) {
+        completed_order_.push_back(file_id);
+    }
+    while (completed_order_.size() > kCompletedHistory) {
+        completed_.erase(completed_order_.front());
+        completed_order_.pop_front();
+    }
+}
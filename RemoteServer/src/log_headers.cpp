@@ -0,0 +1,8 @@
+#include "log_headers.h"
+
+LightLogWrite_Impl g_LogRemoteServer;
+
+void initializeLogger()
+{
+	g_LogRemoteServer.SetLastingsLogs(L"logs", L"RemoteServer-");
+}
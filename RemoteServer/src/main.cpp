@@ -0,0 +1,127 @@
+#include "Lusp_ChunkReceiverServer.h"
+#include "log_headers.h"
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace {
+    void print_usage() {
+        std::cout << "RemoteServer [--address <ip>] [--port <port>] [--dir <output_dir>] [--threads <n>]\n"
+                     "             [--no-verify] [--no-preallocate] [--idle-timeout <seconds>] [--journal-flush <chunks>]\n"
+                     "             [--dedup-entries <n>]" << std::endl;
+    }
+
+    /**
+     * @brief 每 5 秒输出一次吞吐
+     */
+    void schedule_report(asio::steady_timer& timer, Lusp_ChunkReceiverServer& server, Lusp_ReceiveStats& last,
+        std::chrono::steady_clock::time_point& last_time) {
+        timer.expires_after(std::chrono::seconds(5));
+        timer.async_wait([&timer, &server, &last, &last_time](std::error_code ec) {
+            if (ec) {
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            const auto stats = server.get_statistics();
+            const double seconds = std::chrono::duration<double>(now - last_time).count();
+            if (stats.bytes_received != last.bytes_received || stats.files_completed != last.files_completed) {
+                std::cout << "[RemoteServer] " << std::fixed << std::setprecision(1)
+                          << (stats.bytes_received - last.bytes_received) / seconds / (1024.0 * 1024.0) << " MB/s, "
+                          << (stats.files_completed - last.files_completed) / seconds << " files/s | connections "
+                          << server.connection_count() << ", open files " << stats.open_files
+                          << ", completed " << stats.files_completed << " (" << stats.packs_received << " packs), resumed " << stats.files_resumed
+                          << ", deduplicated " << stats.bytes_deduplicated / (1024.0 * 1024.0) << " MB"
+                          << ", digest errors " << stats.digest_errors
+                          << ", write errors " << stats.write_errors << std::endl;
+            }
+            last = stats;
+            last_time = now;
+            schedule_report(timer, server, last, last_time);
+            });
+    }
+}
+
+int main(int argc, char** argv) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    initializeLogger();
+
+    Lusp_ChunkReceiverConfig config;
+    unsigned thread_count = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--address" && has_value) {
+            config.address = argv[++i];
+        }
+        else if (arg == "--port" && has_value) {
+            config.port = static_cast<uint16_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--dir" && has_value) {
+            config.output_dir = argv[++i];
+        }
+        else if (arg == "--threads" && has_value) {
+            thread_count = static_cast<unsigned>(std::max(1ul, std::stoul(argv[++i])));
+        }
+        else if (arg == "--idle-timeout" && has_value) {
+            config.idle_timeout_seconds = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--journal-flush" && has_value) {
+            config.journal_flush_chunks = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--dedup-entries" && has_value) {
+            config.dedup_entries = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--no-verify") {
+            config.verify_checksum = false;
+        }
+        else if (arg == "--no-preallocate") {
+            config.preallocate = false;
+        }
+        else {
+            print_usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    asio::io_context io_context;
+    Lusp_ChunkReceiverServer server(io_context, config);
+    if (!server.start()) {
+        std::cerr << "[RemoteServer] Failed to start, see log for details" << std::endl;
+        return 1;
+    }
+    std::cout << "[RemoteServer] Listening on " << config.address << ":" << server.port()
+              << ", output " << config.output_dir << ", " << thread_count << " io thread(s)" << std::endl;
+
+    asio::signal_set signals(io_context, SIGINT, SIGTERM);
+    signals.async_wait([&](std::error_code, int) {
+        server.stop();
+        io_context.stop();
+        });
+
+    asio::steady_timer report_timer(io_context);
+    Lusp_ReceiveStats last_stats;
+    auto last_time = std::chrono::steady_clock::now();
+    schedule_report(report_timer, server, last_stats, last_time);
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count; ++i) {
+        threads.emplace_back([&io_context]() { io_context.run(); });
+    }
+    io_context.run();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto stats = server.get_statistics();
+    std::cout << "[RemoteServer] Stopped: " << stats.files_completed << " files, " << stats.bytes_received
+              << " bytes received, " << stats.bytes_deduplicated << " bytes deduplicated, " << stats.digest_errors
+              << " digest errors" << std::endl;
+    g_LogRemoteServer.WriteLogContent(LOG_INFO, "RemoteServer stopped, " + std::to_string(stats.files_completed) + " files completed");
+    return 0;
+}
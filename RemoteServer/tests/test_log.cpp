@@ -0,0 +1,5 @@
+#include "log/LightLogWriteImpl.h"
+
+// 测试同时链接接收端与上传引擎，两边的日志对象都在这里定义(不写日志文件)
+LightLogWrite_Impl g_LogRemoteServer;
+LightLogWrite_Impl g_LogAsioLoopbackIpcServer;
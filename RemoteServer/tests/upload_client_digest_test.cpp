@@ -0,0 +1,182 @@
+/**
+ * @file upload_client_digest_test.cpp
+ * @brief 客户端分块摘要: 引擎按客户端入队时的分块 MD5 校验读出的数据
+ *
+ * 1. 客户端分块(192KB)与引擎分块(256KB)不对齐，摘要与文件一致时正常上传
+ * 2. 计算摘要后改写源文件中的一个字节，分块上传与容器上传的文件都失败
+ * 3. 哈希根与摘要列表不符时忽略摘要，文件照常上传
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "asio/asio.hpp"
+#include "Lusp_ChunkReceiverServer.h"
+#include "UploadEngine/Lusp_BackgroundUploader.h"
+#include "UploadEngine/Lusp_PathUtf8.h"
+#include "md5.h"
+
+namespace {
+    constexpr uint32_t kChunkSize = 256 * 1024;
+    constexpr uint32_t kClientChunkSize = 192 * 1024;
+    constexpr uint64_t kLargeSize = static_cast<uint64_t>(kChunkSize) * 6 + 1000;
+    constexpr uint64_t kSmallSize = 20 * 1024;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            ++failures;
+        }
+    }
+
+    std::vector<char> make_content(uint64_t size, uint64_t seed) {
+        std::vector<char> content(static_cast<size_t>(size));
+        uint64_t state = seed;
+        for (char& c : content) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            c = static_cast<char>(state >> 56);
+        }
+        return content;
+    }
+
+    void write_file(const std::filesystem::path& path, const std::vector<char>& content) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+
+    std::vector<char> read_file(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    /**
+     * @brief 按客户端的算法生成任务: 每块 MD5 按块序拼接，哈希根为列表的 MD5
+     */
+    Lusp_UploadTask make_task(uint64_t file_id, const std::filesystem::path& path, const std::vector<char>& content) {
+        Lusp_UploadTask task;
+        task.file_id = file_id;
+        task.file_path = path_to_utf8(path);
+        task.remote_name = "device/" + path.filename().string();
+        task.client_device = "device";
+        task.chunk_hash_size = kClientChunkSize;
+        for (size_t offset = 0; offset < content.size(); offset += kClientChunkSize) {
+            MD5 md5;
+            md5.add(content.data() + offset, std::min<size_t>(kClientChunkSize, content.size() - offset));
+            uint8_t digest[MD5::HashBytes];
+            md5.getHash(digest);
+            task.chunk_digests.insert(task.chunk_digests.end(), digest, digest + MD5::HashBytes);
+        }
+        MD5 root;
+        root.add(task.chunk_digests.data(), task.chunk_digests.size());
+        task.chunk_root_digest = root.getHash();
+        return task;
+    }
+
+    struct Results {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::map<uint64_t, std::pair<bool, std::string>> files;
+
+        bool wait(size_t count, std::chrono::seconds timeout) {
+            std::unique_lock<std::mutex> lock(mutex);
+            return cv.wait_for(lock, timeout, [this, count]() { return files.size() >= count; });
+        }
+    };
+}
+
+int main() {
+    const auto root = std::filesystem::temp_directory_path() / "lusp_upload_client_digest_test";
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    std::filesystem::create_directories(root / "source");
+
+    asio::io_context io_context;
+    Lusp_ChunkReceiverConfig receiver_config;
+    receiver_config.address = "127.0.0.1";
+    receiver_config.port = 0;
+    receiver_config.output_dir = path_to_utf8(root / "received");
+    receiver_config.dedup_entries = 0;
+    Lusp_ChunkReceiverServer receiver(io_context, receiver_config);
+    if (!receiver.start()) {
+        std::cerr << "FAILED: receiver did not start" << std::endl;
+        return 1;
+    }
+    std::thread io_thread([&io_context]() { io_context.run(); });
+
+    Lusp_UploadEngineConfig config;
+    config.remote_port = receiver.port();
+    config.chunk_size = kChunkSize;
+    config.max_concurrent_uploads = 2;
+    config.timeout_seconds = 5;
+    config.retry_count = 1;
+    config.retry_delay_ms = 50;
+    config.journal_dir = path_to_utf8(root / "journal");
+    config.enable_compression = false;
+    config.cpu_threads = 2;
+
+    Results results;
+    Lusp_BackgroundUploader uploader(config);
+    uploader.set_complete_callback([&](uint64_t file_id, bool success, const std::string& message) {
+        std::lock_guard<std::mutex> lock(results.mutex);
+        results.files[file_id] = { success, message };
+        results.cv.notify_all();
+        });
+    check(uploader.start(), "uploader start");
+
+    const auto intact = make_content(kLargeSize, 1);
+    write_file(root / "source" / "intact.bin", intact);
+    uploader.submit(make_task(1, root / "source" / "intact.bin", intact));
+
+    // 摘要按原内容计算，上传前改写一个字节(第 3 个客户端分块内、跨两个引擎分块)
+    auto changed = make_content(kLargeSize, 2);
+    const auto changed_task = make_task(2, root / "source" / "changed.bin", changed);
+    changed[kClientChunkSize * 2 + 100] ^= 0x5A;
+    write_file(root / "source" / "changed.bin", changed);
+    uploader.submit(changed_task);
+
+    auto small = make_content(kSmallSize, 3);
+    const auto small_task = make_task(3, root / "source" / "small.bin", small);
+    small[10] ^= 0x5A;
+    write_file(root / "source" / "small.bin", small);
+    uploader.submit(small_task);
+
+    const auto unverified = make_content(kLargeSize, 4);
+    write_file(root / "source" / "unverified.bin", unverified);
+    auto bad_root_task = make_task(4, root / "source" / "unverified.bin", unverified);
+    bad_root_task.chunk_digests[0] ^= 0xFF;
+    uploader.submit(bad_root_task);
+
+    check(results.wait(4, std::chrono::seconds(60)), "uploads did not finish");
+    {
+        std::lock_guard<std::mutex> lock(results.mutex);
+        check(results.files[1].first, "intact file failed: " + results.files[1].second);
+        check(!results.files[2].first, "changed file should fail");
+        check(results.files[2].second.find("入队后已变化") != std::string::npos, "changed file error: " + results.files[2].second);
+        check(!results.files[3].first, "changed packed file should fail");
+        check(results.files[3].second.find("入队后已变化") != std::string::npos, "changed packed file error: " + results.files[3].second);
+        check(results.files[4].first, "file with mismatched root failed: " + results.files[4].second);
+    }
+    check(read_file(root / "received" / "device" / "intact.bin") == intact, "received intact file differs from source");
+    check(read_file(root / "received" / "device" / "unverified.bin") == unverified, "received unverified file differs from source");
+
+    uploader.stop();
+    receiver.stop();
+    io_context.stop();
+    io_thread.join();
+    if (failures == 0) {
+        std::filesystem::remove_all(root, ec);
+        std::cout << "client digests: intact and unverified uploaded, changed files rejected" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file upload_resume_test.cpp
+ * @brief 断点续传: 上传中途失败后，客户端以新的文件ID再次推送同一文件，只补发接收端缺少的分块
+ *
+ * 1. 限速上传一个 96 块的文件，确认过一部分分块后把源文件截断，文件因读取失败而失败(续传日志保留)
+ * 2. 写回原内容并恢复修改时间，用新的文件ID再次提交
+ * 3. 第二次只发送剩余的分块，落盘文件与源文件一致，续传日志被删除
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "asio/asio.hpp"
+#include "Lusp_ChunkReceiverServer.h"
+#include "UploadEngine/Lusp_BackgroundUploader.h"
+#include "UploadEngine/Lusp_PathUtf8.h"
+
+namespace {
+    constexpr uint32_t kChunkSize = 256 * 1024;
+    constexpr uint32_t kChunkCount = 96;
+    constexpr uint64_t kFileSize = static_cast<uint64_t>(kChunkSize) * kChunkCount;
+    constexpr uint64_t kStopAfterBytes = kFileSize / 3;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            ++failures;
+        }
+    }
+
+    std::vector<char> make_content() {
+        std::vector<char> content(static_cast<size_t>(kFileSize));
+        uint64_t state = 0x243F6A8885A308D3ull;
+        for (char& c : content) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            c = static_cast<char>(state >> 56);
+        }
+        return content;
+    }
+
+    void write_file(const std::filesystem::path& path, const std::vector<char>& content) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+
+    std::vector<char> read_file(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    struct Completion {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        bool success = false;
+
+        bool wait(std::chrono::seconds timeout) {
+            std::unique_lock<std::mutex> lock(mutex);
+            return cv.wait_for(lock, timeout, [this]() { return done; });
+        }
+    };
+}
+
+int main() {
+    const auto root = std::filesystem::temp_directory_path() / "lusp_upload_resume_test";
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    std::filesystem::create_directories(root / "source");
+    const auto source = root / "source" / "resume.bin";
+    const auto content = make_content();
+    write_file(source, content);
+    const auto mtime = std::filesystem::last_write_time(source);
+
+    asio::io_context io_context;
+    Lusp_ChunkReceiverConfig receiver_config;
+    receiver_config.address = "127.0.0.1";
+    receiver_config.port = 0;
+    receiver_config.output_dir = path_to_utf8(root / "received");
+    receiver_config.journal_flush_chunks = 1;
+    receiver_config.dedup_entries = 0;
+    Lusp_ChunkReceiverServer receiver(io_context, receiver_config);
+    if (!receiver.start()) {
+        std::cerr << "FAILED: receiver did not start" << std::endl;
+        return 1;
+    }
+    std::thread io_thread([&io_context]() { io_context.run(); });
+
+    Lusp_UploadEngineConfig config;
+    config.remote_port = receiver.port();
+    config.chunk_size = kChunkSize;
+    config.max_concurrent_uploads = 2;
+    config.timeout_seconds = 5;
+    config.retry_count = 1;
+    config.retry_delay_ms = 50;
+    config.journal_dir = path_to_utf8(root / "journal");
+    config.journal_flush_chunks = 1;
+    config.max_file_upload_speed = 8 * 1024 * 1024;
+    config.rate_burst_ms = 20;
+    config.enable_compression = false;
+    config.enable_packing = false;
+    config.cpu_threads = 2;
+
+    std::atomic<bool> truncated{ false };
+    Completion first;
+    Completion second;
+    Lusp_BackgroundUploader uploader(config);
+    uploader.set_progress_callback([&](uint64_t file_id, uint64_t bytes_done, uint64_t) {
+        // 已确认一部分分块后截断源文件，之后的分块读取失败
+        if (file_id == 1 && bytes_done >= kStopAfterBytes && !truncated.exchange(true)) {
+            std::error_code resize_error;
+            std::filesystem::resize_file(source, kStopAfterBytes / 2, resize_error);
+        }
+        });
+    uploader.set_complete_callback([&](uint64_t file_id, bool success, const std::string&) {
+        Completion& completion = file_id == 1 ? first : second;
+        std::lock_guard<std::mutex> lock(completion.mutex);
+        completion.done = true;
+        completion.success = success;
+        completion.cv.notify_all();
+        });
+    check(uploader.start(), "uploader start");
+
+    Lusp_UploadTask task;
+    task.file_id = 1;
+    task.file_path = path_to_utf8(source);
+    task.remote_name = "device/source/resume.bin";
+    task.client_device = "device";
+    uploader.submit(task);
+    check(first.wait(std::chrono::seconds(60)), "first upload did not finish");
+    check(!first.success, "first upload should fail after the source was truncated");
+    const uint64_t first_chunks = uploader.get_statistics().chunks_sent;
+    check(first_chunks > 0 && first_chunks < kChunkCount, "first upload sent " + std::to_string(first_chunks) + " chunk(s)");
+
+    // 恢复源文件与修改时间，客户端以新的文件ID再次推送
+    write_file(source, content);
+    std::filesystem::last_write_time(source, mtime);
+    task.file_id = 2;
+    uploader.submit(task);
+    check(second.wait(std::chrono::seconds(60)), "second upload did not finish");
+    check(second.success, "second upload failed");
+
+    const uint64_t second_chunks = uploader.get_statistics().chunks_sent - first_chunks;
+    check(second_chunks < kChunkCount, "second upload resent all " + std::to_string(second_chunks) + " chunk(s)");
+    check(first_chunks + second_chunks >= kChunkCount, "chunks missing: " + std::to_string(first_chunks) + " + " +
+        std::to_string(second_chunks));
+    check(read_file(root / "received" / "device" / "source" / "resume.bin") == content, "received file differs from source");
+    check(std::filesystem::is_empty(root / "journal"), "resume journal not removed");
+
+    uploader.stop();
+    receiver.stop();
+    io_context.stop();
+    io_thread.join();
+    if (failures == 0) {
+        std::filesystem::remove_all(root, ec);
+        std::cout << "resume: first " << first_chunks << " chunk(s), second " << second_chunks << " of " << kChunkCount << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
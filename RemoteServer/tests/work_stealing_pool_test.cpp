@@ -0,0 +1,102 @@
+/**
+ * @file work_stealing_pool_test.cpp
+ * @brief 工作窃取线程池: 任务异常与停止时的提交
+ *
+ * 1. 组内任务抛出异常: 其余任务照常执行，wait 重新抛出该异常，计数归零不会永远等待
+ * 2. 直接提交的任务抛出异常只记日志，工作线程继续执行之后的任务
+ * 3. 多个池外线程提交的同时 stop: 每个提交的任务恰好执行一次
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "UploadEngine/Lusp_WorkStealingPool.h"
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            ++failures;
+        }
+    }
+
+    Lusp_WorkStealingPoolConfig pool_config(uint32_t threads) {
+        Lusp_WorkStealingPoolConfig config;
+        config.thread_count = threads;
+        config.spin_rounds = 4;
+        return config;
+    }
+}
+
+int main() {
+    {
+        Lusp_WorkStealingPool pool(pool_config(2));
+        std::atomic<int> ran{ 0 };
+        Lusp_TaskGroup group(&pool);
+        for (int i = 0; i < 8; ++i) {
+            group.run([&ran, i]() {
+                ++ran;
+                if (i == 3) {
+                    throw std::runtime_error("task 3");
+                }
+            });
+        }
+        std::string caught;
+        try {
+            group.wait();
+        }
+        catch (const std::runtime_error& e) {
+            caught = e.what();
+        }
+        check(caught == "task 3", "wait did not rethrow the task exception (got \"" + caught + "\")");
+        check(ran.load() == 8, std::to_string(ran.load()) + " of 8 tasks ran");
+
+        pool.submit([]() { throw std::runtime_error("detached"); });
+        std::atomic<int> after{ 0 };
+        Lusp_TaskGroup next(&pool);
+        for (int i = 0; i < 4; ++i) {
+            next.run([&after]() { ++after; });
+        }
+        next.wait();
+        check(after.load() == 4, "pool stopped running tasks after an exception");
+    }
+
+    constexpr int kRounds = 100;
+    constexpr int kProducers = 3;
+    constexpr int kTasksPerProducer = 300;
+    for (int round = 0; round < kRounds && failures == 0; ++round) {
+        std::atomic<int> executed{ 0 };
+        std::atomic<bool> go{ false };
+        Lusp_WorkStealingPool pool(pool_config(2));
+        std::vector<std::thread> producers;
+        for (int p = 0; p < kProducers; ++p) {
+            producers.emplace_back([&]() {
+                while (!go.load()) {
+                    std::this_thread::yield();
+                }
+                for (int i = 0; i < kTasksPerProducer; ++i) {
+                    pool.submit([&executed]() { ++executed; });
+                }
+            });
+        }
+        go.store(true);
+        std::this_thread::sleep_for(std::chrono::microseconds(round * 10));
+        pool.stop();
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        check(executed.load() == kProducers * kTasksPerProducer, "round " + std::to_string(round) + ": executed " +
+            std::to_string(executed.load()) + " of " + std::to_string(kProducers * kTasksPerProducer));
+    }
+
+    if (failures == 0) {
+        std::cout << "pool: exceptions contained, " << kRounds << " stop rounds without lost tasks" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
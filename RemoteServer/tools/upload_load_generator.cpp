@@ -0,0 +1,164 @@
+/**
+ * @file upload_load_generator.cpp
+ * @brief RemoteServer 压测工具
+ *
+ * 用 LocalUploadServer 的 Lusp_BackgroundUploader 模拟多个本地服务同时向 RemoteServer 上传:
+ * 先在临时目录生成一批小文件和大文件，再由 --clients 个上传引擎(各自独立的连接池)并发上传，
+ * 每个引擎上传全部文件(远端名称带引擎编号前缀)，最后输出总吞吐与失败数。
+ *
+ * 用法:
+ *   UploadLoadGenerator [--host <ip>] [--port <port>] [--clients <n>]
+ *                       [--small-files <n>] [--small-size <bytes>] [--large-files <n>] [--large-size <bytes>]
+ *                       [--chunk-size <bytes>] [--concurrency <n>] [--streams <n>] [--pack-threshold <bytes>]
+ *
+ * --pack-threshold 为小文件打包阈值，0 表示关闭打包(对比小文件 files/s)。
+ */
+
+#include "UploadEngine/Lusp_BackgroundUploader.h"
+#include "UploadEngine/Lusp_PathUtf8.h"
+#include "log_headers.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    struct LoadOptions {
+        Lusp_UploadEngineConfig engine;
+        uint32_t    clients         = 4;
+        uint32_t    small_files     = 1000;
+        uint64_t    small_size      = 64 * 1024;
+        uint32_t    large_files     = 2;
+        uint64_t    large_size      = 512ull * 1024 * 1024;
+    };
+
+    void write_random_file(const fs::path& path, uint64_t size, std::mt19937_64& rng) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        std::vector<uint64_t> block(64 * 1024 / sizeof(uint64_t));
+        uint64_t remaining = size;
+        while (remaining > 0) {
+            for (auto& word : block) {
+                word = rng();
+            }
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(remaining, block.size() * sizeof(uint64_t)));
+            out.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(length));
+            remaining -= length;
+        }
+    }
+
+    std::vector<std::pair<fs::path, uint64_t>> generate_files(const fs::path& dir, const LoadOptions& options) {
+        fs::create_directories(dir);
+        std::mt19937_64 rng(20250101);
+        std::vector<std::pair<fs::path, uint64_t>> files;
+        // 大文件放在前面，让大文件和小文件交错上传
+        for (uint32_t i = 0; i < options.large_files; ++i) {
+            files.emplace_back(dir / ("large_" + std::to_string(i) + ".bin"), options.large_size);
+        }
+        for (uint32_t i = 0; i < options.small_files; ++i) {
+            files.emplace_back(dir / ("small_" + std::to_string(i) + ".bin"), options.small_size);
+        }
+        for (const auto& [path, size] : files) {
+            write_random_file(path, size, rng);
+        }
+        return files;
+    }
+
+    bool parse_options(int argc, char** argv, LoadOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--host") options.engine.remote_host = value;
+            else if (arg == "--port") options.engine.remote_port = static_cast<uint16_t>(std::stoul(value));
+            else if (arg == "--clients") options.clients = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--small-files") options.small_files = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--small-size") options.small_size = std::stoull(value);
+            else if (arg == "--large-files") options.large_files = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--large-size") options.large_size = std::stoull(value);
+            else if (arg == "--chunk-size") options.engine.chunk_size = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--concurrency") options.engine.max_concurrent_uploads = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--streams") options.engine.max_streams_per_file = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--pack-threshold") options.engine.pack_file_threshold = static_cast<uint32_t>(std::stoul(value));
+            else return false;
+        }
+        return options.clients > 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    LoadOptions options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: UploadLoadGenerator [--host <ip>] [--port <port>] [--clients <n>] [--small-files <n>] "
+                     "[--small-size <bytes>] [--large-files <n>] [--large-size <bytes>] [--chunk-size <bytes>] "
+                     "[--concurrency <n>] [--streams <n>] [--pack-threshold <bytes>]" << std::endl;
+        return 1;
+    }
+    initializeLogger();
+
+    const fs::path dir = fs::temp_directory_path() / "lusp_upload_load_generator";
+    fs::remove_all(dir);
+    std::cout << "generating " << options.small_files << " x " << options.small_size << " B and "
+              << options.large_files << " x " << options.large_size << " B under " << path_to_utf8(dir) << std::endl;
+    const auto files = generate_files(dir, options);
+    uint64_t bytes_per_client = 0;
+    for (const auto& file : files) {
+        bytes_per_client += file.second;
+    }
+
+    std::atomic<uint64_t> failed{ 0 };
+    std::vector<std::unique_ptr<Lusp_BackgroundUploader>> clients;
+    for (uint32_t c = 0; c < options.clients; ++c) {
+        Lusp_UploadEngineConfig engine = options.engine;
+        engine.journal_dir = path_to_utf8(dir / ("journal_c" + std::to_string(c)));   // 各引擎只恢复自己的日志
+        auto uploader = std::make_unique<Lusp_BackgroundUploader>(engine);
+        uploader->set_complete_callback([&failed](uint64_t file_id, bool success, const std::string& message) {
+            if (!success && failed.fetch_add(1) < 10) {
+                std::cerr << "file " << file_id << " failed: " << message << std::endl;
+            }
+            });
+        if (!uploader->start()) {
+            std::cerr << "failed to start upload engine " << c << std::endl;
+            return 1;
+        }
+        clients.push_back(std::move(uploader));
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < files.size(); ++f) {
+        for (uint32_t c = 0; c < options.clients; ++c) {
+            Lusp_UploadTask task;
+            task.file_id = (static_cast<uint64_t>(c + 1) << 32) | f;     // 各引擎的文件ID互不重叠
+            task.file_path = path_to_utf8(files[f].first);
+            task.remote_name = "client" + std::to_string(c) + "/" + path_to_utf8(files[f].first.filename());
+            clients[c]->submit(task);
+        }
+    }
+    for (auto& client : clients) {
+        client->wait_idle();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    uint64_t retries = 0;
+    for (auto& client : clients) {
+        client->stop();
+        retries += client->get_statistics().chunk_retries;
+    }
+    fs::remove_all(dir);
+
+    const uint64_t total_bytes = bytes_per_client * options.clients;
+    const uint64_t total_files = files.size() * options.clients;
+    std::cout << options.clients << " clients x " << options.engine.max_concurrent_uploads << " connections: "
+              << total_files << " files, " << total_bytes / (1024.0 * 1024.0) << " MB in " << seconds << " s = "
+              << total_bytes / seconds / 1e9 << " GB/s, " << total_files / seconds << " files/s, "
+              << failed.load() << " failed, " << retries << " retries" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
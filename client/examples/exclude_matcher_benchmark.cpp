@@ -0,0 +1,185 @@
+/**
+ * @file exclude_matcher_benchmark.cpp
+ * @brief Lusp_ExcludeMatcher 微基准
+ *
+ * 10^6 条路径 × 500 条排除模式，对比逐条通配匹配与编译后的组合匹配器，
+ * 并校验两者结果一致。
+ *
+ * 构建(在 client 目录下):
+ *   g++ -std=c++17 -O2 -Iinclude examples/exclude_matcher_benchmark.cpp src/Config/Lusp_ExcludeMatcher.cpp -o exclude_matcher_benchmark
+ */
+
+#include "Config/Lusp_ExcludeMatcher.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr size_t kPathCount     = 1000000;
+    constexpr size_t kPatternCount  = 500;
+
+    // 逐条匹配的参照实现(* ? 与 [...]，不跨 /)，相当于对每条模式调用一次 fnmatch
+    bool naiveMatch(const char* p, const char* s) {
+        const char* starP = nullptr;
+        const char* starS = nullptr;
+        while (*s) {
+            if (*p == '[') {
+                const char* q = p + 1;
+                bool negate = *q == '!' || *q == '^';
+                if (negate) {
+                    ++q;
+                }
+                bool hit = false;
+                bool first = true;
+                while (*q && (*q != ']' || first)) {
+                    if (q[1] == '-' && q[2] && q[2] != ']') {
+                        hit |= static_cast<unsigned char>(*s) >= static_cast<unsigned char>(q[0]) &&
+                            static_cast<unsigned char>(*s) <= static_cast<unsigned char>(q[2]);
+                        q += 3;
+                    }
+                    else {
+                        hit |= *q == *s;
+                        ++q;
+                    }
+                    first = false;
+                }
+                if (*q == ']' && hit != negate) {
+                    p = q + 1;
+                    ++s;
+                    continue;
+                }
+            }
+            else if (*p == '?' || (*p != '*' && *p == *s)) {
+                ++p;
+                ++s;
+                continue;
+            }
+            if (*p == '*') {
+                starP = p++;
+                starS = s;
+                continue;
+            }
+            if (!starP) {
+                return false;
+            }
+            p = starP + 1;
+            s = ++starS;
+        }
+        while (*p == '*') {
+            ++p;
+        }
+        return *p == 0;
+    }
+
+    std::string randomWord(std::mt19937& rng, size_t minLen, size_t maxLen) {
+        static const char kAlphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789_";
+        std::uniform_int_distribution<size_t> len(minLen, maxLen);
+        std::uniform_int_distribution<size_t> ch(0, sizeof(kAlphabet) - 2);
+        std::string out(len(rng), ' ');
+        for (auto& c : out) {
+            c = kAlphabet[ch(rng)];
+        }
+        return out;
+    }
+
+    // 典型配置: 大部分为扩展名，其次为固定文件名，少量复杂通配
+    std::vector<std::string> makePatterns(std::mt19937& rng) {
+        std::vector<std::string> patterns;
+        for (size_t i = 0; i < 300; ++i) {
+            patterns.push_back("*." + randomWord(rng, 2, 5));
+        }
+        for (size_t i = 0; i < 150; ++i) {
+            patterns.push_back(randomWord(rng, 4, 12) + "." + randomWord(rng, 2, 4));
+        }
+        while (patterns.size() < kPatternCount) {
+            switch (patterns.size() % 4) {
+            case 0: patterns.push_back(randomWord(rng, 1, 3) + "*." + randomWord(rng, 2, 3)); break;
+            case 1: patterns.push_back("~$*"); break;
+            case 2: patterns.push_back("*.[ot]mp" + randomWord(rng, 0, 1)); break;
+            default: patterns.push_back(randomWord(rng, 2, 4) + "?" + randomWord(rng, 1, 3) + "*"); break;
+            }
+        }
+        return patterns;
+    }
+
+    std::vector<std::string> makeNames(std::mt19937& rng, const std::vector<std::string>& patterns) {
+        static const char* kCommonExt[] = { "cpp", "h", "txt", "png", "jpg", "json", "md", "dll", "so", "mp4" };
+        std::uniform_int_distribution<int> pick(0, 99);
+        std::vector<std::string> names;
+        names.reserve(kPathCount);
+        for (size_t i = 0; i < kPathCount; ++i) {
+            int r = pick(rng);
+            if (r < 5) {
+                // 约 5% 命中固定文件名
+                names.push_back(patterns[300 + rng() % 150]);
+            }
+            else if (r < 15) {
+                // 约 10% 命中扩展名规则
+                names.push_back(randomWord(rng, 3, 16) + patterns[rng() % 300].substr(1));
+            }
+            else {
+                names.push_back(randomWord(rng, 3, 24) + "." + kCommonExt[rng() % 10]);
+            }
+        }
+        return names;
+    }
+
+    template <typename Fn>
+    double timeMs(Fn&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main() {
+    std::mt19937 rng(20251001);
+    const auto patterns = makePatterns(rng);
+    const auto names = makeNames(rng, patterns);
+
+    std::shared_ptr<const Lusp_ExcludeMatcher> matcher;
+    double compileMs = timeMs([&]() { matcher = Lusp_ExcludeMatcher::compile(patterns, false); });
+    const auto stats = matcher->getStatistics();
+
+    std::vector<char> naiveResult(names.size());
+    std::vector<char> compiledResult(names.size());
+
+    double naiveMs = timeMs([&]() {
+        for (size_t i = 0; i < names.size(); ++i) {
+            bool hit = false;
+            for (const auto& p : patterns) {
+                if (naiveMatch(p.c_str(), names[i].c_str())) {
+                    hit = true;
+                    break;
+                }
+            }
+            naiveResult[i] = hit;
+        }
+    });
+
+    double compiledMs = timeMs([&]() {
+        for (size_t i = 0; i < names.size(); ++i) {
+            compiledResult[i] = matcher->matchName(names[i]);
+        }
+    });
+
+    size_t excluded = 0;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+        excluded += compiledResult[i] != 0;
+        mismatches += naiveResult[i] != compiledResult[i];
+    }
+
+    std::cout << "paths=" << names.size() << " patterns=" << patterns.size() << "\n";
+    std::cout << "compiled: exact=" << stats.exactNames << " suffix=" << stats.suffixes
+        << " nfa_patterns=" << stats.namePatterns << " nfa_states=" << stats.nfaStates
+        << " dfa_states=" << stats.dfaStates
+        << " compile=" << compileMs << " ms\n";
+    std::cout << "naive:    " << naiveMs << " ms (" << naiveMs * 1e6 / names.size() << " ns/path)\n";
+    std::cout << "compiled: " << compiledMs << " ms (" << compiledMs * 1e6 / names.size() << " ns/path)\n";
+    std::cout << "speedup:  " << naiveMs / compiledMs << "x\n";
+    std::cout << "excluded=" << excluded << " mismatches=" << mismatches << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file ipc_channel_pool_benchmark.cpp
+ * @brief 回环 IPC 通道数与吞吐的关系(对应 Lusp_AsioLoopbackIpcChannelPool)
+ *
+ * 服务端用 server-threads 个线程跑一个 io_context，每条连接一个异步读循环，按 IPC 协议
+ * (4字节小端长度前缀)拆帧计数；客户端建立 N 条连接，每条连接一个发送线程：
+ * - 分流键为文件ID，按通道池相同的最高随机权重哈希(splitmix64)选通道，每个发送线程只发落在自己通道上的键
+ * - 帧体前 16 字节为 文件ID + 序号，其余填充到 payload 字节；帧按 64KB 合批写出
+ * - 服务端校验同一文件ID的序号严格递增，输出顺序错误数
+ *
+ * 载荷大小可调，用来观察通道数带来的扩展；真实的上传通知是几百字节的元数据，
+ * 单条连接远未到瓶颈，通道池主要解决的是单连接断开或阻塞时全部消息一起停顿的问题。
+ * 单核机器上多通道没有扩展空间，结果只反映切换开销。
+ *
+ * 用法: ipc_channel_pool_benchmark [--payload <bytes>] [--total-mb <n>] [--keys <n>]
+ *                                  [--server-threads <n>] [--channels 1,2,4,8]
+ *
+ * 构建(在 client 目录下，Linux/Windows 均可):
+ *   g++ -std=c++17 -O2 -pthread -I3rdParty/include -I3rdParty/include/asio examples/ipc_channel_pool_benchmark.cpp -o ipc_channel_pool_benchmark
+ */
+
+#include "asio/asio.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr size_t kReadBufferSize  = 256 * 1024;
+    constexpr size_t kWriteBatchSize  = 64 * 1024;
+    constexpr size_t kFrameHeaderSize = 4;
+    constexpr size_t kBodyPrefixSize  = 16;
+
+    struct Options {
+        size_t payload = 4096;
+        size_t total_mb = 1024;
+        size_t keys = 1024;
+        size_t server_threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<size_t> channels{ 1, 2, 4, 8 };
+    };
+
+    // 与 Lusp_AsioLoopbackIpcChannelPool::route_weight 相同
+    uint64_t route_weight(uint64_t key, size_t index) {
+        uint64_t x = key ^ (0x9E3779B97F4A7C15ull * (static_cast<uint64_t>(index) + 1));
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    size_t route(uint64_t key, size_t channel_count) {
+        size_t best_index = 0;
+        uint64_t best_weight = 0;
+        for (size_t i = 0; i < channel_count; ++i) {
+            uint64_t weight = route_weight(key, i);
+            if (i == 0 || weight > best_weight) {
+                best_index = i;
+                best_weight = weight;
+            }
+        }
+        return best_index;
+    }
+
+    struct ServerStats {
+        std::atomic<uint64_t> bytes{ 0 };
+        std::atomic<uint64_t> frames{ 0 };
+        std::atomic<uint64_t> order_errors{ 0 };
+    };
+
+    /**
+     * @brief 服务端连接: 异步读循环，拆帧并校验每个文件ID的序号
+     */
+    class ServerConnection : public std::enable_shared_from_this<ServerConnection> {
+    public:
+        ServerConnection(asio::ip::tcp::socket socket, ServerStats& stats)
+            : socket_(std::move(socket)), stats_(stats), buffer_(kReadBufferSize) {}
+
+        void start() { do_read(); }
+
+    private:
+        void do_read() {
+            auto self = shared_from_this();
+            socket_.async_read_some(asio::buffer(buffer_.data() + buffered_, buffer_.size() - buffered_),
+                [this, self](const std::error_code& ec, size_t bytes) {
+                    if (ec) {
+                        return;
+                    }
+                    buffered_ += bytes;
+                    stats_.bytes.fetch_add(bytes, std::memory_order_relaxed);
+                    consume_frames();
+                    do_read();
+                });
+        }
+
+        void consume_frames() {
+            size_t offset = 0;
+            uint64_t frames = 0;
+            while (buffered_ - offset >= kFrameHeaderSize) {
+                uint32_t length = 0;
+                std::memcpy(&length, buffer_.data() + offset, kFrameHeaderSize);
+                if (buffered_ - offset < kFrameHeaderSize + length) {
+                    break;
+                }
+                uint64_t key = 0;
+                uint64_t seq = 0;
+                std::memcpy(&key, buffer_.data() + offset + kFrameHeaderSize, 8);
+                std::memcpy(&seq, buffer_.data() + offset + kFrameHeaderSize + 8, 8);
+                auto it = last_seq_.find(key);
+                if (it != last_seq_.end() && seq <= it->second) {
+                    stats_.order_errors.fetch_add(1, std::memory_order_relaxed);
+                }
+                last_seq_[key] = seq;
+                offset += kFrameHeaderSize + length;
+                ++frames;
+            }
+            stats_.frames.fetch_add(frames, std::memory_order_relaxed);
+            // 帧体不超过读缓冲区，剩余的半帧挪到开头
+            std::memmove(buffer_.data(), buffer_.data() + offset, buffered_ - offset);
+            buffered_ -= offset;
+        }
+
+        asio::ip::tcp::socket socket_;
+        ServerStats& stats_;
+        std::vector<char> buffer_;
+        size_t buffered_ = 0;
+        std::unordered_map<uint64_t, uint64_t> last_seq_;
+    };
+
+    struct RunResult {
+        double seconds = 0.0;
+        uint64_t bytes = 0;
+        uint64_t frames = 0;
+        uint64_t order_errors = 0;
+        uint64_t min_channel_frames = 0;
+        uint64_t max_channel_frames = 0;
+    };
+
+    RunResult run(const Options& options, size_t channel_count) {
+        asio::io_context server_io;
+        auto work = asio::make_work_guard(server_io);
+        asio::ip::tcp::acceptor acceptor(server_io, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+        const auto endpoint = acceptor.local_endpoint();
+
+        ServerStats stats;
+        std::vector<std::thread> server_threads;
+        for (size_t i = 0; i < options.server_threads; ++i) {
+            server_threads.emplace_back([&server_io]() { server_io.run(); });
+        }
+
+        // 先建立全部连接，计时只包含发送
+        asio::io_context client_io;
+        std::vector<asio::ip::tcp::socket> sockets;
+        for (size_t i = 0; i < channel_count; ++i) {
+            sockets.emplace_back(client_io);
+            sockets.back().connect(endpoint);
+            sockets.back().set_option(asio::ip::tcp::no_delay(true));
+            auto accepted = acceptor.accept();
+            std::make_shared<ServerConnection>(std::move(accepted), stats)->start();
+        }
+
+        const size_t frame_size = kFrameHeaderSize + options.payload;
+        const uint64_t total_frames = std::max<uint64_t>(1, options.total_mb * 1024 * 1024 / frame_size);
+        const uint64_t rounds = (total_frames + options.keys - 1) / options.keys;
+
+        std::vector<std::vector<uint64_t>> channel_keys(channel_count);
+        for (uint64_t key = 0; key < options.keys; ++key) {
+            channel_keys[route(key, channel_count)].push_back(key);
+        }
+
+        const uint64_t expected_bytes = rounds * options.keys * frame_size;
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> senders;
+        for (size_t c = 0; c < channel_count; ++c) {
+            senders.emplace_back([&, c]() {
+                std::vector<char> batch;
+                batch.reserve(kWriteBatchSize + frame_size);
+                const uint32_t length = static_cast<uint32_t>(options.payload);
+                for (uint64_t seq = 0; seq < rounds; ++seq) {
+                    for (uint64_t key : channel_keys[c]) {
+                        size_t offset = batch.size();
+                        batch.resize(offset + frame_size, 'x');
+                        std::memcpy(batch.data() + offset, &length, kFrameHeaderSize);
+                        std::memcpy(batch.data() + offset + kFrameHeaderSize, &key, 8);
+                        std::memcpy(batch.data() + offset + kFrameHeaderSize + 8, &seq, 8);
+                        if (batch.size() >= kWriteBatchSize) {
+                            asio::write(sockets[c], asio::buffer(batch));
+                            batch.clear();
+                        }
+                    }
+                }
+                if (!batch.empty()) {
+                    asio::write(sockets[c], asio::buffer(batch));
+                }
+            });
+        }
+        for (auto& sender : senders) {
+            sender.join();
+        }
+        while (stats.bytes.load(std::memory_order_relaxed) < expected_bytes) {
+            std::this_thread::yield();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        RunResult result;
+        result.seconds = std::chrono::duration<double>(elapsed).count();
+        result.bytes = stats.bytes.load();
+        result.frames = stats.frames.load();
+        result.order_errors = stats.order_errors.load();
+        result.min_channel_frames = UINT64_MAX;
+        for (auto& keys : channel_keys) {
+            result.min_channel_frames = std::min<uint64_t>(result.min_channel_frames, keys.size() * rounds);
+            result.max_channel_frames = std::max<uint64_t>(result.max_channel_frames, keys.size() * rounds);
+        }
+
+        for (auto& socket : sockets) {
+            std::error_code ec;
+            socket.shutdown(asio::socket_base::shutdown_both, ec);
+            socket.close(ec);
+        }
+        work.reset();
+        acceptor.close();
+        server_io.stop();
+        for (auto& thread : server_threads) {
+            thread.join();
+        }
+        return result;
+    }
+
+    std::vector<size_t> parse_list(const std::string& text) {
+        std::vector<size_t> values;
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find(',', start);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            values.push_back(std::max<size_t>(1, std::stoul(text.substr(start, end - start))));
+            start = end + 1;
+        }
+        return values;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--payload") {
+            options.payload = std::max<size_t>(kBodyPrefixSize, std::stoul(value));
+        } else if (arg == "--total-mb") {
+            options.total_mb = std::stoul(value);
+        } else if (arg == "--keys") {
+            options.keys = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--server-threads") {
+            options.server_threads = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--channels") {
+            options.channels = parse_list(value);
+        } else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return 1;
+        }
+    }
+    options.payload = std::min(options.payload, kReadBufferSize - kFrameHeaderSize);
+
+    std::cout << "payload " << options.payload << " B, total " << options.total_mb << " MB, keys " << options.keys
+              << ", server threads " << options.server_threads
+              << ", hardware threads " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::left << std::setw(10) << "channels" << std::setw(16) << "GB/s" << std::setw(14) << "Mframes/s"
+              << std::setw(16) << "frames/channel" << "order errors" << std::endl;
+
+    double baseline = 0.0;
+    for (size_t channel_count : options.channels) {
+        RunResult result = run(options, channel_count);
+        double gbps = result.bytes / result.seconds / 1e9;
+        if (baseline == 0.0) {
+            baseline = gbps;
+        }
+        std::cout << std::left << std::setw(10) << channel_count
+                  << std::setw(16) << (std::to_string(gbps).substr(0, 5) + " (x" + std::to_string(gbps / baseline).substr(0, 4) + ")")
+                  << std::setw(14) << std::fixed << std::setprecision(3) << result.frames / result.seconds / 1e6
+                  << std::setw(16) << (std::to_string(result.min_channel_frames) + "-" + std::to_string(result.max_channel_frames))
+                  << result.order_errors << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file upload_item_memory_benchmark.cpp
+ * @brief 上传队列条目内存占用对比
+ *
+ * 构造 10^6 个典型的 Lusp_SyncUploadFileInfo(同一设备、按目录分布的长路径、UUID 令牌、MD5)，
+ * 分别以原结构体与 Lusp_CompactUploadItem 存入 std::deque，统计每个文件的堆内存与条目大小，
+ * 并校验 pack/unpack 往返一致。
+ *
+ * 构建(在 client 目录下，需要 Qt 头文件路径以包含 FileInfo.h):
+ *   g++ -std=c++17 -O2 -Iinclude -I<Qt include> examples/upload_item_memory_benchmark.cpp src/SyncUploadQueue/Lusp_CompactUploadItem.cpp -o upload_item_memory_benchmark
+ */
+
+#include "SyncUploadQueue/Lusp_CompactUploadItem.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+
+namespace {
+    constexpr size_t kFileCount = 1000000;
+
+    std::atomic<int64_t> g_heapBytes{ 0 };
+
+    // 统计申请字节数: 在块前保存大小
+    void* countedAlloc(size_t size) {
+        void* block = std::malloc(size + sizeof(std::max_align_t));
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        *static_cast<size_t*>(block) = size;
+        g_heapBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+        return static_cast<char*>(block) + sizeof(std::max_align_t);
+    }
+
+    void countedFree(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+        void* block = static_cast<char*>(ptr) - sizeof(std::max_align_t);
+        g_heapBytes.fetch_sub(static_cast<int64_t>(*static_cast<size_t*>(block)), std::memory_order_relaxed);
+        std::free(block);
+    }
+
+    std::u16string toU16(const std::string& ascii) {
+        return std::u16string(ascii.begin(), ascii.end());
+    }
+
+    std::string randomHex(std::mt19937_64& rng, size_t digits) {
+        static const char kHex[] = "0123456789abcdef";
+        std::string out(digits, '0');
+        for (auto& c : out) {
+            c = kHex[rng() & 15];
+        }
+        return out;
+    }
+
+    Lusp_SyncUploadFileInfo makeInfo(std::mt19937_64& rng, size_t index) {
+        Lusp_SyncUploadFileInfo info{};
+        const std::u16string dir = u"C:\\Users\\developer\\Documents\\Projects\\workspace-" +
+            toU16(std::to_string(index / 20000)) + u"\\module_" + toU16(std::to_string(index / 200 % 100)) + u"\\";
+        std::u16string name = u"file_" + toU16(std::to_string(index)) + (index % 7 == 0 ? u"_报告.docx" : u".cpp");
+        info.eUploadFileTyped = Lusp_UploadFileTyped::LUSP_UPLOADTYPE_CODE;
+        info.sLanClientDevice = u"DESKTOP-7H2K9Q1";
+        info.sSyncFileSizeValue = rng() % (1 << 20);
+        info.sFileFullNameValue = dir + name;
+        info.sOnlyFileNameValue = name;
+        info.sFileRecordTimeValue = "2025-10-01 12:" + std::to_string(10 + index / 60000 % 50) + ":" + std::to_string(10 + index / 1000 % 50);
+        info.sFileMd5ValueInfo = randomHex(rng, 32);
+        info.eFileExistPolicy = Lusp_FileExistPolicy::LUSP_FILE_EXIST_POLICY_OVERWRITE;
+        info.sAuthTokenValues = randomHex(rng, 8) + "-" + randomHex(rng, 4) + "-" + randomHex(rng, 4) + "-" + randomHex(rng, 4) + "-" + randomHex(rng, 12);
+        info.uUploadTimeStamp = 1759300000000ull + index;
+    info.uFileId = (uint64_t(index) << 22) | 0x1A5000;
+        info.eUploadStatusInf = Lusp_UploadStatusInf::LUSP_UPLOAD_STATUS_IDENTIFIERS_PENDING;
+        info.enqueueTime = std::chrono::steady_clock::now();
+        return info;
+    }
+
+    bool sameInfo(const Lusp_SyncUploadFileInfo& a, const Lusp_SyncUploadFileInfo& b) {
+        return a.eUploadFileTyped == b.eUploadFileTyped && a.sLanClientDevice == b.sLanClientDevice &&
+            a.sSyncFileSizeValue == b.sSyncFileSizeValue && a.sFileFullNameValue == b.sFileFullNameValue &&
+            a.sOnlyFileNameValue == b.sOnlyFileNameValue && a.sFileRecordTimeValue == b.sFileRecordTimeValue &&
+            a.sFileMd5ValueInfo == b.sFileMd5ValueInfo && a.eFileExistPolicy == b.eFileExistPolicy &&
+            a.sAuthTokenValues == b.sAuthTokenValues && a.uUploadTimeStamp == b.uUploadTimeStamp && a.uFileId == b.uFileId &&
+            a.eUploadStatusInf == b.eUploadStatusInf && a.sDescriptionInfo == b.sDescriptionInfo &&
+            a.enqueueTime == b.enqueueTime && a.uChunkHashSize == b.uChunkHashSize &&
+            a.vChunkDigests == b.vChunkDigests && a.sChunkRootDigest == b.sChunkRootDigest &&
+            a.bPayloadCompressed == b.bPayloadCompressed;
+    }
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+
+int main() {
+    std::mt19937_64 rng(20251001);
+
+    int64_t base = g_heapBytes.load();
+    std::deque<Lusp_SyncUploadFileInfo> legacy;
+    for (size_t i = 0; i < kFileCount; ++i) {
+        legacy.push_back(makeInfo(rng, i));
+    }
+    const double legacyPerFile = double(g_heapBytes.load() - base) / kFileCount;
+
+    Lusp_UploadItemInternTable table;
+    base = g_heapBytes.load();
+    std::deque<Lusp_CompactUploadItem> compact;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& info : legacy) {
+        compact.push_back(table.pack(info));
+    }
+    const double packMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const double compactPerFile = double(g_heapBytes.load() - base) / kFileCount;
+
+    size_t mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kFileCount; ++i) {
+        mismatches += !sameInfo(legacy[i], table.unpack(compact[i]));
+    }
+    const double unpackMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "files=" << kFileCount << " directories=" << table.directoryCount() << "\n";
+    std::cout << "legacy:  sizeof=" << sizeof(Lusp_SyncUploadFileInfo) << " heap/file=" << legacyPerFile << " bytes\n";
+    std::cout << "compact: sizeof=" << sizeof(Lusp_CompactUploadItem) << " heap/file=" << compactPerFile
+        << " bytes (intern table " << table.approximateBytes() << " bytes)\n";
+    std::cout << "ratio:   " << legacyPerFile / compactPerFile << "x\n";
+    std::cout << "pack:    " << packMs * 1e6 / kFileCount << " ns/file, unpack+compare: " << unpackMs * 1e6 / kFileCount << " ns/file\n";
+    std::cout << "mismatches=" << mismatches << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
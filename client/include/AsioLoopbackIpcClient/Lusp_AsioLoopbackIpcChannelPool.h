@@ -0,0 +1,142 @@
+#ifndef LUSP_ASIO_LOOPBACK_IPC_CHANNEL_POOL_H
+#define LUSP_ASIO_LOOPBACK_IPC_CHANNEL_POOL_H
+
+#include "AsioLoopbackIpcClient/Lusp_AsioLoopbackIpcClient.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ClientConfigManager;
+
+/**
+ * @brief 回环 IPC 通道池
+ *
+ * 向同一服务端建立 N 条连接(默认 NetworkConfig::maxConnections)，每条连接是一个
+ * Lusp_AsioLoopbackIpcClient，各有自己的持久化队列与发送循环：
+ * - 按分流键(文件ID)做最高随机权重哈希(rendezvous)，同一个键固定走同一条通道，保证单个文件的消息顺序
+ * - 通道断开时只迁移该通道上的键：取出其队列中未发送的消息，按顺序转给新的通道，再接收新消息
+ * - 通道恢复后等其他通道队列排空再重新参与分流，迁走的键回来时不会越过还在排队的旧消息
+ * - 只有 0 号通道(控制通道)做完整的应用层心跳；数据通道空闲时只发轻量保活 PING，
+ *   不等待 PONG，断开靠读失败和 TCP Keep-Alive 发现
+ */
+class Lusp_AsioLoopbackIpcChannelPool {
+public:
+    using MessageCallback = Lusp_AsioLoopbackIpcClient::MessageCallback;
+
+    /**
+     * @brief 单条通道的统计信息
+     */
+    struct ChannelStatistics {
+        bool     connected = false;        ///< 是否已连接
+        bool     routable = false;         ///< 是否参与分流
+        size_t   pending = 0;              ///< 队列中未发送的消息数
+        uint64_t routed_messages = 0;      ///< 分流到本通道的新消息数
+        uint64_t migrated_messages = 0;    ///< 从断开通道迁入的消息数
+    };
+
+    /**
+     * @brief 构造通道池
+     * @param io_context Asio IO 上下文(所有通道共用)
+     * @param configMgr 客户端配置管理器
+     * @param channel_count 通道数，0 表示取 NetworkConfig::maxConnections
+     */
+    Lusp_AsioLoopbackIpcChannelPool(asio::io_context& io_context, const ClientConfigManager& configMgr, size_t channel_count = 0);
+
+    ~Lusp_AsioLoopbackIpcChannelPool() = default;
+
+    Lusp_AsioLoopbackIpcChannelPool(const Lusp_AsioLoopbackIpcChannelPool&) = delete;
+    Lusp_AsioLoopbackIpcChannelPool& operator=(const Lusp_AsioLoopbackIpcChannelPool&) = delete;
+
+    /**
+     * @brief 连接全部通道
+     */
+    void connect();
+
+    /**
+     * @brief 按分流键发送消息(可在任意线程调用)
+     * @param message 要发送的消息
+     * @param key 分流键(文件ID)，相同的键保持发送顺序
+     * @param priority 消息优先级(0最高)
+     */
+    void send(const std::string& message, uint64_t key, uint32_t priority = 0);
+
+    /**
+     * @brief 设置消息接收回调(所有通道共用)
+     */
+    void on_receive(MessageCallback cb);
+
+    /**
+     * @brief 断开全部通道(不再迁移消息)
+     */
+    void disconnect();
+
+    /**
+     * @brief 是否至少有一条通道已连接
+     */
+    bool is_connected() const;
+
+    /**
+     * @brief 获取通道数
+     */
+    size_t get_channel_count() const;
+
+    /**
+     * @brief 获取已连接的通道数
+     */
+    size_t get_connected_channel_count() const;
+
+    /**
+     * @brief 获取各通道统计信息
+     */
+    std::vector<ChannelStatistics> get_channel_statistics() const;
+
+private:
+    /**
+     * @brief 通道连接状态变化(在 io 线程上调用)
+     * @param index 通道序号
+     * @param connected 是否已连接
+     */
+    void handle_channel_change(size_t index, bool connected);
+
+    /**
+     * @brief 取出断开通道队列中的消息并按当前分流重新发送(调用方持有 route_mutex_)
+     */
+    void migrate_pending_locked(size_t index);
+
+    /**
+     * @brief 参与分流的通道队列都已排空时，让已恢复的通道重新参与分流(调用方持有 route_mutex_)
+     */
+    void try_rejoin_locked();
+
+    /**
+     * @brief 选择分流键所在的通道(调用方持有 route_mutex_)
+     * @details 在参与分流的通道中取权重最大者；没有可用通道时在全部通道中选，消息留在队列等待重连
+     */
+    size_t route_locked(uint64_t key) const;
+
+    /**
+     * @brief 分流键在指定通道上的权重(splitmix64 混合)
+     */
+    static uint64_t route_weight(uint64_t key, size_t index);
+
+private:
+    //-------------------------------------------------------------------------------------------
+    // Private Members @{
+    //-------------------------------------------------------------------------------------------
+    std::vector<std::unique_ptr<Lusp_AsioLoopbackIpcClient>> channels_;           ///< 通道(0 号为控制通道)
+
+    mutable std::mutex                              route_mutex_;                    ///< 保护以下分流状态
+    std::vector<bool>                               channel_connected_;              ///< 通道是否已连接
+    std::vector<bool>                               channel_routable_;               ///< 通道是否参与分流
+    std::vector<bool>                               channel_rejoin_pending_;         ///< 已恢复连接，等待重新参与分流
+    std::vector<uint64_t>                           routed_messages_;                ///< 各通道分流的新消息数
+    std::vector<uint64_t>                           migrated_messages_;              ///< 各通道迁入的消息数
+    std::atomic<bool>                               is_stopping_{ false };           ///< 正在断开全部通道，不再迁移
+    //-------------------------------------------------------------------------------------------
+    // @}
+    //-------------------------------------------------------------------------------------------
+};
+
+#endif // LUSP_ASIO_LOOPBACK_IPC_CHANNEL_POOL_H
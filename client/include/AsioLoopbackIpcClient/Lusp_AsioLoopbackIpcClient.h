@@ -4,12 +4,17 @@
 #include "asio/asio.hpp"
 #include "MessageQueue/PersistentMessageQueue.h"
 #include "MessageQueue/ConnectionMonitor.h"
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 #include <mutex>
 
+#if defined(LUSP_IPC_COROUTINES) && !defined(ASIO_HAS_CO_AWAIT)
+#error "LUSP_IPC_COROUTINES requires C++20 coroutine support"
+#endif
+
 // 前向声明，避免循环依赖
 class ClientConfigManager;
 
@@ -32,6 +37,7 @@ namespace Lusp_ProtobufUtils {
 class Lusp_AsioLoopbackIpcClient {
 public:
     using MessageCallback = std::function<void(const std::string&)>;
+    using ConnectionCallback = std::function<void(bool connected)>;
 
     /**
      * @brief 全局配置使用 ClientConfigManager
@@ -40,6 +46,15 @@ public:
      */
     Lusp_AsioLoopbackIpcClient(asio::io_context& io_context, const ClientConfigManager& configMgr);
 
+    /**
+     * @brief 指定持久化队列目录(通道池中每个通道一个目录)
+     * @param io_context Asio IO 上下文
+     * @param configMgr 客户端配置管理器
+     * @param queue_dir 持久化消息队列目录
+     */
+    Lusp_AsioLoopbackIpcClient(asio::io_context& io_context, const ClientConfigManager& configMgr,
+        const std::filesystem::path& queue_dir);
+
     /**
      * @brief 析构函数
      */
@@ -54,8 +69,10 @@ public:
      * @brief 发送消息
      * @param message 要发送的消息
      * @param priority 消息优先级(0最高)
+     * @param routing_key 分流键(通道池写入文件ID，通道断开后据此把未发送的消息重新分流)；
+     *                    消息ID 由队列分配，保持唯一
      */
-    void send(const std::string& message, uint32_t priority = 0);
+    void send(const std::string& message, uint32_t priority = 0, uint64_t routing_key = 0);
 
     /**
      * @brief 设置消息接收回调
@@ -63,6 +80,21 @@ public:
      */
     void on_receive(MessageCallback cb);
 
+    /**
+     * @brief 设置连接建立/断开回调
+     * @details 连接状态进入或离开 Connected 时调用(在 io 线程上)，参数为是否已连接
+     * @param cb 回调函数
+     */
+    void on_connection_change(ConnectionCallback cb);
+
+    /**
+     * @brief 取出队列中全部未发送的消息(按出队顺序)
+     * @details 供通道池在连接断开后把消息转移到其他通道，连接正常时不应调用。
+     *          断开回调可能先于写完成回调执行，此时正在写出的消息不取出，留在队首等写出结果：
+     *          成功则出队，失败则留在本通道，下次迁移或重连后再发
+     */
+    std::vector<IpcMessage> take_pending_messages();
+
     /**
      * @brief 断开连接
      */
@@ -79,6 +111,11 @@ public:
      */
     PersistentMessageQueue::Statistics get_queue_statistics() const;
 
+    /**
+     * @brief 获取队列中未发送(含正在写出)的消息数
+     */
+    size_t get_pending_count() const;
+
     /**
      * @brief 启用/禁用应用层心跳
      * @param enable 是否启用 默认启用
@@ -91,6 +128,15 @@ public:
      */
     void set_heartbeat_interval(uint32_t interval_ms);
 
+    /**
+     * @brief 设置本连接是否为心跳控制通道(默认是)
+     * @details 通道池只在控制通道上做完整心跳(等待 PONG、测 RTT、超时重连)；数据通道只在空闲时
+     *          发轻量保活 PING，供服务端超时检查，断开靠读失败和 TCP Keep-Alive 发现。
+     *          在 connect() 之前设置，之后的每次连接都生效
+     * @param enable 是否为控制通道
+     */
+    void set_heartbeat_channel(bool enable);
+
 private:
 
     /**
@@ -120,6 +166,13 @@ private:
      */
     void handle_connect_result(const std::error_code& ec, const asio::ip::tcp::endpoint& endpoint);
     void handle_read_result(const std::error_code& ec, std::size_t bytes_transferred);
+
+    /**
+     * @brief 拆分接收缓冲区中的完整帧(4字节长度前缀)
+     * @details 心跳 PONG 在缓冲区上直接解析，其他帧交给消息回调；剩余半包留在缓冲区
+     * @param pending 当前连接的接收缓冲区
+     */
+    void dispatch_frames(std::vector<char>& pending);
     void handle_send_result(const std::error_code& ec, std::size_t bytes_transferred, uint64_t msg_id);
 
     // TCP Keep-Alive
@@ -128,11 +181,44 @@ private:
     // 应用层心跳
     void start_heartbeat_timer(); // 启动心跳定时器
     void stop_heartbeat_timer();  // 停止心跳定时器
-    void send_heartbeat_ping();   // 发送心跳PING
-    void handle_heartbeat_pong(const std::string& pong_data); // 处理心跳PONG
-    void check_heartbeat_timeout();         // 检查心跳超时
+    void send_heartbeat_ping();   // 发送心跳PING(协程模式下交给发送循环)
+    uint32_t encode_heartbeat_ping(std::vector<char>& frame);  // 构建PING帧(4字节长度前缀 + FlatBuffer)，返回序列号
+    void handle_heartbeat_ping_result(const std::error_code& ec, std::size_t bytes_sent, uint32_t sequence);
+    void handle_heartbeat_pong(const uint8_t* pong_data);      // 处理心跳PONG(已校验的 FlatBuffer)，记录往返时延
+
+    /**
+     * @brief 心跳定时器到期
+     * @details 空闲未满心跳间隔(收发数据已证明连接存活)时不发 PING；
+     *          PING 在 RTO 内没有收到任何数据则记一次超时并重发(超时翻倍)，连续超时达到上限后重连
+     * @return 下次定时等待时长(毫秒)，0 表示停止心跳
+     */
+    uint32_t on_heartbeat_timer();
+
+    /**
+     * @brief 当前 PING 的等待超时: RTO × 2^连续超时次数，不超过配置的心跳超时
+     */
+    uint32_t get_heartbeat_timeout_ms() const;
     std::string get_computer_name() const;  // 获取计算机名称
 
+#ifdef LUSP_IPC_COROUTINES
+    /**
+     * @brief 协程版本的读/发送/心跳循环(LUSP_IPC_COROUTINES)
+     * @details 每个连接各起一个循环，协程帧只在连接建立时分配(asio 从线程本地缓存回收)，
+     *          读缓冲区和发送帧缓冲区在整个连接期间复用；心跳 PING 也由发送循环写出，
+     *          socket 上同一时刻只有一个写操作
+     */
+    asio::awaitable<void> read_loop(std::shared_ptr<asio::ip::tcp::socket> socket);
+    asio::awaitable<void> send_loop(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<asio::steady_timer> signal);
+    asio::awaitable<void> heartbeat_loop(std::shared_ptr<asio::ip::tcp::socket> socket);
+
+    /**
+     * @brief 唤醒空闲的发送循环(可在任意线程调用)
+     */
+    void wake_send_loop();
+#else
+    void schedule_heartbeat(uint32_t delay_ms);  // 按 on_heartbeat_timer 给出的时长重新调度心跳定时器
+#endif
+
 private:
     //-------------------------------------------------------------------------------------------
     // Private Members @{
@@ -141,13 +227,16 @@ private:
     const ClientConfigManager&                      config_mgr_;                     ///< 客户端配置管理器
     std::shared_ptr<asio::ip::tcp::socket>          socket_;                         ///< TCP socket
     std::shared_ptr<std::vector<char>>              buffer_;                         ///< 读缓冲区
+    std::vector<char>                               read_pending_;                   ///< 未拆完的接收数据(回调模式，连接建立时清空)
     MessageCallback                                 on_message_;                     ///< 消息接收回调
+    ConnectionCallback                              on_connection_change_;           ///< 连接建立/断开回调
     std::mutex                                      send_mutex_;                     ///< 发送消息的互斥锁
 
     // 消息队列和连接监测
     std::unique_ptr<PersistentMessageQueue>         message_queue_;                  ///< 持久化消息队列
     std::unique_ptr<ConnectionMonitor>              connection_monitor_;             ///< 连接监测器
     std::atomic<bool>                               is_sending_{ false };            ///< 是否正在发送
+    std::atomic<uint64_t>                           in_flight_id_{ 0 };              ///< 正在写出的消息ID(0 表示没有)
 
     // 重连相关状态
     int                                             current_reconnect_attempts_;     ///< 当前重连尝试次数
@@ -158,11 +247,22 @@ private:
     // 心跳相关状态
     std::shared_ptr<asio::steady_timer>             heartbeat_timer_;                ///< 心跳定时器
     std::atomic<bool>                               heartbeat_enabled_{ false };     ///< 是否启用心跳
+    std::atomic<bool>                               heartbeat_channel_{ true };      ///< 本连接是否为心跳控制通道(否则只发保活 PING)
     std::atomic<uint32_t>                           heartbeat_interval_ms_{ 10000 }; ///< 心跳间隔
     std::atomic<uint32_t>                           heartbeat_sequence_{ 0 };        ///< 心跳序列号
     std::atomic<uint64_t>                           last_pong_time_ms_{ 0 };         ///< 最后收到PONG时间
+    std::atomic<uint64_t>                           last_receive_time_ms_{ 0 };      ///< 最后收到任意数据时间
+    std::atomic<uint64_t>                           ping_sent_time_ms_{ 0 };         ///< 等待应答的 PING 发出时间
+    std::atomic<bool>                               ping_outstanding_{ false };      ///< 是否有 PING 在等待应答
     std::atomic<uint32_t>                           heartbeat_failure_count_{ 0 };   ///< 心跳失败计数
     std::string                                     client_computer_name_;           ///< 客户端计算机名称
+
+#ifdef LUSP_IPC_COROUTINES
+    // 协程发送循环
+    std::shared_ptr<asio::steady_timer>             send_signal_;                    ///< 当前连接发送循环的唤醒信号(取消等待即唤醒)
+    std::atomic<bool>                               send_loop_idle_{ false };        ///< 发送循环是否在等待唤醒
+    std::atomic<bool>                               ping_pending_{ false };          ///< 是否有待发送的心跳PING
+#endif
     //-------------------------------------------------------------------------------------------
     // @}
     //-------------------------------------------------------------------------------------------
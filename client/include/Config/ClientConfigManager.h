@@ -8,6 +8,7 @@
 #include <functional>
 #include <mutex>
 #include "utils/EnumConvert.hpp"
+#include "Config/Lusp_ExcludeMatcher.h"
 #ifdef _MSC_VER
 // utf-8
 #pragma execution_character_set("utf-8")
@@ -131,6 +132,20 @@ public:
         // ===================== 文件相关 =====================
         std::string targetDir = "/uploads";   // 服务器目标目录
 
+        // ===================== 本地摘要缓存 =====================
+        bool enableDigestCache          = true;         // 是否启用文件摘要缓存(未变化的文件不再重复计算MD5)
+        std::string digestCacheDir      = "./cache";    // 摘要缓存目录
+        uint32_t digestCacheMaxEntries  = 131072;       // 摘要缓存最大条目数(超出后LRU淘汰)
+        bool enableChunkHash            = true;         // 大文件按chunkSize分块并行哈希
+        uint64_t chunkHashThreshold     = 64ull * 1024 * 1024; // 启用分块哈希的文件大小阈值(字节)
+        bool enableContentSniff         = true;         // 无/未知扩展名时读取文件头识别类型
+
+        // ===================== 目录监控 =====================
+        bool enableWatch                = false;        // 是否监控目录并自动入队变化的文件
+        std::vector<std::string> watchDirs;             // 监控的根目录(UTF-8)
+        uint32_t watchDebounceMs        = 500;          // 同一文件最后一次写入后静默多久才入队(毫秒)
+        bool watchInitialScan           = true;         // 启动监控时与摘要缓存对账，入队离线期间变化的文件
+
 
         bool useSSL                     = false;        // 是否启用 SSL/TLS
         std::string certFile            = "";           // 客户端证书文件
@@ -183,18 +198,18 @@ public:
         uint32_t writeTimeoutMs          = 30000;  // 写入超时时间
 
         uint32_t bufferSize              = 8192;   // 网络缓冲区大小
-        uint32_t maxConnections          = 10;     // 最大连接数
+        uint32_t maxConnections          = 10;     // 最大连接数(IPC 通道池的通道数)
         bool     enableKeepAlive         = true;   // 启用Keep-Alive
         uint32_t keepAliveIntervalMs     = 30000;  // Keep-Alive间隔
 
         // 应用层心跳配置
         bool     enableAppHeartbeat      = true;   // 启用应用层心跳
-        uint32_t heartbeatIntervalMs     = 10000;  // 心跳发送间隔（毫秒）
-        uint32_t heartbeatTimeoutMs      = 30000;  // 心跳超时时间（毫秒）
+        uint32_t heartbeatIntervalMs     = 10000;  // 空闲心跳间隔（毫秒，有数据收发时不发 PING）
+        uint32_t heartbeatTimeoutMs      = 30000;  // 单个 PING 等待应答上限（毫秒，实际按 RTO 等待）
         uint32_t heartbeatMaxFailures    = 3;      // 连续失败次数触发重连
 
         bool     enableAutoReconnect     = true;   // 启用自动重连
-        uint32_t reconnectIntervalMs     = 1000;   // 重连间隔（毫秒）
+        uint32_t reconnectIntervalMs     = 1000;   // 重连间隔（毫秒，有 RTT 样本时取 RTO 且不超过此值）
         uint32_t maxReconnectAttempts    = 5;      // 最大重连尝试次数
         uint32_t reconnectBackoffMs      = 2000;   // 重连退避时间（毫秒）
         bool     enableReconnectBackoff  = true;   // 启用重连退避策略
@@ -281,6 +296,12 @@ public:
      */
     const NetworkConfig& getNetworkConfig() const { return m_networkConfig; }
 
+    /**
+     * @brief 获取编译后的排除模式匹配器
+     * @return 当前匹配器快照(配置重载时整体替换，已取得的快照不受影响)
+     */
+    std::shared_ptr<const Lusp_ExcludeMatcher> getExcludeMatcher() const;
+
     // ===================== 配置更新通知 =====================
 
     /**
@@ -444,6 +465,11 @@ private:
      */
     void parseStringArray(const toml::value& section, const std::string& key, std::vector<std::string>& target);
 
+    /**
+     * @brief 根据 excludePatterns 重新编译排除匹配器并原子替换
+     */
+    void rebuildExcludeMatcher();
+
 private:
     // ===================== 成员变量 =====================
     UploadConfig                                    m_uploadConfig;      // 上传配置
@@ -453,6 +479,7 @@ private:
     mutable std::string                             m_lastError;         // 最后的错误信息
     std::string                                     m_currentConfigPath; // 当前配置文件路径
     mutable std::mutex                              m_configMutex;       // 配置访问互斥锁
+    std::shared_ptr<const Lusp_ExcludeMatcher>      m_excludeMatcher;    // 编译后的排除匹配器(原子读写)
     static std::unique_ptr<ClientConfigManager>     m_instance;
     static std::mutex                               m_instanceMutex;
 
@@ -0,0 +1,102 @@
+#ifndef LUSP_EXCLUDE_MATCHER_H
+#define LUSP_EXCLUDE_MATCHER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief 编译后的排除模式匹配器
+ *
+ * 将 UploadConfig::excludePatterns 一次性编译为组合匹配器，避免逐条 fnmatch:
+ * - 精确文件名(如 Thumbs.db)          -> 哈希集合，一次查找
+ * - 纯后缀(如 *.tmp、*.tar.gz)       -> 按后缀长度分组的哈希集合，每种长度一次查找
+ * - 其余通配模式(?、[]、多个 *)       -> 合并为一个位并行 NFA，编译期子集构造为 DFA，逐字节一次查表
+ *
+ * 模式语法: * 任意字符(不跨 /)，** 任意字符(跨 /)，? 单个字符，[abc] [a-z] [!a] 字符集。
+ * 不含 / 的模式匹配文件/目录名；含 / 的模式匹配相对遍历根目录的路径(以 / 分隔)。
+ * Windows 下按 ASCII 忽略大小写。
+ *
+ * 编译后的对象不可变，可被多个线程无锁共享；配置重载时整体替换 shared_ptr。
+ */
+class Lusp_ExcludeMatcher {
+public:
+#ifdef _WIN32
+    static constexpr bool kDefaultCaseInsensitive = true;
+#else
+    static constexpr bool kDefaultCaseInsensitive = false;
+#endif
+
+    /**
+     * @brief 编译统计
+     */
+    struct Statistics {
+        size_t  exactNames      = 0;    ///< 精确文件名数
+        size_t  suffixes        = 0;    ///< 后缀数
+        size_t  namePatterns    = 0;    ///< 进入 NFA 的文件名模式数
+        size_t  pathPatterns    = 0;    ///< 进入 NFA 的路径模式数
+        size_t  nfaStates       = 0;    ///< NFA 状态位总数
+        size_t  dfaStates       = 0;    ///< DFA 状态数(0 表示状态过多，使用 NFA)
+        bool    matchAll        = false;///< 是否存在 "*"
+    };
+
+    /**
+     * @brief 编译模式列表
+     * @param patterns        模式列表(UTF-8)
+     * @param caseInsensitive 是否忽略大小写(ASCII)
+     * @return 编译结果(不会为空)
+     */
+    static std::shared_ptr<const Lusp_ExcludeMatcher> compile(const std::vector<std::string>& patterns,
+        bool caseInsensitive = kDefaultCaseInsensitive);
+
+    ~Lusp_ExcludeMatcher();
+
+    /**
+     * @brief 判断文件/目录名是否被排除
+     * @param name 文件/目录名(UTF-8，不含路径)
+     */
+    bool matchName(std::string_view name) const;
+
+    /**
+     * @brief 判断相对路径是否被排除(先匹配文件名规则，再匹配路径规则)
+     * @param relativePath 相对遍历根目录的路径(UTF-8，以 / 分隔)
+     */
+    bool matchPath(std::string_view relativePath) const;
+
+    /**
+     * @brief 是否存在需要完整相对路径的规则
+     */
+    bool hasPathRules() const { return m_pathProgram != nullptr; }
+
+    /**
+     * @brief 是否没有任何规则
+     */
+    bool empty() const;
+
+    Statistics getStatistics() const { return m_stats; }
+
+private:
+    struct GlobProgram;
+
+    Lusp_ExcludeMatcher() = default;
+    Lusp_ExcludeMatcher(const Lusp_ExcludeMatcher&) = delete;
+    Lusp_ExcludeMatcher& operator=(const Lusp_ExcludeMatcher&) = delete;
+
+    bool                                    m_caseInsensitive = false;
+    bool                                    m_matchAll = false;
+    bool                                    m_hasSuffixes = false;
+    std::string                             m_literalStorage;   ///< 精确名与后缀的连续存储，下面的 string_view 指向这里
+    std::unordered_set<std::string_view>    m_exactNames;
+    std::unordered_set<std::string_view>    m_suffixes;
+    std::vector<size_t>                     m_suffixLengths;    ///< 出现过的后缀长度(升序，>= 2)
+    std::vector<uint64_t>                   m_suffixTailBits;   ///< 后缀末两字节的位图(65536 位)，不命中则无需查哈希
+    std::vector<uint64_t>                   m_oneByteSuffixes;  ///< 单字节后缀位图(256 位，如 *~)
+    std::unique_ptr<GlobProgram>            m_nameProgram;
+    std::unique_ptr<GlobProgram>            m_pathProgram;
+    Statistics                              m_stats;
+};
+
+#endif // LUSP_EXCLUDE_MATCHER_H
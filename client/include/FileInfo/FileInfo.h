@@ -13,8 +13,8 @@
 #include <iomanip>
 #include <sstream>
 #include <cstdint>
-#include <rpc.h>
 #include <string>
+#include <vector>
 #include <filesystem>
 
 #include "log_headers.h"
@@ -93,10 +93,15 @@ DEFINE_ENUM_SUPPORT(Lusp_FileExistPolicy)
     std::string                        sFileMd5ValueInfo;           /*!< 文件MD5值 */
     Lusp_FileExistPolicy               eFileExistPolicy;            /*!< 文件存在策略 */
     std::string                        sAuthTokenValues;            /*!< Wan 上传时的tokenkey LAN 中不使用 */
+    uint64_t                           uFileId;                     /*!< 上传ID(Lusp_UploadIdGenerator 生成，进程内单调递增) */
     uint64_t                           uUploadTimeStamp;            /*!< 上传时间戳  精确级别：毫秒级*/
     Lusp_UploadStatusInf               eUploadStatusInf;            /*!< 上传状态 */
     std::u16string                     sDescriptionInfo;            /*!< 描述信息 在没有上传成功时被赋值*/
     std::chrono::steady_clock::time_point   enqueueTime;            /*!< 入队时间戳（用于队列延迟统计）*/
+    uint32_t                           uChunkHashSize;              /*!< 分块哈希的分块大小 0表示使用整文件MD5 */
+    std::vector<uint8_t>               vChunkDigests;               /*!< 各分块MD5(16字节/块) 命中摘要缓存时取自缓存 */
+    std::string                        sChunkRootDigest;            /*!< 分块哈希根摘要 */
+    bool                               bPayloadCompressed;          /*!< 内容已是压缩格式(zip/jpg/mp4等) 上传时跳过压缩 */
 
 }Lusp_SyncUploadFileInfo, * PLusp_SyncUploadFileInfo;
 
@@ -138,8 +143,13 @@ public:
 
     // 文件MD5/唯一标识
     bool                         calculateFileMd5ValueInfo();
+    bool                         calculateChunkHashTree(uint32_t chunkSize);
+    bool                         isChunkHashed()          const { return m_fileInfo.uChunkHashSize != 0; }
+    std::string                  getChunkRootDigest()     const { return m_fileInfo.sChunkRootDigest; }
+    bool                         isPayloadCompressed()    const { return m_fileInfo.bPayloadCompressed; }
     std::string                  getMd5Hash()             const { return m_fileInfo.sFileMd5ValueInfo; }
-    std::string                  getId()                  const { return m_id; }
+    uint64_t                     getId()                  const { return m_id; }
+    std::string                  getIdText()              const;
 
     // 设备信息
     std::string                  getComputerName();
@@ -160,16 +170,17 @@ public:
     void                         setDescription(const std::u16string& desc);
     void                         setRecordTime(const std::string& recordTime) { m_fileInfo.sFileRecordTimeValue = recordTime; }
     void                         setFileExistPolicy(Lusp_FileExistPolicy policy) { m_fileInfo.eFileExistPolicy = policy; }
-    void                         setId(const std::string& id) { m_id = id; }
+    void                         setId(uint64_t id) { m_id = m_fileInfo.uFileId = id; }
 
 private:
     void                         updateFileInfoFromFileSystem();
-    std::string                  generateUuidWindows();
+    void                         resolveFileDigest(const std::filesystem::path& path, const std::string& filePathUtf8);
     void                         initializeDefaults();
-    Lusp_UploadFileTyped         detectFileType(const std::string& filePath) const;
+    Lusp_UploadFileTyped         detectFileType(const std::u16string& filePath) const;
+    void                         classifyFileContent(const std::filesystem::path& path);
 
     Lusp_SyncUploadFileInfo      m_fileInfo;
-    std::string                  m_id;
+    uint64_t                     m_id = 0;
     uint64_t                     m_uploadedBytesCount;
     bool                         m_valid = false;
     std::string                  m_error;
@@ -19,7 +19,7 @@ public:
     // explicit FileInfoQtAdapter(const Lusp_SyncUploadFileInfo& info) = delete;
 
     // Qt友好getter
-    QString getId() const { return QString::fromStdString(m_handler.getId()); }
+    QString getId() const { return QString::fromStdString(m_handler.getIdText()); }
     QString getFilePath() const { return QString::fromStdString(m_handler.getFilePath()); }
     // 使用 UTF-16 直接构造 QString，避免编码转换问题
     QString getFileName() const {
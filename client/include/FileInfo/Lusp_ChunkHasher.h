@@ -0,0 +1,83 @@
+#ifndef LUSP_CHUNK_HASHER_H
+#define LUSP_CHUNK_HASHER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 分块哈希结果
+ *
+ * 分块与 UploadConfig::chunkSize 对齐，最后一块可能不足一个分块大小。
+ */
+struct Lusp_ChunkHashResult {
+    uint32_t                chunkSize = 0;      ///< 分块大小(字节)
+    std::vector<uint8_t>    chunkDigests;       ///< 各分块 MD5(每块 16 字节，按块序拼接)
+    std::string             rootDigest;         ///< 根摘要: chunkDigests 整体的 MD5(十六进制)
+
+    size_t chunkCount() const { return chunkDigests.size() / 16; }
+};
+
+/**
+ * @brief 分块哈希计算器(两层哈希树)
+ *
+ * MD5 本身是串行的，大文件整体计算只能用满一个核。分块模式下各块独立计算，
+ * 由调用线程与进程内共享的哈希线程池(硬件并发数-1 个线程)并行完成，再对分块摘要列表计算一次根摘要:
+ * - 客户端可以并行哈希单个大文件
+ * - 接收端可以逐块校验，出错只需重传对应分块
+ * - 断点续传时只需比对分块摘要，无需重新读取整个文件
+ */
+class Lusp_ChunkHasher {
+public:
+    static constexpr size_t kDigestBytes = 16;  ///< 单个分块摘要长度(MD5)
+
+    /**
+     * @brief 并行计算文件的分块哈希
+     * @param filePath   文件路径
+     * @param fileSize   文件大小(字节)
+     * @param chunkSize  分块大小(字节)
+     * @param result     输出结果
+     * @param maxThreads 单个文件的最大并发数(0=共享池线程数+1，含调用线程)
+     * @return 是否成功
+     */
+    static bool hashFile(const std::filesystem::path& filePath, uint64_t fileSize, uint32_t chunkSize,
+        Lusp_ChunkHashResult& result, unsigned maxThreads = 0);
+
+    /**
+     * @brief 计算单个分块的摘要
+     * @param data   分块数据
+     * @param len    数据长度
+     * @param digest 输出摘要(16 字节)
+     */
+    static void hashChunk(const void* data, size_t len, uint8_t digest[kDigestBytes]);
+
+    /**
+     * @brief 校验单个分块
+     * @param data           分块数据
+     * @param len            数据长度
+     * @param expectedDigest 期望摘要(16 字节)
+     * @return 是否一致
+     */
+    static bool verifyChunk(const void* data, size_t len, const uint8_t* expectedDigest);
+
+    /**
+     * @brief 根据分块摘要列表计算根摘要
+     * @param chunkDigests 分块摘要列表
+     * @return 十六进制根摘要
+     */
+    static std::string computeRoot(const std::vector<uint8_t>& chunkDigests);
+
+    /**
+     * @brief 编码为摘要缓存中的字符串("ct<分块大小>:<根摘要>")
+     */
+    static std::string toCacheDigest(uint32_t chunkSize, const std::string& rootDigest);
+
+    /**
+     * @brief 从摘要缓存字符串解析分块大小与根摘要
+     * @return 是否为分块哈希格式
+     */
+    static bool parseCacheDigest(const std::string& cacheDigest, uint32_t& chunkSize, std::string& rootDigest);
+};
+
+#endif // LUSP_CHUNK_HASHER_H
@@ -0,0 +1,216 @@
+#ifndef LUSP_FILE_DIGEST_CACHE_H
+#define LUSP_FILE_DIGEST_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 文件摘要缓存键
+ *
+ * 四元组全部一致才视为同一份文件内容，任意一项变化(改写、替换、移动)都会导致缓存未命中。
+ */
+struct Lusp_FileStatKey {
+    uint64_t    pathHash    = 0;    ///< 规范化路径的 64 位哈希
+    uint64_t    fileSize    = 0;    ///< 文件大小(字节)
+    int64_t     mtimeNs     = 0;    ///< 最后修改时间(自 Unix 纪元起的纳秒数)
+    uint64_t    fileId      = 0;    ///< 文件标识(POSIX: st_dev/st_ino, Windows: 卷序列号/FileIndex)
+
+    bool operator==(const Lusp_FileStatKey& other) const {
+        return pathHash == other.pathHash && fileSize == other.fileSize &&
+            mtimeNs == other.mtimeNs && fileId == other.fileId;
+    }
+    bool operator!=(const Lusp_FileStatKey& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 持久化文件摘要缓存
+ *
+ * 重复添加同一目录时避免对未变化的文件重新计算 MD5，只需读取文件元数据。
+ *
+ * 特性:
+ * 1. 磁盘端为紧凑的追加写日志(每条记录自带 CRC32)，崩溃只会丢失未写完的尾部记录
+ *    分块哈希的文件连同分块摘要列表一起缓存，命中后接收端仍可逐块校验与续传
+ * 2. 内存端为开放寻址(线性探测)哈希索引，按路径哈希定位，一个路径只保留一条记录
+ * 3. 条目数有上限，超出后按 LRU 淘汰最久未使用的条目
+ * 4. 日志中的失效记录过多时自动压缩: 先写临时文件并 fsync，再原子 rename 覆盖旧日志并 fsync 目录
+ *
+ * @note 线程安全，可被多个入队/扫描线程同时调用
+ */
+class Lusp_FileDigestCache {
+public:
+    /**
+     * @brief 获取全局实例
+     */
+    static Lusp_FileDigestCache& instance();
+
+    // 禁止拷贝
+    Lusp_FileDigestCache(const Lusp_FileDigestCache&) = delete;
+    Lusp_FileDigestCache& operator=(const Lusp_FileDigestCache&) = delete;
+
+    /**
+     * @brief 打开(或创建)缓存目录并回放日志
+     * @param cacheDir   缓存目录
+     * @param maxEntries 最大条目数(超出后 LRU 淘汰)
+     * @return 是否成功
+     */
+    bool open(const std::filesystem::path& cacheDir, size_t maxEntries = 131072);
+
+    /**
+     * @brief 刷新并关闭缓存
+     */
+    void close();
+
+    /**
+     * @brief 缓存是否已打开
+     */
+    bool isOpen() const { return m_opened.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 读取文件元数据生成缓存键(不读取文件内容)
+     * @param filePath 文件路径
+     * @param key      输出的缓存键
+     * @return 是否成功
+     */
+    static bool queryFileKey(const std::filesystem::path& filePath, Lusp_FileStatKey& key);
+
+    /**
+     * @brief 查询缓存
+     * @param key          缓存键
+     * @param digest       命中时输出的摘要
+     * @param chunkDigests 命中时输出的分块摘要列表(可为空，非分块哈希条目输出空列表)
+     * @return 是否命中
+     */
+    bool lookup(const Lusp_FileStatKey& key, std::string& digest, std::vector<uint8_t>* chunkDigests = nullptr);
+
+    /**
+     * @brief 写入缓存(同一路径的旧记录被替换)
+     * @param key          缓存键
+     * @param digest       摘要(最长 64 字节)
+     * @param chunkDigests 分块摘要列表(每块 16 字节，非分块哈希为空)
+     * @return 是否成功
+     */
+    bool store(const Lusp_FileStatKey& key, const std::string& digest, const std::vector<uint8_t>& chunkDigests = {});
+
+    /**
+     * @brief 压缩日志，只保留当前有效条目
+     * @return 是否成功
+     */
+    bool compact();
+
+    /**
+     * @brief 获取统计信息
+     */
+    struct Statistics {
+        size_t      entries;        // 当前条目数
+        size_t      maxEntries;     // 最大条目数
+        uint64_t    hits;           // 命中次数
+        uint64_t    misses;         // 未命中次数
+        uint64_t    evictions;      // LRU 淘汰次数
+        uint64_t    logRecords;     // 日志记录数(含失效记录)
+        uint64_t    logBytes;       // 日志文件大小
+        uint64_t    compactions;    // 压缩次数
+    };
+    Statistics getStatistics() const;
+
+private:
+    Lusp_FileDigestCache() = default;
+    ~Lusp_FileDigestCache();
+
+    static constexpr uint32_t   kInvalidIndex   = 0xFFFFFFFFu;  ///< 空槽 / 链表结束
+    static constexpr uint32_t   kTombstone      = 0xFFFFFFFEu;  ///< 已删除槽
+    static constexpr size_t     kMaxDigestLen   = 64;           ///< 摘要最大长度
+    static constexpr size_t     kMaxChunkDigestBytes = 16u * 1024 * 1024;   ///< 分块摘要列表最大长度(1M 个分块)
+
+    // 缓存条目(同时挂在 LRU 双向链表上)
+    struct Entry {
+        Lusp_FileStatKey    key;
+        uint32_t            prev        = kInvalidIndex;
+        uint32_t            next        = kInvalidIndex;
+        uint8_t             digestLen   = 0;
+        char                digest[kMaxDigestLen];
+        std::vector<uint8_t> chunkDigests;          ///< 分块摘要列表(只有分块哈希的大文件非空)
+    };
+
+    // 哈希索引
+    size_t      slotOf(uint64_t pathHash) const;
+    uint32_t    findEntry(uint64_t pathHash, size_t* slotOut = nullptr) const;
+    void        insertSlot(uint64_t pathHash, uint32_t entryIndex);
+    void        rehash(size_t newCapacity);
+
+    // LRU 链表
+    void        lruUnlink(uint32_t entryIndex);
+    void        lruPushFront(uint32_t entryIndex);
+    void        evictOldest();
+
+    // 内存更新(调用方持有 m_mutex)
+    void        putLocked(const Lusp_FileStatKey& key, const char* digest, size_t digestLen,
+                          const uint8_t* chunkDigests, size_t chunkDigestLen);
+
+    // 日志操作(调用方持有 m_mutex)
+    bool        replayLog();
+    bool        appendRecord(const Lusp_FileStatKey& key, const char* digest, size_t digestLen,
+                             const std::vector<uint8_t>& chunkDigests);
+    bool        compactLocked();
+    bool        maybeCompactLocked();
+
+    static void     encodeRecord(std::vector<char>& out, const Lusp_FileStatKey& key, const char* digest, size_t digestLen,
+                                 const std::vector<uint8_t>& chunkDigests);
+    static uint32_t crc32Of(const char* data, size_t len);
+
+private:
+    /*   日志文件格式  */
+    // ┌─────────────────────────────────────────────────────────────┐
+    // │                    文件头(8 bytes)                          │
+    // ├─────────────────────────────────────────────────────────────┤
+    // │  Offset 0 - 3 : magic_number(uint32_t) = 0x4C464443         │  ← "CDFL" 魔数
+    // │  Offset 4 - 7 : version(uint32_t) = 2                       │  ← 版本号
+    // ├─────────────────────────────────────────────────────────────┤
+    // │              记录(变长，追加写，重复 N 次)                   │
+    // ├─────────────────────────────────────────────────────────────┤
+    // │  Offset 0 - 3   : crc32(uint32_t)       记录其余部分的 CRC32 │
+    // │  Offset 4 - 11  : path_hash(uint64_t)                       │
+    // │  Offset 12 - 19 : file_size(uint64_t)                       │
+    // │  Offset 20 - 27 : mtime_ns(int64_t)                         │
+    // │  Offset 28 - 35 : file_id(uint64_t)                         │
+    // │  Offset 36      : digest_len(uint8_t)                       │
+    // │  Offset 37 - 40 : chunk_digests_len(uint32_t)               │
+    // │  Offset 41 ~    : digest(char[digest_len])                  │
+    // │  随后           : chunk_digests(uint8_t[chunk_digests_len]) │
+    // └─────────────────────────────────────────────────────────────┘
+    // 同一 path_hash 以最后一条记录为准；回放时遇到 CRC 错误或不完整记录即截断尾部。
+    // 版本 1 的日志没有分块摘要列表，打开时整体丢弃重建。
+
+    mutable std::mutex                  m_mutex;                        ///< 保护索引、链表与日志
+    std::atomic<bool>                   m_opened{ false };              ///< 是否已打开
+
+    // 内存索引
+    std::vector<Entry>                  m_entries;                      ///< 条目池
+    std::vector<uint32_t>               m_freeList;                     ///< 空闲条目下标
+    std::vector<uint32_t>               m_slots;                        ///< 开放寻址槽(存条目下标)
+    size_t                              m_slotMask = 0;                 ///< 槽数 - 1(槽数为 2 的幂)
+    size_t                              m_liveCount = 0;                ///< 有效条目数
+    size_t                              m_tombstoneCount = 0;           ///< 墓碑槽数
+    size_t                              m_maxEntries = 0;               ///< 最大条目数
+    uint32_t                            m_lruHead = kInvalidIndex;      ///< 最近使用
+    uint32_t                            m_lruTail = kInvalidIndex;      ///< 最久未使用
+
+    // 磁盘日志
+    std::filesystem::path               m_logPath;                      ///< 日志文件路径
+    std::filesystem::path               m_tmpPath;                      ///< 压缩临时文件路径
+    std::ofstream                       m_logWriter;                    ///< 日志追加流
+    uint64_t                            m_logRecords = 0;               ///< 日志记录数
+    uint64_t                            m_logBytes = 0;                 ///< 日志字节数
+
+    // 统计
+    std::atomic<uint64_t>               m_hits{ 0 };                    ///< 命中次数
+    std::atomic<uint64_t>               m_misses{ 0 };                  ///< 未命中次数
+    std::atomic<uint64_t>               m_evictions{ 0 };               ///< 淘汰次数
+    std::atomic<uint64_t>               m_compactions{ 0 };             ///< 压缩次数
+};
+
+#endif // LUSP_FILE_DIGEST_CACHE_H
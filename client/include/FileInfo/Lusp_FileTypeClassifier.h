@@ -0,0 +1,93 @@
+#ifndef LUSP_FILE_TYPE_CLASSIFIER_H
+#define LUSP_FILE_TYPE_CLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+enum class Lusp_UploadFileTyped;
+
+/**
+ * @brief 文件头魔数识别出的内容格式
+ */
+enum class Lusp_ContentFormat : uint8_t {
+    Unknown,
+    Zip,        ///< PK\x03\x04 (含 docx/xlsx/jar/apk)
+    Gzip,
+    Bzip2,
+    Xz,
+    Zstd,
+    SevenZip,
+    Rar,
+    Png,
+    Jpeg,
+    Gif,
+    WebP,
+    Mp4,        ///< ISO BMFF: ....ftyp (含 mov/m4a/heic)
+    Matroska,   ///< mkv/webm
+    Avi,
+    Mp3,
+    Flac,
+    Ogg,
+    Wav,
+    Pdf
+};
+
+/**
+ * @brief 文件类型分类器
+ *
+ * 扩展名查表使用编译期生成的完美哈希表: 扩展名(最多 8 个 ASCII 字符，忽略大小写)打包成一个
+ * 64 位整数，乘法哈希直接定位唯一槽位，一次整数比较确认，无字符串拷贝、无 std::filesystem::path 构造。
+ *
+ * 内容嗅探读取文件头 64 字节识别常见压缩/媒体格式，用于:
+ * - 无扩展名或未知扩展名文件的分类
+ * - 判断负载是否已压缩，上传时跳过压缩
+ */
+class Lusp_FileTypeClassifier {
+public:
+    static constexpr size_t kSniffBytes = 64;   ///< 内容嗅探读取的字节数
+
+    /**
+     * @brief 按扩展名分类
+     * @param path 文件路径或文件名(UTF-16/UTF-8)
+     * @return 文件类型，未知扩展名返回 LUSP_UPLOADTYPE_UNDEFINED
+     */
+    static Lusp_UploadFileTyped classifyByExtension(std::u16string_view path) noexcept;
+    static Lusp_UploadFileTyped classifyByExtension(std::string_view path) noexcept;
+
+    /**
+     * @brief 扩展名是否对应已压缩的格式(zip/jpg/mp4 等)
+     */
+    static bool isCompressedExtension(std::u16string_view path) noexcept;
+
+    /**
+     * @brief 根据文件头识别内容格式
+     * @param head 文件开头的数据
+     * @param len  数据长度(建议 kSniffBytes)
+     */
+    static Lusp_ContentFormat sniffContent(const uint8_t* head, size_t len) noexcept;
+
+    /**
+     * @brief 读取文件头并识别内容格式
+     * @return 无法读取时返回 Unknown
+     */
+    static Lusp_ContentFormat sniffFile(const std::filesystem::path& filePath);
+
+    /**
+     * @brief 内容格式对应的上传类型
+     */
+    static Lusp_UploadFileTyped typeOfFormat(Lusp_ContentFormat format) noexcept;
+
+    /**
+     * @brief 内容格式是否已经压缩(再压缩收益很低)
+     */
+    static bool isCompressedFormat(Lusp_ContentFormat format) noexcept;
+
+    /**
+     * @brief 内容格式名称(用于日志)
+     */
+    static const char* formatName(Lusp_ContentFormat format) noexcept;
+};
+
+#endif // LUSP_FILE_TYPE_CLASSIFIER_H
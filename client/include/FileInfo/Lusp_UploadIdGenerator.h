@@ -0,0 +1,81 @@
+#ifndef LUSP_UPLOAD_ID_GENERATOR_H
+#define LUSP_UPLOAD_ID_GENERATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 上传 ID 的组成部分
+ */
+struct Lusp_UploadIdParts {
+    uint64_t    timestampMs = 0;    ///< Unix 毫秒时间戳
+    uint32_t    nodeId      = 0;    ///< 节点号
+    uint32_t    sequence    = 0;    ///< 同一毫秒内的序列号
+};
+
+/**
+ * @brief 64 位上传 ID 生成器(snowflake 布局)
+ *
+ * 布局(高位到低位): 1 位保留 | 41 位毫秒时间戳(自 2025-01-01 起) | 10 位节点号 | 12 位序列号
+ *
+ * - 无锁: 状态为一个 atomic<uint64_t>(时间戳 << 12 | 序列号)，CAS 推进
+ * - 无分配: next() 不分配内存，格式化只用于日志
+ * - 单调: 同一进程内严格递增；同一毫秒序列号用尽或系统时钟回拨时沿用上次的时间戳继续递增，不等待
+ *
+ * 节点号默认由计算机名与进程号散列得到，多客户端部署时可用 setNodeId 指定。
+ */
+class Lusp_UploadIdGenerator {
+public:
+    static constexpr unsigned   kSequenceBits   = 12;
+    static constexpr unsigned   kNodeBits       = 10;
+    static constexpr unsigned   kTimestampBits  = 41;
+    static constexpr uint64_t   kEpochMs        = 1735689600000ull;    ///< 2025-01-01T00:00:00Z
+    static constexpr size_t     kFormattedLength = 16;                  ///< 格式化后的长度(16 位十六进制)
+
+    /**
+     * @brief 获取全局实例
+     */
+    static Lusp_UploadIdGenerator& instance();
+
+    Lusp_UploadIdGenerator(const Lusp_UploadIdGenerator&) = delete;
+    Lusp_UploadIdGenerator& operator=(const Lusp_UploadIdGenerator&) = delete;
+
+    /**
+     * @brief 生成下一个 ID(线程安全，无锁)
+     */
+    uint64_t next();
+
+    /**
+     * @brief 指定节点号(只取低 10 位)，应在生成 ID 之前调用
+     */
+    void setNodeId(uint32_t nodeId);
+    uint32_t nodeId() const { return m_nodeId.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 拆分 ID
+     */
+    static Lusp_UploadIdParts decompose(uint64_t id);
+
+    /**
+     * @brief 格式化为 16 位十六进制(不分配内存)
+     * @param buffer 输出缓冲区，至少 kFormattedLength + 1 字节
+     */
+    static void format(uint64_t id, char* buffer);
+
+    /**
+     * @brief 格式化为字符串(用于日志)
+     */
+    static std::string toString(uint64_t id);
+
+private:
+    Lusp_UploadIdGenerator();
+
+    static uint32_t defaultNodeId();
+
+    std::atomic<uint64_t>   m_state{ 0 };   ///< 上次发出的 (时间戳 << kSequenceBits | 序列号)
+    std::atomic<uint32_t>   m_nodeId{ 0 };
+};
+
+#endif // LUSP_UPLOAD_ID_GENERATOR_H
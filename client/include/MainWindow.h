@@ -32,6 +32,7 @@ private:
     void setupUploadQueue();
     void addFilesToList(const QStringList& filePaths);
     void addFilesToUploadQueue(const QStringList& filePaths);
+    void addDirectoryToUploadQueue(const QString& dirPath);
 
 private:
 
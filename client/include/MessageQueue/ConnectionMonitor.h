@@ -76,6 +76,18 @@ struct ConnectionStatistics
     uint64_t total_connected_duration_ms = 0; ///< 总连接持续时长
 };
 
+/**
+ * @brief 往返时延统计信息 (RFC 6298 平滑估计)
+ */
+struct RttStatistics
+{
+    uint64_t sample_count = 0;              ///< 有效样本数
+    uint32_t last_rtt_ms = 0;               ///< 最近一次样本
+    uint32_t min_rtt_ms = 0;                ///< 最小样本
+    double   srtt_ms = 0.0;                 ///< 平滑往返时延 SRTT
+    double   rttvar_ms = 0.0;               ///< 往返时延抖动 RTTVAR
+};
+
 // 使用宏定义枚举转换支持
 DEFINE_ENUM_SUPPORT(ConnectionState)
 DEFINE_ENUM_SUPPORT(ErrorCategory)
@@ -91,6 +103,7 @@ DEFINE_ENUM_SUPPORT(ErrorCategory)
  * 3. 判断是否需要重连
  * 4. 防止重复触发重连
  * 5. 提供详细的连接和错误统计
+ * 6. 按心跳 PING/PONG 估计往返时延(RFC 6298)，给出超时/重连等待时间
  */
     class ConnectionMonitor
 {
@@ -175,6 +188,38 @@ public:
      */
     void record_heartbeat_success();
 
+    /**
+     * @brief 记录收到数据 (任意帧都说明对端存活)
+     */
+    void record_receive();
+
+    // ==================== 往返时延估计 ====================
+
+    /**
+     * @brief 记录一次往返时延样本
+     * @details 首个样本 SRTT = R, RTTVAR = R/2；之后 RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|，
+     *          SRTT = 7/8 SRTT + 1/8 R。连接重建后保留估计值(同一条回环路径)
+     * @param rtt_ms 往返时延(毫秒)
+     */
+    void record_rtt_sample(uint32_t rtt_ms);
+
+    /**
+     * @brief 是否已有往返时延样本
+     */
+    bool has_rtt_sample() const;
+
+    /**
+     * @brief 获取重传超时 RTO = SRTT + max(G, 4 * RTTVAR)
+     * @details 无样本时为 INITIAL_RTO_MS，结果限制在 [MIN_RTO_MS, max_rto_ms]
+     * @param max_rto_ms 上限(毫秒)
+     */
+    uint32_t get_rto_ms(uint32_t max_rto_ms) const;
+
+    /**
+     * @brief 获取距最后活跃(收到数据、发送成功、心跳成功)的时长(毫秒)
+     */
+    uint64_t get_idle_time_ms() const;
+
     // ==================== 错误分类 ====================
 
     /**
@@ -225,6 +270,11 @@ public:
      */
     ConnectionStatistics get_connection_statistics() const;
 
+    /**
+     * @brief 获取往返时延统计信息
+     */
+    RttStatistics get_rtt_statistics() const;
+
     /**
      * @brief 打印统计报告
      */
@@ -248,6 +298,10 @@ public:
      */
     void reconnect_completed();
 
+    static constexpr uint32_t MIN_RTO_MS = 200;       ///< RTO 下限(回环/局域网路径，取 Linux TCP 的 200ms 而非 RFC 的 1s)
+    static constexpr uint32_t INITIAL_RTO_MS = 1000;  ///< 无样本时的 RTO
+    static constexpr uint32_t CLOCK_GRANULARITY_MS = 1;  ///< 时间戳粒度 G
+
 private:
     // ==================== 内部方法 ====================
 
@@ -274,6 +328,7 @@ private:
     mutable std::mutex              statistics_mutex_;                        ///< 统计数据互斥锁
     ErrorStatistics                 error_stats_;                             ///< 错误统计
     ConnectionStatistics            connection_stats_;                        ///< 连接统计
+    RttStatistics                   rtt_stats_;                               ///< 往返时延估计
 
     // ==================== 回调函数 ====================
 
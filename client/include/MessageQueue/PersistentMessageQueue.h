@@ -19,16 +19,18 @@
 struct IpcMessage
 {
     uint64_t                id;                    // 消息唯一ID
+    uint64_t                routing_key;           // 分流键(通道池按文件ID选择通道，0 表示未指定)
     uint64_t                timestamp;             // 时间戳(ms)
     uint32_t                priority;              // 优先级(0最高)
     std::vector<uint8_t>    data;                  // 消息数据
 
     IpcMessage()
-        : id(0), timestamp(0), priority(0) {
+        : id(0), routing_key(0), timestamp(0), priority(0) {
     }
 
-    IpcMessage(uint64_t msg_id, const std::vector<uint8_t>& msg_data, uint32_t msg_priority = 0)
+    IpcMessage(uint64_t msg_id, const std::vector<uint8_t>& msg_data, uint32_t msg_priority = 0, uint64_t msg_routing_key = 0)
         : id(msg_id)
+        , routing_key(msg_routing_key)
         , timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch())
             .count())
@@ -90,6 +92,13 @@ public:
      */
     bool pop_front();
 
+    /**
+     * @brief 队首消息ID等于 id 时删除队首(写出完成后调用，队首已被换掉时不误删)
+     * @param id 已写出的消息ID
+     * @return 是否删除
+     */
+    bool pop_front_if(uint64_t id);
+
     /**
      * @brief 获取队列大小(近似值)
      */
@@ -144,6 +153,8 @@ private:
     // 磁盘操作
     bool                        write_to_disk(const IpcMessage& message);
     std::optional<IpcMessage>   read_from_disk();
+    std::optional<uint64_t>     front_id() const;               ///< 队首消息ID(磁盘上的只读消息头)
+    bool                        has_disk_backlog() const;       ///< 磁盘上是否还有未出队的消息
     void                        rebuild_disk_index();           ///< 重建索引（优先从idx，失败才扫描数据文件）
     void                        rebuild_disk_index_from_data(); ///< 从数据文件扫描重建索引
     bool                        load_disk_index();              ///< 从索引文件加载（快速）
@@ -194,6 +205,8 @@ private:
     // │  │ Offset 8 - 15 : timestamp(uint64_t)  时间戳(毫秒)         │  │
     // │  │ Offset 16 - 19 : priority(uint32_t)   优先级(0最高)       │  │
     // │  │ Offset 20 - 23 : data_size(uint32_t)  数据长度            │  │
+    // │  │ Offset 24 - 31 : routing_key(uint64_t) 分流键             │  │
+    // │  │                  (data_size 最高位置 1 时存在)            │  │
     // │  └───────────────────────────────────────────────────────────┘  │
     // │  消息数据(data_size 字节，变长)                                │
     // │  ┌───────────────────────────────────────────────────────────┐  │
@@ -224,6 +237,7 @@ private:
     // │[8 - 15]  timestamp   uint64_t   8 字节               │
     // │[16 - 19] priority    uint32_t   4 字节               │
     // │[20 - 23] data_size   uint32_t   4 字节               │
+    // │[24 - 31] routing_key uint64_t   8 字节(可选)         │
     // ├──────────────────────────────────────────────────────┤
     // │            消息数据(data_size 字节变长)              │
     // ├──────────────────────────────────────────────────────┤
@@ -231,7 +245,9 @@ private:
     // │
     // └──────────────────────────────────────────────────────┘
 
-    // 总大小 = 24 + data_size 字节
+    // 总大小 = 24 + data_size 字节；data_size 最高位(kRoutingKeyFlag)置 1 时头部后跟 8 字节分流键，
+    // 总大小 = 32 + 数据长度。早期写入的消息没有该位，读出的分流键为 0
+    static constexpr uint32_t kRoutingKeyFlag = 0x80000000u;
 
     // 内存队列
     std::unique_ptr<MemoryNode[]>                   memory_buffer_;          ///< 内存队列
@@ -13,6 +13,7 @@
 #include "FileInfo/FileInfo.h"
 #include "SyncUploadQueue/Lusp_SyncUploadQueue.h"
 #include "AsioLoopbackIpcClient/Lusp_AsioLoopbackIpcClient.h"
+#include "AsioLoopbackIpcClient/Lusp_AsioLoopbackIpcChannelPool.h"
 #include "upload_file_info_generated.h"
 
 /**
@@ -80,7 +81,7 @@ public:
      */
     std::string dumpStatus() const;
     /**
-     * @brief 设置IPC客户端（用于自动发送proto消息）。
+     * @brief 设置IPC客户端（用于自动发送proto消息），替代内部通道池。
      */
     void setIpcClient(std::shared_ptr<Lusp_AsioLoopbackIpcClient> ipcClient);
 private:
@@ -108,7 +109,8 @@ private:
     std::atomic<size_t>                             processedCount{ 0 };   ///< 已处理任务数
     std::atomic<uint64_t>                           totalLatencyUs_{ 0 };  ///< 总处理延迟(微秒)，使用原子变量实现无锁累加
     std::atomic<uint64_t>                           errorCount_{ 0 };      ///< 错误计数器，统计处理异常次数
-    std::shared_ptr<Lusp_AsioLoopbackIpcClient>     ipcClient_;            ///< IPC客户端
+    std::shared_ptr<Lusp_AsioLoopbackIpcClient>     ipcClient_;            ///< 外部设置的IPC客户端
+    std::shared_ptr<Lusp_AsioLoopbackIpcChannelPool> ipcChannelPool_;      ///< IPC通道池(默认发送路径)
     const ClientConfigManager* configMgr_;            ///< 配置管理器引用
     std::shared_ptr<asio::io_context>               ioContext_;            ///< Asio IO 上下文
     std::thread                                     ioThread_;             ///< Asio IO 线程
@@ -0,0 +1,132 @@
+#ifndef LUSP_COMPACT_UPLOAD_ITEM_H
+#define LUSP_COMPACT_UPLOAD_ITEM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "FileInfo/FileInfo.h"
+
+/**
+ * @brief 队列中的紧凑文件条目
+ *
+ * 与 Lusp_SyncUploadFileInfo 一一对应，但:
+ * - 所在目录、客户端设备名替换为 Lusp_UploadItemInternTable 中的 32 位 ID
+ * - UUID 令牌与 MD5 以 16 字节二进制定长保存
+ * - 其余变长字段(文件名、描述、记录时间、分块摘要等)打包进一块连续内存，
+ *   长度使用 varint，仅含 Latin-1 字符的 UTF-16 字符串按单字节存储
+ *
+ * 只能通过 Lusp_UploadItemInternTable::pack 构造，unpack 还原为完整结构体。
+ */
+struct Lusp_CompactUploadItem {
+    enum Flags : uint8_t {
+        kMd5Binary          = 1 << 0,   ///< md5 为二进制(否则文本存于 blob)
+        kTokenBinary        = 1 << 1,   ///< tokenId 为二进制 UUID(否则文本存于 blob)
+        kNameDiffers        = 1 << 2,   ///< sOnlyFileNameValue 与路径末段不同，单独存于 blob
+        kPayloadCompressed  = 1 << 3,   ///< bPayloadCompressed
+        kPendingKey         = 1 << 4,   ///< 条目在上传队列的等待索引中登记过，出队时须解除登记
+        kPendingKeyDiffers  = 1 << 5    ///< 登记键与全路径不同，单独存于 blob 末尾
+    };
+
+    uint64_t                    fileSize        = 0;
+    uint64_t                    uploadTimeStamp = 0;
+    uint64_t                    fileId          = 0;
+    int64_t                     enqueueTicks    = 0;    ///< steady_clock 计数
+    uint32_t                    directoryId     = 0;    ///< 目录 ID，0 表示无目录部分
+    uint32_t                    deviceId        = 0;    ///< 设备名字符串 ID，0 表示空串
+    uint32_t                    chunkHashSize   = 0;
+    uint32_t                    blobSize        = 0;
+    std::array<uint8_t, 16>     tokenId{};
+    std::array<uint8_t, 16>     md5{};
+    uint8_t                     fileType        = 0;
+    uint8_t                     existPolicy     = 0;
+    uint8_t                     uploadStatus    = 0;
+    uint8_t                     flags           = 0;
+    std::unique_ptr<uint8_t[]>  blob;
+
+    /**
+     * @brief 条目自身占用的字节数(不含共享的驻留表)
+     */
+    size_t approximateBytes() const { return sizeof(*this) + blobSize; }
+};
+
+/**
+ * @brief 上传队列内存统计
+ */
+struct Lusp_UploadQueueMemoryStats {
+    size_t  queuedItems     = 0;    ///< 队列中的文件数
+    size_t  itemBytes       = 0;    ///< 条目自身占用字节数
+    size_t  internBytes     = 0;    ///< 驻留表占用字节数(目录树、设备名)
+    size_t  directories     = 0;    ///< 驻留的目录节点数
+    size_t  bytesPerItem    = 0;    ///< 平均每个文件占用字节数
+};
+
+/**
+ * @brief 紧凑条目的驻留表
+ *
+ * - 目录以路径前缀树保存: 每个节点只存父节点 ID 与一段路径分量(含结尾分隔符)，
+ *   同一目录下的文件共享一个目录 ID，公共前缀只存一次
+ * - 设备名等高度重复的短串驻留为字符串 ID
+ *
+ * 驻留项只增不减(数量与不同目录数成正比，与文件数无关)。线程安全。
+ */
+class Lusp_UploadItemInternTable {
+public:
+    Lusp_UploadItemInternTable();
+    ~Lusp_UploadItemInternTable();
+
+    /**
+     * @brief 将完整结构体压缩为队列条目
+     * @param pendingKey 等待索引的登记键(空表示未登记)，与条目一起保存，
+     *                   文件信息无效(全路径为空)时出队方仍能解除登记
+     */
+    Lusp_CompactUploadItem pack(const Lusp_SyncUploadFileInfo& info, std::u16string_view pendingKey = {});
+
+    /**
+     * @brief 将队列条目还原为完整结构体
+     * @param pendingKey 非空时输出 pack 时保存的登记键(未登记时为空串)
+     */
+    Lusp_SyncUploadFileInfo unpack(const Lusp_CompactUploadItem& item, std::u16string* pendingKey = nullptr) const;
+
+    /**
+     * @brief 驻留表占用字节数(近似值)
+     */
+    size_t approximateBytes() const;
+
+    /**
+     * @brief 驻留的目录节点数
+     */
+    size_t directoryCount() const;
+
+private:
+    struct DirectoryNode {
+        uint32_t    parent;         ///< 父节点 ID，0 为根
+        uint32_t    offset;         ///< 分量在 m_componentChars 中的起始位置
+        uint32_t    length;         ///< 分量长度(含结尾分隔符)
+    };
+
+    Lusp_UploadItemInternTable(const Lusp_UploadItemInternTable&) = delete;
+    Lusp_UploadItemInternTable& operator=(const Lusp_UploadItemInternTable&) = delete;
+
+    uint32_t    internDirectory(std::u16string_view directory);
+    uint32_t    internComponent(uint32_t parent, std::u16string_view component);
+    uint32_t    internString(const std::u16string& value);
+    void        appendDirectory(uint32_t id, std::u16string& out) const;
+    void        growDirectorySlots();
+
+    mutable std::mutex                          m_mutex;
+    std::vector<DirectoryNode>                  m_nodes;            ///< 下标即目录 ID，0 号为根占位
+    std::u16string                              m_componentChars;   ///< 所有路径分量的连续存储
+    std::vector<uint32_t>                       m_slots;            ///< (parent, 分量) -> 节点 ID 的开放寻址表，0 为空
+    std::u16string                              m_lastDirectory;    ///< 最近一次驻留的目录(同目录批量入队时命中)
+    uint32_t                                    m_lastDirectoryId = 0;
+    std::vector<std::u16string>                 m_strings;          ///< 下标即字符串 ID，0 号为空串
+    std::unordered_map<std::u16string, uint32_t> m_stringIds;
+};
+
+#endif // LUSP_COMPACT_UPLOAD_ITEM_H
@@ -0,0 +1,86 @@
+#ifndef LUSP_DIRECTORY_WATCHER_H
+#define LUSP_DIRECTORY_WATCHER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Config/Lusp_ExcludeMatcher.h"
+#include "SyncUploadQueue/Lusp_ParallelDirectoryWalker.h"
+
+/**
+ * @brief 目录监控选项
+ */
+struct Lusp_DirectoryWatchOptions {
+    std::vector<std::u16string> roots;                          ///< 监控的根目录
+    uint32_t                    debounceMs          = 500;      ///< 同一文件最后一次事件后静默多久才入队(毫秒)
+    size_t                      batchSize           = 256;      ///< 每批提交的文件数
+    bool                        initialScan         = true;     ///< 启动时全量扫描，与摘要缓存对账后入队变化的文件
+    bool                        skipHidden          = false;    ///< 忽略隐藏文件/目录(以 . 开头)
+    bool                        applyConfigExcludes = true;     ///< 是否使用配置中的排除模式
+    std::shared_ptr<const Lusp_ExcludeMatcher> excludeMatcher;  ///< 预编译的排除匹配器(为空且 applyConfigExcludes 时取配置快照)
+};
+
+/**
+ * @brief 目录监控统计
+ */
+struct Lusp_DirectoryWatchStats {
+    uint64_t    watchedDirectories  = 0;    ///< 当前监控的目录数(Windows 下为根目录数)
+    uint64_t    events              = 0;    ///< 收到的文件系统事件数
+    uint64_t    coalescedEvents     = 0;    ///< 防抖期内被合并的事件数
+    uint64_t    renamesMerged       = 0;    ///< 合并的重命名(旧路径的待入队项被丢弃)
+    uint64_t    filesQueued         = 0;    ///< 事件触发入队的文件数
+    uint64_t    overflows           = 0;    ///< 内核事件队列溢出次数(每次触发一次对账扫描)
+    uint64_t    scanFiles           = 0;    ///< 对账扫描遍历的文件数
+    uint64_t    scanUnchanged       = 0;    ///< 对账扫描中命中摘要缓存、无需入队的文件数
+};
+
+/**
+ * @brief 目录监控器
+ *
+ * 监控若干根目录，文件写入/创建/移入后按路径防抖，静默 debounceMs 后批量回调。
+ *
+ * 平台实现:
+ * - Linux: inotify，每个目录一个 watch。目录以 (父 watch, 名称) 的树保存，
+ *   事件按 wd 直接定位，目录重命名只改一个节点，不需要重扫整棵树；
+ *   IN_MOVED_FROM/IN_MOVED_TO 按 cookie 配对合并重命名。
+ *   目录数较多时需调大 fs.inotify.max_user_watches。
+ * - Windows: 每个根目录一个 ReadDirectoryChangesW(bWatchSubtree)，由内核递归监控。
+ *
+ * 内核事件队列溢出时事件已丢失，只能对根目录做一次对账扫描(与摘要缓存比较)。
+ */
+class Lusp_DirectoryWatcher {
+public:
+    using BatchCallback = Lusp_ParallelDirectoryWalker::BatchCallback;
+
+    /**
+     * @param options 监控选项
+     * @param onBatch 批量回调(在监控线程或对账扫描线程上调用，需线程安全)
+     */
+    Lusp_DirectoryWatcher(const Lusp_DirectoryWatchOptions& options, BatchCallback onBatch);
+    ~Lusp_DirectoryWatcher();
+
+    Lusp_DirectoryWatcher(const Lusp_DirectoryWatcher&) = delete;
+    Lusp_DirectoryWatcher& operator=(const Lusp_DirectoryWatcher&) = delete;
+
+    /**
+     * @brief 开始监控(注册监控后在后台线程运行)
+     * @return 是否成功(平台不支持或没有可用根目录时失败)
+     */
+    bool start();
+
+    /**
+     * @brief 停止监控，未到期的防抖项被丢弃
+     */
+    void stop();
+
+    bool isRunning() const;
+
+    Lusp_DirectoryWatchStats getStatistics() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+#endif // LUSP_DIRECTORY_WATCHER_H
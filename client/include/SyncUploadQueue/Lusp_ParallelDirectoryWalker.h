@@ -0,0 +1,83 @@
+#ifndef LUSP_PARALLEL_DIRECTORY_WALKER_H
+#define LUSP_PARALLEL_DIRECTORY_WALKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Config/Lusp_ExcludeMatcher.h"
+
+/**
+ * @brief 目录遍历选项
+ */
+struct Lusp_DirectoryWalkOptions {
+    unsigned                    threadCount         = 0;        ///< 遍历线程数(0=硬件并发数)
+    size_t                      batchSize           = 256;      ///< 每批提交的文件数
+    int                         maxDepth            = -1;       ///< 最大递归深度(-1=不限，0=只遍历根目录)
+    bool                        skipHidden          = false;    ///< 跳过隐藏文件/目录
+    bool                        followSymlinks      = false;    ///< 是否收录符号链接指向的文件(符号链接目录始终不进入，避免环)
+    bool                        applyConfigExcludes = true;     ///< 是否叠加 UploadConfig::excludePatterns
+    std::vector<std::string>    excludePatterns;                ///< 额外的排除模式(UTF-8，构造遍历器时编译)
+    std::shared_ptr<const Lusp_ExcludeMatcher> excludeMatcher;  ///< 预编译的排除匹配器(如配置中的匹配器快照)
+};
+
+/**
+ * @brief 目录遍历统计
+ */
+struct Lusp_DirectoryWalkStats {
+    uint64_t    files       = 0;    ///< 提交的文件数
+    uint64_t    directories = 0;    ///< 遍历的目录数
+    uint64_t    excluded    = 0;    ///< 被排除的条目数(目录被排除时整棵子树跳过，只计一次)
+    uint64_t    errors      = 0;    ///< 无法打开的目录数
+    uint64_t    batches     = 0;    ///< 提交批次数
+    uint64_t    elapsedMs   = 0;    ///< 耗时(毫秒)
+};
+
+/**
+ * @brief 并行目录遍历器(工作窃取)
+ *
+ * 每个线程持有自己的目录双端队列: 自己从尾部取(深度优先，局部性好)，
+ * 空闲时从其他线程队列头部窃取(靠近根的目录，子树更大，窃取一次收益更高)。
+ * 文件边遍历边按批回调，不等待整棵树遍历完成。
+ *
+ * 平台实现:
+ * - Linux: openat + getdents64，大缓冲一次读取多条目录项，d_type 免 stat
+ * - Windows: FindFirstFileExW(FindExInfoBasic, FIND_FIRST_EX_LARGE_FETCH)
+ * - 其他 POSIX: opendir/readdir
+ */
+class Lusp_ParallelDirectoryWalker {
+public:
+    /**
+     * @brief 批量回调(在遍历线程上调用，需线程安全)
+     * @param batch 本批文件完整路径，回调可以移走其内容
+     */
+    using BatchCallback = std::function<void(std::vector<std::u16string>& batch)>;
+
+    Lusp_ParallelDirectoryWalker(const Lusp_DirectoryWalkOptions& options, BatchCallback onBatch);
+
+    /**
+     * @brief 遍历目录树(阻塞直到遍历结束或被取消)
+     * @param rootDir    根目录
+     * @param cancelFlag 取消标志(可为空)，置为 true 后尽快返回
+     * @return 遍历统计
+     */
+    Lusp_DirectoryWalkStats walk(const std::u16string& rootDir, const std::atomic<bool>* cancelFlag = nullptr);
+
+private:
+    /**
+     * @brief 判断条目是否被排除
+     * @param nameUtf8         条目名
+     * @param relativePathUtf8 相对根目录的路径(仅存在路径规则时有效)
+     */
+    bool isExcluded(const std::string& nameUtf8, const std::string& relativePathUtf8) const;
+
+    Lusp_DirectoryWalkOptions                   m_options;
+    BatchCallback                               m_onBatch;
+    std::shared_ptr<const Lusp_ExcludeMatcher>  m_extraMatcher;     ///< excludePatterns 编译结果
+    bool                                        m_needRelativePath = false;
+};
+
+#endif // LUSP_PARALLEL_DIRECTORY_WALKER_H
@@ -22,6 +22,9 @@ class Lusp_SyncFilesNotificationService; // 前置声明
 #include <condition_variable>
 #include <memory>
 #include "ThreadSafeRowLockQueue/ThreadSafeRowLockQueue.hpp"
+#include "SyncUploadQueue/Lusp_CompactUploadItem.h"
+#include "SyncUploadQueue/Lusp_ParallelDirectoryWalker.h"
+#include "SyncUploadQueue/Lusp_DirectoryWatcher.h"
 
 /**
  * @brief 高性能上传队列 - 使用标准C++实现
@@ -44,6 +47,29 @@ public:
     void push(const std::u16string& filePath);                   // 推送单个文件
     void push(const std::vector<std::u16string>& filePaths);     // 推送多个文件
     void push(const Lusp_SyncUploadFileInfo& fileInfo);          // 推送文件信息对象
+
+    /**
+     * @brief 并行递归遍历目录并批量入队(阻塞直到遍历结束)
+     * @param rootDir 根目录
+     * @param options 遍历选项
+     * @return 遍历统计
+     */
+    Lusp_DirectoryWalkStats pushDirectory(const std::u16string& rootDir, const Lusp_DirectoryWalkOptions& options = {});
+    /**
+     * @brief 后台线程遍历目录并批量入队，立即返回
+     * @param onFinished 遍历结束回调(在遍历线程上调用)
+     */
+    void pushDirectoryAsync(const std::u16string& rootDir, const Lusp_DirectoryWalkOptions& options = {},
+        std::function<void(const Lusp_DirectoryWalkStats&)> onFinished = nullptr);
+    /**
+     * @brief 监控目录，新建/修改/移入的文件防抖后自动入队
+     * @param options 监控选项(initialScan 时先与摘要缓存对账一次)
+     * @return 是否启动成功
+     */
+    bool startWatching(const Lusp_DirectoryWatchOptions& options);
+    void stopWatching();
+    bool isWatching() const;
+    Lusp_DirectoryWatchStats watchStatistics() const;
     
    
     void setProgressCallback(ProgressCallback callback);
@@ -54,6 +80,7 @@ public:
     size_t pendingCount() const;
     bool   isActive() const;
     bool   empty() const;
+    Lusp_UploadQueueMemoryStats memoryStatistics() const;  // 队列内存占用(紧凑条目 + 驻留表)
 
     friend class Lusp_SyncFilesNotificationService;
 private:
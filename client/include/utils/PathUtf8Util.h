@@ -0,0 +1,36 @@
+#ifndef INCLUDE_UTILS_PATH_UTF8_UTIL_H
+#define INCLUDE_UTILS_PATH_UTF8_UTIL_H
+
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief 路径与 UTF-8 std::string 的转换
+ * @details C++20(char8_t)起 path::u8string() 返回 std::u8string，不能再当作 std::string 使用；
+ *          所有 UTF-8 路径都经这里转换，C++17 与 C++20(LUSP_IPC_COROUTINES)下都能编译。
+ */
+class PathUtf8Util {
+public:
+    static std::string ToUtf8(const std::filesystem::path& path) {
+#if defined(__cpp_char8_t)
+        const std::u8string text = path.u8string();
+        return std::string(text.begin(), text.end());
+#else
+        return path.u8string();
+#endif
+    }
+
+    /**
+     * @brief 同 ToUtf8，分隔符统一为 '/'
+     */
+    static std::string ToGenericUtf8(const std::filesystem::path& path) {
+#if defined(__cpp_char8_t)
+        const std::u8string text = path.generic_u8string();
+        return std::string(text.begin(), text.end());
+#else
+        return path.generic_u8string();
+#endif
+    }
+};
+
+#endif // INCLUDE_UTILS_PATH_UTF8_UTIL_H
@@ -0,0 +1,183 @@
+#include "AsioLoopbackIpcClient/Lusp_AsioLoopbackIpcChannelPool.h"
+#include "Config/ClientConfigManager.h"
+#include "log_headers.h"
+#include <algorithm>
+
+
+Lusp_AsioLoopbackIpcChannelPool::Lusp_AsioLoopbackIpcChannelPool(asio::io_context& io_context, const ClientConfigManager& configMgr, size_t channel_count) {
+    if (channel_count == 0) {
+        channel_count = configMgr.getNetworkConfig().maxConnections;
+    }
+    channel_count = std::max<size_t>(channel_count, 1);
+
+    channel_connected_.assign(channel_count, false);
+    channel_routable_.assign(channel_count, false);
+    channel_rejoin_pending_.assign(channel_count, false);
+    routed_messages_.assign(channel_count, 0);
+    migrated_messages_.assign(channel_count, 0);
+
+    channels_.reserve(channel_count);
+    for (size_t i = 0; i < channel_count; ++i) {
+        // 0 号通道沿用原来的 ./queue，其余通道各用一个子目录
+        std::filesystem::path queue_dir = i == 0
+            ? std::filesystem::path("./queue")
+            : std::filesystem::path("./queue") / ("channel_" + std::to_string(i));
+
+        auto channel = std::make_unique<Lusp_AsioLoopbackIpcClient>(io_context, configMgr, queue_dir);
+        channel->set_heartbeat_channel(i == 0);
+        channel->on_connection_change([this, i](bool connected) {
+            handle_channel_change(i, connected);
+            });
+        channels_.push_back(std::move(channel));
+    }
+
+    g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_INFO,
+        "[IPC Pool] 初始化通道池: " + std::to_string(channel_count) + " 条通道");
+}
+
+void Lusp_AsioLoopbackIpcChannelPool::connect() {
+    is_stopping_.store(false);
+    for (auto& channel : channels_) {
+        channel->connect();
+    }
+}
+
+void Lusp_AsioLoopbackIpcChannelPool::send(const std::string& message, uint64_t key, uint32_t priority) {
+    std::lock_guard<std::mutex> lock(route_mutex_);
+    try_rejoin_locked();
+
+    size_t index = route_locked(key);
+    routed_messages_[index]++;
+    channels_[index]->send(message, priority, key);
+}
+
+void Lusp_AsioLoopbackIpcChannelPool::on_receive(MessageCallback cb) {
+    for (auto& channel : channels_) {
+        channel->on_receive(cb);
+    }
+}
+
+void Lusp_AsioLoopbackIpcChannelPool::disconnect() {
+    is_stopping_.store(true);
+    for (auto& channel : channels_) {
+        channel->disconnect();
+    }
+}
+
+bool Lusp_AsioLoopbackIpcChannelPool::is_connected() const {
+    return get_connected_channel_count() > 0;
+}
+
+size_t Lusp_AsioLoopbackIpcChannelPool::get_channel_count() const {
+    return channels_.size();
+}
+
+size_t Lusp_AsioLoopbackIpcChannelPool::get_connected_channel_count() const {
+    std::lock_guard<std::mutex> lock(route_mutex_);
+    return static_cast<size_t>(std::count(channel_connected_.begin(), channel_connected_.end(), true));
+}
+
+std::vector<Lusp_AsioLoopbackIpcChannelPool::ChannelStatistics> Lusp_AsioLoopbackIpcChannelPool::get_channel_statistics() const {
+    std::lock_guard<std::mutex> lock(route_mutex_);
+    std::vector<ChannelStatistics> stats(channels_.size());
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        stats[i].connected = channel_connected_[i];
+        stats[i].routable = channel_routable_[i];
+        stats[i].pending = channels_[i]->get_pending_count();
+        stats[i].routed_messages = routed_messages_[i];
+        stats[i].migrated_messages = migrated_messages_[i];
+    }
+    return stats;
+}
+
+void Lusp_AsioLoopbackIpcChannelPool::handle_channel_change(size_t index, bool connected) {
+    if (is_stopping_.load()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(route_mutex_);
+    channel_connected_[index] = connected;
+
+    if (!connected) {
+        // 先退出分流，再把队列中未发送的消息按顺序迁到接手的通道
+        channel_routable_[index] = false;
+        channel_rejoin_pending_[index] = false;
+        migrate_pending_locked(index);
+        g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN,
+            "[IPC Pool] 通道 " + std::to_string(index) + " 断开，其分流键已迁移到其他通道");
+        return;
+    }
+
+    channel_rejoin_pending_[index] = true;
+    try_rejoin_locked();
+
+    // 没有可用通道时分到断开通道上排队的消息，交给现在可用的通道
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        if (!channel_connected_[i]) {
+            migrate_pending_locked(i);
+        }
+    }
+
+    g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_INFO,
+        "[IPC Pool] 通道 " + std::to_string(index) + " 已连接" +
+        (channel_routable_[index] ? "，参与分流" : "，等待其他通道队列排空后参与分流"));
+}
+
+void Lusp_AsioLoopbackIpcChannelPool::migrate_pending_locked(size_t index) {
+    auto messages = channels_[index]->take_pending_messages();
+    for (auto& ipc_message : messages) {
+        size_t target = route_locked(ipc_message.routing_key);
+        if (target != index) {
+            migrated_messages_[target]++;
+        }
+        channels_[target]->send(std::string(ipc_message.data.begin(), ipc_message.data.end()),
+            ipc_message.priority, ipc_message.routing_key);
+    }
+}
+
+void Lusp_AsioLoopbackIpcChannelPool::try_rejoin_locked() {
+    if (std::find(channel_rejoin_pending_.begin(), channel_rejoin_pending_.end(), true) == channel_rejoin_pending_.end()) {
+        return;
+    }
+
+    // 迁走的键可能还有消息排在其他通道上，排空前回到原通道会越过它们
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        if (channel_routable_[i] && channels_[i]->get_pending_count() > 0) {
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        if (channel_rejoin_pending_[i]) {
+            channel_rejoin_pending_[i] = false;
+            channel_routable_[i] = true;
+        }
+    }
+}
+
+size_t Lusp_AsioLoopbackIpcChannelPool::route_locked(uint64_t key) const {
+    const bool any_routable = std::find(channel_routable_.begin(), channel_routable_.end(), true) != channel_routable_.end();
+
+    size_t best_index = 0;
+    uint64_t best_weight = 0;
+    bool found = false;
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        if (any_routable && !channel_routable_[i]) {
+            continue;
+        }
+        uint64_t weight = route_weight(key, i);
+        if (!found || weight > best_weight) {
+            best_index = i;
+            best_weight = weight;
+            found = true;
+        }
+    }
+    return best_index;
+}
+
+uint64_t Lusp_AsioLoopbackIpcChannelPool::route_weight(uint64_t key, size_t index) {
+    uint64_t x = key ^ (0x9E3779B97F4A7C15ull * (static_cast<uint64_t>(index) + 1));
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
@@ -17,8 +17,29 @@
 #include <netinet/tcp.h>
 #endif
 
+namespace {
+    // 心跳帧以此 file_identifier 封装，数据帧不带；按 type() 区分会把 type 字段恰为 0/1 的其它消息
+    // 误当作心跳。与服务端保持一致
+    constexpr char kHeartbeatIdentifier[] = "LHBT";
+    constexpr size_t kHeartbeatMinSize = sizeof(flatbuffers::uoffset_t) + flatbuffers::FlatBufferBuilder::kFileIdentifierLength;
+
+    // 过渡期兼容旧版服务端不带标识的 PONG: 心跳表只有 6 个字段，vtable 不超过 (2 + 6) 个 voffset_t
+    constexpr size_t kHeartbeatFieldCount = 6;
+    constexpr size_t kLegacyHeartbeatMaxVTable = (2 + kHeartbeatFieldCount) * sizeof(flatbuffers::voffset_t);
+
+#ifdef LUSP_IPC_COROUTINES
+    // 以 (error_code, ...) 元组返回结果，断开等错误不走异常
+    constexpr auto use_awaitable_tuple = asio::as_tuple(asio::use_awaitable);
+#endif
+}
+
 
 Lusp_AsioLoopbackIpcClient::Lusp_AsioLoopbackIpcClient(asio::io_context& io_context, const ClientConfigManager& configMgr)
+    : Lusp_AsioLoopbackIpcClient(io_context, configMgr, std::filesystem::path("./queue")) {
+}
+
+Lusp_AsioLoopbackIpcClient::Lusp_AsioLoopbackIpcClient(asio::io_context& io_context, const ClientConfigManager& configMgr,
+    const std::filesystem::path& queue_dir)
     : io_context_(io_context)
     , config_mgr_(configMgr)
     , socket_(std::make_shared<asio::ip::tcp::socket>(io_context))
@@ -33,9 +54,9 @@ Lusp_AsioLoopbackIpcClient::Lusp_AsioLoopbackIpcClient(asio::io_context& io_cont
     // 缓冲区大小
     buffer_ = std::make_shared<std::vector<char>>(networkConfig.bufferSize);
 
-    // 初始化消息队列（持久化目录：./queue，内存容量1024，磁盘最大100MB）
+    // 初始化消息队列（默认持久化目录：./queue，内存容量1024，磁盘最大100MB）
     message_queue_ = std::make_unique<PersistentMessageQueue>(
-        std::filesystem::path("./queue"),
+        queue_dir,
         1024,
         100 * 1024 * 1024
     );
@@ -48,6 +69,12 @@ Lusp_AsioLoopbackIpcClient::Lusp_AsioLoopbackIpcClient(asio::io_context& io_cont
         g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_INFO,
             "[IPC] 连接状态变化: " + std::string(ConnectionStateToString(old_state)) +
             " -> " + std::string(ConnectionStateToString(new_state)));
+
+        // 进入或离开 Connected 时通知(通道池据此重新分流)
+        if (on_connection_change_ &&
+            (old_state == ConnectionState::Connected || new_state == ConnectionState::Connected)) {
+            on_connection_change_(new_state == ConnectionState::Connected);
+        }
         });
 
     // 设置重连回调
@@ -95,10 +122,10 @@ void Lusp_AsioLoopbackIpcClient::connect() {
     }
 }
 
-void Lusp_AsioLoopbackIpcClient::send(const std::string& message, uint32_t priority) {
-    // 构造消息并入队
+void Lusp_AsioLoopbackIpcClient::send(const std::string& message, uint32_t priority, uint64_t routing_key) {
+    // 构造消息并入队(ID 为 0，由队列分配)
     std::vector<uint8_t> data(message.begin(), message.end());
-    IpcMessage ipc_message(0, data, priority);
+    IpcMessage ipc_message(0, data, priority, routing_key);
 
     if (!message_queue_->enqueue(std::move(ipc_message))) {
         g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_ERROR,
@@ -107,7 +134,11 @@ void Lusp_AsioLoopbackIpcClient::send(const std::string& message, uint32_t prior
     }
 
     // 触发发送
+#ifdef LUSP_IPC_COROUTINES
+    wake_send_loop();
+#else
     do_send_from_queue();
+#endif
 }
 
 void Lusp_AsioLoopbackIpcClient::do_send_from_queue() {
@@ -143,6 +174,7 @@ void Lusp_AsioLoopbackIpcClient::do_send_from_queue() {
         std::memcpy(buffer.data() + 4, ipc_message.data.data(), ipc_message.data.size());
 
         auto data = std::make_shared<std::vector<char>>(std::move(buffer));
+        in_flight_id_.store(ipc_message.id);
         asio::async_write(*socket_, asio::buffer(*data),
             [this, data, len, msg_id = ipc_message.id](std::error_code ec, std::size_t bytes_sent) {
                 handle_send_result(ec, bytes_sent, msg_id);
@@ -161,20 +193,27 @@ void Lusp_AsioLoopbackIpcClient::do_send_from_queue() {
     catch (const std::exception& e) {
         g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_ERROR,
             "[IPC] 发送异常: " + std::string(e.what()));
+        in_flight_id_.store(0);
         is_sending_.store(false);
         connection_monitor_->record_send_failure(std::make_error_code(std::errc::io_error));
     }
 }
 
 void Lusp_AsioLoopbackIpcClient::handle_send_result(const std::error_code& ec, std::size_t bytes_transferred, uint64_t msg_id) {
+    in_flight_id_.store(0);
     is_sending_.store(false);
 
     if (!ec) {
 
-        if (message_queue_->pop_front()) {
+        // 写出期间队列可能已被通道池迁移，只删除写出的那条
+        if (message_queue_->pop_front_if(msg_id)) {
             g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
                 "[IPC] 消息 " + std::to_string(msg_id) + " 已从队列移除");
         }
+        else {
+            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN,
+                "[IPC] 消息 " + std::to_string(msg_id) + " 已不在队首，不再出队");
+        }
 
         connection_monitor_->record_send_success();
 
@@ -201,6 +240,29 @@ void Lusp_AsioLoopbackIpcClient::on_receive(MessageCallback cb) {
     on_message_ = std::move(cb);
 }
 
+void Lusp_AsioLoopbackIpcClient::on_connection_change(ConnectionCallback cb) {
+    on_connection_change_ = std::move(cb);
+}
+
+std::vector<IpcMessage> Lusp_AsioLoopbackIpcClient::take_pending_messages() {
+    // 断开回调可能先于写完成回调执行，正在写出的消息可能已经发出：迁走会重复，丢弃又可能丢失。
+    // 把它放回(已清空的)队列，仍在队首，由写完成回调按ID出队或保留
+    const uint64_t in_flight_id = in_flight_id_.load();
+    std::optional<IpcMessage> in_flight;
+    std::vector<IpcMessage> messages;
+    while (auto ipc_message = message_queue_->dequeue()) {
+        if (in_flight_id != 0 && messages.empty() && !in_flight.has_value() && ipc_message->id == in_flight_id) {
+            in_flight = std::move(ipc_message);
+            continue;
+        }
+        messages.push_back(std::move(*ipc_message));
+    }
+    if (in_flight.has_value()) {
+        message_queue_->enqueue(std::move(*in_flight));
+    }
+    return messages;
+}
+
 void Lusp_AsioLoopbackIpcClient::disconnect() {
     is_permanently_stopped_ = true;  // 设置永久停止标志，防止自动重连
     connection_monitor_->set_state(ConnectionState::Disconnected);
@@ -228,6 +290,10 @@ PersistentMessageQueue::Statistics Lusp_AsioLoopbackIpcClient::get_queue_statist
     return message_queue_->get_statistics();
 }
 
+size_t Lusp_AsioLoopbackIpcClient::get_pending_count() const {
+    return message_queue_->size();
+}
+
 void Lusp_AsioLoopbackIpcClient::do_read() {
     if (!is_connected()) {
         return;
@@ -266,18 +332,23 @@ void Lusp_AsioLoopbackIpcClient::try_reconnect() {
     // 创建新的socket
     socket_ = std::make_shared<asio::ip::tcp::socket>(io_context_);
 
+    // 基础等待：有实测往返时延时取 RTO(不超过配置的重连间隔)，否则取配置值
     uint32_t delay = networkConfig.reconnectIntervalMs;
+    if (connection_monitor_->has_rtt_sample()) {
+        delay = connection_monitor_->get_rto_ms(networkConfig.reconnectIntervalMs);
+    }
+    const uint32_t base_delay = delay;
 
     // 指数退避策略
     if (networkConfig.enableReconnectBackoff && current_reconnect_attempts_ > 1) {
         // 指数退避：delay = base_delay × 2^(attempts-1)
         // 例如：1000ms, 2000ms, 4000ms, 8000ms, 16000ms
-        uint32_t exponentialDelay = delay * (1U << (current_reconnect_attempts_ - 1));
-        delay = std::min(exponentialDelay, networkConfig.reconnectBackoffMs);
+        uint64_t exponentialDelay = static_cast<uint64_t>(delay) << std::min(current_reconnect_attempts_ - 1, 20);
+        delay = static_cast<uint32_t>(std::min<uint64_t>(exponentialDelay, networkConfig.reconnectBackoffMs));
 
         g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
             "[IPC] 指数退避计算: " + std::to_string(delay) +
-            "ms (基础: " + std::to_string(networkConfig.reconnectIntervalMs) +
+            "ms (基础: " + std::to_string(base_delay) +
             "ms x 2^" + std::to_string(current_reconnect_attempts_ - 1) +
             ", 上限: " + std::to_string(networkConfig.reconnectBackoffMs) + "ms)");
     }
@@ -317,7 +388,7 @@ void Lusp_AsioLoopbackIpcClient::handle_connect_result(const std::error_code& ec
             enable_tcp_keepalive();
         }
 
-        //  启动应用层心跳
+        //  启动应用层心跳(通道池中的数据通道只发轻量保活，见 on_heartbeat_timer)
         if (networkConfig.enableAppHeartbeat) {
             heartbeat_enabled_.store(true);
             heartbeat_interval_ms_.store(networkConfig.heartbeatIntervalMs);
@@ -326,14 +397,28 @@ void Lusp_AsioLoopbackIpcClient::handle_connect_result(const std::error_code& ec
             auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::steady_clock::now().time_since_epoch()).count();
             last_pong_time_ms_.store(now_ms);
+            last_receive_time_ms_.store(now_ms);
+            ping_outstanding_.store(false);
+            heartbeat_failure_count_.store(0);
 
             start_heartbeat_timer();
         }
 
+#ifdef LUSP_IPC_COROUTINES
+        // 唤醒上一个连接遗留的发送循环，它发现 socket 已更换后退出
+        if (send_signal_) {
+            send_signal_->cancel();
+        }
+        send_signal_ = std::make_shared<asio::steady_timer>(io_context_);
+        asio::co_spawn(io_context_, read_loop(socket_), asio::detached);
+        asio::co_spawn(io_context_, send_loop(socket_, send_signal_), asio::detached);
+#else
+        read_pending_.clear();
         do_read();
 
         // 连接成功后，开始发送队列中的消息
         do_send_from_queue();
+#endif
     }
     else {
         connection_monitor_->set_state(ConnectionState::Disconnected);
@@ -345,13 +430,8 @@ void Lusp_AsioLoopbackIpcClient::handle_connect_result(const std::error_code& ec
 
 void Lusp_AsioLoopbackIpcClient::handle_read_result(const std::error_code& ec, std::size_t bytes_transferred) {
     if (!ec && bytes_transferred > 0) {
-        if (on_message_) {
-            std::string message(buffer_->data(), bytes_transferred);
-            on_message_(message);
-
-            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
-                "[IPC] 接收消息，长度: " + std::to_string(bytes_transferred));
-        }
+        read_pending_.insert(read_pending_.end(), buffer_->data(), buffer_->data() + bytes_transferred);
+        dispatch_frames(read_pending_);
         do_read(); // 继续读取
     }
     else {
@@ -363,6 +443,59 @@ void Lusp_AsioLoopbackIpcClient::handle_read_result(const std::error_code& ec, s
     }
 }
 
+void Lusp_AsioLoopbackIpcClient::dispatch_frames(std::vector<char>& pending) {
+    // 收到任何数据都说明服务端存活
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    last_receive_time_ms_.store(now_ms);
+    connection_monitor_->record_receive();
+
+    size_t offset = 0;
+
+    // 拆包循环
+    while (pending.size() - offset >= 4) {
+        const char* head = pending.data() + offset;
+        uint32_t msg_len = 0;
+        msg_len |= (uint8_t)head[0];
+        msg_len |= ((uint8_t)head[1] << 8);
+        msg_len |= ((uint8_t)head[2] << 16);
+        msg_len |= ((uint8_t)head[3] << 24);
+        if (pending.size() - offset < 4 + static_cast<size_t>(msg_len)) break; // 数据不够
+
+        const uint8_t* body = reinterpret_cast<const uint8_t*>(head + 4);
+        offset += 4 + static_cast<size_t>(msg_len);
+
+        // 按 file_identifier 识别心跳帧
+        const bool tagged = msg_len >= kHeartbeatMinSize && flatbuffers::BufferHasIdentifier(body, kHeartbeatIdentifier);
+        // 帧在接收缓冲区中的位置不一定按 FlatBuffer 要求对齐
+        flatbuffers::Verifier::Options verifier_options;
+        verifier_options.check_alignment = false;
+        flatbuffers::Verifier verifier(body, msg_len, verifier_options);
+        const bool is_pong = verifier.VerifyBuffer<UploadClient::Sync::FBS_HeartbeatMessage>(tagged ? kHeartbeatIdentifier : nullptr) &&
+            flatbuffers::GetRoot<UploadClient::Sync::FBS_HeartbeatMessage>(body)->type() ==
+            UploadClient::Sync::FBS_HeartbeatType_FBS_HEARTBEAT_PONG &&
+            (tagged || flatbuffers::ReadScalar<flatbuffers::voffset_t>(flatbuffers::GetRoot<flatbuffers::Table>(body)->GetVTable()) <=
+                kLegacyHeartbeatMaxVTable);
+        if (is_pong) {
+            handle_heartbeat_pong(body);
+        }
+        else if (tagged) {
+            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN, "[IPC] 收到无效的心跳帧，已忽略");
+        }
+        else if (on_message_) {
+            on_message_(std::string(head + 4, head + 4 + msg_len));
+
+            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
+                "[IPC] 接收消息，长度: " + std::to_string(msg_len));
+        }
+    }
+
+    // 移除已处理(一批消息只搬移一次剩余的半包)
+    if (offset > 0) {
+        pending.erase(pending.begin(), pending.begin() + offset);
+    }
+}
+
 // ==================== TCP Keep-Alive 实现 ====================
 
 void Lusp_AsioLoopbackIpcClient::enable_tcp_keepalive() {
@@ -441,6 +574,10 @@ void Lusp_AsioLoopbackIpcClient::enable_heartbeat(bool enable) {
     }
 }
 
+void Lusp_AsioLoopbackIpcClient::set_heartbeat_channel(bool enable) {
+    heartbeat_channel_.store(enable);
+}
+
 void Lusp_AsioLoopbackIpcClient::set_heartbeat_interval(uint32_t interval_ms) {
     heartbeat_interval_ms_.store(interval_ms);
     g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_INFO,
@@ -452,16 +589,26 @@ void Lusp_AsioLoopbackIpcClient::start_heartbeat_timer() {
         heartbeat_timer_ = std::make_shared<asio::steady_timer>(io_context_);
     }
 
-    auto interval = std::chrono::milliseconds(heartbeat_interval_ms_.load());
-    heartbeat_timer_->expires_after(interval);
+#ifdef LUSP_IPC_COROUTINES
+    asio::co_spawn(io_context_, heartbeat_loop(socket_), asio::detached);
+#else
+    schedule_heartbeat(heartbeat_interval_ms_.load());
+#endif
+}
+
+#ifndef LUSP_IPC_COROUTINES
+void Lusp_AsioLoopbackIpcClient::schedule_heartbeat(uint32_t delay_ms) {
+    heartbeat_timer_->expires_after(std::chrono::milliseconds(delay_ms));
     heartbeat_timer_->async_wait([this](std::error_code ec) {
         if (!ec && heartbeat_enabled_.load() && is_connected()) {
-            send_heartbeat_ping();
-            check_heartbeat_timeout();
-            start_heartbeat_timer();  // 递归调度
+            uint32_t next_delay_ms = on_heartbeat_timer();
+            if (next_delay_ms > 0) {
+                schedule_heartbeat(next_delay_ms);  // 递归调度
+            }
         }
         });
 }
+#endif
 
 void Lusp_AsioLoopbackIpcClient::stop_heartbeat_timer() {
     heartbeat_enabled_.store(false);
@@ -471,141 +618,202 @@ void Lusp_AsioLoopbackIpcClient::stop_heartbeat_timer() {
 }
 
 void Lusp_AsioLoopbackIpcClient::send_heartbeat_ping() {
+#ifdef LUSP_IPC_COROUTINES
+    // PING 交给发送循环写出，避免与消息写操作交错
+    ping_pending_.store(true);
+    wake_send_loop();
+#else
     try {
-        // 使用 FlatBuffer 构建心跳 PING 消息
-        flatbuffers::FlatBufferBuilder builder(256);
-
-        auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now().time_since_epoch()).count();
-
-        auto client_name_str = builder.CreateString(client_computer_name_);
-        auto client_version_str = builder.CreateString(config_mgr_.getUploadConfig().clientVersion);
-        auto payload_str = builder.CreateString("");  // 可选的附加数据
-
-        uint32_t sequence = heartbeat_sequence_.fetch_add(1);
-
-        auto heartbeat = UploadClient::Sync::CreateFBS_HeartbeatMessage(builder,
-            UploadClient::Sync::FBS_HeartbeatType_FBS_HEARTBEAT_PING,
-            sequence,
-            static_cast<uint64_t>(now_ms),
-            client_name_str,
-            client_version_str,
-            payload_str);
-
-        builder.Finish(heartbeat);
-
-        // 发送心跳消息（前4字节为长度）
-        uint32_t msg_size = builder.GetSize();
-        std::vector<char> buffer(4 + msg_size);
-
-        // 小端序写入长度
-        buffer[0] = static_cast<char>(msg_size & 0xFF);
-        buffer[1] = static_cast<char>((msg_size >> 8) & 0xFF);
-        buffer[2] = static_cast<char>((msg_size >> 16) & 0xFF);
-        buffer[3] = static_cast<char>((msg_size >> 24) & 0xFF);
-
-        // 拷贝心跳数据
-        std::memcpy(buffer.data() + 4, builder.GetBufferPointer(), msg_size);
-
-        auto data = std::make_shared<std::vector<char>>(std::move(buffer));
+        auto data = std::make_shared<std::vector<char>>();
+        uint32_t sequence = encode_heartbeat_ping(*data);
 
         asio::async_write(*socket_, asio::buffer(*data),
             [this, data, sequence](std::error_code ec, std::size_t bytes_sent) {
-                if (!ec) {
-                    g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
-                        "[IPC] ❤️ 心跳 PING #" + std::to_string(sequence) +
-                        " 发送成功 (" + std::to_string(bytes_sent) + " 字节)");
-                }
-                else {
-                    uint32_t failure_count = heartbeat_failure_count_.fetch_add(1);
-                    g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN,
-                        "[IPC] 心跳 PING #" + std::to_string(sequence) +
-                        " 发送失败 (连续失败: " + std::to_string(failure_count + 1) + "): " +
-                        SystemErrorUtil::GetErrorMessage(ec, true));
-
-                    // 通知 ConnectionMonitor 心跳发送失败
-                    connection_monitor_->record_heartbeat_failure(false);
-
-                    // 心跳发送失败，触发重连
-                    const auto& networkConfig = config_mgr_.getNetworkConfig();
-                    if (failure_count + 1 >= networkConfig.heartbeatMaxFailures) {
-                        g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_ERROR,
-                            "[IPC] 心跳连续失败 " + std::to_string(failure_count + 1) + " 次，触发重连");
-
-                        // 使用 ConnectionMonitor 的防重复机制
-                        connection_monitor_->try_trigger_reconnect();
-                    }
-                }
+                handle_heartbeat_ping_result(ec, bytes_sent, sequence);
             });
     }
     catch (const std::exception& e) {
         g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_ERROR,
             "[IPC] 构建心跳消息异常: " + std::string(e.what()));
     }
+#endif
 }
 
-void Lusp_AsioLoopbackIpcClient::handle_heartbeat_pong(const std::string& pong_data) {
-    try {
-        // 解析 FlatBuffer PONG 消息（跳过前4字节长度前缀）
-        const uint8_t* buf = reinterpret_cast<const uint8_t*>(pong_data.data()) + 4;
-        auto heartbeat = flatbuffers::GetRoot<UploadClient::Sync::FBS_HeartbeatMessage>(buf);
+uint32_t Lusp_AsioLoopbackIpcClient::encode_heartbeat_ping(std::vector<char>& frame) {
+    // 使用 FlatBuffer 构建心跳 PING 消息
+    flatbuffers::FlatBufferBuilder builder(256);
 
-        if (heartbeat->type() == UploadClient::Sync::FBS_HeartbeatType_FBS_HEARTBEAT_PONG) {
-            auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now().time_since_epoch()).count();
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 
-            last_pong_time_ms_.store(now_ms);
-            heartbeat_failure_count_.store(0);  // 重置失败计数
+    auto client_name_str = builder.CreateString(client_computer_name_);
+    auto client_version_str = builder.CreateString(config_mgr_.getUploadConfig().clientVersion);
+    auto payload_str = builder.CreateString("");  // 可选的附加数据
 
-            // 计算往返时延（RTT）
-            uint64_t rtt = now_ms - heartbeat->timestamp();
+    uint32_t sequence = heartbeat_sequence_.fetch_add(1);
 
-            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
-                "[IPC] 💚 心跳 PONG #" + std::to_string(heartbeat->sequence()) +
-                " 收到 (RTT: " + std::to_string(rtt) + "ms)");
+    auto heartbeat = UploadClient::Sync::CreateFBS_HeartbeatMessage(builder,
+        UploadClient::Sync::FBS_HeartbeatType_FBS_HEARTBEAT_PING,
+        sequence,
+        static_cast<uint64_t>(now_ms),
+        client_name_str,
+        client_version_str,
+        payload_str);
+
+    builder.Finish(heartbeat, kHeartbeatIdentifier);
+
+    // 心跳消息（前4字节为长度）
+    uint32_t msg_size = builder.GetSize();
+    frame.resize(4 + msg_size);
+
+    // 小端序写入长度
+    frame[0] = static_cast<char>(msg_size & 0xFF);
+    frame[1] = static_cast<char>((msg_size >> 8) & 0xFF);
+    frame[2] = static_cast<char>((msg_size >> 16) & 0xFF);
+    frame[3] = static_cast<char>((msg_size >> 24) & 0xFF);
+
+    // 拷贝心跳数据
+    std::memcpy(frame.data() + 4, builder.GetBufferPointer(), msg_size);
+    return sequence;
+}
+
+void Lusp_AsioLoopbackIpcClient::handle_heartbeat_ping_result(const std::error_code& ec, std::size_t bytes_sent, uint32_t sequence) {
+    if (!ec) {
+        g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
+            "[IPC] ❤️ 心跳 PING #" + std::to_string(sequence) +
+            " 发送成功 (" + std::to_string(bytes_sent) + " 字节)");
+    }
+    else {
+        uint32_t failure_count = heartbeat_failure_count_.fetch_add(1);
+        g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN,
+            "[IPC] 心跳 PING #" + std::to_string(sequence) +
+            " 发送失败 (连续失败: " + std::to_string(failure_count + 1) + "): " +
+            SystemErrorUtil::GetErrorMessage(ec, true));
+
+        // 通知 ConnectionMonitor 心跳发送失败
+        connection_monitor_->record_heartbeat_failure(false);
+
+        // 心跳发送失败，触发重连
+        const auto& networkConfig = config_mgr_.getNetworkConfig();
+        if (failure_count + 1 >= networkConfig.heartbeatMaxFailures) {
+            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_ERROR,
+                "[IPC] 心跳连续失败 " + std::to_string(failure_count + 1) + " 次，触发重连");
+
+            // 使用 ConnectionMonitor 的防重复机制
+            connection_monitor_->try_trigger_reconnect();
         }
     }
-    catch (const std::exception& e) {
-        g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_ERROR,
-            "[IPC] 解析心跳 PONG 异常: " + std::string(e.what()));
+}
+
+void Lusp_AsioLoopbackIpcClient::handle_heartbeat_pong(const uint8_t* pong_data) {
+    auto heartbeat = flatbuffers::GetRoot<UploadClient::Sync::FBS_HeartbeatMessage>(pong_data);
+
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    last_pong_time_ms_.store(now_ms);
+    ping_outstanding_.store(false);
+    heartbeat_failure_count_.store(0);  // 重置失败计数
+    connection_monitor_->record_heartbeat_success();
+
+    // 计算往返时延（RTT）：服务端原样回传 PING 的发送时间戳，重发的 PING 也能得到准确样本
+    const uint64_t timestamp = heartbeat->timestamp();
+    if (timestamp == 0 || timestamp > static_cast<uint64_t>(now_ms)) {
+        return;
     }
+    uint64_t rtt = now_ms - timestamp;
+    connection_monitor_->record_rtt_sample(static_cast<uint32_t>(std::min<uint64_t>(rtt, UINT32_MAX)));
+
+    g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
+        "[IPC] 💚 心跳 PONG #" + std::to_string(heartbeat->sequence()) +
+        " 收到 (RTT: " + std::to_string(rtt) + "ms)");
 }
 
-void Lusp_AsioLoopbackIpcClient::check_heartbeat_timeout() {
+uint32_t Lusp_AsioLoopbackIpcClient::get_heartbeat_timeout_ms() const {
+    const auto& networkConfig = config_mgr_.getNetworkConfig();
+    const uint32_t max_timeout_ms = networkConfig.heartbeatTimeoutMs;
+
+    uint64_t timeout_ms = connection_monitor_->get_rto_ms(max_timeout_ms);
+    timeout_ms <<= std::min<uint32_t>(heartbeat_failure_count_.load(), 16);
+    return static_cast<uint32_t>(std::min<uint64_t>(timeout_ms, max_timeout_ms));
+}
+
+uint32_t Lusp_AsioLoopbackIpcClient::on_heartbeat_timer() {
     const auto& networkConfig = config_mgr_.getNetworkConfig();
 
     auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::steady_clock::now().time_since_epoch()).count();
-    auto last_pong = last_pong_time_ms_.load();
 
-    // 如果从未初始化(连接前),跳过检查
-    if (last_pong == 0) {
-        return;
+    // 数据通道只做轻量保活: 空闲满一个间隔发一次 PING，让服务端的超时检查看到连接仍在；
+    // 不等待 PONG、不因超时重连，断开由读失败和 TCP Keep-Alive 发现
+    if (!heartbeat_channel_.load()) {
+        const uint32_t interval_ms = heartbeat_interval_ms_.load();
+        const uint64_t idle_ms = connection_monitor_->get_idle_time_ms();
+        if (idle_ms < interval_ms) {
+            return static_cast<uint32_t>(interval_ms - idle_ms);
+        }
+        send_heartbeat_ping();
+        return interval_ms;
     }
 
-    // 检查是否超时(从连接时间或最后一次PONG时间开始计算)
-    uint64_t elapsed = now_ms - last_pong;
-    if (elapsed > networkConfig.heartbeatTimeoutMs) {
-        uint32_t failure_count = heartbeat_failure_count_.fetch_add(1);
+    if (ping_outstanding_.load()) {
+        const uint64_t ping_sent = ping_sent_time_ms_.load();
+        const uint64_t waited = now_ms - ping_sent;
 
-        g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN,
-            "[IPC] ⚠️ 心跳超时 #" + std::to_string(failure_count + 1) +
-            " (未收到 PONG 超过 " + std::to_string(elapsed) + "ms)");
+        // PING 发出后收到过数据，服务端存活(PONG 本身在 handle_heartbeat_pong 中清除等待)
+        if (last_receive_time_ms_.load() >= ping_sent) {
+            ping_outstanding_.store(false);
+            heartbeat_failure_count_.store(0);
+        }
+        else {
+            const uint32_t timeout_ms = get_heartbeat_timeout_ms();
+            if (waited < timeout_ms) {
+                return static_cast<uint32_t>(timeout_ms - waited);
+            }
 
-        // 连续超时，通知 ConnectionMonitor 并触发重连
-        if (failure_count + 1 >= networkConfig.heartbeatMaxFailures) {
-            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_ERROR,
-                "[IPC] 💔 心跳连续超时 " + std::to_string(failure_count + 1) + " 次，触发重连");
+            uint32_t failure_count = heartbeat_failure_count_.fetch_add(1);
+            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN,
+                "[IPC] ⚠️ 心跳超时 #" + std::to_string(failure_count + 1) +
+                " (未收到 PONG 超过 " + std::to_string(waited) + "ms)");
 
             // 通知 ConnectionMonitor 心跳失败(超时)
             connection_monitor_->record_heartbeat_failure(true);
 
-            disconnect();
+            // 连续超时，关闭当前连接并触发重连(不同于 disconnect()，保留自动重连)
+            if (failure_count + 1 >= networkConfig.heartbeatMaxFailures) {
+                g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_ERROR,
+                    "[IPC] 💔 心跳连续超时 " + std::to_string(failure_count + 1) + " 次，触发重连");
 
-            // 使用 ConnectionMonitor 的防重复触发机制
-            connection_monitor_->try_trigger_reconnect();
+                ping_outstanding_.store(false);
+                std::error_code close_ec;
+                socket_->close(close_ec);
+                connection_monitor_->set_state(ConnectionState::Reconnecting);
+
+                // 使用 ConnectionMonitor 的防重复触发机制
+                connection_monitor_->try_trigger_reconnect();
+                return 0;
+            }
+
+            // 重发 PING，等待时间翻倍
+            ping_sent_time_ms_.store(now_ms);
+            send_heartbeat_ping();
+            return get_heartbeat_timeout_ms();
         }
     }
+
+    // 心跳间隔内收发过数据，连接已证明存活，不发 PING，等到空闲满一个间隔再检查
+    const uint32_t interval_ms = heartbeat_interval_ms_.load();
+    const uint64_t idle_ms = connection_monitor_->get_idle_time_ms();
+    if (idle_ms < interval_ms) {
+        return static_cast<uint32_t>(interval_ms - idle_ms);
+    }
+
+    ping_sent_time_ms_.store(now_ms);
+    ping_outstanding_.store(true);
+    send_heartbeat_ping();
+
+    // 收到 PONG 后按空闲时长重新计时，心跳间隔短于超时时也不拉长探测周期
+    return std::min(get_heartbeat_timeout_ms(), interval_ms);
 }
 
 std::string Lusp_AsioLoopbackIpcClient::get_computer_name() const {
@@ -623,4 +831,120 @@ std::string Lusp_AsioLoopbackIpcClient::get_computer_name() const {
 }
     return "Unknown-Linux";
 #endif
-}
\ No newline at end of file
+}
+
+#ifdef LUSP_IPC_COROUTINES
+// ==================== 协程读/发送/心跳循环 ====================
+
+asio::awaitable<void> Lusp_AsioLoopbackIpcClient::read_loop(std::shared_ptr<asio::ip::tcp::socket> socket) {
+    auto buffer = buffer_;
+    std::vector<char> pending;  // 本连接未拆完的接收数据
+    while (true) {
+        auto [ec, bytes_transferred] = co_await socket->async_read_some(asio::buffer(*buffer), use_awaitable_tuple);
+        if (ec || bytes_transferred == 0) {
+            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN,
+                "[IPC] 读取失败: " + SystemErrorUtil::GetErrorMessage(ec));
+
+            // 通知 ConnectionMonitor 读取失败，由 Monitor 决定是否触发重连
+            connection_monitor_->record_read_failure(ec);
+            co_return;
+        }
+        pending.insert(pending.end(), buffer->data(), buffer->data() + bytes_transferred);
+        dispatch_frames(pending);
+    }
+}
+
+asio::awaitable<void> Lusp_AsioLoopbackIpcClient::send_loop(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<asio::steady_timer> signal) {
+    std::vector<char> frame;  // 发送帧缓冲区，只增不缩，跨消息复用
+    while (socket == socket_ && socket->is_open()) {
+        if (ping_pending_.exchange(false)) {
+            const uint32_t sequence = encode_heartbeat_ping(frame);
+            auto [ec, bytes_sent] = co_await asio::async_write(*socket, asio::buffer(frame), use_awaitable_tuple);
+            handle_heartbeat_ping_result(ec, bytes_sent, sequence);
+            continue;
+        }
+
+        auto ipc_message_opt = message_queue_->peek();
+        if (!ipc_message_opt.has_value()) {
+            // 先标记空闲再复查队列：send() 在两步之间入队时会看到空闲标记并唤醒，不会丢失
+            send_loop_idle_.store(true);
+            if (!message_queue_->empty() || ping_pending_.load()) {
+                send_loop_idle_.store(false);
+                continue;
+            }
+            signal->expires_at(asio::steady_timer::time_point::max());
+            co_await signal->async_wait(use_awaitable_tuple);
+            send_loop_idle_.store(false);
+            continue;
+        }
+
+        const auto& ipc_message = ipc_message_opt.value();
+        const uint64_t msg_id = ipc_message.id;
+
+        // 计算长度并转为4字节（小端序）
+        uint32_t len = static_cast<uint32_t>(ipc_message.data.size());
+        frame.resize(4 + ipc_message.data.size());
+        frame[0] = static_cast<char>(len & 0xFF);
+        frame[1] = static_cast<char>((len >> 8) & 0xFF);
+        frame[2] = static_cast<char>((len >> 16) & 0xFF);
+        frame[3] = static_cast<char>((len >> 24) & 0xFF);
+        std::memcpy(frame.data() + 4, ipc_message.data.data(), ipc_message.data.size());
+
+        in_flight_id_.store(msg_id);
+        auto [ec, bytes_sent] = co_await asio::async_write(*socket, asio::buffer(frame), use_awaitable_tuple);
+        in_flight_id_.store(0);
+        if (!ec) {
+            g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
+                "[IPC] 消息 " + std::to_string(msg_id) + " 发送成功，长度: " + std::to_string(len));
+            // 写出期间队列可能已被通道池迁移，只删除写出的那条
+            if (message_queue_->pop_front_if(msg_id)) {
+                g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_DEBUG,
+                    "[IPC] 消息 " + std::to_string(msg_id) + " 已从队列移除");
+            }
+            connection_monitor_->record_send_success();
+            continue;
+        }
+
+        // 发送失败，消息保留在队列，交给连接监测器判断是否需要重连
+        g_LogAsioLoopbackIpcClient.WriteLogContent(LOG_WARN,
+            "[IPC] 消息 " + std::to_string(msg_id) + " 发送失败: " + SystemErrorUtil::GetErrorMessage(ec) +
+            "，保留在队列等待重试");
+        if (connection_monitor_->record_send_failure(ec)) {
+            // 需要重连：ConnectionMonitor 会触发 try_reconnect()，新连接起新的发送循环
+            co_return;
+        }
+        // 可能是临时错误，短暂延迟后继续发送(不阻塞 io 线程)
+        signal->expires_after(std::chrono::milliseconds(100));
+        co_await signal->async_wait(use_awaitable_tuple);
+    }
+}
+
+asio::awaitable<void> Lusp_AsioLoopbackIpcClient::heartbeat_loop(std::shared_ptr<asio::ip::tcp::socket> socket) {
+    // 重新启动心跳时 expires_after 会取消上一个循环的等待，旧循环随之退出
+    auto timer = heartbeat_timer_;
+    uint32_t delay_ms = heartbeat_interval_ms_.load();
+    while (heartbeat_enabled_.load() && socket == socket_ && is_connected()) {
+        timer->expires_after(std::chrono::milliseconds(delay_ms));
+        auto [ec] = co_await timer->async_wait(use_awaitable_tuple);
+        if (ec || !heartbeat_enabled_.load() || socket != socket_ || !is_connected()) {
+            co_return;
+        }
+        delay_ms = on_heartbeat_timer();
+        if (delay_ms == 0) {
+            co_return;
+        }
+    }
+}
+
+void Lusp_AsioLoopbackIpcClient::wake_send_loop() {
+    if (!send_loop_idle_.exchange(false)) {
+        return;  // 发送循环正在工作，写完当前帧后会再检查队列
+    }
+    // 计时器只在 io_context 线程上操作
+    asio::post(io_context_, [this]() {
+        if (send_signal_) {
+            send_signal_->cancel();
+        }
+        });
+}
+#endif
@@ -139,6 +139,8 @@ void ClientConfigManager::initializeDefaults() {
     // 网络配置默认值已在结构体中设置
     m_networkConfig = NetworkConfig{};
 
+    rebuildExcludeMatcher();
+
     // 清空错误信息
     m_lastError.clear();
     m_currentConfigPath.clear();
@@ -307,6 +309,30 @@ bool ClientConfigManager::validateUploadConfig(std::vector<std::string>& errors)
         isValid = false;
     }
 
+    // 验证摘要缓存
+    if (m_uploadConfig.enableDigestCache) {
+        if (m_uploadConfig.digestCacheDir.empty()) {
+            errors.push_back("摘要缓存目录不能为空");
+            isValid = false;
+        }
+        if (m_uploadConfig.digestCacheMaxEntries < 1024 || m_uploadConfig.digestCacheMaxEntries > 16 * 1024 * 1024) {
+            errors.push_back("摘要缓存最大条目数应在1024-16777216范围内");
+            isValid = false;
+        }
+    }
+
+    // 验证目录监控
+    if (m_uploadConfig.enableWatch) {
+        if (m_uploadConfig.watchDirs.empty()) {
+            errors.push_back("启用目录监控时监控目录不能为空");
+            isValid = false;
+        }
+        if (m_uploadConfig.watchDebounceMs < 10 || m_uploadConfig.watchDebounceMs > 60000) {
+            errors.push_back("目录监控防抖时间应在10-60000毫秒范围内");
+            isValid = false;
+        }
+    }
+
     return isValid;
 }
 
@@ -485,6 +511,15 @@ std::string ClientConfigManager::generateFullTomlConfig() const {
     oss << "enable_multipart = " << (m_uploadConfig.enableMultipart ? "true" : "false") << std::endl;
     oss << "enable_progress = " << (m_uploadConfig.enableProgress ? "true" : "false") << std::endl;
     oss << "target_dir = \"" << m_uploadConfig.targetDir << "\"" << std::endl;
+    oss << "enable_digest_cache = " << (m_uploadConfig.enableDigestCache ? "true" : "false") << std::endl;
+    oss << "digest_cache_dir = \"" << m_uploadConfig.digestCacheDir << "\"" << std::endl;
+    oss << "digest_cache_max_entries = " << m_uploadConfig.digestCacheMaxEntries << std::endl;
+    oss << "enable_chunk_hash = " << (m_uploadConfig.enableChunkHash ? "true" : "false") << std::endl;
+    oss << "chunk_hash_threshold = " << m_uploadConfig.chunkHashThreshold << std::endl;
+    oss << "enable_content_sniff = " << (m_uploadConfig.enableContentSniff ? "true" : "false") << std::endl;
+    oss << "enable_watch = " << (m_uploadConfig.enableWatch ? "true" : "false") << std::endl;
+    oss << "watch_debounce_ms = " << m_uploadConfig.watchDebounceMs << std::endl;
+    oss << "watch_initial_scan = " << (m_uploadConfig.watchInitialScan ? "true" : "false") << std::endl;
     oss << "use_ssl = " << (m_uploadConfig.useSSL ? "true" : "false") << std::endl;
     oss << "cert_file = \"" << m_uploadConfig.certFile << "\"" << std::endl;
     oss << "private_key_file = \"" << m_uploadConfig.privateKeyFile << "\"" << std::endl;
@@ -506,6 +541,14 @@ std::string ClientConfigManager::generateFullTomlConfig() const {
         }
         oss << "]" << std::endl;
     }
+    if (!m_uploadConfig.watchDirs.empty()) {
+        oss << "watch_dirs = [";
+        for (size_t i = 0; i < m_uploadConfig.watchDirs.size(); ++i) {
+            if (i > 0) oss << ", ";
+            oss << "\"" << m_uploadConfig.watchDirs[i] << "\"";
+        }
+        oss << "]" << std::endl;
+    }
 
     oss << std::endl;
 
@@ -692,6 +735,20 @@ void ClientConfigManager::parseUploadConfigSection(const toml::value& data) {
     // 文件和路径配置
     parseConfigValue(upload, "target_dir", m_uploadConfig.targetDir);
 
+    // 本地摘要缓存
+    parseConfigValue(upload, "enable_digest_cache", m_uploadConfig.enableDigestCache);
+    parseConfigValue(upload, "digest_cache_dir", m_uploadConfig.digestCacheDir);
+    parseConfigValue(upload, "digest_cache_max_entries", m_uploadConfig.digestCacheMaxEntries);
+    parseConfigValue(upload, "enable_chunk_hash", m_uploadConfig.enableChunkHash);
+    parseConfigValue(upload, "chunk_hash_threshold", m_uploadConfig.chunkHashThreshold);
+    parseConfigValue(upload, "enable_content_sniff", m_uploadConfig.enableContentSniff);
+
+    // 目录监控
+    parseConfigValue(upload, "enable_watch", m_uploadConfig.enableWatch);
+    parseConfigValue(upload, "watch_debounce_ms", m_uploadConfig.watchDebounceMs);
+    parseConfigValue(upload, "watch_initial_scan", m_uploadConfig.watchInitialScan);
+    parseStringArray(upload, "watch_dirs", m_uploadConfig.watchDirs);
+
     // SSL/TLS安全配置
     parseConfigValue(upload, "use_ssl", m_uploadConfig.useSSL);
     parseConfigValue(upload, "cert_file", m_uploadConfig.certFile);
@@ -711,6 +768,23 @@ void ClientConfigManager::parseUploadConfigSection(const toml::value& data) {
 
     // 特殊处理：字符串数组
     parseStringArray(upload, "exclude_patterns", m_uploadConfig.excludePatterns);
+    rebuildExcludeMatcher();
+}
+
+void ClientConfigManager::rebuildExcludeMatcher() {
+    auto matcher = Lusp_ExcludeMatcher::compile(m_uploadConfig.excludePatterns);
+    const auto stats = matcher->getStatistics();
+    std::atomic_store(&m_excludeMatcher, matcher);
+    g_luspLogWriteImpl.WriteLogContent(LOG_DEBUG,
+        "排除模式已编译: exact=" + std::to_string(stats.exactNames) +
+        " suffix=" + std::to_string(stats.suffixes) +
+        " name_glob=" + std::to_string(stats.namePatterns) +
+        " path_glob=" + std::to_string(stats.pathPatterns) +
+        " nfa_states=" + std::to_string(stats.nfaStates));
+}
+
+std::shared_ptr<const Lusp_ExcludeMatcher> ClientConfigManager::getExcludeMatcher() const {
+    return std::atomic_load(&m_excludeMatcher);
 }
 
 void ClientConfigManager::parseUIConfigSection(const toml::value& data) {
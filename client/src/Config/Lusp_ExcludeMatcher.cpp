@@ -0,0 +1,577 @@
+#include "Config/Lusp_ExcludeMatcher.h"
+#include <algorithm>
+#include <bitset>
+#include <map>
+
+namespace {
+    constexpr size_t kMaxExpandedVariants   = 16;   // "**/" 展开的上限，防止病态模式指数膨胀
+    constexpr size_t kStackWords            = 64;   // NFA 状态不超过 4096 位时使用栈缓冲
+    constexpr size_t kMaxDfaStates          = 4096; // DFA 状态上限，超出则退回 NFA
+
+    /**
+     * @brief 通配符编译后的单个记号
+     *
+     * 非星号记号消耗一个字节，chars 为可接受的字节集合；
+     * 星号记号原地自环，chars 为自环可接受的字节集合(普通 * 不含 /，** 含 /)。
+     */
+    struct GlobToken {
+        bool            star = false;
+        std::bitset<256> chars;
+    };
+
+    char foldAscii(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    std::string foldString(std::string_view s) {
+        std::string out(s);
+        for (auto& c : out) {
+            c = foldAscii(c);
+        }
+        return out;
+    }
+
+    void addFoldedCase(std::bitset<256>& set) {
+        for (int c = 'a'; c <= 'z'; ++c) {
+            int upper = c - 'a' + 'A';
+            if (set.test(c) || set.test(upper)) {
+                set.set(c);
+                set.set(upper);
+            }
+        }
+    }
+
+    // 取末两字节组成 16 位键
+    size_t suffixTailKey(std::string_view s) {
+        return (static_cast<size_t>(static_cast<unsigned char>(s[s.size() - 2])) << 8) |
+            static_cast<unsigned char>(s[s.size() - 1]);
+    }
+
+    bool hasGlobMeta(std::string_view s) {
+        return s.find_first_of("*?[") != std::string_view::npos;
+    }
+
+    void pushStar(std::vector<GlobToken>& tokens, const std::bitset<256>& loopChars) {
+        // 相邻星号合并为一个(自环集合取并集)，保证 NFA 中不存在相邻的星号状态，ε 闭包一步即可完成
+        if (!tokens.empty() && tokens.back().star) {
+            tokens.back().chars |= loopChars;
+            return;
+        }
+        GlobToken token;
+        token.star = true;
+        token.chars = loopChars;
+        tokens.push_back(token);
+    }
+
+    /**
+     * @brief 将通配模式解析为记号序列
+     * @param pathMode 路径模式下 * 和 ? 不匹配 /，** 匹配 /
+     */
+    std::vector<GlobToken> parseGlob(std::string_view pattern, bool pathMode, bool fold) {
+        std::bitset<256> anyByte;
+        anyByte.set();
+        std::bitset<256> anyExceptSlash = anyByte;
+        if (pathMode) {
+            anyExceptSlash.reset('/');
+        }
+        // UTF-8 续字节，? 匹配一个完整码点: 一个非续字节 + 任意个续字节
+        std::bitset<256> continuation;
+        for (int c = 0x80; c <= 0xBF; ++c) {
+            continuation.set(c);
+        }
+
+        std::vector<GlobToken> tokens;
+        size_t i = 0;
+        while (i < pattern.size()) {
+            char c = pattern[i];
+            if (c == '*') {
+                size_t run = 0;
+                while (i < pattern.size() && pattern[i] == '*') {
+                    ++run;
+                    ++i;
+                }
+                pushStar(tokens, run >= 2 ? anyByte : anyExceptSlash);
+                continue;
+            }
+            GlobToken token;
+            if (c == '?') {
+                token.chars = anyExceptSlash & ~continuation;
+                tokens.push_back(token);
+                pushStar(tokens, continuation);
+                ++i;
+                continue;
+            }
+            if (c == '[') {
+                size_t j = i + 1;
+                bool negate = j < pattern.size() && (pattern[j] == '!' || pattern[j] == '^');
+                if (negate) {
+                    ++j;
+                }
+                std::bitset<256> set;
+                bool first = true;
+                while (j < pattern.size() && (pattern[j] != ']' || first)) {
+                    unsigned char lo = static_cast<unsigned char>(pattern[j]);
+                    if (j + 2 < pattern.size() && pattern[j + 1] == '-' && pattern[j + 2] != ']') {
+                        unsigned char hi = static_cast<unsigned char>(pattern[j + 2]);
+                        for (unsigned v = lo; v <= hi; ++v) {
+                            set.set(v);
+                        }
+                        j += 3;
+                    }
+                    else {
+                        set.set(lo);
+                        ++j;
+                    }
+                    first = false;
+                }
+                if (j < pattern.size()) {
+                    if (fold) {
+                        addFoldedCase(set);
+                    }
+                    token.chars = (negate ? ~set : set) & anyExceptSlash;
+                    tokens.push_back(token);
+                    i = j + 1;
+                    continue;
+                }
+                // 没有闭合的 ] 按普通字符处理
+            }
+            token.chars.set(static_cast<unsigned char>(c));
+            if (fold) {
+                addFoldedCase(token.chars);
+            }
+            tokens.push_back(token);
+            ++i;
+        }
+        return tokens;
+    }
+
+    // 展开路径模式中位于目录边界的 "**/"，使其同时匹配零层目录("a/**/b" 也匹配 "a/b")
+    void expandDoubleStarSlash(const std::string& pattern, size_t from, std::vector<std::string>& out) {
+        if (out.size() >= kMaxExpandedVariants) {
+            return;
+        }
+        size_t pos = pattern.find("**/", from);
+        while (pos != std::string::npos && pos != 0 && pattern[pos - 1] != '/') {
+            pos = pattern.find("**/", pos + 1);
+        }
+        if (pos == std::string::npos) {
+            out.push_back(pattern);
+            return;
+        }
+        expandDoubleStarSlash(pattern, pos + 3, out);
+        expandDoubleStarSlash(pattern.substr(0, pos) + pattern.substr(pos + 3), pos, out);
+    }
+}
+
+/**
+ * @brief 多模式位并行 NFA + 预构建 DFA
+ *
+ * 每个模式的 m 个记号占用 m+1 个连续状态位(第 m 位为接受态)，所有模式拼接成一个位向量。
+ * 状态 j 表示已匹配前 j 个记号，每读入一个字节:
+ *   D' = ((D & consume[c]) << 1) | (D & loop[c])
+ *   D' = D' | ((D' & starMask) << 1)        // 星号的 ε 转移
+ * 接受态在 consume 中恒为 0，不会移入下一个模式的起始位。
+ *
+ * 编译时按字节等价类对 NFA 做子集构造得到 DFA，匹配时每字节一次查表；
+ * 状态数超过上限时放弃 DFA，退回位并行 NFA。
+ */
+struct Lusp_ExcludeMatcher::GlobProgram {
+    size_t                  words = 0;
+    size_t                  bits = 0;
+    std::vector<uint64_t>   initial;
+    std::vector<uint64_t>   accept;
+    std::vector<uint64_t>   starMask;
+    std::vector<uint64_t>   consume;    ///< 256 * words
+    std::vector<uint64_t>   loop;       ///< 256 * words
+
+    std::vector<uint8_t>    byteClass;  ///< 字节 -> 等价类
+    size_t                  classCount = 0;
+    std::vector<uint32_t>   dfaTable;   ///< 状态 * classCount，状态 0 为死状态，1 为起始状态
+    std::vector<uint8_t>    dfaAccept;
+
+    explicit GlobProgram(const std::vector<std::vector<GlobToken>>& patterns) {
+        for (const auto& tokens : patterns) {
+            bits += tokens.size() + 1;
+        }
+        words = (bits + 63) / 64;
+        initial.assign(words, 0);
+        accept.assign(words, 0);
+        starMask.assign(words, 0);
+        consume.assign(256 * words, 0);
+        loop.assign(256 * words, 0);
+
+        size_t base = 0;
+        for (const auto& tokens : patterns) {
+            setBit(initial, base);
+            if (!tokens.empty() && tokens[0].star) {
+                setBit(initial, base + 1);
+            }
+            for (size_t j = 0; j < tokens.size(); ++j) {
+                const size_t bit = base + j;
+                const GlobToken& token = tokens[j];
+                if (token.star) {
+                    setBit(starMask, bit);
+                }
+                uint64_t* table = token.star ? loop.data() : consume.data();
+                for (size_t c = 0; c < 256; ++c) {
+                    if (token.chars.test(c)) {
+                        table[c * words + bit / 64] |= uint64_t(1) << (bit % 64);
+                    }
+                }
+            }
+            setBit(accept, base + tokens.size());
+            base += tokens.size() + 1;
+        }
+
+        buildDfa();
+    }
+
+    static void setBit(std::vector<uint64_t>& v, size_t bit) {
+        v[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+
+    size_t dfaStates() const {
+        return dfaAccept.size();
+    }
+
+    /**
+     * @brief NFA 前进一个字节(全量，用于构造 DFA)
+     */
+    void step(const uint64_t* cur, unsigned char c, uint64_t* next) const {
+        const uint64_t* consumeRow = consume.data() + c * words;
+        const uint64_t* loopRow = loop.data() + c * words;
+        uint64_t shiftCarry = 0;
+        uint64_t epsilonCarry = 0;
+        for (size_t w = 0; w < words; ++w) {
+            const uint64_t d = cur[w];
+            const uint64_t advance = d & consumeRow[w];
+            uint64_t n = (advance << 1) | shiftCarry | (d & loopRow[w]);
+            shiftCarry = advance >> 63;
+            const uint64_t starBits = n & starMask[w];
+            n |= (starBits << 1) | epsilonCarry;
+            epsilonCarry = starBits >> 63;
+            next[w] = n;
+        }
+    }
+
+    bool isAccepting(const std::vector<uint64_t>& set) const {
+        for (size_t w = 0; w < words; ++w) {
+            if (set[w] & accept[w]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void buildDfa() {
+        // 转移行完全相同的字节归为一类，典型模式集合只有十几个类
+        std::map<std::vector<uint64_t>, uint8_t> classIds;
+        std::vector<unsigned char> representatives;
+        byteClass.assign(256, 0);
+        std::vector<uint64_t> signature(words * 2);
+        for (size_t c = 0; c < 256; ++c) {
+            std::copy_n(consume.data() + c * words, words, signature.begin());
+            std::copy_n(loop.data() + c * words, words, signature.begin() + words);
+            auto inserted = classIds.emplace(signature, static_cast<uint8_t>(representatives.size()));
+            if (inserted.second) {
+                representatives.push_back(static_cast<unsigned char>(c));
+            }
+            byteClass[c] = inserted.first->second;
+        }
+        classCount = representatives.size();
+
+        std::map<std::vector<uint64_t>, uint32_t> stateIds;
+        std::vector<std::vector<uint64_t>> states;
+        states.emplace_back(words, 0);
+        states.push_back(initial);
+        stateIds.emplace(states[0], 0);
+        stateIds.emplace(states[1], 1);
+        dfaTable.assign(2 * classCount, 0);
+
+        std::vector<uint64_t> current;
+        std::vector<uint64_t> next(words);
+        for (size_t s = 1; s < states.size(); ++s) {
+            current = states[s];
+            for (size_t k = 0; k < classCount; ++k) {
+                step(current.data(), representatives[k], next.data());
+                auto inserted = stateIds.emplace(next, static_cast<uint32_t>(states.size()));
+                if (inserted.second) {
+                    if (states.size() >= kMaxDfaStates) {
+                        dfaTable.clear();
+                        dfaAccept.clear();
+                        return;
+                    }
+                    states.push_back(next);
+                    dfaTable.resize(states.size() * classCount, 0);
+                }
+                dfaTable[s * classCount + k] = inserted.first->second;
+            }
+        }
+
+        dfaAccept.resize(states.size());
+        for (size_t s = 0; s < states.size(); ++s) {
+            dfaAccept[s] = isAccepting(states[s]) ? 1 : 0;
+        }
+    }
+
+    bool run(std::string_view text) const {
+        if (!dfaAccept.empty()) {
+            const uint32_t* table = dfaTable.data();
+            const uint8_t* classes = byteClass.data();
+            const size_t stride = classCount;
+            uint32_t state = 1;
+            for (unsigned char c : text) {
+                state = table[state * stride + classes[c]];
+                if (state == 0) {
+                    return false;
+                }
+            }
+            return dfaAccept[state] != 0;
+        }
+        return runNfa(text);
+    }
+
+    bool runNfa(std::string_view text) const {
+        uint64_t stackBuffer[kStackWords * 2];
+        std::vector<uint64_t> heapBuffer;
+        uint64_t* cur = stackBuffer;
+        if (words > kStackWords) {
+            heapBuffer.resize(words * 2);
+            cur = heapBuffer.data();
+        }
+        uint64_t* next = cur + words;
+        std::copy(initial.begin(), initial.end(), cur);
+
+        // 拷贝到局部变量，避免写 cur/next 时编译器因别名反复重新加载成员
+        const size_t wordCount = words;
+        const uint64_t* consumeTable = consume.data();
+        const uint64_t* loopTable = loop.data();
+        const uint64_t* stars = starMask.data();
+
+        // 只处理含活跃状态的字区间: 锚定开头的模式通常在前几个字节就失配，对应的字不再参与计算
+        size_t activeBegin = 0;
+        size_t activeEnd = wordCount;
+        for (unsigned char c : text) {
+            const uint64_t* consumeRow = consumeTable + c * wordCount;
+            const uint64_t* loopRow = loopTable + c * wordCount;
+            uint64_t shiftCarry = 0;
+            uint64_t epsilonCarry = 0;
+            size_t nextBegin = wordCount;
+            size_t nextEnd = 0;
+            const size_t limit = (std::min)(activeEnd + 1, wordCount);
+            for (size_t w = activeBegin; w < limit; ++w) {
+                const uint64_t d = cur[w];
+                const uint64_t advance = d & consumeRow[w];
+                uint64_t n = (advance << 1) | shiftCarry | (d & loopRow[w]);
+                shiftCarry = advance >> 63;
+                const uint64_t starBits = n & stars[w];
+                n |= (starBits << 1) | epsilonCarry;
+                epsilonCarry = starBits >> 63;
+                next[w] = n;
+                if (n != 0) {
+                    nextBegin = (std::min)(nextBegin, w);
+                    nextEnd = w + 1;
+                }
+            }
+            if (nextEnd == 0) {
+                return false;
+            }
+            activeBegin = nextBegin;
+            activeEnd = nextEnd;
+            std::swap(cur, next);
+        }
+
+        for (size_t w = activeBegin; w < activeEnd; ++w) {
+            if (cur[w] & accept[w]) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+
+Lusp_ExcludeMatcher::~Lusp_ExcludeMatcher() = default;
+
+std::shared_ptr<const Lusp_ExcludeMatcher> Lusp_ExcludeMatcher::compile(const std::vector<std::string>& patterns,
+    bool caseInsensitive) {
+    std::shared_ptr<Lusp_ExcludeMatcher> matcher(new Lusp_ExcludeMatcher());
+    matcher->m_caseInsensitive = caseInsensitive;
+
+    std::vector<std::string> exactNames;
+    std::vector<std::string> suffixes;
+    std::vector<std::vector<GlobToken>> namePatterns;
+    std::vector<std::vector<GlobToken>> pathPatterns;
+
+    for (const auto& raw : patterns) {
+        std::string pattern = raw;
+        std::replace(pattern.begin(), pattern.end(), '\\', '/');
+        if (pattern.empty()) {
+            continue;
+        }
+
+        if (pattern.find('/') != std::string::npos) {
+            // 路径模式锚定到遍历根目录，首尾的 / 没有额外含义
+            size_t first = pattern.find_first_not_of('/');
+            size_t last = pattern.find_last_not_of('/');
+            if (first == std::string::npos) {
+                continue;
+            }
+            pattern = pattern.substr(first, last - first + 1);
+            if (pattern.find('/') != std::string::npos) {
+                std::vector<std::string> variants;
+                expandDoubleStarSlash(pattern, 0, variants);
+                for (const auto& variant : variants) {
+                    pathPatterns.push_back(parseGlob(variant, true, caseInsensitive));
+                }
+                continue;
+            }
+            // "/foo" 或 "foo/" 去掉首尾 / 后退化为文件名模式
+        }
+
+        if (pattern.find_first_not_of('*') == std::string::npos) {
+            matcher->m_matchAll = true;
+        }
+        else if (!hasGlobMeta(pattern)) {
+            exactNames.push_back(caseInsensitive ? foldString(pattern) : pattern);
+        }
+        else if (pattern[0] == '*' && !hasGlobMeta(std::string_view(pattern).substr(1))) {
+            suffixes.push_back(caseInsensitive ? foldString(pattern.substr(1)) : pattern.substr(1));
+        }
+        else {
+            namePatterns.push_back(parseGlob(pattern, false, caseInsensitive));
+        }
+    }
+
+    // 先把所有字面量写入连续存储，再建立 string_view 索引(写入过程中存储可能重新分配)
+    size_t storageSize = 0;
+    for (const auto& s : exactNames) {
+        storageSize += s.size();
+    }
+    for (const auto& s : suffixes) {
+        storageSize += s.size();
+    }
+    matcher->m_literalStorage.reserve(storageSize);
+    for (const auto& s : exactNames) {
+        matcher->m_literalStorage.append(s);
+    }
+    for (const auto& s : suffixes) {
+        matcher->m_literalStorage.append(s);
+    }
+    size_t offset = 0;
+    const std::string_view storage(matcher->m_literalStorage);
+    for (const auto& s : exactNames) {
+        matcher->m_exactNames.insert(storage.substr(offset, s.size()));
+        offset += s.size();
+    }
+    matcher->m_hasSuffixes = !suffixes.empty();
+    matcher->m_suffixTailBits.assign(65536 / 64, 0);
+    matcher->m_oneByteSuffixes.assign(256 / 64, 0);
+    for (const auto& s : suffixes) {
+        if (s.size() == 1) {
+            const unsigned char last = static_cast<unsigned char>(s[0]);
+            matcher->m_oneByteSuffixes[last / 64] |= uint64_t(1) << (last % 64);
+        }
+        else {
+            const size_t tail = suffixTailKey(s);
+            matcher->m_suffixTailBits[tail / 64] |= uint64_t(1) << (tail % 64);
+            matcher->m_suffixes.insert(storage.substr(offset, s.size()));
+            matcher->m_suffixLengths.push_back(s.size());
+        }
+        offset += s.size();
+    }
+    std::sort(matcher->m_suffixLengths.begin(), matcher->m_suffixLengths.end());
+    matcher->m_suffixLengths.erase(
+        std::unique(matcher->m_suffixLengths.begin(), matcher->m_suffixLengths.end()),
+        matcher->m_suffixLengths.end());
+
+    // 以 * 开头的模式在整个输入上都保持活跃，集中放在位向量前部，便于其余部分尽早失活
+    auto leadingStar = [](const std::vector<GlobToken>& tokens) { return !tokens.empty() && tokens[0].star; };
+    std::stable_partition(namePatterns.begin(), namePatterns.end(), leadingStar);
+    std::stable_partition(pathPatterns.begin(), pathPatterns.end(), leadingStar);
+
+    if (!namePatterns.empty()) {
+        matcher->m_nameProgram = std::make_unique<GlobProgram>(namePatterns);
+    }
+    if (!pathPatterns.empty()) {
+        matcher->m_pathProgram = std::make_unique<GlobProgram>(pathPatterns);
+    }
+
+    matcher->m_stats.exactNames = matcher->m_exactNames.size();
+    matcher->m_stats.suffixes = matcher->m_suffixes.size();
+    for (uint64_t bits : matcher->m_oneByteSuffixes) {
+        matcher->m_stats.suffixes += std::bitset<64>(bits).count();
+    }
+    matcher->m_stats.namePatterns = namePatterns.size();
+    matcher->m_stats.pathPatterns = pathPatterns.size();
+    matcher->m_stats.nfaStates = (matcher->m_nameProgram ? matcher->m_nameProgram->bits : 0) +
+        (matcher->m_pathProgram ? matcher->m_pathProgram->bits : 0);
+    matcher->m_stats.dfaStates = (matcher->m_nameProgram ? matcher->m_nameProgram->dfaStates() : 0) +
+        (matcher->m_pathProgram ? matcher->m_pathProgram->dfaStates() : 0);
+    matcher->m_stats.matchAll = matcher->m_matchAll;
+    return matcher;
+}
+
+bool Lusp_ExcludeMatcher::empty() const {
+    return !m_matchAll && m_exactNames.empty() && !m_hasSuffixes && !m_nameProgram && !m_pathProgram;
+}
+
+bool Lusp_ExcludeMatcher::matchName(std::string_view name) const {
+    if (m_matchAll) {
+        return true;
+    }
+    if (name.empty()) {
+        return false;
+    }
+
+    if (!m_exactNames.empty() || m_hasSuffixes) {
+        std::string_view key = name;
+        char stackBuffer[256];
+        std::string heapBuffer;
+        if (m_caseInsensitive) {
+            char* out = stackBuffer;
+            if (name.size() > sizeof(stackBuffer)) {
+                heapBuffer.resize(name.size());
+                out = heapBuffer.data();
+            }
+            for (size_t i = 0; i < name.size(); ++i) {
+                out[i] = foldAscii(name[i]);
+            }
+            key = std::string_view(out, name.size());
+        }
+
+        if (!m_exactNames.empty() && m_exactNames.count(key) != 0) {
+            return true;
+        }
+        if (m_hasSuffixes) {
+            const unsigned char last = static_cast<unsigned char>(key.back());
+            if (m_oneByteSuffixes[last / 64] & (uint64_t(1) << (last % 64))) {
+                return true;
+            }
+            // 末两字节位图预过滤，绝大多数名称在这里就能排除，不必逐个长度查哈希
+            const size_t tail = key.size() >= 2 ? suffixTailKey(key) : 0;
+            if (key.size() >= 2 && (m_suffixTailBits[tail / 64] & (uint64_t(1) << (tail % 64)))) {
+                for (size_t len : m_suffixLengths) {
+                    if (len > key.size()) {
+                        break;
+                    }
+                    if (m_suffixes.count(key.substr(key.size() - len)) != 0) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    // NFA 在编译期已展开大小写，直接使用原始名称
+    return m_nameProgram && m_nameProgram->run(name);
+}
+
+bool Lusp_ExcludeMatcher::matchPath(std::string_view relativePath) const {
+    size_t slash = relativePath.find_last_of('/');
+    std::string_view name = slash == std::string_view::npos ? relativePath : relativePath.substr(slash + 1);
+    if (matchName(name)) {
+        return true;
+    }
+    return m_pathProgram && m_pathProgram->run(relativePath);
+}
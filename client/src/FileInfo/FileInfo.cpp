@@ -1,10 +1,14 @@
 #include "FileInfo/FileInfo.h"
+#include "FileInfo/Lusp_FileDigestCache.h"
+#include "FileInfo/Lusp_ChunkHasher.h"
+#include "FileInfo/Lusp_FileTypeClassifier.h"
+#include "FileInfo/Lusp_UploadIdGenerator.h"
+#include "Config/ClientConfigManager.h"
 #include "log_headers.h"
 #include "UniConv.h"
+#include "utils/PathUtf8Util.h"
 #include <codecvt>
 
-#pragma comment(lib, "rpcrt4.lib")
-
 
 
 std::string Lusp_SyncUploadFileInfoHandler::getComputerName() {
@@ -32,7 +36,7 @@ std::u16string Lusp_SyncUploadFileInfoHandler::getComputerNameU16() {
 
 
 void Lusp_SyncUploadFileInfoHandler::initializeDefaults() {
-    m_id = m_fileInfo.sAuthTokenValues = generateUuidWindows();
+    m_id = m_fileInfo.uFileId = Lusp_UploadIdGenerator::instance().next();
     m_fileInfo.eUploadFileTyped = Lusp_UploadFileTyped::LUSP_UPLOADTYPE_UNDEFINED;
     m_fileInfo.sLanClientDevice = this->getComputerNameU16();
     m_fileInfo.sSyncFileSizeValue = 0;
@@ -40,6 +44,8 @@ void Lusp_SyncUploadFileInfoHandler::initializeDefaults() {
     m_fileInfo.uUploadTimeStamp = 0;
     m_fileInfo.eUploadStatusInf = Lusp_UploadStatusInf::LUSP_UPLOAD_STATUS_IDENTIFIERS_PENDING;
     m_fileInfo.sFileRecordTimeValue = {};
+    m_fileInfo.uChunkHashSize = 0;
+    m_fileInfo.bPayloadCompressed = false;
 }
 
 
@@ -61,74 +67,21 @@ void Lusp_SyncUploadFileInfoHandler::setFileInfoPath(const std::u16string& fileP
     std::string filePathUtf8 = UniConv::GetInstance()->ToUtf8FromUtf16LE(filePathU16);
     std::filesystem::path fsPath = std::filesystem::u8path(filePathUtf8);
     m_fileInfo.sFileFullNameValue = filePathU16;
-    m_fileInfo.sOnlyFileNameValue = UniConv::GetInstance()->ToUtf16LEFromLocale(fsPath.filename().u8string());
+    m_fileInfo.sOnlyFileNameValue = UniConv::GetInstance()->ToUtf16LEFromLocale(PathUtf8Util::ToUtf8(fsPath.filename()));
     g_luspLogWriteImpl.WriteLogContent(
         LOG_DEBUG,
-        "设置文件路径: " + filePathUtf8 + " (文件名: " + fsPath.filename().u8string() + ")"
+        "设置文件路径: " + filePathUtf8 + " (文件名: " + PathUtf8Util::ToUtf8(fsPath.filename()) + ")"
     );
-    m_fileInfo.eUploadFileTyped = this->detectFileType(filePathUtf8);
+    m_fileInfo.eUploadFileTyped = this->detectFileType(filePathU16);
 }
 
 void Lusp_SyncUploadFileInfoHandler::setFileInfoPath(const std::string& filePath) {
     setFileInfoPath(UniConv::GetInstance()->ToUtf16LEFromLocale(filePath));
 }
 
-Lusp_UploadFileTyped Lusp_SyncUploadFileInfoHandler::detectFileType(const std::string& filePath) const {
-    std::filesystem::path path(filePath);
-    std::string suffix = path.extension().string(); // e.g ".jpg"
-    if (!suffix.empty() && suffix[0] == '.')
-        suffix.erase(0, 1); // remove leading dot
-    std::transform(suffix.begin(), suffix.end(), suffix.begin(), ::tolower); // 转为小写
-
-    if (!path.has_extension()) {
-        return Lusp_UploadFileTyped::LUSP_UPLOADTYPE_UNDEFINED; // 无扩展名，返回未定义类型
-    }
-
-    // 文档类型
-    if (suffix == "txt" || suffix == "doc" || suffix == "docx" ||
-        suffix == "pdf" || suffix == "rtf" || suffix == "odt") {
-        return Lusp_UploadFileTyped::LUSP_UPLOADTYPE_DOCUMENT;
-    }
-
-    // 图片类型
-    if (suffix == "jpg" || suffix == "jpeg" || suffix == "png" ||
-        suffix == "gif" || suffix == "bmp" || suffix == "svg" ||
-        suffix == "tiff" || suffix == "webp") {
-        return Lusp_UploadFileTyped::LUSP_UPLOADTYPE_IMAGE;
-    }
-
-    // 视频类型
-    if (suffix == "mp4" || suffix == "avi" || suffix == "mkv" ||
-        suffix == "mov" || suffix == "wmv" || suffix == "flv" ||
-        suffix == "webm" || suffix == "m4v") {
-        return Lusp_UploadFileTyped::LUSP_UPLOADTYPE_VIDEO;
-    }
-
-    // 音频类型
-    if (suffix == "mp3" || suffix == "wav" || suffix == "flac" ||
-        suffix == "aac" || suffix == "ogg" || suffix == "wma" ||
-        suffix == "m4a") {
-        return Lusp_UploadFileTyped::LUSP_UPLOADTYPE_AUDIO;
-    }
-
-    // 压缩包类型
-    if (suffix == "zip" || suffix == "rar" || suffix == "7z" ||
-        suffix == "tar" || suffix == "gz" || suffix == "bz2" ||
-        suffix == "xz") {
-        return Lusp_UploadFileTyped::LUSP_UPLOADTYPE_ARCHIVE;
-    }
-
-    // 代码文件类型
-    if (suffix == "cpp" || suffix == "h" || suffix == "c" ||
-        suffix == "hpp" || suffix == "js" || suffix == "py" ||
-        suffix == "java" || suffix == "cs" || suffix == "php" ||
-        suffix == "html" || suffix == "css" || suffix == "xml" ||
-        suffix == "json") {
-        return Lusp_UploadFileTyped::LUSP_UPLOADTYPE_CODE;
-    }
-
-
-    return Lusp_UploadFileTyped::LUSP_UPLOADTYPE_UNDEFINED; // 默认返回未定义类型
+Lusp_UploadFileTyped Lusp_SyncUploadFileInfoHandler::detectFileType(const std::u16string& filePath) const {
+    // 编译期完美哈希表查扩展名，无扩展名/未知扩展名返回未定义类型，由内容嗅探补充
+    return Lusp_FileTypeClassifier::classifyByExtension(std::u16string_view(filePath));
 }
 
 void Lusp_SyncUploadFileInfoHandler::updateFileInfoFromFileSystem() {
@@ -149,11 +102,88 @@ void Lusp_SyncUploadFileInfoHandler::updateFileInfoFromFileSystem() {
     }
     setFileSize(std::filesystem::file_size(path));
     // u8string() 返回 UTF-8 编码，应使用 ToUtf16LEFromUtf8 转换
-    setFileName(UniConv::GetInstance()->ToUtf16LEFromUtf8(path.filename().u8string()));
+    setFileName(UniConv::GetInstance()->ToUtf16LEFromUtf8(PathUtf8Util::ToUtf8(path.filename())));
     setRecordTime(getCurrentTimeString());
-    if (getMd5Hash().empty()) {
-        if (!calculateFileMd5ValueInfo()) {
-            g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "计算MD5值失败: " + filePathUtf8);
+    classifyFileContent(path);
+    if (getMd5Hash().empty() && !isChunkHashed()) {
+        resolveFileDigest(path, filePathUtf8);
+    }
+}
+
+void Lusp_SyncUploadFileInfoHandler::classifyFileContent(const std::filesystem::path& path) {
+    // 已知扩展名直接查表，不读取文件内容
+    if (m_fileInfo.eUploadFileTyped != Lusp_UploadFileTyped::LUSP_UPLOADTYPE_UNDEFINED) {
+        m_fileInfo.bPayloadCompressed = Lusp_FileTypeClassifier::isCompressedExtension(m_fileInfo.sFileFullNameValue);
+        return;
+    }
+    if (!ClientConfigManager::getInstance().getUploadConfig().enableContentSniff) {
+        return;
+    }
+    // 无扩展名或未知扩展名: 读取文件头 64 字节识别魔数
+    Lusp_ContentFormat format = Lusp_FileTypeClassifier::sniffFile(path);
+    if (format == Lusp_ContentFormat::Unknown) {
+        return;
+    }
+    m_fileInfo.eUploadFileTyped = Lusp_FileTypeClassifier::typeOfFormat(format);
+    m_fileInfo.bPayloadCompressed = Lusp_FileTypeClassifier::isCompressedFormat(format);
+    g_luspLogWriteImpl.WriteLogContent(
+        LOG_DEBUG,
+        "内容嗅探识别文件格式: " + PathUtf8Util::ToUtf8(path) + " -> " + Lusp_FileTypeClassifier::formatName(format)
+    );
+}
+
+void Lusp_SyncUploadFileInfoHandler::resolveFileDigest(const std::filesystem::path& path, const std::string& filePathUtf8) {
+    // 大文件按 chunk_size 分块并行哈希，小文件仍计算整文件MD5
+    const auto& uploadCfg = ClientConfigManager::getInstance().getUploadConfig();
+    const uint64_t fileSize = m_fileInfo.sSyncFileSizeValue;
+    const bool useChunkHash = uploadCfg.enableChunkHash &&
+        fileSize >= uploadCfg.chunkHashThreshold && fileSize > uploadCfg.chunkSize;
+
+    // 先查询摘要缓存，未变化的文件只需读取元数据
+    auto& digestCache = Lusp_FileDigestCache::instance();
+    Lusp_FileStatKey statKey;
+    bool hasStatKey = digestCache.isOpen() && Lusp_FileDigestCache::queryFileKey(path, statKey);
+    std::string cachedDigest;
+    std::vector<uint8_t> cachedChunkDigests;
+    if (hasStatKey && digestCache.lookup(statKey, cachedDigest, &cachedChunkDigests)) {
+        uint32_t cachedChunkSize = 0;
+        std::string cachedRoot;
+        bool isChunkDigest = Lusp_ChunkHasher::parseCacheDigest(cachedDigest, cachedChunkSize, cachedRoot);
+        // 分块摘要列表随根摘要一起缓存，接收端命中缓存的文件也能逐块校验与续传
+        const uint64_t expectedChunks = cachedChunkSize == 0 ? 0 : (fileSize + cachedChunkSize - 1) / cachedChunkSize;
+        if (useChunkHash && isChunkDigest && cachedChunkSize == uploadCfg.chunkSize &&
+            cachedChunkDigests.size() == expectedChunks * Lusp_ChunkHasher::kDigestBytes &&
+            Lusp_ChunkHasher::computeRoot(cachedChunkDigests) == cachedRoot) {
+            m_fileInfo.uChunkHashSize = cachedChunkSize;
+            m_fileInfo.vChunkDigests = std::move(cachedChunkDigests);
+            m_fileInfo.sChunkRootDigest = cachedRoot;
+            g_luspLogWriteImpl.WriteLogContent(LOG_DEBUG, "命中摘要缓存: " + filePathUtf8 + " 分块哈希根: " + cachedRoot);
+            return;
+        }
+        if (!useChunkHash && !isChunkDigest) {
+            setMd5Hash(cachedDigest);
+            g_luspLogWriteImpl.WriteLogContent(LOG_DEBUG, "命中摘要缓存: " + filePathUtf8 + " MD5: " + cachedDigest);
+            return;
+        }
+        // 缓存的摘要模式与当前配置不一致，重新计算
+    }
+
+    bool ok = useChunkHash ? calculateChunkHashTree(uploadCfg.chunkSize) : calculateFileMd5ValueInfo();
+    if (!ok) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, (useChunkHash ? "计算分块哈希失败: " : "计算MD5值失败: ") + filePathUtf8);
+        return;
+    }
+    if (hasStatKey) {
+        // 计算期间文件被修改则不写入缓存，避免旧元数据对应新内容
+        Lusp_FileStatKey afterKey;
+        if (Lusp_FileDigestCache::queryFileKey(path, afterKey) && afterKey == statKey) {
+            if (useChunkHash) {
+                digestCache.store(statKey, Lusp_ChunkHasher::toCacheDigest(m_fileInfo.uChunkHashSize, m_fileInfo.sChunkRootDigest),
+                    m_fileInfo.vChunkDigests);
+            }
+            else {
+                digestCache.store(statKey, getMd5Hash());
+            }
         }
     }
 }
@@ -180,7 +210,6 @@ Lusp_SyncUploadFileInfoHandler::Lusp_SyncUploadFileInfoHandler(const std::u16str
         return;
     }
     this->setFileInfoPath(filePath);
-    m_fileInfo.eUploadFileTyped = this->detectFileType(UniConv::GetInstance()->ToUtf8FromUtf16LE(filePath));
     updateFileInfoFromFileSystem();
     m_valid = true;
 }
@@ -200,16 +229,8 @@ void Lusp_SyncUploadFileInfoHandler::setCurrentTimestampMs() {
     m_fileInfo.uUploadTimeStamp = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
 }
 
-std::string Lusp_SyncUploadFileInfoHandler::generateUuidWindows() {
-    UUID uuid;
-    UuidCreate(&uuid);
-    RPC_CSTR str = nullptr;
-    std::string uuidStr;
-    if (UuidToStringA(&uuid, &str) == RPC_S_OK && str != nullptr) {
-        uuidStr = reinterpret_cast<const char*>(str);
-        RpcStringFreeA(&str);
-    }
-    return uuidStr;
+std::string Lusp_SyncUploadFileInfoHandler::getIdText() const {
+    return Lusp_UploadIdGenerator::toString(m_id);
 }
 
 
@@ -222,7 +243,7 @@ bool Lusp_SyncUploadFileInfoHandler::calculateFileMd5ValueInfo() {
     std::filesystem::path fsPath(m_fileInfo.sFileFullNameValue);
     std::ifstream file(fsPath, std::ios::binary);
     if (!file.is_open()) {
-        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "无法打开文件: " + fsPath.u8string());
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "无法打开文件: " + PathUtf8Util::ToUtf8(fsPath));
         return false;
     }
     std::vector<char> buffer(8192);
@@ -234,7 +255,28 @@ bool Lusp_SyncUploadFileInfoHandler::calculateFileMd5ValueInfo() {
     this->setMd5Hash(md5.getHash());
     g_luspLogWriteImpl.WriteLogContent(
         LOG_DEBUG,
-        "计算文件MD5值完成: " + fsPath.u8string() + " MD5: " + m_fileInfo.sFileMd5ValueInfo
+        "计算文件MD5值完成: " + PathUtf8Util::ToUtf8(fsPath) + " MD5: " + m_fileInfo.sFileMd5ValueInfo
+    );
+    return true;
+}
+
+
+bool Lusp_SyncUploadFileInfoHandler::calculateChunkHashTree(uint32_t chunkSize) {
+    if (m_fileInfo.sFileFullNameValue.empty()) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "文件路径为空,无法计算分块哈希");
+        return false;
+    }
+    std::filesystem::path fsPath(m_fileInfo.sFileFullNameValue);
+    Lusp_ChunkHashResult result;
+    if (!Lusp_ChunkHasher::hashFile(fsPath, m_fileInfo.sSyncFileSizeValue, chunkSize, result)) {
+        return false;
+    }
+    m_fileInfo.uChunkHashSize = result.chunkSize;
+    m_fileInfo.vChunkDigests = std::move(result.chunkDigests);
+    m_fileInfo.sChunkRootDigest = std::move(result.rootDigest);
+    g_luspLogWriteImpl.WriteLogContent(
+        LOG_DEBUG,
+        "计算文件分块哈希完成: " + PathUtf8Util::ToUtf8(fsPath) + " 根摘要: " + m_fileInfo.sChunkRootDigest
     );
     return true;
 }
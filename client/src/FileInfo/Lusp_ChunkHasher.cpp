@@ -0,0 +1,243 @@
+#include "FileInfo/Lusp_ChunkHasher.h"
+#include "log_headers.h"
+#include "md5.h"
+#include "utils/PathUtf8Util.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+    constexpr size_t        kReadBlockSize  = 256 * 1024;   // 每次读取 256KB，避免按分块大小分配缓冲区
+    constexpr const char*   kCachePrefix    = "ct";
+
+    /**
+     * @brief 进程内共享的哈希线程池
+     *
+     * 入队/遍历线程各自调用 hashFile，每个文件再各起一组线程会让核数被放大 N×M 倍，
+     * 所以辅助线程固定为 硬件并发数-1 个，所有文件的分块任务共用；调用线程自己也领取分块。
+     */
+    class HashWorkerPool {
+    public:
+        static HashWorkerPool& instance() {
+            static HashWorkerPool pool;
+            return pool;
+        }
+
+        size_t workerCount() const { return m_workers.size(); }
+
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.push_back(std::move(task));
+            }
+            m_cv.notify_one();
+        }
+
+    private:
+        HashWorkerPool() {
+            unsigned count = std::thread::hardware_concurrency();
+            count = count > 1 ? count - 1 : 1;
+            m_workers.reserve(count);
+            for (unsigned i = 0; i < count; ++i) {
+                m_workers.emplace_back([this]() { run(); });
+            }
+        }
+
+        ~HashWorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_cv.notify_all();
+            for (auto& t : m_workers) {
+                t.join();
+            }
+        }
+
+        void run() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                    if (m_tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::mutex                          m_mutex;
+        std::condition_variable             m_cv;
+        std::deque<std::function<void()>>   m_tasks;
+        std::vector<std::thread>            m_workers;
+        bool                                m_stopping = false;
+    };
+
+    // 一次 hashFile 的共享状态；池中任务可能在 hashFile 返回后才开始执行，因此不引用调用方的栈
+    struct ChunkHashJob {
+        std::filesystem::path   filePath;
+        uint64_t                fileSize = 0;
+        uint32_t                chunkSize = 0;
+        uint64_t                chunkCount = 0;
+        std::vector<uint8_t>    chunkDigests;
+        std::atomic<uint64_t>   nextChunk{ 0 };
+        std::atomic<bool>       failed{ false };
+
+        std::mutex              mutex;
+        std::condition_variable cv;
+        unsigned                activeWorkers = 0;  // 正在领取分块的执行者数
+    };
+
+    // 领取并计算分块，直到分块领完或出错
+    void runChunkWorker(ChunkHashJob& job) {
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            ++job.activeWorkers;
+        }
+
+        std::ifstream file;
+        std::vector<char> buffer;
+        while (!job.failed.load(std::memory_order_relaxed)) {
+            uint64_t index = job.nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (index >= job.chunkCount) {
+                break;
+            }
+            // 分块都被领走后才开始执行的任务不打开文件
+            if (!file.is_open()) {
+                file.open(job.filePath, std::ios::binary);
+                if (!file.is_open()) {
+                    job.failed.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                buffer.resize(kReadBlockSize);
+            }
+            uint64_t offset = index * job.chunkSize;
+            uint64_t remaining = (std::min<uint64_t>)(job.chunkSize, job.fileSize - offset);
+
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+            MD5 md5;
+            while (remaining > 0) {
+                size_t toRead = static_cast<size_t>((std::min<uint64_t>)(remaining, buffer.size()));
+                file.read(buffer.data(), toRead);
+                if (static_cast<size_t>(file.gcount()) != toRead) {
+                    job.failed.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                md5.add(buffer.data(), toRead);
+                remaining -= toRead;
+            }
+            if (remaining > 0) {
+                break;
+            }
+            md5.getHash(job.chunkDigests.data() + index * Lusp_ChunkHasher::kDigestBytes);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            --job.activeWorkers;
+        }
+        job.cv.notify_all();
+    }
+}
+
+
+bool Lusp_ChunkHasher::hashFile(const std::filesystem::path& filePath, uint64_t fileSize, uint32_t chunkSize,
+    Lusp_ChunkHashResult& result, unsigned maxThreads) {
+    if (chunkSize == 0) {
+        return false;
+    }
+
+    auto job = std::make_shared<ChunkHashJob>();
+    job->filePath = filePath;
+    job->fileSize = fileSize;
+    job->chunkSize = chunkSize;
+    job->chunkCount = fileSize == 0 ? 1 : (fileSize + chunkSize - 1) / chunkSize;
+    job->chunkDigests.assign(static_cast<size_t>(job->chunkCount) * kDigestBytes, 0);
+
+    // 调用线程 + 共享池中的辅助任务，并发度不超过 maxThreads 与池大小
+    auto& pool = HashWorkerPool::instance();
+    unsigned threadCount = maxThreads != 0 ? maxThreads : static_cast<unsigned>(pool.workerCount() + 1);
+    threadCount = static_cast<unsigned>((std::min<uint64_t>)(
+        (std::min<uint64_t>)((std::max)(threadCount, 1u), pool.workerCount() + 1), job->chunkCount));
+
+    result.chunkSize = chunkSize;
+    result.chunkDigests.clear();
+    result.rootDigest.clear();
+
+    for (unsigned i = 1; i < threadCount; ++i) {
+        pool.submit([job]() { runChunkWorker(*job); });
+    }
+    runChunkWorker(*job);
+
+    // 分块已全部领走，只需等待仍在计算的辅助任务；之后才开始的任务领不到分块，直接退出
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->cv.wait(lock, [&]() { return job->activeWorkers == 0; });
+    }
+
+    if (job->failed.load()) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "分块哈希读取文件失败: " + PathUtf8Util::ToUtf8(filePath));
+        return false;
+    }
+
+    result.chunkDigests = std::move(job->chunkDigests);
+    result.rootDigest = computeRoot(result.chunkDigests);
+    g_luspLogWriteImpl.WriteLogContent(LOG_DEBUG,
+        "分块哈希完成: " + PathUtf8Util::ToUtf8(filePath) +
+        " chunks=" + std::to_string(job->chunkCount) +
+        " threads=" + std::to_string(threadCount) +
+        " root=" + result.rootDigest);
+    return true;
+}
+
+void Lusp_ChunkHasher::hashChunk(const void* data, size_t len, uint8_t digest[kDigestBytes]) {
+    MD5 md5;
+    md5.add(data, len);
+    md5.getHash(digest);
+}
+
+bool Lusp_ChunkHasher::verifyChunk(const void* data, size_t len, const uint8_t* expectedDigest) {
+    uint8_t digest[kDigestBytes];
+    hashChunk(data, len, digest);
+    return std::memcmp(digest, expectedDigest, kDigestBytes) == 0;
+}
+
+std::string Lusp_ChunkHasher::computeRoot(const std::vector<uint8_t>& chunkDigests) {
+    MD5 md5;
+    md5.add(chunkDigests.data(), chunkDigests.size());
+    return md5.getHash();
+}
+
+std::string Lusp_ChunkHasher::toCacheDigest(uint32_t chunkSize, const std::string& rootDigest) {
+    return kCachePrefix + std::to_string(chunkSize) + ":" + rootDigest;
+}
+
+bool Lusp_ChunkHasher::parseCacheDigest(const std::string& cacheDigest, uint32_t& chunkSize, std::string& rootDigest) {
+    if (cacheDigest.compare(0, 2, kCachePrefix) != 0) {
+        return false;
+    }
+    size_t colon = cacheDigest.find(':', 2);
+    if (colon == std::string::npos || colon == 2) {
+        return false;
+    }
+    try {
+        chunkSize = static_cast<uint32_t>(std::stoul(cacheDigest.substr(2, colon - 2)));
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    rootDigest = cacheDigest.substr(colon + 1);
+    return !rootDigest.empty();
+}
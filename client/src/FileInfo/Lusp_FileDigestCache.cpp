@@ -0,0 +1,648 @@
+#include "FileInfo/Lusp_FileDigestCache.h"
+#include "log_headers.h"
+#include "UniConv.h"
+#include "utils/PathUtf8Util.h"
+#include <algorithm>
+#include <cstring>
+// 每条记录使用CRC32校验
+#include "crc32.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr uint32_t  kLogMagic           = 0x4C464443;   // "CDFL"
+    constexpr uint32_t  kLogVersion         = 2;
+    constexpr size_t    kLogHeaderSize      = 8;
+    constexpr size_t    kRecordFixedSize    = 41;           // crc + 4 * 8 + digest_len + chunk_digests_len
+    constexpr uint64_t  kCompactMinRecords  = 4096;         // 日志记录数低于该值时不压缩
+
+    // FNV-1a 64
+    uint64_t fnv1a64(const std::string& data) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // 规范化路径后计算哈希，Windows 文件系统大小写不敏感，统一转为小写
+    uint64_t hashPath(const std::filesystem::path& filePath) {
+        std::string normalized = PathUtf8Util::ToGenericUtf8(filePath.lexically_normal());
+#ifdef _WIN32
+        std::transform(normalized.begin(), normalized.end(), normalized.begin(),
+            [](unsigned char c) { return static_cast<char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c); });
+#endif
+        return fnv1a64(normalized);
+    }
+
+    // 把文件内容刷到磁盘，rename 之前调用，否则掉电后新日志可能是空的或只写了一部分
+    bool syncFile(const std::filesystem::path& filePath) {
+#ifdef _WIN32
+        HANDLE handle = CreateFileW(filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        BOOL ok = FlushFileBuffers(handle);
+        CloseHandle(handle);
+        return ok != FALSE;
+#else
+        int fd = ::open(filePath.c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        int result = ::fsync(fd);
+        ::close(fd);
+        return result == 0;
+#endif
+    }
+
+    // 用 source 替换 target，返回前确保目录项已落盘
+    bool replaceFileDurably(const std::filesystem::path& source, const std::filesystem::path& target, std::string& error) {
+#ifdef _WIN32
+        if (!MoveFileExW(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            error = "MoveFileEx error " + std::to_string(GetLastError());
+            return false;
+        }
+        return true;
+#else
+        std::error_code ec;
+        std::filesystem::rename(source, target, ec);
+        if (ec) {
+            error = ec.message();
+            return false;
+        }
+        // rename 只改了目录项，目录本身也要 fsync 才能在掉电后保留
+        std::filesystem::path dir = target.has_parent_path() ? target.parent_path() : std::filesystem::path(".");
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "open directory failed, errno " + std::to_string(errno);
+            return true;    // 替换已经完成，只是不保证掉电持久
+        }
+        if (::fsync(fd) != 0) {
+            error = "fsync directory failed, errno " + std::to_string(errno);
+        }
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    size_t roundUpPow2(size_t value) {
+        size_t result = 16;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+
+Lusp_FileDigestCache& Lusp_FileDigestCache::instance() {
+    static Lusp_FileDigestCache cache;
+    return cache;
+}
+
+Lusp_FileDigestCache::~Lusp_FileDigestCache() {
+    close();
+}
+
+bool Lusp_FileDigestCache::open(const std::filesystem::path& cacheDir, size_t maxEntries) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_opened.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    try {
+        if (!std::filesystem::exists(cacheDir)) {
+            std::filesystem::create_directories(cacheDir);
+        }
+        m_logPath = cacheDir / "file_digest.log";
+        m_tmpPath = cacheDir / "file_digest.log.tmp";
+
+        // 上次压缩未完成(rename 之前崩溃)，旧日志仍然完整，直接丢弃临时文件
+        std::error_code ec;
+        if (std::filesystem::exists(m_tmpPath, ec)) {
+            std::filesystem::remove(m_tmpPath, ec);
+            g_luspLogWriteImpl.WriteLogContent(LOG_WARN, "发现未完成的摘要缓存压缩文件，已删除: " + PathUtf8Util::ToUtf8(m_tmpPath));
+        }
+
+        m_maxEntries = (std::max)(maxEntries, static_cast<size_t>(16));
+        m_entries.clear();
+        m_entries.reserve((std::min)(m_maxEntries, static_cast<size_t>(4096)));
+        m_freeList.clear();
+        m_slots.assign(roundUpPow2(m_maxEntries * 2), kInvalidIndex);
+        m_slotMask = m_slots.size() - 1;
+        m_liveCount = 0;
+        m_tombstoneCount = 0;
+        m_lruHead = m_lruTail = kInvalidIndex;
+        m_logRecords = 0;
+        m_logBytes = 0;
+
+        replayLog();
+
+        m_logWriter.open(m_logPath, std::ios::binary | std::ios::app);
+        if (!m_logWriter.is_open()) {
+            g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "无法打开摘要缓存日志: " + PathUtf8Util::ToUtf8(m_logPath));
+            return false;
+        }
+        if (m_logBytes == 0) {
+            char header[kLogHeaderSize];
+            std::memcpy(header, &kLogMagic, sizeof(kLogMagic));
+            std::memcpy(header + 4, &kLogVersion, sizeof(kLogVersion));
+            m_logWriter.write(header, sizeof(header));
+            m_logWriter.flush();
+            m_logBytes = kLogHeaderSize;
+        }
+
+        m_opened.store(true, std::memory_order_release);
+        maybeCompactLocked();
+
+        g_luspLogWriteImpl.WriteLogContent(LOG_INFO,
+            "文件摘要缓存已打开: " + PathUtf8Util::ToUtf8(m_logPath) +
+            ", entries=" + std::to_string(m_liveCount) +
+            ", records=" + std::to_string(m_logRecords) +
+            ", max_entries=" + std::to_string(m_maxEntries));
+        return true;
+    }
+    catch (const std::exception& e) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR,
+            "打开文件摘要缓存失败: " + UniConv::GetInstance()->ToUtf8FromLocale(e.what()));
+        return false;
+    }
+}
+
+void Lusp_FileDigestCache::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_opened.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    maybeCompactLocked();
+    if (m_logWriter.is_open()) {
+        m_logWriter.flush();
+        m_logWriter.close();
+    }
+
+    g_luspLogWriteImpl.WriteLogContent(LOG_INFO,
+        "文件摘要缓存已关闭: entries=" + std::to_string(m_liveCount) +
+        ", hits=" + std::to_string(m_hits.load(std::memory_order_relaxed)) +
+        ", misses=" + std::to_string(m_misses.load(std::memory_order_relaxed)) +
+        ", evictions=" + std::to_string(m_evictions.load(std::memory_order_relaxed)));
+
+    m_entries.clear();
+    m_entries.shrink_to_fit();
+    m_freeList.clear();
+    m_slots.clear();
+    m_slots.shrink_to_fit();
+    m_liveCount = 0;
+    m_tombstoneCount = 0;
+    m_lruHead = m_lruTail = kInvalidIndex;
+    m_opened.store(false, std::memory_order_release);
+}
+
+bool Lusp_FileDigestCache::queryFileKey(const std::filesystem::path& filePath, Lusp_FileStatKey& key) {
+#ifdef _WIN32
+    // 只请求属性访问权限，不会与正在写入文件的进程冲突
+    HANDLE handle = CreateFileW(filePath.c_str(), FILE_READ_ATTRIBUTES,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    BOOL ok = GetFileInformationByHandle(handle, &info);
+    CloseHandle(handle);
+    if (!ok) {
+        return false;
+    }
+
+    // FILETIME 以 1601-01-01 为起点，单位 100ns
+    constexpr uint64_t kEpochDiff100ns = 116444736000000000ull;
+    uint64_t ticks = (static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+        info.ftLastWriteTime.dwLowDateTime;
+    uint64_t fileIndex = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+
+    key.fileSize = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+    key.mtimeNs = static_cast<int64_t>(ticks - kEpochDiff100ns) * 100;
+    key.fileId = fileIndex ^ (static_cast<uint64_t>(info.dwVolumeSerialNumber) * 0x9E3779B97F4A7C15ull);
+#else
+    struct stat st;
+    if (::stat(filePath.c_str(), &st) != 0) {
+        return false;
+    }
+#if defined(__APPLE__)
+    const struct timespec& mtime = st.st_mtimespec;
+#else
+    const struct timespec& mtime = st.st_mtim;
+#endif
+    key.fileSize = static_cast<uint64_t>(st.st_size);
+    key.mtimeNs = static_cast<int64_t>(mtime.tv_sec) * 1000000000ll + mtime.tv_nsec;
+    key.fileId = static_cast<uint64_t>(st.st_ino) ^ (static_cast<uint64_t>(st.st_dev) * 0x9E3779B97F4A7C15ull);
+#endif
+    key.pathHash = hashPath(filePath);
+    return true;
+}
+
+bool Lusp_FileDigestCache::lookup(const Lusp_FileStatKey& key, std::string& digest, std::vector<uint8_t>* chunkDigests) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t index = findEntry(key.pathHash);
+    if (index == kInvalidIndex || m_entries[index].key != key) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const Entry& entry = m_entries[index];
+    digest.assign(entry.digest, entry.digestLen);
+    if (chunkDigests) {
+        *chunkDigests = entry.chunkDigests;
+    }
+    lruUnlink(index);
+    lruPushFront(index);
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Lusp_FileDigestCache::store(const Lusp_FileStatKey& key, const std::string& digest, const std::vector<uint8_t>& chunkDigests) {
+    if (!isOpen() || digest.empty() || digest.size() > kMaxDigestLen || chunkDigests.size() > kMaxChunkDigestBytes) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // 内容未变化则只刷新 LRU 位置，避免无意义的日志写入
+    uint32_t index = findEntry(key.pathHash);
+    if (index != kInvalidIndex) {
+        const Entry& entry = m_entries[index];
+        if (entry.key == key && entry.digestLen == digest.size() &&
+            std::memcmp(entry.digest, digest.data(), digest.size()) == 0 &&
+            entry.chunkDigests == chunkDigests) {
+            lruUnlink(index);
+            lruPushFront(index);
+            return true;
+        }
+    }
+
+    putLocked(key, digest.data(), digest.size(), chunkDigests.data(), chunkDigests.size());
+    bool ok = appendRecord(key, digest.data(), digest.size(), chunkDigests);
+    maybeCompactLocked();
+    return ok;
+}
+
+bool Lusp_FileDigestCache::compact() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_opened.load(std::memory_order_acquire)) {
+        return false;
+    }
+    return compactLocked();
+}
+
+Lusp_FileDigestCache::Statistics Lusp_FileDigestCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Statistics stats;
+    stats.entries = m_liveCount;
+    stats.maxEntries = m_maxEntries;
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.logRecords = m_logRecords;
+    stats.logBytes = m_logBytes;
+    stats.compactions = m_compactions.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ===================== 哈希索引 =====================
+
+size_t Lusp_FileDigestCache::slotOf(uint64_t pathHash) const {
+    // 路径哈希再做一次混合，避免低位分布不均
+    uint64_t h = pathHash;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return static_cast<size_t>(h) & m_slotMask;
+}
+
+uint32_t Lusp_FileDigestCache::findEntry(uint64_t pathHash, size_t* slotOut) const {
+    if (m_slots.empty()) {
+        return kInvalidIndex;
+    }
+    size_t pos = slotOf(pathHash);
+    while (true) {
+        uint32_t index = m_slots[pos];
+        if (index == kInvalidIndex) {
+            return kInvalidIndex;
+        }
+        if (index != kTombstone && m_entries[index].key.pathHash == pathHash) {
+            if (slotOut) {
+                *slotOut = pos;
+            }
+            return index;
+        }
+        pos = (pos + 1) & m_slotMask;
+    }
+}
+
+void Lusp_FileDigestCache::insertSlot(uint64_t pathHash, uint32_t entryIndex) {
+    size_t pos = slotOf(pathHash);
+    while (m_slots[pos] != kInvalidIndex && m_slots[pos] != kTombstone) {
+        pos = (pos + 1) & m_slotMask;
+    }
+    if (m_slots[pos] == kTombstone) {
+        --m_tombstoneCount;
+    }
+    m_slots[pos] = entryIndex;
+}
+
+void Lusp_FileDigestCache::rehash(size_t newCapacity) {
+    std::vector<uint32_t> oldSlots;
+    oldSlots.swap(m_slots);
+    m_slots.assign(newCapacity, kInvalidIndex);
+    m_slotMask = newCapacity - 1;
+    m_tombstoneCount = 0;
+    for (uint32_t index : oldSlots) {
+        if (index != kInvalidIndex && index != kTombstone) {
+            insertSlot(m_entries[index].key.pathHash, index);
+        }
+    }
+}
+
+// ===================== LRU 链表 =====================
+
+void Lusp_FileDigestCache::lruUnlink(uint32_t entryIndex) {
+    Entry& entry = m_entries[entryIndex];
+    if (entry.prev != kInvalidIndex) {
+        m_entries[entry.prev].next = entry.next;
+    }
+    else {
+        m_lruHead = entry.next;
+    }
+    if (entry.next != kInvalidIndex) {
+        m_entries[entry.next].prev = entry.prev;
+    }
+    else {
+        m_lruTail = entry.prev;
+    }
+    entry.prev = entry.next = kInvalidIndex;
+}
+
+void Lusp_FileDigestCache::lruPushFront(uint32_t entryIndex) {
+    Entry& entry = m_entries[entryIndex];
+    entry.prev = kInvalidIndex;
+    entry.next = m_lruHead;
+    if (m_lruHead != kInvalidIndex) {
+        m_entries[m_lruHead].prev = entryIndex;
+    }
+    m_lruHead = entryIndex;
+    if (m_lruTail == kInvalidIndex) {
+        m_lruTail = entryIndex;
+    }
+}
+
+void Lusp_FileDigestCache::evictOldest() {
+    uint32_t victim = m_lruTail;
+    if (victim == kInvalidIndex) {
+        return;
+    }
+    size_t slot = 0;
+    if (findEntry(m_entries[victim].key.pathHash, &slot) == victim) {
+        m_slots[slot] = kTombstone;
+        ++m_tombstoneCount;
+    }
+    lruUnlink(victim);
+    std::vector<uint8_t>().swap(m_entries[victim].chunkDigests);
+    m_freeList.push_back(victim);
+    --m_liveCount;
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Lusp_FileDigestCache::putLocked(const Lusp_FileStatKey& key, const char* digest, size_t digestLen,
+    const uint8_t* chunkDigests, size_t chunkDigestLen) {
+    uint32_t index = findEntry(key.pathHash);
+    if (index == kInvalidIndex) {
+        if (m_liveCount >= m_maxEntries) {
+            evictOldest();
+        }
+        if (!m_freeList.empty()) {
+            index = m_freeList.back();
+            m_freeList.pop_back();
+        }
+        else {
+            index = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+        }
+        insertSlot(key.pathHash, index);
+        ++m_liveCount;
+    }
+    else {
+        lruUnlink(index);
+    }
+
+    Entry& entry = m_entries[index];
+    entry.key = key;
+    entry.digestLen = static_cast<uint8_t>(digestLen);
+    std::memcpy(entry.digest, digest, digestLen);
+    entry.chunkDigests.assign(chunkDigests, chunkDigests + chunkDigestLen);
+    lruPushFront(index);
+
+    // 墓碑过多会拉长探测链，超过 3/4 时原地重建
+    if ((m_liveCount + m_tombstoneCount) * 4 > m_slots.size() * 3) {
+        rehash(m_slots.size());
+    }
+}
+
+// ===================== 日志操作 =====================
+
+bool Lusp_FileDigestCache::replayLog() {
+    std::error_code ec;
+    if (!std::filesystem::exists(m_logPath, ec)) {
+        return true;
+    }
+
+    std::ifstream reader(m_logPath, std::ios::binary | std::ios::ate);
+    if (!reader.is_open()) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "无法读取摘要缓存日志: " + PathUtf8Util::ToUtf8(m_logPath));
+        return false;
+    }
+    std::vector<char> content(static_cast<size_t>(reader.tellg()));
+    reader.seekg(0, std::ios::beg);
+    reader.read(content.data(), content.size());
+    reader.close();
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    if (content.size() >= kLogHeaderSize) {
+        std::memcpy(&magic, content.data(), sizeof(magic));
+        std::memcpy(&version, content.data() + 4, sizeof(version));
+    }
+    if (magic != kLogMagic || version != kLogVersion) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_WARN, "摘要缓存日志头无效，重新创建: " + PathUtf8Util::ToUtf8(m_logPath));
+        std::filesystem::remove(m_logPath, ec);
+        return false;
+    }
+
+    size_t offset = kLogHeaderSize;
+    while (offset + kRecordFixedSize <= content.size()) {
+        const char* record = content.data() + offset;
+        uint8_t digestLen = static_cast<uint8_t>(record[36]);
+        uint32_t chunkDigestLen = 0;
+        std::memcpy(&chunkDigestLen, record + 37, sizeof(chunkDigestLen));
+        if (digestLen == 0 || digestLen > kMaxDigestLen || chunkDigestLen > kMaxChunkDigestBytes) {
+            break;
+        }
+        size_t recordSize = kRecordFixedSize + digestLen + chunkDigestLen;
+        if (offset + recordSize > content.size()) {
+            break;
+        }
+        uint32_t storedCrc = 0;
+        std::memcpy(&storedCrc, record, sizeof(storedCrc));
+        if (crc32Of(record + 4, recordSize - 4) != storedCrc) {
+            break;
+        }
+
+        Lusp_FileStatKey key;
+        std::memcpy(&key.pathHash, record + 4, 8);
+        std::memcpy(&key.fileSize, record + 12, 8);
+        std::memcpy(&key.mtimeNs, record + 20, 8);
+        std::memcpy(&key.fileId, record + 28, 8);
+        putLocked(key, record + kRecordFixedSize, digestLen,
+            reinterpret_cast<const uint8_t*>(record + kRecordFixedSize + digestLen), chunkDigestLen);
+
+        ++m_logRecords;
+        offset += recordSize;
+    }
+
+    // 尾部残缺(写入时崩溃)，截断到最后一条完整记录
+    if (offset != content.size()) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_WARN,
+            "摘要缓存日志尾部损坏，截断 " + std::to_string(content.size() - offset) + " 字节");
+        std::filesystem::resize_file(m_logPath, offset, ec);
+        if (ec) {
+            g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "截断摘要缓存日志失败: " + ec.message());
+        }
+    }
+    m_logBytes = offset;
+    return true;
+}
+
+bool Lusp_FileDigestCache::appendRecord(const Lusp_FileStatKey& key, const char* digest, size_t digestLen,
+    const std::vector<uint8_t>& chunkDigests) {
+    if (!m_logWriter.is_open()) {
+        return false;
+    }
+    std::vector<char> record;
+    encodeRecord(record, key, digest, digestLen, chunkDigests);
+    m_logWriter.write(record.data(), record.size());
+    m_logWriter.flush();
+    if (!m_logWriter.good()) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "写入摘要缓存日志失败: " + PathUtf8Util::ToUtf8(m_logPath));
+        m_logWriter.clear();
+        return false;
+    }
+    ++m_logRecords;
+    m_logBytes += record.size();
+    return true;
+}
+
+bool Lusp_FileDigestCache::maybeCompactLocked() {
+    if (m_logRecords < kCompactMinRecords || m_logRecords <= m_liveCount * 2) {
+        return false;
+    }
+    return compactLocked();
+}
+
+bool Lusp_FileDigestCache::compactLocked() {
+    // 从最久未使用到最近使用依次写出，回放后 LRU 顺序保持不变
+    std::ofstream tmpWriter(m_tmpPath, std::ios::binary | std::ios::trunc);
+    if (!tmpWriter.is_open()) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "无法创建摘要缓存压缩文件: " + PathUtf8Util::ToUtf8(m_tmpPath));
+        return false;
+    }
+
+    char header[kLogHeaderSize];
+    std::memcpy(header, &kLogMagic, sizeof(kLogMagic));
+    std::memcpy(header + 4, &kLogVersion, sizeof(kLogVersion));
+    tmpWriter.write(header, sizeof(header));
+
+    uint64_t records = 0;
+    uint64_t bytes = kLogHeaderSize;
+    std::vector<char> record;
+    for (uint32_t index = m_lruTail; index != kInvalidIndex; index = m_entries[index].prev) {
+        const Entry& entry = m_entries[index];
+        encodeRecord(record, entry.key, entry.digest, entry.digestLen, entry.chunkDigests);
+        tmpWriter.write(record.data(), record.size());
+        ++records;
+        bytes += record.size();
+    }
+    tmpWriter.flush();
+    bool written = tmpWriter.good();
+    tmpWriter.close();
+
+    std::error_code ec;
+    if (!written || !syncFile(m_tmpPath)) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "写入摘要缓存压缩文件失败: " + PathUtf8Util::ToUtf8(m_tmpPath));
+        std::filesystem::remove(m_tmpPath, ec);
+        return false;
+    }
+
+    // 临时文件已落盘再原子替换并刷目录: 任意时刻崩溃或掉电，磁盘上要么是旧日志，要么是完整的新日志
+    m_logWriter.close();
+    std::string error;
+    if (!replaceFileDurably(m_tmpPath, m_logPath, error)) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "替换摘要缓存日志失败: " + error);
+        std::filesystem::remove(m_tmpPath, ec);
+        m_logWriter.open(m_logPath, std::ios::binary | std::ios::app);
+        return false;
+    }
+    if (!error.empty()) {
+        g_luspLogWriteImpl.WriteLogContent(LOG_WARN, "摘要缓存日志目录刷盘失败: " + error);
+    }
+    m_logWriter.open(m_logPath, std::ios::binary | std::ios::app);
+
+    g_luspLogWriteImpl.WriteLogContent(LOG_DEBUG,
+        "摘要缓存日志压缩完成: records " + std::to_string(m_logRecords) + " -> " + std::to_string(records) +
+        ", bytes " + std::to_string(m_logBytes) + " -> " + std::to_string(bytes));
+
+    m_logRecords = records;
+    m_logBytes = bytes;
+    m_compactions.fetch_add(1, std::memory_order_relaxed);
+    return m_logWriter.is_open();
+}
+
+void Lusp_FileDigestCache::encodeRecord(std::vector<char>& out, const Lusp_FileStatKey& key, const char* digest, size_t digestLen,
+    const std::vector<uint8_t>& chunkDigests) {
+    const uint32_t chunkDigestLen = static_cast<uint32_t>(chunkDigests.size());
+    out.resize(kRecordFixedSize + digestLen + chunkDigestLen);
+    char* p = out.data();
+    std::memcpy(p + 4, &key.pathHash, 8);
+    std::memcpy(p + 12, &key.fileSize, 8);
+    std::memcpy(p + 20, &key.mtimeNs, 8);
+    std::memcpy(p + 28, &key.fileId, 8);
+    p[36] = static_cast<char>(digestLen);
+    std::memcpy(p + 37, &chunkDigestLen, sizeof(chunkDigestLen));
+    std::memcpy(p + kRecordFixedSize, digest, digestLen);
+    if (chunkDigestLen > 0) {
+        std::memcpy(p + kRecordFixedSize + digestLen, chunkDigests.data(), chunkDigestLen);
+    }
+    uint32_t crc = crc32Of(p + 4, out.size() - 4);
+    std::memcpy(p, &crc, sizeof(crc));
+}
+
+uint32_t Lusp_FileDigestCache::crc32Of(const char* data, size_t len) {
+    CRC32 crc32;
+    crc32.add(data, len);
+    unsigned char crcBytes[4];
+    crc32.getHash(crcBytes);
+    uint32_t crc = 0;
+    std::memcpy(&crc, crcBytes, sizeof(crc));
+    return crc;
+}
@@ -0,0 +1,346 @@
+#include "FileInfo/Lusp_FileTypeClassifier.h"
+#include "FileInfo/FileInfo.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace {
+    using T = Lusp_UploadFileTyped;
+
+    struct ExtensionEntry {
+        std::string_view        ext;
+        Lusp_UploadFileTyped    type;
+        bool                    compressed;     ///< 内容本身已压缩，再压缩收益很低
+    };
+
+    struct ExtensionSlot {
+        uint64_t                key = 0;        ///< 打包后的扩展名，0 表示空槽
+        Lusp_UploadFileTyped    type = T::LUSP_UPLOADTYPE_UNDEFINED;
+        bool                    compressed = false;
+    };
+
+    // 扩展名统一使用小写，最长 8 个字符
+    constexpr ExtensionEntry kExtensions[] = {
+        // 文档类型
+        { "txt",  T::LUSP_UPLOADTYPE_DOCUMENT, false }, { "doc",  T::LUSP_UPLOADTYPE_DOCUMENT, false },
+        { "docx", T::LUSP_UPLOADTYPE_DOCUMENT, true  }, { "pdf",  T::LUSP_UPLOADTYPE_DOCUMENT, false },
+        { "rtf",  T::LUSP_UPLOADTYPE_DOCUMENT, false }, { "odt",  T::LUSP_UPLOADTYPE_DOCUMENT, true  },
+        // 图片类型
+        { "jpg",  T::LUSP_UPLOADTYPE_IMAGE, true  }, { "jpeg", T::LUSP_UPLOADTYPE_IMAGE, true  },
+        { "png",  T::LUSP_UPLOADTYPE_IMAGE, true  }, { "gif",  T::LUSP_UPLOADTYPE_IMAGE, true  },
+        { "bmp",  T::LUSP_UPLOADTYPE_IMAGE, false }, { "svg",  T::LUSP_UPLOADTYPE_IMAGE, false },
+        { "tiff", T::LUSP_UPLOADTYPE_IMAGE, false }, { "webp", T::LUSP_UPLOADTYPE_IMAGE, true  },
+        // 视频类型
+        { "mp4",  T::LUSP_UPLOADTYPE_VIDEO, true  }, { "avi",  T::LUSP_UPLOADTYPE_VIDEO, true  },
+        { "mkv",  T::LUSP_UPLOADTYPE_VIDEO, true  }, { "mov",  T::LUSP_UPLOADTYPE_VIDEO, true  },
+        { "wmv",  T::LUSP_UPLOADTYPE_VIDEO, true  }, { "flv",  T::LUSP_UPLOADTYPE_VIDEO, true  },
+        { "webm", T::LUSP_UPLOADTYPE_VIDEO, true  }, { "m4v",  T::LUSP_UPLOADTYPE_VIDEO, true  },
+        // 音频类型
+        { "mp3",  T::LUSP_UPLOADTYPE_AUDIO, true  }, { "wav",  T::LUSP_UPLOADTYPE_AUDIO, false },
+        { "flac", T::LUSP_UPLOADTYPE_AUDIO, true  }, { "aac",  T::LUSP_UPLOADTYPE_AUDIO, true  },
+        { "ogg",  T::LUSP_UPLOADTYPE_AUDIO, true  }, { "wma",  T::LUSP_UPLOADTYPE_AUDIO, true  },
+        { "m4a",  T::LUSP_UPLOADTYPE_AUDIO, true  },
+        // 压缩包类型
+        { "zip",  T::LUSP_UPLOADTYPE_ARCHIVE, true  }, { "rar",  T::LUSP_UPLOADTYPE_ARCHIVE, true  },
+        { "7z",   T::LUSP_UPLOADTYPE_ARCHIVE, true  }, { "tar",  T::LUSP_UPLOADTYPE_ARCHIVE, false },
+        { "gz",   T::LUSP_UPLOADTYPE_ARCHIVE, true  }, { "bz2",  T::LUSP_UPLOADTYPE_ARCHIVE, true  },
+        { "xz",   T::LUSP_UPLOADTYPE_ARCHIVE, true  }, { "zst",  T::LUSP_UPLOADTYPE_ARCHIVE, true  },
+        { "tgz",  T::LUSP_UPLOADTYPE_ARCHIVE, true  },
+        // 代码文件类型
+        { "cpp",  T::LUSP_UPLOADTYPE_CODE, false }, { "h",    T::LUSP_UPLOADTYPE_CODE, false },
+        { "c",    T::LUSP_UPLOADTYPE_CODE, false }, { "hpp",  T::LUSP_UPLOADTYPE_CODE, false },
+        { "js",   T::LUSP_UPLOADTYPE_CODE, false }, { "py",   T::LUSP_UPLOADTYPE_CODE, false },
+        { "java", T::LUSP_UPLOADTYPE_CODE, false }, { "cs",   T::LUSP_UPLOADTYPE_CODE, false },
+        { "php",  T::LUSP_UPLOADTYPE_CODE, false }, { "html", T::LUSP_UPLOADTYPE_CODE, false },
+        { "css",  T::LUSP_UPLOADTYPE_CODE, false }, { "xml",  T::LUSP_UPLOADTYPE_CODE, false },
+        { "json", T::LUSP_UPLOADTYPE_CODE, false },
+    };
+
+    constexpr size_t    kMaxExtensionLength = 8;
+    constexpr unsigned  kTableBits          = 8;
+    constexpr size_t    kTableSize          = size_t(1) << kTableBits;
+
+    constexpr uint64_t packExtension(std::string_view ext) {
+        uint64_t key = 0;
+        for (size_t i = 0; i < ext.size(); ++i) {
+            key |= uint64_t(static_cast<unsigned char>(ext[i])) << (8 * i);
+        }
+        return key;
+    }
+
+    constexpr size_t slotOf(uint64_t key, uint64_t seed) {
+        return static_cast<size_t>(((key ^ (key >> 29)) * (seed * 2 + 1) * 0x9E3779B97F4A7C15ull) >> (64 - kTableBits));
+    }
+
+    // 编译期搜索使所有扩展名落入不同槽位的种子
+    constexpr uint64_t findSeed() {
+        for (uint64_t seed = 1; seed < 4096; ++seed) {
+            bool used[kTableSize] = {};
+            bool collision = false;
+            for (const auto& entry : kExtensions) {
+                const size_t slot = slotOf(packExtension(entry.ext), seed);
+                if (used[slot]) {
+                    collision = true;
+                    break;
+                }
+                used[slot] = true;
+            }
+            if (!collision) {
+                return seed;
+            }
+        }
+        return 0;
+    }
+
+    constexpr uint64_t kSeed = findSeed();
+    static_assert(kSeed != 0, "扩展名完美哈希种子搜索失败(是否存在重复扩展名?)");
+
+    constexpr std::array<ExtensionSlot, kTableSize> buildTable() {
+        std::array<ExtensionSlot, kTableSize> table{};
+        for (const auto& entry : kExtensions) {
+            const uint64_t key = packExtension(entry.ext);
+            auto& slot = table[slotOf(key, kSeed)];
+            slot.key = key;
+            slot.type = entry.type;
+            slot.compressed = entry.compressed;
+        }
+        return table;
+    }
+
+    constexpr std::array<ExtensionSlot, kTableSize> kTable = buildTable();
+
+    /**
+     * @brief 从路径末尾取扩展名并查表
+     *
+     * 自尾部向前最多扫描 kMaxExtensionLength + 1 个字符，遇到路径分隔符即认为无扩展名；
+     * ".bashrc" 这类隐藏文件按无扩展名处理(与 std::filesystem::path::extension 一致)。
+     */
+    template <typename CharT>
+    const ExtensionSlot* lookupExtension(std::basic_string_view<CharT> path) {
+        const size_t size = path.size();
+        const size_t limit = size < kMaxExtensionLength + 1 ? size : kMaxExtensionLength + 1;
+        uint64_t key = 0;
+        for (size_t n = 1; n <= limit; ++n) {
+            const auto ch = static_cast<std::make_unsigned_t<CharT>>(path[size - n]);
+            if (ch == '.') {
+                if (n == 1 || n == size) {
+                    return nullptr;
+                }
+                const auto prev = path[size - n - 1];
+                if (prev == CharT('/') || prev == CharT('\\')) {
+                    return nullptr;
+                }
+                const ExtensionSlot& slot = kTable[slotOf(key, kSeed)];
+                return slot.key == key ? &slot : nullptr;
+            }
+            if (ch == '/' || ch == '\\' || ch >= 0x80 || n > kMaxExtensionLength) {
+                return nullptr;
+            }
+            const uint64_t lower = (ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+            key = (key << 8) | lower;
+        }
+        return nullptr;
+    }
+
+    bool startsWith(const uint8_t* head, size_t len, size_t offset, const char* magic, size_t magicLen) {
+        return len >= offset + magicLen && std::memcmp(head + offset, magic, magicLen) == 0;
+    }
+}
+
+
+Lusp_UploadFileTyped Lusp_FileTypeClassifier::classifyByExtension(std::u16string_view path) noexcept {
+    const ExtensionSlot* slot = lookupExtension(path);
+    return slot ? slot->type : T::LUSP_UPLOADTYPE_UNDEFINED;
+}
+
+Lusp_UploadFileTyped Lusp_FileTypeClassifier::classifyByExtension(std::string_view path) noexcept {
+    const ExtensionSlot* slot = lookupExtension(path);
+    return slot ? slot->type : T::LUSP_UPLOADTYPE_UNDEFINED;
+}
+
+bool Lusp_FileTypeClassifier::isCompressedExtension(std::u16string_view path) noexcept {
+    const ExtensionSlot* slot = lookupExtension(path);
+    return slot && slot->compressed;
+}
+
+Lusp_ContentFormat Lusp_FileTypeClassifier::sniffContent(const uint8_t* head, size_t len) noexcept {
+    using F = Lusp_ContentFormat;
+    if (head == nullptr || len < 4) {
+        return F::Unknown;
+    }
+    // 按首字节分派，每个分支只做少量 memcmp
+    switch (head[0]) {
+    case 'P':
+        if (startsWith(head, len, 0, "PK\x03\x04", 4) || startsWith(head, len, 0, "PK\x05\x06", 4)) {
+            return F::Zip;
+        }
+        break;
+    case 0x1F:
+        if (head[1] == 0x8B) {
+            return F::Gzip;
+        }
+        break;
+    case 'B':
+        if (startsWith(head, len, 0, "BZh", 3)) {
+            return F::Bzip2;
+        }
+        break;
+    case 0xFD:
+        if (startsWith(head, len, 0, "\xFD" "7zXZ\x00", 6)) {
+            return F::Xz;
+        }
+        break;
+    case 0x28:
+        if (startsWith(head, len, 0, "\x28\xB5\x2F\xFD", 4)) {
+            return F::Zstd;
+        }
+        break;
+    case '7':
+        if (startsWith(head, len, 0, "7z\xBC\xAF\x27\x1C", 6)) {
+            return F::SevenZip;
+        }
+        break;
+    case 'R':
+        if (startsWith(head, len, 0, "Rar!\x1A\x07", 6)) {
+            return F::Rar;
+        }
+        if (startsWith(head, len, 0, "RIFF", 4)) {
+            if (startsWith(head, len, 8, "WEBP", 4)) return F::WebP;
+            if (startsWith(head, len, 8, "WAVE", 4)) return F::Wav;
+            if (startsWith(head, len, 8, "AVI ", 4)) return F::Avi;
+        }
+        break;
+    case 0x89:
+        if (startsWith(head, len, 0, "\x89PNG\r\n\x1A\n", 8)) {
+            return F::Png;
+        }
+        break;
+    case 0xFF:
+        if (head[1] == 0xD8 && head[2] == 0xFF) {
+            return F::Jpeg;
+        }
+        // MPEG 音频帧同步: 11 位全 1，layer 字段非保留值
+        if ((head[1] & 0xE0) == 0xE0 && (head[1] & 0x06) != 0) {
+            return F::Mp3;
+        }
+        break;
+    case 'G':
+        if (startsWith(head, len, 0, "GIF87a", 6) || startsWith(head, len, 0, "GIF89a", 6)) {
+            return F::Gif;
+        }
+        break;
+    case 0x1A:
+        if (startsWith(head, len, 0, "\x1A\x45\xDF\xA3", 4)) {
+            return F::Matroska;
+        }
+        break;
+    case 'I':
+        if (startsWith(head, len, 0, "ID3", 3)) {
+            return F::Mp3;
+        }
+        break;
+    case 'f':
+        if (startsWith(head, len, 0, "fLaC", 4)) {
+            return F::Flac;
+        }
+        break;
+    case 'O':
+        if (startsWith(head, len, 0, "OggS", 4)) {
+            return F::Ogg;
+        }
+        break;
+    case '%':
+        if (startsWith(head, len, 0, "%PDF-", 5)) {
+            return F::Pdf;
+        }
+        break;
+    default:
+        break;
+    }
+    // ISO BMFF(mp4/mov/m4a/heic): 首个 box 的类型位于偏移 4
+    if (startsWith(head, len, 4, "ftyp", 4)) {
+        return F::Mp4;
+    }
+    return F::Unknown;
+}
+
+Lusp_ContentFormat Lusp_FileTypeClassifier::sniffFile(const std::filesystem::path& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return Lusp_ContentFormat::Unknown;
+    }
+    uint8_t head[kSniffBytes];
+    file.read(reinterpret_cast<char*>(head), sizeof(head));
+    return sniffContent(head, static_cast<size_t>(file.gcount()));
+}
+
+Lusp_UploadFileTyped Lusp_FileTypeClassifier::typeOfFormat(Lusp_ContentFormat format) noexcept {
+    using F = Lusp_ContentFormat;
+    switch (format) {
+    case F::Zip:
+    case F::Gzip:
+    case F::Bzip2:
+    case F::Xz:
+    case F::Zstd:
+    case F::SevenZip:
+    case F::Rar:
+        return T::LUSP_UPLOADTYPE_ARCHIVE;
+    case F::Png:
+    case F::Jpeg:
+    case F::Gif:
+    case F::WebP:
+        return T::LUSP_UPLOADTYPE_IMAGE;
+    case F::Mp4:
+    case F::Matroska:
+    case F::Avi:
+        return T::LUSP_UPLOADTYPE_VIDEO;
+    case F::Mp3:
+    case F::Flac:
+    case F::Ogg:
+    case F::Wav:
+        return T::LUSP_UPLOADTYPE_AUDIO;
+    case F::Pdf:
+        return T::LUSP_UPLOADTYPE_DOCUMENT;
+    default:
+        return T::LUSP_UPLOADTYPE_UNDEFINED;
+    }
+}
+
+bool Lusp_FileTypeClassifier::isCompressedFormat(Lusp_ContentFormat format) noexcept {
+    using F = Lusp_ContentFormat;
+    switch (format) {
+    case F::Unknown:
+    case F::Wav:
+    case F::Pdf:        // PDF 内部流可能未压缩，交给压缩器判断
+        return false;
+    default:
+        return true;
+    }
+}
+
+const char* Lusp_FileTypeClassifier::formatName(Lusp_ContentFormat format) noexcept {
+    using F = Lusp_ContentFormat;
+    switch (format) {
+    case F::Zip:        return "zip";
+    case F::Gzip:       return "gzip";
+    case F::Bzip2:      return "bzip2";
+    case F::Xz:         return "xz";
+    case F::Zstd:       return "zstd";
+    case F::SevenZip:   return "7z";
+    case F::Rar:        return "rar";
+    case F::Png:        return "png";
+    case F::Jpeg:       return "jpeg";
+    case F::Gif:        return "gif";
+    case F::WebP:       return "webp";
+    case F::Mp4:        return "mp4";
+    case F::Matroska:   return "matroska";
+    case F::Avi:        return "avi";
+    case F::Mp3:        return "mp3";
+    case F::Flac:       return "flac";
+    case F::Ogg:        return "ogg";
+    case F::Wav:        return "wav";
+    case F::Pdf:        return "pdf";
+    default:            return "unknown";
+    }
+}
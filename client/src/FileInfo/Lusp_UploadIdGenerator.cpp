@@ -0,0 +1,102 @@
+#include "FileInfo/Lusp_UploadIdGenerator.h"
+#include <chrono>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr uint64_t kSequenceMask = (1ull << Lusp_UploadIdGenerator::kSequenceBits) - 1;
+    constexpr uint32_t kNodeMask = (1u << Lusp_UploadIdGenerator::kNodeBits) - 1;
+    constexpr uint64_t kTimestampMask = (1ull << Lusp_UploadIdGenerator::kTimestampBits) - 1;
+    constexpr unsigned kNodeShift = Lusp_UploadIdGenerator::kSequenceBits;
+    constexpr unsigned kTimestampShift = Lusp_UploadIdGenerator::kSequenceBits + Lusp_UploadIdGenerator::kNodeBits;
+
+    uint64_t elapsedMs() {
+        const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        const uint64_t unixMs = now > 0 ? static_cast<uint64_t>(now) : 0;
+        return unixMs > Lusp_UploadIdGenerator::kEpochMs ? unixMs - Lusp_UploadIdGenerator::kEpochMs : 0;
+    }
+}
+
+Lusp_UploadIdGenerator& Lusp_UploadIdGenerator::instance() {
+    static Lusp_UploadIdGenerator generator;
+    return generator;
+}
+
+Lusp_UploadIdGenerator::Lusp_UploadIdGenerator()
+    : m_nodeId(defaultNodeId()) {
+}
+
+uint64_t Lusp_UploadIdGenerator::next() {
+    const uint64_t candidate = (elapsedMs() & kTimestampMask) << kSequenceBits;
+    uint64_t current = m_state.load(std::memory_order_relaxed);
+    uint64_t state;
+    do {
+        // 时钟前进则序列号归零；同一毫秒(或时钟回拨)则在上次基础上加 1，序列号溢出时进位到时间戳
+        state = candidate > current ? candidate : current + 1;
+    } while (!m_state.compare_exchange_weak(current, state, std::memory_order_relaxed));
+
+    const uint64_t timestamp = (state >> kSequenceBits) & kTimestampMask;
+    return (timestamp << kTimestampShift) |
+        (static_cast<uint64_t>(m_nodeId.load(std::memory_order_relaxed)) << kNodeShift) |
+        (state & kSequenceMask);
+}
+
+void Lusp_UploadIdGenerator::setNodeId(uint32_t nodeId) {
+    m_nodeId.store(nodeId & kNodeMask, std::memory_order_relaxed);
+}
+
+Lusp_UploadIdParts Lusp_UploadIdGenerator::decompose(uint64_t id) {
+    Lusp_UploadIdParts parts;
+    parts.timestampMs = ((id >> kTimestampShift) & kTimestampMask) + kEpochMs;
+    parts.nodeId = static_cast<uint32_t>((id >> kNodeShift) & kNodeMask);
+    parts.sequence = static_cast<uint32_t>(id & kSequenceMask);
+    return parts;
+}
+
+void Lusp_UploadIdGenerator::format(uint64_t id, char* buffer) {
+    static const char kHex[] = "0123456789abcdef";
+    for (size_t i = kFormattedLength; i > 0; --i) {
+        buffer[i - 1] = kHex[id & 0xF];
+        id >>= 4;
+    }
+    buffer[kFormattedLength] = '\0';
+}
+
+std::string Lusp_UploadIdGenerator::toString(uint64_t id) {
+    char buffer[kFormattedLength + 1];
+    format(id, buffer);
+    return std::string(buffer, kFormattedLength);
+}
+
+uint32_t Lusp_UploadIdGenerator::defaultNodeId() {
+    // FNV-1a(计算机名) 混入进程号，同一台机器上的多个进程也尽量错开
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 1099511628211ull;
+        }
+    };
+#if defined(_WIN32)
+    char name[MAX_COMPUTERNAME_LENGTH + 1] = {};
+    DWORD size = sizeof(name);
+    if (GetComputerNameA(name, &size)) {
+        mix(name, size);
+    }
+    const uint32_t pid = static_cast<uint32_t>(_getpid());
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) == 0) {
+        mix(name, std::char_traits<char>::length(name));
+    }
+    const uint32_t pid = static_cast<uint32_t>(getpid());
+#endif
+    mix(reinterpret_cast<const char*>(&pid), sizeof(pid));
+    return static_cast<uint32_t>(hash ^ (hash >> 32)) & kNodeMask;
+}
@@ -19,6 +19,7 @@
 #include <QStatusBar>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QPointer>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -234,6 +235,11 @@ void MainWindow::addFilesToUploadQueue(const QStringList& filePaths) {
     
     for (const QString& filePath : filePaths) {
         QFileInfo fileInfo(filePath);
+        if (fileInfo.exists() && fileInfo.isDir()) {
+            // 目录交给后台并行遍历，避免阻塞UI线程
+            addDirectoryToUploadQueue(filePath);
+            continue;
+        }
         if (fileInfo.exists() && fileInfo.isFile()) {
             std::u16string u16Path = filePath.toStdU16String();
             u16FilePaths.push_back(u16Path);
@@ -259,6 +265,27 @@ void MainWindow::addFilesToUploadQueue(const QStringList& filePaths) {
     }
 }
 
+void MainWindow::addDirectoryToUploadQueue(const QString& dirPath) {
+    g_luspLogWriteImpl.WriteLogContent(LOG_INFO, "准备遍历目录: " + dirPath.toStdString());
+    m_statusLabel->setText(QString("正在扫描目录: %1").arg(dirPath));
+
+    QPointer<MainWindow> self(this);
+    Lusp_SyncUploadQueue::instance().pushDirectoryAsync(dirPath.toStdU16String(), Lusp_DirectoryWalkOptions{},
+        [self, dirPath](const Lusp_DirectoryWalkStats& stats) {
+            if (!self) {
+                return;
+            }
+            QMetaObject::invokeMethod(self, [self, dirPath, stats]() {
+                if (self) {
+                    self->m_statusLabel->setText(QString("目录 %1 已提交 %2 个文件到上传队列 (耗时 %3 ms)")
+                        .arg(dirPath)
+                        .arg(stats.files)
+                        .arg(stats.elapsedMs));
+                }
+            }, Qt::QueuedConnection);
+        });
+}
+
 void MainWindow::onClearListClicked() {
     m_fileListWidget->clearFiles();
     m_statusLabel->setText("已清空文件列表");
@@ -6,6 +6,7 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <cmath>
 
 
 
@@ -52,8 +53,8 @@ void ConnectionMonitor::set_state(ConnectionState new_state) {
             }
         }
         else if (new_state == ConnectionState::Reconnecting) {
+            // 重连标志只由 try_trigger_reconnect() 设置，这里置位会让随后的触发被当成重复而跳过
             connection_stats_.total_reconnects++;
-            is_reconnecting_flag_.store(true, std::memory_order_release);
         }
     }
 }
@@ -294,6 +295,55 @@ void ConnectionMonitor::record_heartbeat_success() {
     last_active_time_ms_.store(get_current_time_ms(), std::memory_order_release);
 }
 
+void ConnectionMonitor::record_receive() {
+    last_active_time_ms_.store(get_current_time_ms(), std::memory_order_release);
+}
+
+uint64_t ConnectionMonitor::get_idle_time_ms() const {
+    uint64_t now_ms = get_current_time_ms();
+    uint64_t last_ms = last_active_time_ms_.load(std::memory_order_acquire);
+    return now_ms > last_ms ? now_ms - last_ms : 0;
+}
+
+// ==================== 往返时延估计 (RFC 6298) ====================
+
+void ConnectionMonitor::record_rtt_sample(uint32_t rtt_ms) {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    const double sample = static_cast<double>(rtt_ms);
+
+    if (rtt_stats_.sample_count == 0) {
+        rtt_stats_.srtt_ms = sample;
+        rtt_stats_.rttvar_ms = sample / 2.0;
+        rtt_stats_.min_rtt_ms = rtt_ms;
+    }
+    else {
+        // 先用旧 SRTT 更新 RTTVAR，再更新 SRTT (alpha = 1/8, beta = 1/4)
+        rtt_stats_.rttvar_ms = 0.75 * rtt_stats_.rttvar_ms + 0.25 * std::abs(rtt_stats_.srtt_ms - sample);
+        rtt_stats_.srtt_ms = 0.875 * rtt_stats_.srtt_ms + 0.125 * sample;
+        rtt_stats_.min_rtt_ms = std::min(rtt_stats_.min_rtt_ms, rtt_ms);
+    }
+    rtt_stats_.last_rtt_ms = rtt_ms;
+    rtt_stats_.sample_count++;
+}
+
+bool ConnectionMonitor::has_rtt_sample() const {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    return rtt_stats_.sample_count > 0;
+}
+
+uint32_t ConnectionMonitor::get_rto_ms(uint32_t max_rto_ms) const {
+    double rto_ms = INITIAL_RTO_MS;
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        if (rtt_stats_.sample_count > 0) {
+            rto_ms = rtt_stats_.srtt_ms + std::max<double>(CLOCK_GRANULARITY_MS, 4.0 * rtt_stats_.rttvar_ms);
+        }
+    }
+
+    uint32_t upper = std::max(max_rto_ms, MIN_RTO_MS);
+    return std::clamp(static_cast<uint32_t>(std::ceil(rto_ms)), MIN_RTO_MS, upper);
+}
+
 // ==================== 统计信息获取 ====================
 
 ErrorStatistics ConnectionMonitor::get_error_statistics() const {
@@ -306,6 +356,11 @@ ConnectionStatistics ConnectionMonitor::get_connection_statistics() const {
     return connection_stats_;
 }
 
+RttStatistics ConnectionMonitor::get_rtt_statistics() const {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    return rtt_stats_;
+}
+
 void ConnectionMonitor::print_statistics_report() const {
     std::lock_guard<std::mutex> lock(statistics_mutex_);
 
@@ -335,6 +390,15 @@ void ConnectionMonitor::print_statistics_report() const {
         ss << "  成功率: " << std::fixed << std::setprecision(2) << success_rate << "%\n";
     }
 
+    // 往返时延
+    if (rtt_stats_.sample_count > 0) {
+        ss << "\n[往返时延]\n";
+        ss << "  样本数: " << rtt_stats_.sample_count << "\n";
+        ss << "  SRTT: " << std::fixed << std::setprecision(2) << rtt_stats_.srtt_ms << " ms\n";
+        ss << "  RTTVAR: " << std::fixed << std::setprecision(2) << rtt_stats_.rttvar_ms << " ms\n";
+        ss << "  最小/最近: " << rtt_stats_.min_rtt_ms << " / " << rtt_stats_.last_rtt_ms << " ms\n";
+    }
+
     // 错误统计
     ss << "\n[错误统计]\n";
     ss << "  总网络错误: " << error_stats_.total_network_errors << "\n";
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cstring>
+#include <thread>
 // 尾部使用CRC32校验
 #include "crc32.h"
 
@@ -100,9 +101,10 @@ bool PersistentMessageQueue::enqueue(IpcMessage&& message) {
     size_t write_idx = write_pos_.load(std::memory_order_relaxed);
     size_t read_idx = read_pos_.load(std::memory_order_acquire);
 
-    // 检查是否满(留一个空位避免读写指针重叠)
-    if (next_index(write_idx) == read_idx) {
-        // 内存队列满，尝试写入磁盘
+    // 检查是否满(留一个空位避免读写指针重叠)；磁盘上还有积压时新消息也写入磁盘，
+    // 内存中的消息总是早于磁盘上的，出队顺序与入队顺序一致
+    if (next_index(write_idx) == read_idx || has_disk_backlog()) {
+        // 内存队列满或磁盘有积压，尝试写入磁盘
         if (write_to_disk(message)) {
             total_enqueued_.fetch_add(1, std::memory_order_relaxed);
             return true;
@@ -234,6 +236,44 @@ bool PersistentMessageQueue::pop_front() {
     return true;
 }
 
+bool PersistentMessageQueue::pop_front_if(uint64_t id) {
+    const auto front = front_id();
+    if (!front.has_value() || front.value() != id) {
+        return false;
+    }
+    return pop_front();
+}
+
+std::optional<uint64_t> PersistentMessageQueue::front_id() const {
+    size_t read_idx = read_pos_.load(std::memory_order_acquire);
+    size_t write_idx = write_pos_.load(std::memory_order_acquire);
+
+    if (read_idx == write_idx) {
+        std::lock_guard<std::mutex> lock(disk_mutex_);
+        if (disk_read_pos_ >= disk_index_.size()) {
+            return std::nullopt;
+        }
+
+        // 消息ID 位于消息头开头
+        std::ifstream temp_reader(data_file_path_, std::ios::binary);
+        if (!temp_reader.is_open()) {
+            return std::nullopt;
+        }
+        uint64_t id = 0;
+        temp_reader.seekg(disk_index_[disk_read_pos_].first);
+        temp_reader.read(reinterpret_cast<char*>(&id), sizeof(id));
+        if (temp_reader.gcount() != sizeof(id)) {
+            return std::nullopt;
+        }
+        return id;
+    }
+
+    while (!memory_buffer_[read_idx].ready.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    return memory_buffer_[read_idx].message.id;
+}
+
 size_t PersistentMessageQueue::size() const {
     size_t write_idx = write_pos_.load(std::memory_order_acquire);
     size_t read_idx = read_pos_.load(std::memory_order_acquire);
@@ -426,6 +466,11 @@ bool PersistentMessageQueue::write_to_disk(const IpcMessage& message) {
     }
 }
 
+bool PersistentMessageQueue::has_disk_backlog() const {
+    std::lock_guard<std::mutex> lock(disk_mutex_);
+    return disk_read_pos_ < disk_index_.size();
+}
+
 std::optional<IpcMessage> PersistentMessageQueue::read_from_disk() {
     std::lock_guard<std::mutex> lock(disk_mutex_);
 
@@ -500,7 +545,10 @@ void PersistentMessageQueue::rebuild_disk_index_from_data() {
             }
 
             // 计算整个消息大小并添加索引
-            uint32_t total_size = HEADER_SIZE + data_size;
+            uint32_t total_size = HEADER_SIZE + (data_size & ~kRoutingKeyFlag);
+            if (data_size & kRoutingKeyFlag) {
+                total_size += sizeof(uint64_t);
+            }
             disk_index_.emplace_back(offset, total_size);
             offset += total_size;
         }
@@ -522,7 +570,8 @@ std::vector<uint8_t> PersistentMessageQueue::serialize_message(const IpcMessage&
     constexpr size_t HEADER_SIZE = sizeof(uint64_t) * 2 + sizeof(uint32_t) * 2;
 
     const uint32_t data_size = static_cast<uint32_t>(message.data.size());
-    const size_t total_size = HEADER_SIZE + data_size;
+    const uint32_t size_field = data_size | kRoutingKeyFlag;
+    const size_t total_size = HEADER_SIZE + sizeof(message.routing_key) + data_size;
 
     std::vector<uint8_t> buffer(total_size);
     size_t offset = 0;
@@ -537,8 +586,11 @@ std::vector<uint8_t> PersistentMessageQueue::serialize_message(const IpcMessage&
     std::memcpy(buffer.data() + offset, &message.priority, sizeof(message.priority));
     offset += sizeof(message.priority);
 
-    std::memcpy(buffer.data() + offset, &data_size, sizeof(data_size));
-    offset += sizeof(data_size);
+    std::memcpy(buffer.data() + offset, &size_field, sizeof(size_field));
+    offset += sizeof(size_field);
+
+    std::memcpy(buffer.data() + offset, &message.routing_key, sizeof(message.routing_key));
+    offset += sizeof(message.routing_key);
 
     // 写入数据
     if (data_size > 0) {
@@ -572,6 +624,16 @@ std::optional<IpcMessage> PersistentMessageQueue::deserialize_message(
     std::memcpy(&data_size, data.data() + offset, sizeof(data_size));
     offset += sizeof(data_size);
 
+    // 读取分流键(早期格式没有)
+    if (data_size & kRoutingKeyFlag) {
+        data_size &= ~kRoutingKeyFlag;
+        if (data.size() < offset + sizeof(message.routing_key)) {
+            return std::nullopt;
+        }
+        std::memcpy(&message.routing_key, data.data() + offset, sizeof(message.routing_key));
+        offset += sizeof(message.routing_key);
+    }
+
     // 读取数据
     if (offset + data_size != data.size()) {
         return std::nullopt; // 数据长度不匹配
@@ -13,6 +13,7 @@
 #include "SyncUploadQueue/Lusp_SyncUploadQueue.h"
 #include "Lusp_SyncUploadQueuePrivate.h"
 #include "AsioLoopbackIpcClient/Lusp_AsioLoopbackIpcClient.h"
+#include "AsioLoopbackIpcClient/Lusp_AsioLoopbackIpcChannelPool.h"
 #include "Config/ClientConfigManager.h"
 #include "asio/asio/io_context.hpp"
 #include "upload_file_info_generated.h"
@@ -27,16 +28,16 @@
 Lusp_SyncFilesNotificationService::Lusp_SyncFilesNotificationService(Lusp_SyncUploadQueue& queue, const ClientConfigManager& configMgr)
     : queueRef(queue), shouldStop(false), processedCount(0), totalLatencyUs_(0), configMgr_(&configMgr) {
 
-    // 自动管理io_context和IPC客户端
+    // 自动管理io_context和IPC通道池(maxConnections 条连接)
     ioContext_ = std::make_shared<asio::io_context>();
-    ipcClient_ = std::make_shared<Lusp_AsioLoopbackIpcClient>(*ioContext_, configMgr);
-    ipcClient_->connect();
+    ipcChannelPool_ = std::make_shared<Lusp_AsioLoopbackIpcChannelPool>(*ioContext_, configMgr);
+    ipcChannelPool_->connect();
 
-    // 自动设置socketSendFunc为FlatBuffers序列化并发送
+    // 自动设置socketSendFunc为FlatBuffers序列化并发送，按文件ID分流保证同一文件的消息顺序
     setSocketSendFunc([this](const Lusp_SyncUploadFileInfo& info) {
         std::string msg = ToFlatBuffer(info);
-        if (ipcClient_) {
-            ipcClient_->send(msg);
+        if (ipcChannelPool_) {
+            ipcChannelPool_->send(msg, info.uFileId);
         }
         });
 
@@ -52,7 +53,10 @@ Lusp_SyncFilesNotificationService::~Lusp_SyncFilesNotificationService() {
         //  停止通知线程（带超时保护）
         stop();
 
-        //  关闭 IPC 客户端（取消所有待处理的异步操作）
+        //  关闭 IPC 通道池/客户端（取消所有待处理的异步操作）
+        if (ipcChannelPool_) {
+            ipcChannelPool_->disconnect();
+        }
         if (ipcClient_) {
             ipcClient_->disconnect();
         }
@@ -169,10 +173,15 @@ std::string Lusp_SyncFilesNotificationService::dumpStatus() const {
     size_t errors = errorCount_.load(std::memory_order_relaxed);
     double errorRate = processed > 0 ? (static_cast<double>(errors) / processed * 100.0) : 0.0;
 
+    uint64_t coalesced = queueRef.d ? queueRef.d->getCoalescedCount() : 0;
+    uint64_t refreshed = queueRef.d ? queueRef.d->getRefreshedCount() : 0;
+
     return "[NotificationService] Processed: " + std::to_string(processed) +
         ", Errors: " + std::to_string(errors) +
         " (" + std::to_string(errorRate) + "%)" +
-        ", AvgLatency(ms): " + std::to_string(getAverageLatencyMs());
+        ", AvgLatency(ms): " + std::to_string(getAverageLatencyMs()) +
+        ", Coalesced: " + std::to_string(coalesced) +
+        " (Refreshed: " + std::to_string(refreshed) + ")";
 }
 
 /**
@@ -188,7 +197,7 @@ void Lusp_SyncFilesNotificationService::notificationLoop() {
             Lusp_SyncUploadFileInfo fileInfo;
 
             //  waitAndPop 被 notify_all() 唤醒后，检查返回值
-            if (queueRef.d && queueRef.d->uploadQueue.waitAndPop(fileInfo)) {
+            if (queueRef.d && queueRef.d->waitAndPop(fileInfo)) {
                 // 检查是否需要停止（被 notify_all 唤醒）
                 if (shouldStop.load(std::memory_order_relaxed)) {
                     g_LogSyncNotificationService.WriteLogContent(LOG_INFO,
@@ -287,6 +296,10 @@ void Lusp_SyncFilesNotificationService::notificationLoop() {
 
 void Lusp_SyncFilesNotificationService::setIpcClient(std::shared_ptr<Lusp_AsioLoopbackIpcClient> ipcClient) {
     ipcClient_ = ipcClient;
+    // 改用外部客户端后断开内部通道池
+    if (ipcChannelPool_) {
+        ipcChannelPool_->disconnect();
+    }
     // 设置socketSendFunc为自动序列化并发送FlatBuffers
     setSocketSendFunc([this](const Lusp_SyncUploadFileInfo& info) {
         std::string out = ToFlatBuffer(info);
@@ -307,8 +320,10 @@ std::string Lusp_SyncFilesNotificationService::ToFlatBuffer(const Lusp_SyncUploa
     auto s_only_file_name_value = builder.CreateString(UniConv::GetInstance()->ToUtf8FromUtf16LE(info.sOnlyFileNameValue));
     auto s_file_record_time_value = builder.CreateString(info.sFileRecordTimeValue);
     auto s_file_md5_value_info = builder.CreateString(info.sFileMd5ValueInfo);
-    auto s_auth_token_values = builder.CreateString(info.sAuthTokenValues);
+    auto s_auth_token_values = info.sAuthTokenValues.empty() ? 0 : builder.CreateString(info.sAuthTokenValues);
     auto s_description_info = builder.CreateString(UniConv::GetInstance()->ToUtf8FromUtf16LE(info.sDescriptionInfo));
+    auto v_chunk_digests = info.vChunkDigests.empty() ? 0 : builder.CreateVector(info.vChunkDigests);
+    auto s_chunk_root_digest = info.sChunkRootDigest.empty() ? 0 : builder.CreateString(info.sChunkRootDigest);
 
     auto fb = CreateFBS_SyncUploadFileInfo(
         builder,
@@ -324,7 +339,12 @@ std::string Lusp_SyncFilesNotificationService::ToFlatBuffer(const Lusp_SyncUploa
         info.uUploadTimeStamp,
         static_cast<FBS_SyncUploadStatusInf>(static_cast<int>(info.eUploadStatusInf)),
         s_description_info,
-        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(info.enqueueTime.time_since_epoch()).count())
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(info.enqueueTime.time_since_epoch()).count()),
+        info.uChunkHashSize,
+        v_chunk_digests,
+        s_chunk_root_digest,
+        info.bPayloadCompressed,
+        info.uFileId
     );
     builder.Finish(fb);
     return std::string(reinterpret_cast<const char*>(builder.GetBufferPointer()), builder.GetSize());
@@ -351,5 +371,12 @@ Lusp_SyncUploadFileInfo Lusp_SyncFilesNotificationService::FromFlatBuffer(const
     info.sDescriptionInfo = UniConv::GetInstance()->ToUtf16LEFromLocale(fb->s_description_info() ? fb->s_description_info()->str() : "");
     // FlatBuffers 里 enqueue_time_ms 是 uint64_t 毫秒
     info.enqueueTime = std::chrono::steady_clock::time_point(std::chrono::milliseconds(fb->enqueue_time_ms()));
+    info.uChunkHashSize = fb->u_chunk_size();
+    if (fb->v_chunk_digests()) {
+        info.vChunkDigests.assign(fb->v_chunk_digests()->begin(), fb->v_chunk_digests()->end());
+    }
+    info.sChunkRootDigest = fb->s_chunk_root_digest() ? fb->s_chunk_root_digest()->str() : "";
+    info.bPayloadCompressed = fb->b_payload_compressed();
+    info.uFileId = fb->u_file_id();
     return info;
 }
@@ -0,0 +1,412 @@
+#include "SyncUploadQueue/Lusp_CompactUploadItem.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr size_t    kInitialDirectorySlots  = 1024;
+    constexpr size_t    kUuidTextLength         = 36;   // xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+    constexpr size_t    kMd5TextLength          = 32;
+    constexpr char      kHexDigits[]            = "0123456789abcdef";
+
+    bool isSeparator(char16_t ch) {
+        return ch == u'/' || ch == u'\\';
+    }
+
+    size_t hashComponent(uint32_t parent, std::u16string_view component) {
+        uint64_t h = 14695981039346656037ull ^ parent;
+        for (char16_t ch : component) {
+            h = (h ^ ch) * 1099511628211ull;
+        }
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    int hexValue(char ch) {
+        if (ch >= '0' && ch <= '9') return ch - '0';
+        if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+        return -1;     // 大写等不可逆格式走文本存储，保证原样还原
+    }
+
+    bool parseHex(const char* text, size_t bytes, uint8_t* out) {
+        for (size_t i = 0; i < bytes; ++i) {
+            int hi = hexValue(text[2 * i]);
+            int lo = hexValue(text[2 * i + 1]);
+            if (hi < 0 || lo < 0) {
+                return false;
+            }
+            out[i] = static_cast<uint8_t>(hi << 4 | lo);
+        }
+        return true;
+    }
+
+    void appendHex(const uint8_t* data, size_t bytes, std::string& out) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out.push_back(kHexDigits[data[i] >> 4]);
+            out.push_back(kHexDigits[data[i] & 0x0F]);
+        }
+    }
+
+    bool parseMd5(const std::string& text, std::array<uint8_t, 16>& out) {
+        return text.size() == kMd5TextLength && parseHex(text.data(), 16, out.data());
+    }
+
+    bool parseUuid(const std::string& text, std::array<uint8_t, 16>& out) {
+        if (text.size() != kUuidTextLength || text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-') {
+            return false;
+        }
+        const char* p = text.data();
+        return parseHex(p, 4, out.data()) && parseHex(p + 9, 2, out.data() + 4) && parseHex(p + 14, 2, out.data() + 6) &&
+            parseHex(p + 19, 2, out.data() + 8) && parseHex(p + 24, 6, out.data() + 10);
+    }
+
+    std::string formatUuid(const std::array<uint8_t, 16>& id) {
+        std::string text;
+        text.reserve(kUuidTextLength);
+        appendHex(id.data(), 4, text);
+        text.push_back('-');
+        appendHex(id.data() + 4, 2, text);
+        text.push_back('-');
+        appendHex(id.data() + 6, 2, text);
+        text.push_back('-');
+        appendHex(id.data() + 8, 2, text);
+        text.push_back('-');
+        appendHex(id.data() + 10, 6, text);
+        return text;
+    }
+
+    /**
+     * @brief blob 写入器: varint 长度 + 原始字节
+     */
+    class BlobWriter {
+    public:
+        explicit BlobWriter(std::vector<uint8_t>& buffer) : m_buffer(buffer) { m_buffer.clear(); }
+
+        void putVarint(uint64_t value) {
+            while (value >= 0x80) {
+                m_buffer.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            m_buffer.push_back(static_cast<uint8_t>(value));
+        }
+
+        void putBytes(const void* data, size_t size) {
+            putVarint(size);
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+        }
+
+        void putString(const std::string& value) { putBytes(value.data(), value.size()); }
+
+        // 头部 = 长度 << 1 | 是否 Latin-1；Latin-1 串每字符 1 字节，否则按 UTF-16LE 2 字节
+        void putU16(std::u16string_view value) {
+            const bool latin1 = std::all_of(value.begin(), value.end(), [](char16_t ch) { return ch < 0x100; });
+            putVarint(uint64_t(value.size()) << 1 | (latin1 ? 1 : 0));
+            for (char16_t ch : value) {
+                m_buffer.push_back(static_cast<uint8_t>(ch));
+                if (!latin1) {
+                    m_buffer.push_back(static_cast<uint8_t>(ch >> 8));
+                }
+            }
+        }
+
+    private:
+        std::vector<uint8_t>& m_buffer;
+    };
+
+    class BlobReader {
+    public:
+        BlobReader(const uint8_t* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+        uint64_t getVarint() {
+            uint64_t value = 0;
+            for (unsigned shift = 0; m_pos < m_end && shift < 64; shift += 7) {
+                uint8_t byte = *m_pos++;
+                value |= uint64_t(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    break;
+                }
+            }
+            return value;
+        }
+
+        const uint8_t* getBytes(size_t& size) {
+            size = static_cast<size_t>((std::min<uint64_t>)(getVarint(), static_cast<uint64_t>(m_end - m_pos)));
+            const uint8_t* data = m_pos;
+            m_pos += size;
+            return data;
+        }
+
+        std::string getString() {
+            size_t size = 0;
+            const uint8_t* data = getBytes(size);
+            return std::string(reinterpret_cast<const char*>(data), size);
+        }
+
+        void appendU16(std::u16string& out) {
+            const uint64_t header = getVarint();
+            const bool latin1 = (header & 1) != 0;
+            const size_t width = latin1 ? 1 : 2;
+            const size_t length = static_cast<size_t>((std::min<uint64_t>)(header >> 1, static_cast<uint64_t>(m_end - m_pos) / width));
+            out.reserve(out.size() + length);
+            for (size_t i = 0; i < length; ++i, m_pos += width) {
+                out.push_back(latin1 ? char16_t(m_pos[0]) : char16_t(m_pos[0] | m_pos[1] << 8));
+            }
+        }
+
+        std::u16string getU16() {
+            std::u16string value;
+            appendU16(value);
+            return value;
+        }
+
+    private:
+        const uint8_t*  m_pos;
+        const uint8_t*  m_end;
+    };
+}
+
+
+Lusp_UploadItemInternTable::Lusp_UploadItemInternTable()
+    : m_nodes(1, DirectoryNode{ 0, 0, 0 }), m_slots(kInitialDirectorySlots, 0), m_strings(1) {
+}
+
+Lusp_UploadItemInternTable::~Lusp_UploadItemInternTable() = default;
+
+Lusp_CompactUploadItem Lusp_UploadItemInternTable::pack(const Lusp_SyncUploadFileInfo& info, std::u16string_view pendingKey) {
+    Lusp_CompactUploadItem item;
+    item.fileSize = info.sSyncFileSizeValue;
+    item.uploadTimeStamp = info.uUploadTimeStamp;
+    item.fileId = info.uFileId;
+    item.enqueueTicks = static_cast<int64_t>(info.enqueueTime.time_since_epoch().count());
+    item.chunkHashSize = info.uChunkHashSize;
+    item.fileType = static_cast<uint8_t>(info.eUploadFileTyped);
+    item.existPolicy = static_cast<uint8_t>(info.eFileExistPolicy);
+    item.uploadStatus = static_cast<uint8_t>(info.eUploadStatusInf);
+    if (info.bPayloadCompressed) {
+        item.flags |= Lusp_CompactUploadItem::kPayloadCompressed;
+    }
+    if (parseMd5(info.sFileMd5ValueInfo, item.md5)) {
+        item.flags |= Lusp_CompactUploadItem::kMd5Binary;
+    }
+    if (parseUuid(info.sAuthTokenValues, item.tokenId)) {
+        item.flags |= Lusp_CompactUploadItem::kTokenBinary;
+    }
+
+    // 全路径拆为 目录(驻留) + 末段文件名(存于 blob)
+    std::u16string_view fullPath(info.sFileFullNameValue);
+    size_t split = fullPath.size();
+    while (split > 0 && !isSeparator(fullPath[split - 1])) {
+        --split;
+    }
+    std::u16string_view baseName = fullPath.substr(split);
+    if (info.sOnlyFileNameValue != baseName) {
+        item.flags |= Lusp_CompactUploadItem::kNameDiffers;
+    }
+    if (!pendingKey.empty()) {
+        item.flags |= Lusp_CompactUploadItem::kPendingKey;
+        if (pendingKey != fullPath) {
+            item.flags |= Lusp_CompactUploadItem::kPendingKeyDiffers;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        item.directoryId = internDirectory(fullPath.substr(0, split));
+        item.deviceId = internString(info.sLanClientDevice);
+    }
+
+    thread_local std::vector<uint8_t> scratch;
+    BlobWriter writer(scratch);
+    writer.putU16(baseName);
+    if (item.flags & Lusp_CompactUploadItem::kNameDiffers) {
+        writer.putU16(info.sOnlyFileNameValue);
+    }
+    writer.putU16(info.sDescriptionInfo);
+    writer.putString(info.sFileRecordTimeValue);
+    if (!(item.flags & Lusp_CompactUploadItem::kMd5Binary)) {
+        writer.putString(info.sFileMd5ValueInfo);
+    }
+    if (!(item.flags & Lusp_CompactUploadItem::kTokenBinary)) {
+        writer.putString(info.sAuthTokenValues);
+    }
+    writer.putString(info.sChunkRootDigest);
+    writer.putBytes(info.vChunkDigests.data(), info.vChunkDigests.size());
+    if (item.flags & Lusp_CompactUploadItem::kPendingKeyDiffers) {
+        writer.putU16(pendingKey);
+    }
+
+    item.blobSize = static_cast<uint32_t>(scratch.size());
+    item.blob.reset(new uint8_t[scratch.size()]);
+    std::memcpy(item.blob.get(), scratch.data(), scratch.size());
+    return item;
+}
+
+Lusp_SyncUploadFileInfo Lusp_UploadItemInternTable::unpack(const Lusp_CompactUploadItem& item, std::u16string* pendingKey) const {
+    Lusp_SyncUploadFileInfo info{};
+    info.sSyncFileSizeValue = static_cast<size_t>(item.fileSize);
+    info.uUploadTimeStamp = item.uploadTimeStamp;
+    info.uFileId = item.fileId;
+    info.enqueueTime = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(item.enqueueTicks));
+    info.uChunkHashSize = item.chunkHashSize;
+    info.eUploadFileTyped = static_cast<Lusp_UploadFileTyped>(item.fileType);
+    info.eFileExistPolicy = static_cast<Lusp_FileExistPolicy>(item.existPolicy);
+    info.eUploadStatusInf = static_cast<Lusp_UploadStatusInf>(item.uploadStatus);
+    info.bPayloadCompressed = (item.flags & Lusp_CompactUploadItem::kPayloadCompressed) != 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        appendDirectory(item.directoryId, info.sFileFullNameValue);
+        if (item.deviceId < m_strings.size()) {
+            info.sLanClientDevice = m_strings[item.deviceId];
+        }
+    }
+
+    BlobReader reader(item.blob.get(), item.blobSize);
+    const size_t directoryLength = info.sFileFullNameValue.size();
+    reader.appendU16(info.sFileFullNameValue);
+    if (item.flags & Lusp_CompactUploadItem::kNameDiffers) {
+        info.sOnlyFileNameValue = reader.getU16();
+    }
+    else {
+        info.sOnlyFileNameValue = info.sFileFullNameValue.substr(directoryLength);
+    }
+    info.sDescriptionInfo = reader.getU16();
+    info.sFileRecordTimeValue = reader.getString();
+    if (item.flags & Lusp_CompactUploadItem::kMd5Binary) {
+        appendHex(item.md5.data(), item.md5.size(), info.sFileMd5ValueInfo);
+    }
+    else {
+        info.sFileMd5ValueInfo = reader.getString();
+    }
+    if (item.flags & Lusp_CompactUploadItem::kTokenBinary) {
+        info.sAuthTokenValues = formatUuid(item.tokenId);
+    }
+    else {
+        info.sAuthTokenValues = reader.getString();
+    }
+    info.sChunkRootDigest = reader.getString();
+    size_t digestBytes = 0;
+    const uint8_t* digests = reader.getBytes(digestBytes);
+    info.vChunkDigests.assign(digests, digests + digestBytes);
+    if (pendingKey) {
+        pendingKey->clear();
+        if (item.flags & Lusp_CompactUploadItem::kPendingKeyDiffers) {
+            *pendingKey = reader.getU16();
+        }
+        else if (item.flags & Lusp_CompactUploadItem::kPendingKey) {
+            *pendingKey = info.sFileFullNameValue;
+        }
+    }
+    return info;
+}
+
+size_t Lusp_UploadItemInternTable::approximateBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t bytes = sizeof(*this);
+    bytes += m_nodes.capacity() * sizeof(DirectoryNode);
+    bytes += m_componentChars.capacity() * sizeof(char16_t);
+    bytes += m_slots.capacity() * sizeof(uint32_t);
+    bytes += m_lastDirectory.capacity() * sizeof(char16_t);
+    for (const auto& value : m_strings) {
+        // 字符串在数组与哈希表中各存一份，外加哈希节点
+        bytes += 2 * (sizeof(std::u16string) + value.capacity() * sizeof(char16_t)) + sizeof(void*) * 2 + sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+size_t Lusp_UploadItemInternTable::directoryCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nodes.size() - 1;
+}
+
+uint32_t Lusp_UploadItemInternTable::internDirectory(std::u16string_view directory) {
+    if (directory.empty()) {
+        return 0;
+    }
+    // 遍历器按目录批量入队，连续文件大多位于同一目录
+    if (m_lastDirectoryId != 0 && directory == m_lastDirectory) {
+        return m_lastDirectoryId;
+    }
+    uint32_t id = 0;
+    size_t begin = 0;
+    for (size_t i = 0; i < directory.size(); ++i) {
+        if (isSeparator(directory[i])) {
+            id = internComponent(id, directory.substr(begin, i + 1 - begin));
+            begin = i + 1;
+        }
+    }
+    if (begin < directory.size()) {
+        id = internComponent(id, directory.substr(begin));
+    }
+    m_lastDirectory.assign(directory.data(), directory.size());
+    m_lastDirectoryId = id;
+    return id;
+}
+
+uint32_t Lusp_UploadItemInternTable::internComponent(uint32_t parent, std::u16string_view component) {
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = hashComponent(parent, component) & mask;
+    while (m_slots[slot] != 0) {
+        const DirectoryNode& node = m_nodes[m_slots[slot]];
+        if (node.parent == parent && std::u16string_view(m_componentChars).substr(node.offset, node.length) == component) {
+            return m_slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    const uint32_t id = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(DirectoryNode{ parent, static_cast<uint32_t>(m_componentChars.size()), static_cast<uint32_t>(component.size()) });
+    m_componentChars.append(component.data(), component.size());
+    m_slots[slot] = id;
+    // 负载因子保持在 1/2 以下
+    if (m_nodes.size() * 2 > m_slots.size()) {
+        growDirectorySlots();
+    }
+    return id;
+}
+
+void Lusp_UploadItemInternTable::growDirectorySlots() {
+    std::vector<uint32_t> slots(m_slots.size() * 2, 0);
+    const size_t mask = slots.size() - 1;
+    for (uint32_t id = 1; id < m_nodes.size(); ++id) {
+        const DirectoryNode& node = m_nodes[id];
+        size_t slot = hashComponent(node.parent, std::u16string_view(m_componentChars).substr(node.offset, node.length)) & mask;
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = id;
+    }
+    m_slots.swap(slots);
+}
+
+uint32_t Lusp_UploadItemInternTable::internString(const std::u16string& value) {
+    if (value.empty()) {
+        return 0;
+    }
+    auto it = m_stringIds.find(value);
+    if (it != m_stringIds.end()) {
+        return it->second;
+    }
+    const uint32_t id = static_cast<uint32_t>(m_strings.size());
+    m_strings.push_back(value);
+    m_stringIds.emplace(value, id);
+    return id;
+}
+
+void Lusp_UploadItemInternTable::appendDirectory(uint32_t id, std::u16string& out) const {
+    if (id == 0 || id >= m_nodes.size()) {
+        return;
+    }
+    // 自叶向根收集，再正序拼接
+    thread_local std::vector<uint32_t> chain;
+    chain.clear();
+    size_t length = 0;
+    for (uint32_t cur = id; cur != 0; cur = m_nodes[cur].parent) {
+        chain.push_back(cur);
+        length += m_nodes[cur].length;
+    }
+    out.reserve(out.size() + length + 32);
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        const DirectoryNode& node = m_nodes[*it];
+        out.append(m_componentChars, node.offset, node.length);
+    }
+}
@@ -0,0 +1,875 @@
+#include "SyncUploadQueue/Lusp_DirectoryWatcher.h"
+#include "Config/ClientConfigManager.h"
+#include "FileInfo/Lusp_FileDigestCache.h"
+#include "log_headers.h"
+#include "UniConv.h"
+#include "utils/PathUtf8Util.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using NativeString = std::filesystem::path::string_type;
+    using NativeChar   = NativeString::value_type;
+    using Clock        = std::chrono::steady_clock;
+    constexpr NativeChar kSeparator = std::filesystem::path::preferred_separator;
+
+    std::u16string pathToU16(const NativeString& path) {
+#ifdef _WIN32
+        return std::u16string(path.begin(), path.end());
+#else
+        return LUSP_UNICONV->ToUtf16LEFromUtf8(path);
+#endif
+    }
+
+    NativeString joinPath(const NativeString& dir, const NativeString& name) {
+        NativeString out;
+        out.reserve(dir.size() + 1 + name.size());
+        out.append(dir);
+        if (out.empty() || (out.back() != kSeparator && out.back() != '/')) {
+            out.push_back(kSeparator);
+        }
+        out.append(name);
+        return out;
+    }
+
+    /**
+     * @brief 按路径防抖
+     *
+     * 每个路径只保留最后一次事件的截止时间；最小堆按截止时间出队，
+     * 堆顶项若在期间被顺延则以新的截止时间重新入堆，已移除的路径直接丢弃。
+     */
+    class PathDebouncer {
+    public:
+        explicit PathDebouncer(std::chrono::milliseconds delay) : m_delay(delay) {}
+
+        /**
+         * @return 路径此前已在等待(本次事件被合并)时返回 true
+         */
+        bool touch(const NativeString& path, Clock::time_point now) {
+            const Clock::time_point deadline = now + m_delay;
+            auto result = m_pending.try_emplace(path, deadline);
+            if (!result.second) {
+                result.first->second = deadline;
+                return true;
+            }
+            m_heap.push(HeapEntry{ deadline, path });
+            return false;
+        }
+
+        bool remove(const NativeString& path) {
+            return m_pending.erase(path) != 0;
+        }
+
+        template <typename Emit>
+        void flushDue(Clock::time_point now, Emit&& emit) {
+            while (!m_heap.empty() && m_heap.top().deadline <= now) {
+                HeapEntry top = m_heap.top();
+                m_heap.pop();
+                auto it = m_pending.find(top.path);
+                if (it == m_pending.end()) {
+                    continue;
+                }
+                if (it->second > top.deadline) {
+                    m_heap.push(HeapEntry{ it->second, std::move(top.path) });
+                    continue;
+                }
+                m_pending.erase(it);
+                emit(top.path);
+            }
+        }
+
+        /**
+         * @brief 距最近截止时间的毫秒数，无等待项时返回 -1
+         */
+        int timeoutMs(Clock::time_point now) const {
+            if (m_heap.empty()) {
+                return -1;
+            }
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(m_heap.top().deadline - now).count() + 1;
+            return static_cast<int>(std::max<long long>(wait, 0));
+        }
+
+    private:
+        struct HeapEntry {
+            Clock::time_point   deadline;
+            NativeString        path;
+            bool operator>(const HeapEntry& other) const { return deadline > other.deadline; }
+        };
+
+        std::chrono::milliseconds                                                       m_delay;
+        std::unordered_map<NativeString, Clock::time_point>                             m_pending;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> m_heap;
+    };
+}
+
+
+struct Lusp_DirectoryWatcher::Impl {
+    Lusp_DirectoryWatchOptions                  options;
+    BatchCallback                               onBatch;
+    std::shared_ptr<const Lusp_ExcludeMatcher>  matcher;
+    PathDebouncer                               debouncer;
+    std::vector<std::u16string>                 batch;
+
+    std::thread                                 watchThread;
+    std::atomic<bool>                           running{ false };
+    std::atomic<bool>                           stopFlag{ false };
+
+    // 对账扫描在独立线程执行，不阻塞事件读取
+    std::mutex                                  scanMutex;
+    std::thread                                 scanThread;
+    std::atomic<bool>                           scanRunning{ false };
+    std::atomic<bool>                           rescanRequested{ false };
+
+    std::atomic<uint64_t>                       watchedDirectories{ 0 };
+    std::atomic<uint64_t>                       events{ 0 };
+    std::atomic<uint64_t>                       coalescedEvents{ 0 };
+    std::atomic<uint64_t>                       renamesMerged{ 0 };
+    std::atomic<uint64_t>                       filesQueued{ 0 };
+    std::atomic<uint64_t>                       overflows{ 0 };
+    std::atomic<uint64_t>                       scanFiles{ 0 };
+    std::atomic<uint64_t>                       scanUnchanged{ 0 };
+
+    Impl(const Lusp_DirectoryWatchOptions& opts, BatchCallback callback)
+        : options(opts), onBatch(std::move(callback)), debouncer(std::chrono::milliseconds(opts.debounceMs)) {
+        matcher = options.excludeMatcher;
+        if (!matcher && options.applyConfigExcludes) {
+            matcher = ClientConfigManager::getInstance().getExcludeMatcher();
+        }
+        if (options.batchSize == 0) {
+            options.batchSize = 1;
+        }
+    }
+
+    bool isExcluded(const std::string& nameUtf8, const std::string& relativeUtf8) const {
+        if (options.skipHidden && !nameUtf8.empty() && nameUtf8[0] == '.') {
+            return true;
+        }
+        if (!matcher) {
+            return false;
+        }
+        return matcher->hasPathRules() ? matcher->matchPath(relativeUtf8) : matcher->matchName(nameUtf8);
+    }
+
+    bool needRelativePath() const {
+        return matcher && matcher->hasPathRules();
+    }
+
+    void touch(const NativeString& path) {
+        if (debouncer.touch(path, Clock::now())) {
+            coalescedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void flushBatch() {
+        if (batch.empty()) {
+            return;
+        }
+        filesQueued.fetch_add(batch.size(), std::memory_order_relaxed);
+        try {
+            onBatch(batch);
+        }
+        catch (const std::exception& e) {
+            g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR,
+                "目录监控批量回调异常: " + LUSP_UNICONV->ToUtf8FromLocale(e.what()));
+        }
+        batch.clear();
+    }
+
+    void flushDue() {
+        debouncer.flushDue(Clock::now(), [this](const NativeString& path) {
+            batch.push_back(pathToU16(path));
+            if (batch.size() >= options.batchSize) {
+                flushBatch();
+            }
+        });
+        flushBatch();
+    }
+
+    /**
+     * @brief 请求对账扫描: 遍历所有根目录，只入队摘要缓存中不存在或元数据已变化的文件
+     */
+    void requestReconcile() {
+        std::lock_guard<std::mutex> lock(scanMutex);
+        if (scanRunning.load(std::memory_order_acquire)) {
+            rescanRequested.store(true, std::memory_order_release);
+            return;
+        }
+        if (scanThread.joinable()) {
+            scanThread.join();
+        }
+        scanRunning.store(true, std::memory_order_release);
+        scanThread = std::thread([this]() {
+            do {
+                rescanRequested.store(false, std::memory_order_release);
+                reconcileRoots();
+            } while (rescanRequested.load(std::memory_order_acquire) && !stopFlag.load(std::memory_order_relaxed));
+            scanRunning.store(false, std::memory_order_release);
+        });
+    }
+
+    void reconcileRoots() {
+        Lusp_DirectoryWalkOptions walkOptions;
+        walkOptions.batchSize = options.batchSize;
+        walkOptions.skipHidden = options.skipHidden;
+        walkOptions.applyConfigExcludes = false;
+        walkOptions.excludeMatcher = matcher;
+
+        auto& digestCache = Lusp_FileDigestCache::instance();
+        Lusp_ParallelDirectoryWalker walker(walkOptions, [this, &digestCache](std::vector<std::u16string>& files) {
+            scanFiles.fetch_add(files.size(), std::memory_order_relaxed);
+            if (digestCache.isOpen()) {
+                // 摘要缓存键一致说明内容自上次计算后未变化
+                auto keep = std::remove_if(files.begin(), files.end(), [&digestCache](const std::u16string& file) {
+                    Lusp_FileStatKey key;
+                    std::string digest;
+                    return Lusp_FileDigestCache::queryFileKey(std::filesystem::path(file), key) && digestCache.lookup(key, digest);
+                });
+                scanUnchanged.fetch_add(static_cast<uint64_t>(files.end() - keep), std::memory_order_relaxed);
+                files.erase(keep, files.end());
+            }
+            if (!files.empty()) {
+                onBatch(files);
+            }
+        });
+        for (const auto& root : options.roots) {
+            if (stopFlag.load(std::memory_order_relaxed)) {
+                break;
+            }
+            Lusp_DirectoryWalkStats stats = walker.walk(root, &stopFlag);
+            g_LogSyncUploadQueueInfo.WriteLogContent(LOG_INFO,
+                "目录监控对账扫描: " + LUSP_UNICONV->ToUtf8FromUtf16LE(root) +
+                " files=" + std::to_string(stats.files) +
+                " unchanged=" + std::to_string(scanUnchanged.load(std::memory_order_relaxed)) +
+                " elapsed=" + std::to_string(stats.elapsedMs) + "ms");
+        }
+    }
+
+    void joinScanThread() {
+        std::lock_guard<std::mutex> lock(scanMutex);
+        if (scanThread.joinable()) {
+            scanThread.join();
+        }
+    }
+
+#if defined(__linux__)
+    // ===================== Linux: inotify =====================
+    static constexpr uint32_t kFileMask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE;
+    static constexpr uint32_t kWatchMask = kFileMask | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+    static constexpr auto kMoveCookieTimeout = std::chrono::milliseconds(500);
+
+    /**
+     * @brief 被监控目录: 只保存父节点与名称，完整路径按需自底向上拼接
+     */
+    struct WatchNode {
+        int                                     parent = -1;    ///< 父目录 wd，-1 表示根
+        std::string                             name;           ///< 根节点为完整路径，其他为目录名
+        std::unordered_map<std::string, int>    children;       ///< 子目录名 -> wd
+    };
+
+    /**
+     * @brief 等待配对的 IN_MOVED_FROM
+     */
+    struct PendingMove {
+        int                 parent = -1;
+        std::string         name;
+        bool                isDirectory = false;
+        Clock::time_point   time;
+    };
+
+    int                                         inotifyFd = -1;
+    int                                         stopFd = -1;
+    std::unordered_map<int, WatchNode>          nodes;
+    std::unordered_map<uint32_t, PendingMove>   pendingMoves;
+    bool                                        watchLimitLogged = false;
+
+    std::string directoryPath(int wd) const {
+        thread_local std::vector<const std::string*> chain;
+        chain.clear();
+        size_t length = 0;
+        for (int cur = wd; cur != -1;) {
+            auto it = nodes.find(cur);
+            if (it == nodes.end()) {
+                break;
+            }
+            chain.push_back(&it->second.name);
+            length += it->second.name.size() + 1;
+            cur = it->second.parent;
+        }
+        std::string path;
+        path.reserve(length);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (!path.empty() && path.back() != '/') {
+                path.push_back('/');
+            }
+            path.append(**it);
+        }
+        return path;
+    }
+
+    std::string relativePath(int wd, const std::string& name) const {
+        std::string path = name;
+        for (int cur = wd; cur != -1;) {
+            auto it = nodes.find(cur);
+            if (it == nodes.end() || it->second.parent == -1) {
+                break;
+            }
+            path = it->second.name + "/" + path;
+            cur = it->second.parent;
+        }
+        return path;
+    }
+
+    void detachFromParent(int wd) {
+        auto it = nodes.find(wd);
+        if (it == nodes.end() || it->second.parent == -1) {
+            return;
+        }
+        auto parentIt = nodes.find(it->second.parent);
+        if (parentIt != nodes.end()) {
+            auto childIt = parentIt->second.children.find(it->second.name);
+            if (childIt != parentIt->second.children.end() && childIt->second == wd) {
+                parentIt->second.children.erase(childIt);
+            }
+        }
+    }
+
+    /**
+     * @brief 移除子树的所有 watch(目录被移出监控范围或删除)
+     */
+    void removeSubtree(int wd) {
+        detachFromParent(wd);
+        std::vector<int> stack{ wd };
+        while (!stack.empty()) {
+            int cur = stack.back();
+            stack.pop_back();
+            auto it = nodes.find(cur);
+            if (it == nodes.end()) {
+                continue;
+            }
+            for (const auto& child : it->second.children) {
+                stack.push_back(child.second);
+            }
+            inotify_rm_watch(inotifyFd, cur);
+            nodes.erase(it);
+        }
+        watchedDirectories.store(nodes.size(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 为目录子树注册 watch
+     * @param parent     父目录 wd(-1 表示根目录)
+     * @param name       目录名(根目录为完整路径)
+     * @param touchFiles 是否把子树中的文件加入防抖(新建/移入的目录)
+     */
+    void addWatchTree(int parent, const std::string& name, bool touchFiles) {
+        struct Item {
+            int         parent;
+            std::string name;
+            std::string path;
+            std::string relative;
+        };
+        std::vector<Item> stack;
+        const std::string startPath = parent == -1 ? name : directoryPath(parent) + "/" + name;
+        stack.push_back(Item{ parent, name, startPath, parent == -1 ? std::string() : relativePath(parent, name) });
+
+        while (!stack.empty() && !stopFlag.load(std::memory_order_relaxed)) {
+            Item item = std::move(stack.back());
+            stack.pop_back();
+
+            int wd = inotify_add_watch(inotifyFd, item.path.c_str(), kWatchMask);
+            if (wd < 0) {
+                if (errno == ENOSPC && !watchLimitLogged) {
+                    watchLimitLogged = true;
+                    g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR,
+                        "inotify watch 数量达到上限，请调大 fs.inotify.max_user_watches，未监控目录: " + item.path);
+                }
+                continue;
+            }
+            // 同一 inode 重复注册返回已有 wd(目录在树内移动)，只需更新父节点与名称
+            detachFromParent(wd);
+            WatchNode& node = nodes[wd];
+            node.parent = item.parent;
+            node.name = item.name;
+            if (item.parent != -1) {
+                nodes[item.parent].children[item.name] = wd;
+            }
+
+            DIR* dir = opendir(item.path.c_str());
+            if (!dir) {
+                continue;
+            }
+            while (dirent* entry = readdir(dir)) {
+                const char* entryName = entry->d_name;
+                if (entryName[0] == '.' && (entryName[1] == 0 || (entryName[1] == '.' && entryName[2] == 0))) {
+                    continue;
+                }
+                unsigned char type = entry->d_type;
+                std::string childPath = item.path + "/" + entryName;
+                if (type == DT_UNKNOWN) {
+                    struct stat st;
+                    if (lstat(childPath.c_str(), &st) != 0) {
+                        continue;
+                    }
+                    type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN);
+                }
+                if (type != DT_DIR && !(touchFiles && type == DT_REG)) {
+                    continue;
+                }
+                std::string relative = needRelativePath()
+                    ? (item.relative.empty() ? std::string(entryName) : item.relative + "/" + entryName)
+                    : std::string();
+                if (isExcluded(entryName, relative)) {
+                    continue;
+                }
+                if (type == DT_DIR) {
+                    stack.push_back(Item{ wd, entryName, std::move(childPath), std::move(relative) });
+                }
+                else {
+                    touch(childPath);
+                }
+            }
+            closedir(dir);
+        }
+        watchedDirectories.store(nodes.size(), std::memory_order_relaxed);
+    }
+
+    void expirePendingMoves(Clock::time_point now) {
+        for (auto it = pendingMoves.begin(); it != pendingMoves.end();) {
+            if (now - it->second.time < kMoveCookieTimeout) {
+                ++it;
+                continue;
+            }
+            // 未配对的移出: 目录已离开监控范围
+            if (it->second.isDirectory) {
+                auto parentIt = nodes.find(it->second.parent);
+                if (parentIt != nodes.end()) {
+                    auto childIt = parentIt->second.children.find(it->second.name);
+                    if (childIt != parentIt->second.children.end()) {
+                        removeSubtree(childIt->second);
+                    }
+                }
+            }
+            it = pendingMoves.erase(it);
+        }
+    }
+
+    void handleEvent(const inotify_event* ev) {
+        events.fetch_add(1, std::memory_order_relaxed);
+        if (ev->mask & IN_Q_OVERFLOW) {
+            overflows.fetch_add(1, std::memory_order_relaxed);
+            g_LogSyncUploadQueueInfo.WriteLogContent(LOG_WARN, "inotify 事件队列溢出，执行对账扫描");
+            requestReconcile();
+            return;
+        }
+        if (ev->mask & IN_IGNORED) {
+            // 目录被删除或移除 watch
+            if (nodes.count(ev->wd)) {
+                removeSubtree(ev->wd);
+            }
+            return;
+        }
+        if (ev->len == 0 || !nodes.count(ev->wd)) {
+            return;
+        }
+
+        const std::string name(ev->name);
+        const bool isDirectory = (ev->mask & IN_ISDIR) != 0;
+        if (isExcluded(name, needRelativePath() ? relativePath(ev->wd, name) : std::string())) {
+            return;
+        }
+
+        if (ev->mask & IN_MOVED_FROM) {
+            if (!isDirectory) {
+                debouncer.remove(directoryPath(ev->wd) + "/" + name);
+            }
+            pendingMoves[ev->cookie] = PendingMove{ ev->wd, name, isDirectory, Clock::now() };
+            return;
+        }
+        if (ev->mask & IN_MOVED_TO) {
+            auto moveIt = pendingMoves.find(ev->cookie);
+            if (moveIt != pendingMoves.end()) {
+                renamesMerged.fetch_add(1, std::memory_order_relaxed);
+                pendingMoves.erase(moveIt);
+            }
+            if (isDirectory) {
+                // 树内移动时 inotify_add_watch 返回原 wd，只更新节点；文件路径已变化，整棵子树重新入队
+                addWatchTree(ev->wd, name, true);
+            }
+            else {
+                touch(directoryPath(ev->wd) + "/" + name);
+            }
+            return;
+        }
+        if (isDirectory) {
+            if (ev->mask & IN_CREATE) {
+                addWatchTree(ev->wd, name, true);
+            }
+            return;
+        }
+        if (ev->mask & IN_DELETE) {
+            debouncer.remove(directoryPath(ev->wd) + "/" + name);
+            return;
+        }
+        touch(directoryPath(ev->wd) + "/" + name);
+    }
+
+    bool startPlatform() {
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotifyFd < 0 || stopFd < 0) {
+            g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR, "inotify 初始化失败: errno=" + std::to_string(errno));
+            closePlatform();
+            return false;
+        }
+        for (const auto& root : options.roots) {
+            std::string rootUtf8 = LUSP_UNICONV->ToUtf8FromUtf16LE(root);
+            while (rootUtf8.size() > 1 && rootUtf8.back() == '/') {
+                rootUtf8.pop_back();
+            }
+            addWatchTree(-1, rootUtf8, false);
+        }
+        if (nodes.empty()) {
+            g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR, "目录监控: 没有可监控的根目录");
+            closePlatform();
+            return false;
+        }
+        return true;
+    }
+
+    void runLoop() {
+        alignas(inotify_event) char buffer[64 * 1024];
+        while (!stopFlag.load(std::memory_order_relaxed)) {
+            int timeout = debouncer.timeoutMs(Clock::now());
+            if (!pendingMoves.empty() && (timeout < 0 || timeout > static_cast<int>(kMoveCookieTimeout.count()))) {
+                timeout = static_cast<int>(kMoveCookieTimeout.count());
+            }
+            pollfd fds[2] = { { inotifyFd, POLLIN, 0 }, { stopFd, POLLIN, 0 } };
+            int ready = poll(fds, 2, timeout);
+            if (ready < 0 && errno != EINTR) {
+                g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR, "inotify poll 失败: errno=" + std::to_string(errno));
+                break;
+            }
+            if (fds[1].revents & POLLIN) {
+                break;
+            }
+            if (ready > 0 && (fds[0].revents & POLLIN)) {
+                ssize_t length;
+                while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + length;) {
+                        const auto* ev = reinterpret_cast<const inotify_event*>(p);
+                        handleEvent(ev);
+                        p += sizeof(inotify_event) + ev->len;
+                    }
+                }
+            }
+            const auto now = Clock::now();
+            expirePendingMoves(now);
+            flushDue();
+        }
+    }
+
+    void wakePlatform() {
+        if (stopFd >= 0) {
+            uint64_t one = 1;
+            ssize_t ignored = write(stopFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    void closePlatform() {
+        if (inotifyFd >= 0) {
+            close(inotifyFd);
+            inotifyFd = -1;
+        }
+        if (stopFd >= 0) {
+            close(stopFd);
+            stopFd = -1;
+        }
+        nodes.clear();
+        pendingMoves.clear();
+        watchedDirectories.store(0, std::memory_order_relaxed);
+    }
+
+#elif defined(_WIN32)
+    // ===================== Windows: ReadDirectoryChangesW =====================
+    static constexpr DWORD kNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+    static constexpr DWORD kBufferBytes = 64 * 1024;
+
+    struct RootWatch {
+        NativeString        path;
+        HANDLE              directory = INVALID_HANDLE_VALUE;
+        OVERLAPPED          overlapped{};
+        std::vector<DWORD>  buffer;     // DWORD 对齐
+        NativeString        renameOldName;
+    };
+
+    std::vector<std::unique_ptr<RootWatch>>     rootWatches;
+    HANDLE                                      stopEvent = nullptr;
+
+    bool issueRead(RootWatch& watch) {
+        ResetEvent(watch.overlapped.hEvent);
+        return ReadDirectoryChangesW(watch.directory, watch.buffer.data(), kBufferBytes, TRUE, kNotifyFilter,
+            nullptr, &watch.overlapped, nullptr) != FALSE;
+    }
+
+    // 新建/移入的目录: 子树中的文件全部加入防抖(只遍历该子树)
+    void touchTree(const NativeString& dirPath, const NativeString& rootPath) {
+        std::error_code ec;
+        std::filesystem::recursive_directory_iterator it(dirPath, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            const auto& path = it->path();
+            const std::string nameUtf8 = PathUtf8Util::ToUtf8(path.filename());
+            std::string relative;
+            if (needRelativePath()) {
+                relative = PathUtf8Util::ToGenericUtf8(path.lexically_relative(rootPath));
+            }
+            if (isExcluded(nameUtf8, relative)) {
+                if (it->is_directory(ec)) {
+                    it.disable_recursion_pending();
+                }
+                continue;
+            }
+            if (it->is_regular_file(ec)) {
+                touch(path.native());
+            }
+        }
+    }
+
+    void handleNotification(RootWatch& watch, const FILE_NOTIFY_INFORMATION* info) {
+        events.fetch_add(1, std::memory_order_relaxed);
+        const NativeString relativeNative(info->FileName, info->FileNameLength / sizeof(WCHAR));
+        const NativeString fullPath = joinPath(watch.path, relativeNative);
+        const std::filesystem::path fsPath(fullPath);
+        const std::string nameUtf8 = PathUtf8Util::ToUtf8(fsPath.filename());
+        std::string relative;
+        if (needRelativePath()) {
+            relative = PathUtf8Util::ToGenericUtf8(std::filesystem::path(relativeNative));
+        }
+        if (isExcluded(nameUtf8, relative)) {
+            return;
+        }
+
+        switch (info->Action) {
+        case FILE_ACTION_REMOVED:
+            debouncer.remove(fullPath);
+            break;
+        case FILE_ACTION_RENAMED_OLD_NAME:
+            debouncer.remove(fullPath);
+            watch.renameOldName = fullPath;
+            break;
+        case FILE_ACTION_RENAMED_NEW_NAME:
+        case FILE_ACTION_ADDED:
+        case FILE_ACTION_MODIFIED: {
+            if (info->Action == FILE_ACTION_RENAMED_NEW_NAME && !watch.renameOldName.empty()) {
+                renamesMerged.fetch_add(1, std::memory_order_relaxed);
+                watch.renameOldName.clear();
+            }
+            DWORD attributes = GetFileAttributesW(fullPath.c_str());
+            if (attributes == INVALID_FILE_ATTRIBUTES) {
+                break;
+            }
+            if (attributes & FILE_ATTRIBUTE_DIRECTORY) {
+                if (info->Action != FILE_ACTION_MODIFIED) {
+                    touchTree(fullPath, watch.path);
+                }
+                break;
+            }
+            touch(fullPath);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    bool startPlatform() {
+        stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        for (const auto& root : options.roots) {
+            if (rootWatches.size() >= MAXIMUM_WAIT_OBJECTS - 1) {
+                g_LogSyncUploadQueueInfo.WriteLogContent(LOG_WARN, "目录监控: 根目录数超过上限，忽略: " + LUSP_UNICONV->ToUtf8FromUtf16LE(root));
+                continue;
+            }
+            auto watch = std::make_unique<RootWatch>();
+            watch->path.assign(root.begin(), root.end());
+            watch->directory = CreateFileW(watch->path.c_str(), FILE_LIST_DIRECTORY,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+            if (watch->directory == INVALID_HANDLE_VALUE) {
+                g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR, "目录监控: 无法打开目录: " + LUSP_UNICONV->ToUtf8FromUtf16LE(root));
+                continue;
+            }
+            watch->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            watch->buffer.resize(kBufferBytes / sizeof(DWORD));
+            if (!issueRead(*watch)) {
+                CloseHandle(watch->overlapped.hEvent);
+                CloseHandle(watch->directory);
+                continue;
+            }
+            rootWatches.push_back(std::move(watch));
+        }
+        watchedDirectories.store(rootWatches.size(), std::memory_order_relaxed);
+        if (rootWatches.empty() || !stopEvent) {
+            g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR, "目录监控: 没有可监控的根目录");
+            closePlatform();
+            return false;
+        }
+        return true;
+    }
+
+    void runLoop() {
+        std::vector<HANDLE> handles;
+        for (const auto& watch : rootWatches) {
+            handles.push_back(watch->overlapped.hEvent);
+        }
+        handles.push_back(stopEvent);
+
+        while (!stopFlag.load(std::memory_order_relaxed)) {
+            int timeout = debouncer.timeoutMs(Clock::now());
+            DWORD result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE,
+                timeout < 0 ? INFINITE : static_cast<DWORD>(timeout));
+            if (result == WAIT_OBJECT_0 + handles.size() - 1 || result == WAIT_FAILED) {
+                break;
+            }
+            if (result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + rootWatches.size()) {
+                RootWatch& watch = *rootWatches[result - WAIT_OBJECT_0];
+                DWORD bytes = 0;
+                if (GetOverlappedResult(watch.directory, &watch.overlapped, &bytes, FALSE)) {
+                    if (bytes == 0) {
+                        // 缓冲区溢出，事件已丢失
+                        overflows.fetch_add(1, std::memory_order_relaxed);
+                        g_LogSyncUploadQueueInfo.WriteLogContent(LOG_WARN, "目录监控缓冲区溢出，执行对账扫描");
+                        requestReconcile();
+                    }
+                    else {
+                        const auto* base = reinterpret_cast<const uint8_t*>(watch.buffer.data());
+                        for (DWORD offset = 0;;) {
+                            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(base + offset);
+                            handleNotification(watch, info);
+                            if (info->NextEntryOffset == 0) {
+                                break;
+                            }
+                            offset += info->NextEntryOffset;
+                        }
+                    }
+                }
+                issueRead(watch);
+            }
+            flushDue();
+        }
+    }
+
+    void wakePlatform() {
+        if (stopEvent) {
+            SetEvent(stopEvent);
+        }
+    }
+
+    void closePlatform() {
+        for (auto& watch : rootWatches) {
+            CancelIoEx(watch->directory, &watch->overlapped);
+            DWORD bytes = 0;
+            GetOverlappedResult(watch->directory, &watch->overlapped, &bytes, TRUE);
+            CloseHandle(watch->overlapped.hEvent);
+            CloseHandle(watch->directory);
+        }
+        rootWatches.clear();
+        if (stopEvent) {
+            CloseHandle(stopEvent);
+            stopEvent = nullptr;
+        }
+        watchedDirectories.store(0, std::memory_order_relaxed);
+    }
+
+#else
+    bool startPlatform() {
+        g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR, "目录监控: 当前平台不支持");
+        return false;
+    }
+    void runLoop() {}
+    void wakePlatform() {}
+    void closePlatform() {}
+#endif
+};
+
+
+Lusp_DirectoryWatcher::Lusp_DirectoryWatcher(const Lusp_DirectoryWatchOptions& options, BatchCallback onBatch)
+    : m_impl(std::make_unique<Impl>(options, std::move(onBatch))) {
+}
+
+Lusp_DirectoryWatcher::~Lusp_DirectoryWatcher() {
+    stop();
+}
+
+bool Lusp_DirectoryWatcher::start() {
+    if (m_impl->running.load(std::memory_order_acquire)) {
+        return true;
+    }
+    m_impl->stopFlag.store(false, std::memory_order_relaxed);
+    // 先注册监控再对账扫描，扫描期间的变化不会丢失(重复入队由队列合并)
+    if (!m_impl->startPlatform()) {
+        return false;
+    }
+    m_impl->running.store(true, std::memory_order_release);
+    g_LogSyncUploadQueueInfo.WriteLogContent(LOG_INFO,
+        "目录监控已启动: roots=" + std::to_string(m_impl->options.roots.size()) +
+        " watched_dirs=" + std::to_string(m_impl->watchedDirectories.load(std::memory_order_relaxed)) +
+        " debounce=" + std::to_string(m_impl->options.debounceMs) + "ms");
+
+    if (m_impl->options.initialScan) {
+        m_impl->requestReconcile();
+    }
+    m_impl->watchThread = std::thread([impl = m_impl.get()]() {
+        impl->runLoop();
+    });
+    return true;
+}
+
+void Lusp_DirectoryWatcher::stop() {
+    if (!m_impl->running.exchange(false)) {
+        return;
+    }
+    m_impl->stopFlag.store(true, std::memory_order_relaxed);
+    m_impl->wakePlatform();
+    if (m_impl->watchThread.joinable()) {
+        m_impl->watchThread.join();
+    }
+    m_impl->joinScanThread();
+    m_impl->closePlatform();
+    g_LogSyncUploadQueueInfo.WriteLogContent(LOG_INFO, "目录监控已停止");
+}
+
+bool Lusp_DirectoryWatcher::isRunning() const {
+    return m_impl->running.load(std::memory_order_acquire);
+}
+
+Lusp_DirectoryWatchStats Lusp_DirectoryWatcher::getStatistics() const {
+    Lusp_DirectoryWatchStats stats;
+    stats.watchedDirectories = m_impl->watchedDirectories.load(std::memory_order_relaxed);
+    stats.events = m_impl->events.load(std::memory_order_relaxed);
+    stats.coalescedEvents = m_impl->coalescedEvents.load(std::memory_order_relaxed);
+    stats.renamesMerged = m_impl->renamesMerged.load(std::memory_order_relaxed);
+    stats.filesQueued = m_impl->filesQueued.load(std::memory_order_relaxed);
+    stats.overflows = m_impl->overflows.load(std::memory_order_relaxed);
+    stats.scanFiles = m_impl->scanFiles.load(std::memory_order_relaxed);
+    stats.scanUnchanged = m_impl->scanUnchanged.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,401 @@
+#include "SyncUploadQueue/Lusp_ParallelDirectoryWalker.h"
+#include "log_headers.h"
+#include "UniConv.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+    using NativeString = std::filesystem::path::string_type;
+    using NativeChar   = NativeString::value_type;
+    constexpr NativeChar kSeparator = std::filesystem::path::preferred_separator;
+
+    enum class EntryKind { File, Directory, Other };
+
+    // 待遍历目录
+    struct DirectoryItem {
+        NativeString    path;
+        int             depth = 0;
+        std::string     relativeUtf8;   // 相对根目录的路径，仅存在路径排除规则时维护
+    };
+
+    // 每个遍历线程的目录队列: 所有者操作尾部，窃取者操作头部
+    struct WorkerQueue {
+        std::mutex                  mutex;
+        std::deque<DirectoryItem>   items;
+    };
+
+    bool isDotOrDotDot(const NativeChar* name) {
+        return name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0));
+    }
+
+    std::string nameToUtf8(const NativeChar* name) {
+#ifdef _WIN32
+        int len = WideCharToMultiByte(CP_UTF8, 0, name, -1, nullptr, 0, nullptr, nullptr);
+        if (len <= 1) {
+            return std::string();
+        }
+        std::string out(static_cast<size_t>(len - 1), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, name, -1, out.data(), len, nullptr, nullptr);
+        return out;
+#else
+        return std::string(name);
+#endif
+    }
+
+    std::u16string pathToU16(const NativeString& path) {
+#ifdef _WIN32
+        return std::u16string(path.begin(), path.end());
+#else
+        return LUSP_UNICONV->ToUtf16LEFromUtf8(path);
+#endif
+    }
+
+    NativeString joinPath(const NativeString& dir, const NativeChar* name) {
+        NativeString out;
+        out.reserve(dir.size() + 1 + std::char_traits<NativeChar>::length(name));
+        out.append(dir);
+        if (out.empty() || (out.back() != kSeparator && out.back() != '/')) {
+            out.push_back(kSeparator);
+        }
+        out.append(name);
+        return out;
+    }
+
+    /**
+     * @brief 枚举单个目录
+     * @param visit 回调 visit(name, kind, hidden)
+     * @return 目录是否成功打开
+     */
+    template <typename Visitor>
+    bool enumerateDirectory(const NativeString& dir, bool isRoot, bool followSymlinks, Visitor&& visit) {
+#if defined(_WIN32)
+        (void)isRoot;
+        NativeString pattern = joinPath(dir, L"*");
+        WIN32_FIND_DATAW data;
+        HANDLE handle = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data,
+            FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+        if (handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        do {
+            const wchar_t* name = data.cFileName;
+            if (isDotOrDotDot(name)) {
+                continue;
+            }
+            DWORD attrs = data.dwFileAttributes;
+            bool isReparse = (attrs & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+            EntryKind kind = EntryKind::Other;
+            if (attrs & FILE_ATTRIBUTE_DIRECTORY) {
+                if (!isReparse) {
+                    kind = EntryKind::Directory;
+                }
+            }
+            else if (!isReparse || followSymlinks) {
+                kind = EntryKind::File;
+            }
+            visit(name, kind, (attrs & FILE_ATTRIBUTE_HIDDEN) != 0);
+        } while (FindNextFileW(handle, &data));
+        FindClose(handle);
+        return true;
+#elif defined(__linux__)
+        // glibc 2.30 之前没有 getdents64 包装，直接走系统调用
+        struct LinuxDirent64 {
+            uint64_t        d_ino;
+            int64_t         d_off;
+            unsigned short  d_reclen;
+            unsigned char   d_type;
+            char            d_name[1];
+        };
+
+        // 根目录允许是符号链接；子目录加 O_NOFOLLOW 防止枚举与打开之间被替换成链接
+        int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (isRoot ? 0 : O_NOFOLLOW);
+        int fd = ::openat(AT_FDCWD, dir.c_str(), flags);
+        if (fd < 0) {
+            return false;
+        }
+        alignas(8) char buffer[64 * 1024];
+        bool ok = true;
+        while (true) {
+            long n = ::syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                ok = n == 0;
+                break;
+            }
+            for (long offset = 0; offset < n;) {
+                const auto* entry = reinterpret_cast<const LinuxDirent64*>(buffer + offset);
+                offset += entry->d_reclen;
+                const char* name = entry->d_name;
+                if (isDotOrDotDot(name)) {
+                    continue;
+                }
+                EntryKind kind = EntryKind::Other;
+                unsigned char type = entry->d_type;
+                if (type == DT_REG) {
+                    kind = EntryKind::File;
+                }
+                else if (type == DT_DIR) {
+                    kind = EntryKind::Directory;
+                }
+                else if (type == DT_UNKNOWN || (type == DT_LNK && followSymlinks)) {
+                    // 部分文件系统不填 d_type，需要补一次 stat
+                    struct stat st;
+                    if (::fstatat(fd, name, &st, type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW) == 0) {
+                        if (S_ISREG(st.st_mode)) {
+                            kind = EntryKind::File;
+                        }
+                        else if (S_ISDIR(st.st_mode) && type != DT_LNK) {
+                            kind = EntryKind::Directory;
+                        }
+                    }
+                }
+                visit(name, kind, name[0] == '.');
+            }
+        }
+        ::close(fd);
+        return ok;
+#else
+        (void)isRoot;
+        DIR* handle = ::opendir(dir.c_str());
+        if (!handle) {
+            return false;
+        }
+        while (struct dirent* entry = ::readdir(handle)) {
+            const char* name = entry->d_name;
+            if (isDotOrDotDot(name)) {
+                continue;
+            }
+            EntryKind kind = EntryKind::Other;
+            unsigned char type = entry->d_type;
+            if (type == DT_REG) {
+                kind = EntryKind::File;
+            }
+            else if (type == DT_DIR) {
+                kind = EntryKind::Directory;
+            }
+            else if (type == DT_UNKNOWN || (type == DT_LNK && followSymlinks)) {
+                struct stat st;
+                if (::fstatat(::dirfd(handle), name, &st, type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW) == 0) {
+                    if (S_ISREG(st.st_mode)) {
+                        kind = EntryKind::File;
+                    }
+                    else if (S_ISDIR(st.st_mode) && type != DT_LNK) {
+                        kind = EntryKind::Directory;
+                    }
+                }
+            }
+            visit(name, kind, name[0] == '.');
+        }
+        ::closedir(handle);
+        return true;
+#endif
+    }
+}
+
+
+Lusp_ParallelDirectoryWalker::Lusp_ParallelDirectoryWalker(const Lusp_DirectoryWalkOptions& options, BatchCallback onBatch)
+    : m_options(options)
+    , m_onBatch(std::move(onBatch)) {
+    if (m_options.batchSize == 0) {
+        m_options.batchSize = 1;
+    }
+    if (!m_options.excludePatterns.empty()) {
+        m_extraMatcher = Lusp_ExcludeMatcher::compile(m_options.excludePatterns);
+    }
+    if (m_options.excludeMatcher && m_options.excludeMatcher->empty()) {
+        m_options.excludeMatcher.reset();
+    }
+    m_needRelativePath = (m_extraMatcher && m_extraMatcher->hasPathRules()) ||
+        (m_options.excludeMatcher && m_options.excludeMatcher->hasPathRules());
+}
+
+bool Lusp_ParallelDirectoryWalker::isExcluded(const std::string& nameUtf8, const std::string& relativePathUtf8) const {
+    for (const auto* matcher : { m_options.excludeMatcher.get(), m_extraMatcher.get() }) {
+        if (!matcher) {
+            continue;
+        }
+        if (matcher->hasPathRules() ? matcher->matchPath(relativePathUtf8) : matcher->matchName(nameUtf8)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Lusp_DirectoryWalkStats Lusp_ParallelDirectoryWalker::walk(const std::u16string& rootDir, const std::atomic<bool>* cancelFlag) {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    NativeString rootNative = std::filesystem::path(rootDir).native();
+    while (rootNative.size() > 1 && (rootNative.back() == kSeparator || rootNative.back() == '/')) {
+        rootNative.pop_back();
+    }
+
+    unsigned threadCount = m_options.threadCount != 0 ? m_options.threadCount : std::thread::hardware_concurrency();
+    threadCount = (std::max)(threadCount, 1u);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    queues.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    queues[0]->items.push_back({ rootNative, 0, std::string() });
+
+    // 已入队但尚未处理完的目录数，归零即遍历结束
+    std::atomic<int64_t> pendingDirs{ 1 };
+    std::mutex statsMutex;
+    Lusp_DirectoryWalkStats total;
+    const bool hasExcludes = m_extraMatcher || m_options.excludeMatcher;
+
+    auto isCancelled = [cancelFlag]() {
+        return cancelFlag != nullptr && cancelFlag->load(std::memory_order_relaxed);
+    };
+
+    auto worker = [&](unsigned self) {
+        Lusp_DirectoryWalkStats local;
+        std::vector<std::u16string> batch;
+        batch.reserve(m_options.batchSize);
+        std::vector<DirectoryItem> subDirs;
+
+        auto flushBatch = [&]() {
+            if (batch.empty()) {
+                return;
+            }
+            local.files += batch.size();
+            ++local.batches;
+            try {
+                m_onBatch(batch);
+            }
+            catch (const std::exception& e) {
+                g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR,
+                    "目录遍历批量回调异常: " + LUSP_UNICONV->ToUtf8FromLocale(e.what()));
+            }
+            batch.clear();
+        };
+
+        unsigned idleRounds = 0;
+        while (!isCancelled()) {
+            DirectoryItem item;
+            bool acquired = false;
+            {
+                std::lock_guard<std::mutex> lock(queues[self]->mutex);
+                auto& items = queues[self]->items;
+                if (!items.empty()) {
+                    item = std::move(items.back());
+                    items.pop_back();
+                    acquired = true;
+                }
+            }
+            for (unsigned k = 1; !acquired && k < threadCount; ++k) {
+                WorkerQueue& victim = *queues[(self + k) % threadCount];
+                std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+                if (lock.owns_lock() && !victim.items.empty()) {
+                    item = std::move(victim.items.front());
+                    victim.items.pop_front();
+                    acquired = true;
+                }
+            }
+
+            if (!acquired) {
+                if (pendingDirs.load(std::memory_order_acquire) == 0) {
+                    break;
+                }
+                // 其他线程仍在处理目录，可能很快产生新任务
+                if (++idleRounds < 64) {
+                    std::this_thread::yield();
+                }
+                else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+                continue;
+            }
+            idleRounds = 0;
+
+            const bool canDescend = m_options.maxDepth < 0 || item.depth < m_options.maxDepth;
+            bool opened = enumerateDirectory(item.path, item.depth == 0, m_options.followSymlinks,
+                [&](const NativeChar* name, EntryKind kind, bool hidden) {
+                    if (kind == EntryKind::Other) {
+                        return;
+                    }
+                    if (m_options.skipHidden && hidden) {
+                        ++local.excluded;
+                        return;
+                    }
+                    std::string relativeUtf8;
+                    if (hasExcludes) {
+                        std::string nameUtf8 = nameToUtf8(name);
+                        if (m_needRelativePath) {
+                            relativeUtf8 = item.relativeUtf8.empty() ? nameUtf8 : item.relativeUtf8 + '/' + nameUtf8;
+                        }
+                        if (isExcluded(nameUtf8, relativeUtf8)) {
+                            ++local.excluded;
+                            return;
+                        }
+                    }
+                    if (kind == EntryKind::Directory) {
+                        if (canDescend) {
+                            subDirs.push_back({ joinPath(item.path, name), item.depth + 1, std::move(relativeUtf8) });
+                        }
+                        return;
+                    }
+                    batch.push_back(pathToU16(joinPath(item.path, name)));
+                    if (batch.size() >= m_options.batchSize) {
+                        flushBatch();
+                    }
+                });
+
+            if (opened) {
+                ++local.directories;
+            }
+            else {
+                ++local.errors;
+            }
+
+            if (!subDirs.empty()) {
+                pendingDirs.fetch_add(static_cast<int64_t>(subDirs.size()), std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(queues[self]->mutex);
+                for (auto& dir : subDirs) {
+                    queues[self]->items.push_back(std::move(dir));
+                }
+                subDirs.clear();
+            }
+            pendingDirs.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        flushBatch();
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        total.files += local.files;
+        total.directories += local.directories;
+        total.excluded += local.excluded;
+        total.errors += local.errors;
+        total.batches += local.batches;
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    total.elapsedMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count());
+    return total;
+}
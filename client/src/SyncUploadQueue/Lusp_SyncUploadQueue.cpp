@@ -36,9 +36,27 @@ void Lusp_SyncUploadQueue::push(const std::vector<std::u16string>& filePaths) {
     d->pushFiles(filePaths);
 }
 void Lusp_SyncUploadQueue::push(const Lusp_SyncUploadFileInfo& fileInfo) {
-    // 不能直接传结构体，需用路径构造handler
-    Lusp_SyncUploadFileInfoHandler handler(fileInfo.sFileFullNameValue);
-    d->pushFileInfo(handler);
+    // 不能直接传结构体，需用路径构造handler(在 pushFile 内完成，等待中的文件不会重复计算摘要)
+    d->pushFile(fileInfo.sFileFullNameValue);
+}
+Lusp_DirectoryWalkStats Lusp_SyncUploadQueue::pushDirectory(const std::u16string& rootDir, const Lusp_DirectoryWalkOptions& options) {
+    return d->pushDirectory(rootDir, options);
+}
+void Lusp_SyncUploadQueue::pushDirectoryAsync(const std::u16string& rootDir, const Lusp_DirectoryWalkOptions& options,
+    std::function<void(const Lusp_DirectoryWalkStats&)> onFinished) {
+    d->pushDirectoryAsync(rootDir, options, std::move(onFinished));
+}
+bool Lusp_SyncUploadQueue::startWatching(const Lusp_DirectoryWatchOptions& options) {
+    return d->startWatching(options);
+}
+void Lusp_SyncUploadQueue::stopWatching() {
+    d->stopWatching();
+}
+bool Lusp_SyncUploadQueue::isWatching() const {
+    return d->isWatching();
+}
+Lusp_DirectoryWatchStats Lusp_SyncUploadQueue::watchStatistics() const {
+    return d->getWatchStatistics();
 }
 void Lusp_SyncUploadQueue::setProgressCallback(ProgressCallback callback) {
     d->progressCallback = std::move(callback);
@@ -58,3 +76,6 @@ bool Lusp_SyncUploadQueue::isActive() const {
 bool Lusp_SyncUploadQueue::empty() const {
     return d->uploadQueue.empty();
 }
+Lusp_UploadQueueMemoryStats Lusp_SyncUploadQueue::memoryStatistics() const {
+    return d->getMemoryStatistics();
+}
@@ -1,8 +1,28 @@
 #include "Lusp_SyncUploadQueuePrivate.h"
+#include "Config/ClientConfigManager.h"
 #include "log_headers.h"
 #include "UniConv.h"
 #include <filesystem>
 
+namespace {
+    /**
+     * @brief 等待索引的键: 词法规范化路径，Windows 下统一分隔符并忽略 ASCII 大小写
+     */
+    std::u16string normalizeQueueKey(const std::u16string& filePath) {
+        std::u16string key = std::filesystem::path(filePath).lexically_normal().u16string();
+#ifdef _WIN32
+        for (auto& ch : key) {
+            if (ch == u'/') {
+                ch = u'\\';
+            }
+            else if (ch >= u'A' && ch <= u'Z') {
+                ch = static_cast<char16_t>(ch + (u'a' - u'A'));
+            }
+        }
+#endif
+        return key;
+    }
+}
 
 Lusp_SyncUploadQueuePrivate::Lusp_SyncUploadQueuePrivate()
     : m_autoStart(true), m_isRunning(false), m_shouldStop(false) {
@@ -15,11 +35,43 @@ Lusp_SyncUploadQueuePrivate::~Lusp_SyncUploadQueuePrivate() {
 void Lusp_SyncUploadQueuePrivate::cleanup() {
     m_shouldStop = true;
     m_isRunning = false;
+
+    stopWatching();
+
+    // 遍历线程观察 m_shouldStop 后会尽快退出
+    std::vector<DirectoryWalkTask> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_walkTasksMutex);
+        tasks.swap(m_walkTasks);
+    }
+    for (auto& task : tasks) {
+        if (task.thread.joinable()) {
+            task.thread.join();
+        }
+    }
 }
 
 void Lusp_SyncUploadQueuePrivate::pushFile(const std::u16string& filePath) {
-    Lusp_SyncUploadFileInfoHandler handler(filePath);
-    pushFileInfo(handler);
+    // 先登记再计算摘要，等待中的文件不再重复读取
+    const std::u16string key = normalizeQueueKey(filePath);
+    if (!reservePending(key)) {
+        return;
+    }
+    try {
+        Lusp_SyncUploadFileInfoHandler handler(filePath);
+        if (!handler.isValid()) {
+            // 文件在事件到达前已被删除等: 解除登记，之后重建的同名文件按新条目入队
+            releasePending(key);
+            g_LogSyncUploadQueueInfo.WriteLogContent(LOG_WARN,
+                "入队跳过无效文件: " + LUSP_UNICONV->ToUtf8FromUtf16LE(filePath) + " " + handler.getError());
+            return;
+        }
+        enqueueFileInfo(handler, key);
+    }
+    catch (...) {
+        releasePending(key);
+        throw;
+    }
 }
 
 void Lusp_SyncUploadQueuePrivate::pushFiles(const std::vector<std::u16string>& filePaths) {
@@ -28,7 +80,192 @@ void Lusp_SyncUploadQueuePrivate::pushFiles(const std::vector<std::u16string>& f
     }
 }
 
+Lusp_DirectoryWalkStats Lusp_SyncUploadQueuePrivate::pushDirectory(const std::u16string& rootDir, const Lusp_DirectoryWalkOptions& options) {
+    const std::string rootUtf8 = LUSP_UNICONV->ToUtf8FromUtf16LE(rootDir);
+    std::error_code ec;
+    if (!std::filesystem::is_directory(std::filesystem::path(rootDir), ec)) {
+        g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR, "pushDirectory: 不是有效目录: " + rootUtf8);
+        return Lusp_DirectoryWalkStats{};
+    }
+
+    Lusp_DirectoryWalkOptions walkOptions = options;
+    if (walkOptions.applyConfigExcludes && !walkOptions.excludeMatcher) {
+        // 取当前快照，遍历期间配置重载不影响本次遍历
+        walkOptions.excludeMatcher = ClientConfigManager::getInstance().getExcludeMatcher();
+    }
+
+    // 批量回调在遍历线程上执行，入队本身线程安全
+    Lusp_ParallelDirectoryWalker walker(walkOptions, [this](std::vector<std::u16string>& batch) {
+        pushFiles(batch);
+    });
+    Lusp_DirectoryWalkStats stats = walker.walk(rootDir, &m_shouldStop);
+
+    g_LogSyncUploadQueueInfo.WriteLogContent(LOG_INFO,
+        "pushDirectory: " + rootUtf8 +
+        " files=" + std::to_string(stats.files) +
+        " dirs=" + std::to_string(stats.directories) +
+        " excluded=" + std::to_string(stats.excluded) +
+        " errors=" + std::to_string(stats.errors) +
+        " batches=" + std::to_string(stats.batches) +
+        " elapsed=" + std::to_string(stats.elapsedMs) + "ms");
+
+    const Lusp_UploadQueueMemoryStats memory = getMemoryStatistics();
+    g_LogSyncUploadQueueInfo.WriteLogContent(LOG_INFO,
+        "pushDirectory: queued=" + std::to_string(memory.queuedItems) +
+        " bytes_per_file=" + std::to_string(memory.bytesPerItem) +
+        " intern_bytes=" + std::to_string(memory.internBytes) +
+        " intern_dirs=" + std::to_string(memory.directories));
+    return stats;
+}
+
+void Lusp_SyncUploadQueuePrivate::pushDirectoryAsync(const std::u16string& rootDir, const Lusp_DirectoryWalkOptions& options,
+    std::function<void(const Lusp_DirectoryWalkStats&)> onFinished) {
+    std::lock_guard<std::mutex> lock(m_walkTasksMutex);
+    reapFinishedWalkTasks();
+
+    auto finished = std::make_shared<std::atomic<bool>>(false);
+    DirectoryWalkTask task;
+    task.finished = finished;
+    task.thread = std::thread([this, rootDir, options, onFinished = std::move(onFinished), finished]() {
+        Lusp_DirectoryWalkStats stats = pushDirectory(rootDir, options);
+        if (onFinished) {
+            try {
+                onFinished(stats);
+            }
+            catch (const std::exception& e) {
+                g_LogSyncUploadQueueInfo.WriteLogContent(LOG_ERROR,
+                    "pushDirectoryAsync 完成回调异常: " + LUSP_UNICONV->ToUtf8FromLocale(e.what()));
+            }
+        }
+        finished->store(true, std::memory_order_release);
+    });
+    m_walkTasks.push_back(std::move(task));
+}
+
+bool Lusp_SyncUploadQueuePrivate::startWatching(const Lusp_DirectoryWatchOptions& options) {
+    std::lock_guard<std::mutex> lock(m_watcherMutex);
+    if (m_watcher) {
+        m_watcher->stop();
+        m_watcher.reset();
+    }
+    // 文件可能在防抖到期后、入队前被删除，逐个入队避免一个失败丢弃整批
+    auto watcher = std::make_unique<Lusp_DirectoryWatcher>(options, [this](std::vector<std::u16string>& batch) {
+        for (const auto& path : batch) {
+            try {
+                pushFile(path);
+            }
+            catch (const std::exception& e) {
+                g_LogSyncUploadQueueInfo.WriteLogContent(LOG_WARN,
+                    "目录监控入队失败: " + LUSP_UNICONV->ToUtf8FromUtf16LE(path) + " " + LUSP_UNICONV->ToUtf8FromLocale(e.what()));
+            }
+        }
+    });
+    if (!watcher->start()) {
+        return false;
+    }
+    m_watcher = std::move(watcher);
+    return true;
+}
+
+void Lusp_SyncUploadQueuePrivate::stopWatching() {
+    std::unique_ptr<Lusp_DirectoryWatcher> watcher;
+    {
+        std::lock_guard<std::mutex> lock(m_watcherMutex);
+        watcher.swap(m_watcher);
+    }
+    if (watcher) {
+        watcher->stop();
+    }
+}
+
+bool Lusp_SyncUploadQueuePrivate::isWatching() const {
+    std::lock_guard<std::mutex> lock(m_watcherMutex);
+    return m_watcher && m_watcher->isRunning();
+}
+
+Lusp_DirectoryWatchStats Lusp_SyncUploadQueuePrivate::getWatchStatistics() const {
+    std::lock_guard<std::mutex> lock(m_watcherMutex);
+    return m_watcher ? m_watcher->getStatistics() : Lusp_DirectoryWatchStats{};
+}
+
+void Lusp_SyncUploadQueuePrivate::reapFinishedWalkTasks() {
+    for (auto it = m_walkTasks.begin(); it != m_walkTasks.end();) {
+        if (it->finished->load(std::memory_order_acquire)) {
+            if (it->thread.joinable()) {
+                it->thread.join();
+            }
+            it = m_walkTasks.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
 void Lusp_SyncUploadQueuePrivate::pushFileInfo(const Lusp_SyncUploadFileInfoHandler& handler) {
+    const std::u16string key = normalizeQueueKey(handler.getFileInfo().sFileFullNameValue);
+    if (reservePending(key)) {
+        enqueueFileInfo(handler, key);
+        return;
+    }
+    // 已在等待: 新内容原位替换，不占新的队列位置
+    const_cast<Lusp_SyncUploadFileInfoHandler&>(handler).setCurrentTimestampMs();
+    auto replacement = std::make_unique<Lusp_CompactUploadItem>(m_internTable.pack(handler.getFileInfo()));
+    PendingShard& shard = pendingShardOf(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            // 替换条目同样计入队列字节数，按新旧差值调整(先加后减，避免计数短暂下溢)
+            m_queuedItemBytes.fetch_add(replacement->approximateBytes(), std::memory_order_relaxed);
+            if (it->second.replacement) {
+                m_queuedItemBytes.fetch_sub(it->second.replacement->approximateBytes(), std::memory_order_relaxed);
+            }
+            it->second.replacement = std::move(replacement);
+            it->second.dirty = false;
+            return;
+        }
+        // 等待中的条目恰好已出队，按新条目入队
+        shard.entries.emplace(key, PendingEntry{});
+    }
+    m_coalescedPushes.fetch_sub(1, std::memory_order_relaxed);
+    enqueueFileInfo(handler, key);
+}
+
+Lusp_SyncUploadQueuePrivate::PendingShard& Lusp_SyncUploadQueuePrivate::pendingShardOf(const std::u16string& key) {
+    return m_pendingShards[std::hash<std::u16string>{}(key) % kPendingShardCount];
+}
+
+bool Lusp_SyncUploadQueuePrivate::reservePending(const std::u16string& key) {
+    if (key.empty()) {
+        return true;
+    }
+    PendingShard& shard = pendingShardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto result = shard.entries.try_emplace(key);
+    if (!result.second) {
+        result.first->second.dirty = true;
+        m_coalescedPushes.fetch_add(1, std::memory_order_relaxed);
+        g_LogSyncUploadQueueInfo.WriteLogContent(LOG_DEBUG, "合并重复入队: " + LUSP_UNICONV->ToUtf8FromUtf16LE(key));
+        return false;
+    }
+    return true;
+}
+
+void Lusp_SyncUploadQueuePrivate::releasePending(const std::u16string& key) {
+    PendingShard& shard = pendingShardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        return;
+    }
+    if (it->second.replacement) {
+        m_queuedItemBytes.fetch_sub(it->second.replacement->approximateBytes(), std::memory_order_relaxed);
+    }
+    shard.entries.erase(it);
+}
+
+void Lusp_SyncUploadQueuePrivate::enqueueFileInfo(const Lusp_SyncUploadFileInfoHandler& handler, const std::u16string& pendingKey) {
     // 入队前补全上传时间戳
     const_cast<Lusp_SyncUploadFileInfoHandler&>(handler).setCurrentTimestampMs();
     auto fileInfo = handler.getFileInfo();
@@ -87,10 +324,12 @@ void Lusp_SyncUploadQueuePrivate::pushFileInfo(const Lusp_SyncUploadFileInfoHand
 
     g_LogSyncUploadQueueInfo.WriteLogContent(
         LOG_INFO,
-        "M-ID " + handler.getId()
+        "M-ID " + handler.getIdText()
     );
 
-    uploadQueue.push(fileInfo);
+    Lusp_CompactUploadItem item = m_internTable.pack(fileInfo, pendingKey);
+    m_queuedItemBytes.fetch_add(item.approximateBytes(), std::memory_order_relaxed);
+    uploadQueue.push(std::move(item));
     if (completedCallbackU16) {
         completedCallbackU16(fileInfo.sFileFullNameValue, true, u"文件已入队");
     }
@@ -98,3 +337,63 @@ void Lusp_SyncUploadQueuePrivate::pushFileInfo(const Lusp_SyncUploadFileInfoHand
         progressCallbackU16(fileInfo.sFileFullNameValue, 0, u"等待上传");
     }
 }
+
+bool Lusp_SyncUploadQueuePrivate::waitAndPop(Lusp_SyncUploadFileInfo& fileInfo) {
+    Lusp_CompactUploadItem item;
+    if (!uploadQueue.waitAndPop(item)) {
+        return false;
+    }
+    m_queuedItemBytes.fetch_sub(item.approximateBytes(), std::memory_order_relaxed);
+    // 登记键随条目保存，不依赖还原出的全路径(文件信息无效时全路径为空)
+    std::u16string key;
+    fileInfo = m_internTable.unpack(item, &key);
+    if (key.empty()) {
+        return true;
+    }
+
+    // 出队即解除登记，之后的入队会生成新条目
+    PendingEntry entry;
+    {
+        PendingShard& shard = pendingShardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            entry = std::move(it->second);
+            shard.entries.erase(it);
+        }
+    }
+
+    const auto enqueueTime = fileInfo.enqueueTime;
+    if (entry.replacement) {
+        m_queuedItemBytes.fetch_sub(entry.replacement->approximateBytes(), std::memory_order_relaxed);
+        fileInfo = m_internTable.unpack(*entry.replacement);
+        fileInfo.enqueueTime = enqueueTime;
+    }
+    else if (entry.dirty) {
+        // 等待期间文件又被推送(如编辑器反复保存)，按当前内容重新生成；未变化时命中摘要缓存
+        Lusp_SyncUploadFileInfoHandler handler(fileInfo.sFileFullNameValue);
+        if (handler.isValid()) {
+            handler.setCurrentTimestampMs();
+            fileInfo = handler.getFileInfo();
+            fileInfo.enqueueTime = enqueueTime;
+            m_refreshedOnDequeue.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            g_LogSyncUploadQueueInfo.WriteLogContent(LOG_WARN,
+                "合并条目刷新失败，按入队时的信息发送: " + LUSP_UNICONV->ToUtf8FromUtf16LE(fileInfo.sFileFullNameValue));
+        }
+    }
+    return true;
+}
+
+Lusp_UploadQueueMemoryStats Lusp_SyncUploadQueuePrivate::getMemoryStatistics() const {
+    Lusp_UploadQueueMemoryStats stats;
+    stats.queuedItems = uploadQueue.size();
+    stats.itemBytes = m_queuedItemBytes.load(std::memory_order_relaxed);
+    stats.internBytes = m_internTable.approximateBytes();
+    stats.directories = m_internTable.directoryCount();
+    if (stats.queuedItems != 0) {
+        stats.bytesPerItem = (stats.itemBytes + stats.internBytes) / stats.queuedItems;
+    }
+    return stats;
+}
@@ -1,12 +1,19 @@
 #ifndef LUSP_SYNCUPLOADQUEUEPRIVATE_H
 #define LUSP_SYNCUPLOADQUEUEPRIVATE_H
 
+#include <array>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <mutex>
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <thread>
 #include "FileInfo/FileInfo.h"
+#include "SyncUploadQueue/Lusp_CompactUploadItem.h"
+#include "SyncUploadQueue/Lusp_DirectoryWatcher.h"
+#include "SyncUploadQueue/Lusp_ParallelDirectoryWalker.h"
 #include "ThreadSafeRowLockQueue/ThreadSafeRowLockQueue.hpp"
 
 class Lusp_SyncUploadFileInfoHandler;
@@ -31,6 +38,7 @@ public:
     /**
      * @brief 入队单个文件路径
      * @param filePath 文件全路径
+     * 同一路径已在队列中等待时只标记为待刷新，不再重复计算摘要；文件不存在时不入队并解除登记
      */
     void pushFile(const std::u16string& filePath);
     /**
@@ -42,8 +50,54 @@ public:
      * @brief 入队文件信息对象
      * @param handler 文件信息处理句柄
      * 只允许传 handler，防止外部绕过校验
+     * 同一路径已在队列中等待时，用新内容原位替换等待中的条目
      */
     void pushFileInfo(const Lusp_SyncUploadFileInfoHandler& handler);
+    /**
+     * @brief 并行遍历目录并批量入队
+     * @param rootDir 根目录
+     * @param options 遍历选项(applyConfigExcludes 为 true 时叠加配置中的排除模式)
+     * @return 遍历统计
+     */
+    Lusp_DirectoryWalkStats pushDirectory(const std::u16string& rootDir, const Lusp_DirectoryWalkOptions& options);
+    /**
+     * @brief 在后台线程执行 pushDirectory
+     * @param onFinished 遍历结束回调(在后台线程上调用)
+     */
+    void pushDirectoryAsync(const std::u16string& rootDir, const Lusp_DirectoryWalkOptions& options,
+        std::function<void(const Lusp_DirectoryWalkStats&)> onFinished);
+    /**
+     * @brief 开始监控目录，变化的文件防抖后批量入队
+     * @return 是否启动成功(已在监控时先停止旧的监控)
+     */
+    bool startWatching(const Lusp_DirectoryWatchOptions& options);
+    /**
+     * @brief 停止目录监控
+     */
+    void stopWatching();
+    bool isWatching() const;
+    /**
+     * @brief 目录监控统计(未监控时全为 0)
+     */
+    Lusp_DirectoryWatchStats getWatchStatistics() const;
+    /**
+     * @brief 阻塞出队并还原为完整文件信息
+     * @param fileInfo 输出的文件信息
+     * @return 被 notifyAll 唤醒且队列为空时返回 false
+     */
+    bool waitAndPop(Lusp_SyncUploadFileInfo& fileInfo);
+    /**
+     * @brief 队列内存占用统计
+     */
+    Lusp_UploadQueueMemoryStats getMemoryStatistics() const;
+    /**
+     * @brief 被合并的重复入队次数
+     */
+    uint64_t getCoalescedCount() const { return m_coalescedPushes.load(std::memory_order_relaxed); }
+    /**
+     * @brief 出队时因合并而刷新(重新读取元数据/摘要)的条目数
+     */
+    uint64_t getRefreshedCount() const { return m_refreshedOnDequeue.load(std::memory_order_relaxed); }
     /**
      * @brief 清理资源
      */
@@ -51,9 +105,9 @@ public:
 
     
     /**
-     * @brief 上传队列，线程安全
+     * @brief 上传队列，线程安全(存放紧凑条目，出队时经 m_internTable 还原)
      */
-    ThreadSafeRowLockQueue<Lusp_SyncUploadFileInfo> uploadQueue;
+    ThreadSafeRowLockQueue<Lusp_CompactUploadItem> uploadQueue;
     /**
      * @brief 业务互斥锁
      */
@@ -81,6 +135,63 @@ public:
      * @brief 停止标志
      */
     std::atomic<bool> m_shouldStop;
+
+private:
+    /**
+     * @brief 后台目录遍历任务
+     */
+    struct DirectoryWalkTask {
+        std::thread                         thread;
+        std::shared_ptr<std::atomic<bool>>  finished;
+    };
+
+    /**
+     * @brief 队列中等待的条目(按规范化路径索引)
+     */
+    struct PendingEntry {
+        bool                                    dirty = false;  ///< 等待期间再次入队，出队时需重新读取文件
+        std::unique_ptr<Lusp_CompactUploadItem> replacement;    ///< 等待期间 pushFileInfo 传入的新内容
+    };
+
+    /**
+     * @brief 等待索引分片，降低并发遍历线程的锁竞争
+     */
+    struct PendingShard {
+        std::mutex                                          mutex;
+        std::unordered_map<std::u16string, PendingEntry>    entries;
+    };
+
+    static constexpr size_t kPendingShardCount = 16;
+
+    /**
+     * @brief 回收已结束的后台遍历线程(调用方需持有 m_walkTasksMutex)
+     */
+    void reapFinishedWalkTasks();
+    /**
+     * @brief 登记等待中的路径
+     * @return 路径已在等待时返回 false(本次入队被合并)
+     */
+    bool reservePending(const std::u16string& key);
+    /**
+     * @brief 取消登记(入队失败时回滚)
+     */
+    void releasePending(const std::u16string& key);
+    /**
+     * @brief 将入队条目写入队列并触发回调
+     * @param pendingKey 已登记的等待索引键(空表示未登记)，随条目保存，出队时据此解除登记
+     */
+    void enqueueFileInfo(const Lusp_SyncUploadFileInfoHandler& handler, const std::u16string& pendingKey);
+    PendingShard& pendingShardOf(const std::u16string& key);
+
+    std::mutex                      m_walkTasksMutex;
+    std::vector<DirectoryWalkTask>  m_walkTasks;
+    Lusp_UploadItemInternTable      m_internTable;          ///< 目录/设备名驻留表
+    std::atomic<size_t>             m_queuedItemBytes{ 0 }; ///< 队列中条目占用的字节数(含等待中的替换条目)
+    std::array<PendingShard, kPendingShardCount> m_pendingShards;   ///< 等待索引
+    std::atomic<uint64_t>           m_coalescedPushes{ 0 };
+    std::atomic<uint64_t>           m_refreshedOnDequeue{ 0 };
+    mutable std::mutex                      m_watcherMutex;
+    std::unique_ptr<Lusp_DirectoryWatcher>  m_watcher;      ///< 目录监控(未启用时为空)
 };
 
 
@@ -12,6 +12,7 @@
 #include <filesystem>
 #include <vector>
 #include "Config/ClientConfigManager.h"
+#include "FileInfo/Lusp_FileDigestCache.h"
 
 int main(int argc, char* argv[]) {
     QApplication app(argc, argv);
@@ -34,12 +35,31 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
+    // 打开文件摘要缓存（必须在任何文件入队之前）
+    const auto& uploadCfg = cfgMgr.getUploadConfig();
+    if (uploadCfg.enableDigestCache) {
+        Lusp_FileDigestCache::instance().open(
+            std::filesystem::u8path(uploadCfg.digestCacheDir), uploadCfg.digestCacheMaxEntries);
+    }
+
     // 用智能指针管理 NotificationService（必须传入配置管理器）
     std::unique_ptr<Lusp_SyncFilesNotificationService> notifier =
         std::make_unique<Lusp_SyncFilesNotificationService>(Lusp_SyncUploadQueue::instance(), cfgMgr);
 
     notifier->start();
 
+    // 目录监控：变化的文件防抖后自动入队
+    if (uploadCfg.enableWatch) {
+        Lusp_DirectoryWatchOptions watchOptions;
+        for (const auto& dir : uploadCfg.watchDirs) {
+            watchOptions.roots.push_back(LUSP_UNICONV->ToUtf16LEFromUtf8(dir));
+        }
+        watchOptions.debounceMs = uploadCfg.watchDebounceMs;
+        watchOptions.initialScan = uploadCfg.watchInitialScan;
+        if (!Lusp_SyncUploadQueue::instance().startWatching(watchOptions)) {
+            g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "目录监控启动失败");
+        }
+    }
 
     // 创建主窗口
     MainWindow window;
@@ -50,8 +70,10 @@ int main(int argc, char* argv[]) {
         g_luspLogWriteImpl.WriteLogContent(LOG_ERROR, "应用程序异常退出，错误码：" + std::to_string(ret));
     }
     // 确保后台线程安全退出
+    Lusp_SyncUploadQueue::instance().stopWatching();
     notifier->stop();
     notifier.reset();
+    Lusp_FileDigestCache::instance().close();
 
     // 关闭日志系统
     shutdownLogging();
@@ -0,0 +1,226 @@
+/**
+ * @file ipc_channel_pool_order_test.cpp
+ * @brief 通道池按文件ID分流时，同一文件的消息在通道断开、迁移与恢复后仍按发送顺序到达
+ *
+ * 1. 测试内的帧服务端(4字节小端长度前缀)接受通道池的全部连接，按 文件ID:序号 校验顺序
+ * 2. 发送过程中关闭其中一条连接的发送方向，客户端读到 EOF 后断开重连，该通道的键迁到其他通道；
+ *    服务端继续读到客户端关闭为止，已写出的消息不会丢
+ * 3. 全部到达后检查: 没有乱序、没有缺号，断开的通道重新连上
+ */
+
+#include "asio/asio.hpp"
+#include "AsioLoopbackIpcClient/Lusp_AsioLoopbackIpcChannelPool.h"
+#include "Config/ClientConfigManager.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr size_t kChannels = 4;
+    constexpr uint64_t kKeys = 64;
+    constexpr uint64_t kRounds = 300;
+    constexpr uint64_t kKillAfterRound = 100;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief 帧服务端: 按序号校验每个文件ID的到达顺序(重复到达只计数，不算乱序)
+     */
+    class OrderCheckingServer {
+    public:
+        explicit OrderCheckingServer(asio::io_context& io_context)
+            : acceptor_(io_context, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0)),
+            next_seq_(kKeys, 0) {
+            do_accept();
+        }
+
+        uint16_t port() const { return acceptor_.local_endpoint().port(); }
+
+        /// 关闭第 index 条连接的发送方向(在 io 线程上执行)
+        void close_connection(size_t index) {
+            asio::post(acceptor_.get_executor(), [this, index]() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (index < sockets_.size()) {
+                    std::error_code ec;
+                    sockets_[index]->shutdown(asio::socket_base::shutdown_send, ec);
+                }
+                });
+        }
+
+        size_t accepted() const { std::lock_guard<std::mutex> lock(mutex_); return sockets_.size(); }
+        uint64_t delivered() const { std::lock_guard<std::mutex> lock(mutex_); return delivered_; }
+        uint64_t duplicates() const { std::lock_guard<std::mutex> lock(mutex_); return duplicates_; }
+        uint64_t order_errors() const { std::lock_guard<std::mutex> lock(mutex_); return order_errors_; }
+
+    private:
+        struct Connection {
+            std::shared_ptr<asio::ip::tcp::socket> socket;
+            std::vector<char> buffer;
+            std::vector<char> chunk = std::vector<char>(64 * 1024);
+        };
+
+        void do_accept() {
+            acceptor_.async_accept([this](std::error_code ec, asio::ip::tcp::socket socket) {
+                if (ec) {
+                    return;
+                }
+                auto connection = std::make_shared<Connection>();
+                connection->socket = std::make_shared<asio::ip::tcp::socket>(std::move(socket));
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    sockets_.push_back(connection->socket);
+                }
+                do_read(connection);
+                do_accept();
+                });
+        }
+
+        void do_read(const std::shared_ptr<Connection>& connection) {
+            connection->socket->async_read_some(asio::buffer(connection->chunk),
+                [this, connection](std::error_code ec, std::size_t len) {
+                    if (ec) {
+                        return;
+                    }
+                    connection->buffer.insert(connection->buffer.end(), connection->chunk.data(), connection->chunk.data() + len);
+                    dispatch(connection->buffer);
+                    do_read(connection);
+                });
+        }
+
+        void dispatch(std::vector<char>& buffer) {
+            size_t offset = 0;
+            while (buffer.size() - offset >= 4) {
+                const auto* head = reinterpret_cast<const uint8_t*>(buffer.data() + offset);
+                const uint32_t len = head[0] | (head[1] << 8) | (head[2] << 16) | (static_cast<uint32_t>(head[3]) << 24);
+                if (buffer.size() - offset < 4 + static_cast<size_t>(len)) {
+                    break;
+                }
+                on_message(std::string(buffer.data() + offset + 4, len));
+                offset += 4 + static_cast<size_t>(len);
+            }
+            buffer.erase(buffer.begin(), buffer.begin() + offset);
+        }
+
+        void on_message(const std::string& message) {
+            unsigned long long key = 0;
+            unsigned long long seq = 0;
+            if (std::sscanf(message.c_str(), "%llu:%llu", &key, &seq) != 2 || key >= kKeys) {
+                return;     // 心跳等非测试消息
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            uint64_t& next = next_seq_[key];
+            if (seq == next) {
+                ++next;
+                ++delivered_;
+            }
+            else if (seq < next) {
+                ++duplicates_;
+            }
+            else {
+                ++order_errors_;    // 越过了尚未到达的消息
+            }
+        }
+
+        asio::ip::tcp::acceptor acceptor_;
+        mutable std::mutex mutex_;
+        std::vector<std::shared_ptr<asio::ip::tcp::socket>> sockets_;
+        std::vector<uint64_t> next_seq_;
+        uint64_t delivered_ = 0;
+        uint64_t duplicates_ = 0;
+        uint64_t order_errors_ = 0;
+    };
+
+    template <class Predicate>
+    bool wait_until(Predicate predicate, std::chrono::seconds timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+}
+
+int main() {
+    // 通道池的持久化队列在工作目录下的 ./queue，换到干净的临时目录，避免上次遗留的消息被重放
+    const auto root = std::filesystem::temp_directory_path() / "lusp_ipc_channel_pool_order_test";
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    std::filesystem::create_directories(root);
+    std::filesystem::current_path(root);
+
+    asio::io_context server_context;
+    OrderCheckingServer server(server_context);
+    std::thread server_thread([&server_context]() { server_context.run(); });
+
+    auto& config = ClientConfigManager::getInstance();
+    config.getUploadConfig().serverHost = "127.0.0.1";
+    config.getUploadConfig().serverPort = server.port();
+    config.getNetworkConfig().maxConnections = kChannels;
+    config.getNetworkConfig().enableAppHeartbeat = false;
+    config.getNetworkConfig().reconnectIntervalMs = 50;
+
+    asio::io_context client_context;
+    auto work_guard = asio::make_work_guard(client_context);
+    std::thread client_thread([&client_context]() { client_context.run(); });
+    Lusp_AsioLoopbackIpcChannelPool pool(client_context, config);
+    pool.connect();
+    check(wait_until([&]() { return pool.get_connected_channel_count() == kChannels; }, std::chrono::seconds(10)),
+        "not all channels connected");
+
+    for (uint64_t round = 0; round < kRounds; ++round) {
+        for (uint64_t key = 0; key < kKeys; ++key) {
+            pool.send(std::to_string(key) + ":" + std::to_string(round), key);
+        }
+        if (round == kKillAfterRound) {
+            server.close_connection(2);
+        }
+        if (round % 20 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    const uint64_t expected = kKeys * kRounds;
+    check(wait_until([&]() { return server.delivered() >= expected; }, std::chrono::seconds(30)),
+        "delivered " + std::to_string(server.delivered()) + " of " + std::to_string(expected));
+    check(server.order_errors() == 0, std::to_string(server.order_errors()) + " message(s) arrived out of order");
+    check(server.accepted() > kChannels, "the closed channel did not reconnect");
+    check(wait_until([&]() { return pool.get_connected_channel_count() == kChannels; }, std::chrono::seconds(10)),
+        "channel count did not recover");
+
+    uint64_t migrated = 0;
+    for (const auto& stats : pool.get_channel_statistics()) {
+        migrated += stats.migrated_messages;
+    }
+    std::cout << "order: delivered " << server.delivered() << ", duplicates " << server.duplicates()
+              << ", migrated " << migrated << ", connections " << server.accepted() << std::endl;
+
+    pool.disconnect();
+    work_guard.reset();
+    client_context.stop();
+    client_thread.join();
+    server_context.stop();
+    server_thread.join();
+
+    std::filesystem::current_path(root.parent_path());
+    if (failures == 0) {
+        std::filesystem::remove_all(root, ec);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file ipc_client_in_flight_test.cpp
+ * @brief 写完成回调晚于 take_pending_messages 时，正在写出的消息既不被迁走也不被误删
+ *
+ * 1. 客户端 io_context 由测试逐个驱动: 第一条消息的写操作发起后、完成回调执行前调用 take_pending_messages
+ * 2. 取出的只有后面两条；正在写出的消息留在队首
+ * 3. 再入队一条后让写完成: 服务端按顺序收到第一条与新的一条，各一次，队列清空
+ */
+
+#include "asio/asio.hpp"
+#include "AsioLoopbackIpcClient/Lusp_AsioLoopbackIpcClient.h"
+#include "Config/ClientConfigManager.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAILED: " << message << std::endl;
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief 帧服务端(4字节小端长度前缀)，按到达顺序记录消息
+     */
+    class RecordingServer {
+    public:
+        explicit RecordingServer(asio::io_context& io_context)
+            : acceptor_(io_context, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0)) {
+            do_accept();
+        }
+
+        uint16_t port() const { return acceptor_.local_endpoint().port(); }
+
+        std::vector<std::string> messages() const { std::lock_guard<std::mutex> lock(mutex_); return messages_; }
+
+    private:
+        struct Connection {
+            asio::ip::tcp::socket socket;
+            std::vector<char> buffer;
+            std::vector<char> chunk = std::vector<char>(4096);
+
+            explicit Connection(asio::ip::tcp::socket s) : socket(std::move(s)) {}
+        };
+
+        void do_accept() {
+            acceptor_.async_accept([this](std::error_code ec, asio::ip::tcp::socket socket) {
+                if (ec) {
+                    return;
+                }
+                do_read(std::make_shared<Connection>(std::move(socket)));
+                do_accept();
+                });
+        }
+
+        void do_read(const std::shared_ptr<Connection>& connection) {
+            connection->socket.async_read_some(asio::buffer(connection->chunk),
+                [this, connection](std::error_code ec, std::size_t len) {
+                    if (ec) {
+                        return;
+                    }
+                    auto& buffer = connection->buffer;
+                    buffer.insert(buffer.end(), connection->chunk.data(), connection->chunk.data() + len);
+                    size_t offset = 0;
+                    while (buffer.size() - offset >= 4) {
+                        const auto* head = reinterpret_cast<const uint8_t*>(buffer.data() + offset);
+                        const uint32_t size = head[0] | (head[1] << 8) | (head[2] << 16) | (static_cast<uint32_t>(head[3]) << 24);
+                        if (buffer.size() - offset < 4 + static_cast<size_t>(size)) {
+                            break;
+                        }
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        messages_.emplace_back(buffer.data() + offset + 4, size);
+                        offset += 4 + static_cast<size_t>(size);
+                    }
+                    buffer.erase(buffer.begin(), buffer.begin() + offset);
+                    do_read(connection);
+                });
+        }
+
+        asio::ip::tcp::acceptor acceptor_;
+        mutable std::mutex mutex_;
+        std::vector<std::string> messages_;
+    };
+
+    /**
+     * @brief 每次只执行客户端 io_context 上一个就绪的回调，直到条件成立
+     * @details 先等待再检查，服务端线程有时间读到已写出的数据；条件成立后不再执行任何回调
+     */
+    template <class Predicate>
+    bool step_until(asio::io_context& io_context, Predicate predicate) {
+        for (int i = 0; i < 500; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (predicate()) {
+                return true;
+            }
+            io_context.poll_one();
+        }
+        return false;
+    }
+
+    std::string join(const std::vector<std::string>& values) {
+        std::string text;
+        for (const auto& value : values) {
+            text += (text.empty() ? "" : ",") + value;
+        }
+        return text;
+    }
+}
+
+int main() {
+    const auto root = std::filesystem::temp_directory_path() / "lusp_ipc_client_in_flight_test";
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    std::filesystem::create_directories(root);
+
+    asio::io_context server_context;
+    RecordingServer server(server_context);
+    std::thread server_thread([&server_context]() { server_context.run(); });
+
+    auto& config = ClientConfigManager::getInstance();
+    config.getUploadConfig().serverHost = "127.0.0.1";
+    config.getUploadConfig().serverPort = server.port();
+    config.getNetworkConfig().enableAppHeartbeat = false;
+
+    asio::io_context client_context;
+    std::atomic<bool> connected{ false };
+    {
+        Lusp_AsioLoopbackIpcClient client(client_context, config, root / "queue");
+        client.on_connection_change([&connected](bool value) { connected.store(value); });
+        client.connect();
+        check(step_until(client_context, [&]() { return connected.load(); }), "client did not connect");
+
+        client.send("m1");
+        client.send("m2");
+        client.send("m3");
+        check(step_until(client_context, [&]() { return !server.messages().empty(); }), "m1 was not written");
+
+        // m1 已写出，完成回调尚未执行
+        std::vector<std::string> taken;
+        for (const auto& ipc_message : client.take_pending_messages()) {
+            taken.emplace_back(ipc_message.data.begin(), ipc_message.data.end());
+        }
+        check(join(taken) == "m2,m3", "taken " + join(taken) + ", expected m2,m3");
+        check(client.get_pending_count() == 1, "in-flight message not kept at the front");
+
+        client.send("m4");
+        step_until(client_context, [&]() { return server.messages().size() >= 2 && client.get_pending_count() == 0; });
+        check(join(server.messages()) == "m1,m4", "server received " + join(server.messages()) + ", expected m1,m4");
+        check(client.get_pending_count() == 0, std::to_string(client.get_pending_count()) + " message(s) left in the queue");
+
+        client.disconnect();
+        client_context.poll();
+    }
+
+    server_context.stop();
+    server_thread.join();
+    if (failures == 0) {
+        std::filesystem::remove_all(root, ec);
+        std::cout << "in-flight: taken m2,m3, server received m1,m4" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}